@@ -4,7 +4,10 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/function.hpp>
 
 #include <boost/iostreams/filtering_stream.hpp>
@@ -32,28 +35,49 @@ namespace common {
 struct BinaryDataReader::Implementation
 {
   Implementation(const URI& file, const Uint rank) :
-    xml_doc(XML::parse_file(file)),
-    m_rank(rank)
+    xml_doc(XML::parse_file(file))
   {
     XmlNode cfbinary(xml_doc->content->first_node("cfbinary"));
-    cf3_assert(from_str<Uint>(cfbinary.attribute_value("version")) == version());
+    cf3_assert(from_str<Uint>(cfbinary.attribute_value("version")) <= version());
+
+    // Version 1 files have neither attribute, and consist of single zlib streams
+    const std::string codec = cfbinary.attribute_value("codec");
+    m_raw = codec == "none";
+    if(!m_raw && !codec.empty() && codec != "zlib" && codec != "zlib_fast")
+      throw FileFormatError(FromHere(), "Unknown codec " + codec + " in " + file.path());
+    const std::string chunk_size = cfbinary.attribute_value("chunk_size");
+    m_chunk_size = chunk_size.empty() ? 0 : from_str<boost::uint64_t>(chunk_size);
 
+    set_rank(rank);
+  }
+
+  // Select the data for the given rank. The binary file is only reopened if it differs from the current one,
+  // so reading several ranks from a file shared by all ranks opens it only once.
+  void set_rank(const Uint rank)
+  {
+    XmlNode cfbinary(xml_doc->content->first_node("cfbinary"));
     XmlNode nodes(cfbinary.content->first_node(("nodes")));
     XmlNode node(nodes.content->first_node("node"));
+    my_node = XmlNode();
     for(; node.is_valid(); node = XmlNode(node.content->next_sibling("node")))
     {
       const Uint found_rank = from_str<Uint>(node.attribute_value("rank"));
-      if(found_rank != m_rank)
+      if(found_rank != rank)
         continue;
 
       const std::string binary_file_name = node.attribute_value("filename");
-
-      binary_file.open(binary_file_name, std::ios_base::in | std::ios_base::binary);
+      if(binary_file_name != m_binary_file_name || !binary_file.is_open())
+      {
+        if(binary_file.is_open())
+          binary_file.close();
+        binary_file.open(binary_file_name, std::ios_base::in | std::ios_base::binary);
+        m_binary_file_name = binary_file_name;
+      }
       my_node = node;
     }
 
     if(!my_node.is_valid())
-      throw SetupError(FromHere(), "No node found for rank " + to_str(m_rank));
+      throw SetupError(FromHere(), "No node found for rank " + to_str(rank));
   }
 
   ~Implementation()
@@ -62,7 +86,7 @@ struct BinaryDataReader::Implementation
 
   Uint version() const
   {
-    static const Uint current_version = 1;
+    static const Uint current_version = 2;
     return current_version;
   }
   
@@ -78,38 +102,103 @@ struct BinaryDataReader::Implementation
     throw SetupError(FromHere(), "Block with index " + to_str(block_idx) + " was not found");
   }
 
-  void read_data_block(char *data, const Uint count, const Uint block_idx)
+  // Read count bytes, starting at byte begin of the uncompressed data, from the given block. For chunked blocks, only the
+  // chunks covering the requested range are decoded.
+  void read_data_range(char *data, const boost::uint64_t begin, const boost::uint64_t count, const Uint block_idx)
   {
     static const std::string block_prefix("__CFDATA_BEGIN");
     
     XmlNode block_node = get_block_node(block_idx);
       
-    const Uint block_begin = from_str<Uint>(block_node.attribute_value("begin"));
-    const Uint block_end = from_str<Uint>(block_node.attribute_value("end"));
-    const Uint compressed_size = block_end - block_begin - block_prefix.size();
+    // Offsets may exceed the range of Uint for files shared by all ranks
+    const boost::uint64_t block_begin = from_str<boost::uint64_t>(block_node.attribute_value("begin"));
+    const boost::uint64_t block_end = from_str<boost::uint64_t>(block_node.attribute_value("end"));
+    const boost::uint64_t data_begin = block_begin + block_prefix.size();
 
     // Check the prefix
-    binary_file.seekg(block_begin);
+    binary_file.seekg(static_cast<std::streamoff>(block_begin));
     std::vector<char> prefix_buf(block_prefix.size());
     binary_file.read(&prefix_buf[0], block_prefix.size());
     const std::string read_prefix(prefix_buf.begin(), prefix_buf.end());
     if(read_prefix != block_prefix)
       throw SetupError(FromHere(), "Bad block prefix for block " + to_str(block_idx));
    
-    if(count != 0)
+    if(count == 0)
+      return;
+
+    if(m_chunk_size == 0)
     {
-      // Build a decompressing stream
-      boost::iostreams::filtering_istream decompressing_stream;
-      decompressing_stream.set_auto_close(false);
-      decompressing_stream.push(boost::iostreams::zlib_decompressor());
-      decompressing_stream.push(boost::iostreams::restrict(binary_file, 0, compressed_size));
-      
-      // Read the data
-      decompressing_stream.read(data, count);
-      decompressing_stream.pop();
+      read_stream(data, begin, count, block_end - data_begin);
+      return;
     }
-    
-    cf3_assert(binary_file.tellg() == block_end);
+
+    // Chunk table
+    boost::uint64_t nb_chunks = 0;
+    binary_file.read(reinterpret_cast<char*>(&nb_chunks), sizeof(boost::uint64_t));
+    std::vector<boost::uint64_t> chunk_ends(nb_chunks);
+    if(nb_chunks != 0)
+      binary_file.read(reinterpret_cast<char*>(&chunk_ends[0]), sizeof(boost::uint64_t)*nb_chunks);
+    const boost::uint64_t chunks_begin = data_begin + sizeof(boost::uint64_t)*(nb_chunks + 1);
+
+    const boost::uint64_t end = begin + count;
+    const boost::uint64_t first_chunk = begin / m_chunk_size;
+    const boost::uint64_t last_chunk = (end - 1) / m_chunk_size;
+    if(last_chunk >= nb_chunks)
+      throw FileFormatError(FromHere(), "Requested data is beyond the end of block " + to_str(block_idx));
+
+    std::vector<char> decoded;
+    for(boost::uint64_t chunk = first_chunk; chunk <= last_chunk; ++chunk)
+    {
+      // Range to copy, relative to the start of the chunk
+      const boost::uint64_t chunk_offset = chunk*m_chunk_size;
+      const boost::uint64_t copy_begin = std::max(begin, chunk_offset) - chunk_offset;
+      const boost::uint64_t copy_end = std::min(end, chunk_offset + m_chunk_size) - chunk_offset;
+      char* destination = data + (chunk_offset + copy_begin - begin);
+
+      const boost::uint64_t encoded_begin = chunk == 0 ? 0 : chunk_ends[chunk-1];
+      binary_file.seekg(static_cast<std::streamoff>(chunks_begin + encoded_begin));
+      if(copy_begin == 0)
+      {
+        read_stream(destination, 0, copy_end, chunk_ends[chunk] - encoded_begin);
+      }
+      else
+      {
+        decoded.resize(copy_end);
+        read_stream(&decoded[0], 0, copy_end, chunk_ends[chunk] - encoded_begin);
+        std::copy(decoded.begin() + copy_begin, decoded.end(), destination);
+      }
+    }
+  }
+
+  // Read count bytes, starting at byte begin of the decoded data, from a single stream of encoded_size bytes starting
+  // at the current position in the file
+  void read_stream(char* data, const boost::uint64_t begin, const boost::uint64_t count, const boost::uint64_t encoded_size)
+  {
+    if(m_raw)
+    {
+      binary_file.seekg(static_cast<std::streamoff>(begin), std::ios_base::cur);
+      binary_file.read(data, count);
+      return;
+    }
+
+    // Build a decompressing stream
+    boost::iostreams::filtering_istream decompressing_stream;
+    decompressing_stream.set_auto_close(false);
+    decompressing_stream.push(boost::iostreams::zlib_decompressor());
+    decompressing_stream.push(boost::iostreams::restrict(binary_file, 0, encoded_size));
+
+    // Skip to the start of the requested data
+    std::vector<char> skipped(std::min(begin, static_cast<boost::uint64_t>(65536)));
+    for(boost::uint64_t nb_skipped = 0; nb_skipped != begin;)
+    {
+      const boost::uint64_t nb_to_skip = std::min(begin - nb_skipped, static_cast<boost::uint64_t>(skipped.size()));
+      decompressing_stream.read(&skipped[0], nb_to_skip);
+      nb_skipped += nb_to_skip;
+    }
+
+    // Read the data
+    decompressing_stream.read(data, count);
+    decompressing_stream.pop();
   }
 
   // XML document describing all data added
@@ -121,8 +210,14 @@ struct BinaryDataReader::Implementation
   // Xml data for the blocks associated with the current rank
   XmlNode my_node;
 
-  // Rank to read
-  const Uint m_rank;
+  // Name of the currently open binary file
+  std::string m_binary_file_name;
+
+  // True if the data is stored uncompressed
+  bool m_raw;
+
+  // Size of the independently compressed chunks, or 0 if each block is a single stream
+  boost::uint64_t m_chunk_size;
 };
   
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -137,7 +232,7 @@ BinaryDataReader::BinaryDataReader ( const std::string& name ) : Component(name)
   options().add("rank", common::PE::Comm::instance().rank())
     .pretty_name("Rank")
     .description("Rank for which to read data")
-    .attach_trigger(boost::bind(&BinaryDataReader::trigger_file, this));
+    .attach_trigger(boost::bind(&BinaryDataReader::trigger_rank, this));
 }
 
 BinaryDataReader::~BinaryDataReader()
@@ -155,9 +250,9 @@ Uint BinaryDataReader::block_cols ( const Uint block_idx )
   return from_str<Uint>(m_implementation->get_block_node(block_idx).attribute_value("nb_cols"));
 }
 
-Uint BinaryDataReader::block_rows ( const Uint block_idx )
+boost::uint64_t BinaryDataReader::block_rows ( const Uint block_idx )
 {
-  return from_str<Uint>(m_implementation->get_block_node(block_idx).attribute_value("nb_rows"));
+  return from_str<boost::uint64_t>(m_implementation->get_block_node(block_idx).attribute_value("nb_rows"));
 }
 
 std::string BinaryDataReader::block_name ( const Uint block_idx )
@@ -171,17 +266,25 @@ std::string BinaryDataReader::block_type_name ( const Uint block_idx )
 }
 
 
-void BinaryDataReader::read_data_block(char *data, const Uint count, const Uint block_idx)
+void BinaryDataReader::read_data_block(char *data, const boost::uint64_t count, const Uint block_idx)
+{
+  read_data_range(data, 0, count, block_idx);
+}
+
+void BinaryDataReader::read_data_range(char *data, const boost::uint64_t begin, const boost::uint64_t count, const Uint block_idx)
 {
   if(is_null(m_implementation.get()))
     throw SetupError(FromHere(), "No open file for BinaryDataReader at " + uri().path());
   
-  m_implementation->read_data_block(data, count, block_idx);
+  m_implementation->read_data_range(data, begin, count, block_idx);
 }
 
 void BinaryDataReader::trigger_file()
 {
   const URI file_uri = options().value<URI>("file");
+  // Nothing to open yet, i.e. when the rank is set before the file
+  if(file_uri.path().empty())
+    return;
   if(!boost::filesystem::exists(file_uri.path()))
   {
     throw SetupError(FromHere(), "Input file " + file_uri.path() + " does not exist");
@@ -189,6 +292,17 @@ void BinaryDataReader::trigger_file()
   m_implementation.reset(new Implementation(file_uri, options().value<Uint>("rank")));
 }
 
+void BinaryDataReader::trigger_rank()
+{
+  if(is_null(m_implementation.get()))
+  {
+    trigger_file();
+    return;
+  }
+
+  m_implementation->set_rank(options().value<Uint>("rank"));
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 } // common
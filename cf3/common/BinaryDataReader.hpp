@@ -7,6 +7,7 @@
 #ifndef cf3_common_BinaryDataReader_hpp
 #define cf3_common_BinaryDataReader_hpp
 
+#include <boost/cstdint.hpp>
 #include <boost/scoped_ptr.hpp>
 
 #include "common/Component.hpp"
@@ -41,13 +42,29 @@ public: // functions
     if(block_type_name(block_idx) != class_name<T>())
       throw SetupError(FromHere(), "Block at index " + to_str(block_idx) + " is of type " + block_type_name(block_idx) + " and can't be stored in " + table.type_name());
     
-    const Uint rows = block_rows(block_idx);
-    const Uint cols = block_cols(block_idx);
+    const boost::uint64_t rows = block_rows(block_idx);
+    const boost::uint64_t cols = block_cols(block_idx);
     table.set_row_size(cols);
     table.resize(rows);
     read_data_block(reinterpret_cast<char*>(table.array().data()), sizeof(T)*rows*cols, block_idx);
   }
   
+  /// Read nb_rows rows of the given block, starting at first_row, into the supplied table, which is resized to nb_rows.
+  /// Only the chunks containing the requested rows are decoded.
+  template<typename T>
+  void read_table_rows(Table<T>& table, const Uint block_idx, const boost::uint64_t first_row, const boost::uint64_t nb_rows)
+  {
+    if(block_type_name(block_idx) != class_name<T>())
+      throw SetupError(FromHere(), "Block at index " + to_str(block_idx) + " is of type " + block_type_name(block_idx) + " and can't be stored in " + table.type_name());
+    if(first_row + nb_rows > block_rows(block_idx))
+      throw SetupError(FromHere(), "Rows " + to_str(first_row) + " to " + to_str(first_row + nb_rows) + " are out of range for block at index " + to_str(block_idx));
+
+    const boost::uint64_t cols = block_cols(block_idx);
+    table.set_row_size(cols);
+    table.resize(nb_rows);
+    read_data_range(reinterpret_cast<char*>(table.array().data()), sizeof(T)*first_row*cols, sizeof(T)*nb_rows*cols, block_idx);
+  }
+
   /// Read the given block into the supplied list. The list is resized as needed
   template<typename T>
   void read_list(List<T>& list, const Uint block_idx)
@@ -55,7 +72,7 @@ public: // functions
     if(block_type_name(block_idx) != class_name<T>())
       throw SetupError(FromHere(), "Block at index " + to_str(block_idx) + " is of type " + block_type_name(block_idx) + " and can't be stored in " + list.type_name());
     
-    const Uint rows = block_rows(block_idx);
+    const boost::uint64_t rows = block_rows(block_idx);
     list.resize(rows);
     read_data_block(reinterpret_cast<char*>(list.array().data()), sizeof(T)*rows, block_idx);
   }
@@ -64,7 +81,7 @@ public: // functions
   void close();
 
   /// Number of rows for the given block
-  Uint block_rows(const Uint block_idx);
+  boost::uint64_t block_rows(const Uint block_idx);
 
   /// Number of columns for the given block
   Uint block_cols(const Uint block_idx);
@@ -77,11 +94,17 @@ public: // functions
 
 private:
   // Read aata block from the binary file
-  void read_data_block(char* data, const Uint count, const Uint block_idx);
+  void read_data_block(char* data, const boost::uint64_t count, const Uint block_idx);
+
+  // Read count bytes starting at byte begin of the given block
+  void read_data_range(char* data, const boost::uint64_t begin, const boost::uint64_t count, const Uint block_idx);
 
   // Trigger on output file change
   void trigger_file();
 
+  // Trigger on rank change, reusing the open file where possible
+  void trigger_rank();
+
   class Implementation;
   boost::scoped_ptr<Implementation> m_implementation;
 };
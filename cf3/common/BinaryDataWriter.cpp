@@ -4,14 +4,24 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <deque>
+
 #include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/foreach.hpp>
 #include <boost/function.hpp>
-#include <boost/assign/list_of.hpp>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 
+#include "common/BasicExceptions.hpp"
 #include "common/Log.hpp"
 #include "common/Signal.hpp"
 #include "common/PropertyList.hpp"
@@ -20,6 +30,7 @@
 #include "common/FindComponents.hpp"
 
 #include "common/PE/Comm.hpp"
+#include "common/PE/operations.hpp"
 
 #include "common/XML/FileOperations.hpp"
 #include "common/XML/XmlNode.hpp"
@@ -31,112 +42,148 @@ namespace common {
 
 struct BinaryDataWriter::Implementation
 {
-  Implementation(const URI& file) :
-    filename(build_filename(file, PE::Comm::instance().rank())),
+  Implementation(const URI& file, const bool asynchronous, const bool shared_file, const std::string& codec, const Uint chunk_size, const Uint nb_threads) :
+    filename(shared_file ? build_shared_filename(file) : build_filename(file, PE::Comm::instance().rank())),
     xml_filename(file),
     index(0),
-    xml_doc("1.0", "ISO-8859-1"),
-    m_total_count(0)
+    m_shared_file(shared_file),
+    m_codec_name(codec),
+    m_chunk_size(chunk_size),
+    m_nb_threads(std::max(nb_threads, 1u)),
+    m_total_count(0),
+    m_finished(false)
   {
-    const Uint v = version();
-    out_file.open(filename, std::ios_base::out | std::ios_base::binary);
-    out_file.write(reinterpret_cast<const char*>(&v), sizeof(Uint));
+    if(codec == "zlib")
+      m_codec = CODEC_ZLIB;
+    else if(codec == "zlib_fast")
+      m_codec = CODEC_ZLIB_FAST;
+    else if(codec == "none")
+      m_codec = CODEC_NONE;
+    else
+      throw SetupError(FromHere(), "Unknown codec " + codec + " for binary data");
 
-    PE::Comm& comm = PE::Comm::instance();
-    // Rank 0 writes out an XML file that lists all filenames for all CPUs
-    if(comm.rank() == 0)
+    // In shared file mode the data is kept in memory until the offset of this rank in the file is known
+    if(!m_shared_file)
     {
-      XmlNode cfbinary = xml_doc.add_node("cfbinary");
-      cfbinary.set_attribute("version", to_str(version()));
-      node_xml_data.reserve(comm.size());
-      XmlNode node_list = cfbinary.add_node("nodes");
-      for(Uint i = 0; i != comm.size(); ++i)
-      {
-        XmlNode node = node_list.add_node("node");
-        node.set_attribute("filename", build_filename(file, i));
-        node.set_attribute("rank", to_str(i));
-        node_xml_data.push_back(node);
-      }
+      const Uint v = version();
+      out_file.open(filename, std::ios_base::out | std::ios_base::binary);
+      out_file.write(reinterpret_cast<const char*>(&v), sizeof(Uint));
     }
+
+    if(asynchronous)
+      m_io_thread.reset(new boost::thread(boost::bind(&Implementation::process_queue, this)));
   }
 
   ~Implementation()
   {
-    CFdebug << "wrote a total of " << m_total_count << " bytes with a compression ratio of " << static_cast<Real>(out_file.tellp()) / static_cast<Real>(m_total_count) * 100. << "%" << CFendl;
-    out_file.close();
-    if(PE::Comm::instance().rank() == 0)
-      XML::to_file(xml_doc, xml_filename);
-
-    PE::Comm::instance().barrier();
+    // Only does something if finish() was not called, i.e. when unwinding after an error
+    stop_io_thread();
   }
 
   Uint write_data_block(const char* data, const std::streamsize count, const std::string& list_name, const Uint nb_rows, const Uint nb_cols, const std::string& type_name)
   {
-    cf3_assert(out_file.is_open());
-    PE::Comm& comm = PE::Comm::instance();
-    // Prefix and suffix markers
-    static const std::string block_prefix("__CFDATA_BEGIN");
+    cf3_assert(m_shared_file || out_file.is_open());
 
-    const Uint block_begin = out_file.tellp();
+    block_names.push_back(list_name);
+    block_type_names.push_back(type_name);
 
-    // Write the prefix
-    out_file.write(block_prefix.c_str(), block_prefix.size());
-    
-    if(count != 0)
+    if(is_null(m_io_thread.get()))
     {
-      // Build a compressed stream
-      boost::iostreams::filtering_ostream compressing_stream;
-      compressing_stream.push(boost::iostreams::zlib_compressor());
-      compressing_stream.push(out_file);
-      
-      // Write the data
-      compressing_stream.write(data, count);
-      compressing_stream.pop();
+      {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        add_block_info(nb_rows, nb_cols);
+      }
+      compress_block(index, data, count);
+    }
+    else
+    {
+      // Stage a copy of the data, so the caller is free to modify it as soon as we return
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      add_block_info(nb_rows, nb_cols);
+      m_queue.push_back(PendingBlock());
+      m_queue.back().index = index;
+      m_queue.back().data.assign(data, data + count);
+      m_condition.notify_one();
     }
 
-    const Uint block_end = out_file.tellp();
+    ++index;
+    m_total_count += count;
+
+    return index - 1;
+  }
+
+  /// Wait for the pending blocks and write the XML file describing the blocks of all ranks. Collective.
+  void finish()
+  {
+    stop_io_thread();
+
+    OffsetT nb_bytes_written = 0;
+    if(m_shared_file)
+    {
+      nb_bytes_written = write_shared_file();
+    }
+    else
+    {
+      nb_bytes_written = out_file.tellp();
+      out_file.close();
+    }
+    CFdebug << "wrote a total of " << m_total_count << " bytes with a compression ratio of " << static_cast<Real>(nb_bytes_written) / static_cast<Real>(m_total_count) * 100. << "%" << CFendl;
 
-    // Data describing the block on the current CPU
-    const std::vector<Uint> my_block_info = boost::assign::list_of(nb_rows)(nb_cols)(block_begin)(block_end);
-    const Uint block_info_size = my_block_info.size();
-    std::vector<Uint> global_block_info;
+    // Data describing the blocks on all CPUs, gathered in one go
+    PE::Comm& comm = PE::Comm::instance();
+    std::vector<OffsetT> global_block_info;
     const Uint root = 0;
     if(comm.is_active())
     {
-      comm.gather(my_block_info, global_block_info, root);
+      comm.gather(m_block_info, global_block_info, root);
     }
     else
     {
-      global_block_info = my_block_info;
+      global_block_info = m_block_info;
     }
 
-    // Write out the XML data
+    // Rank 0 writes out an XML file that lists all filenames and blocks for all CPUs
     if(comm.rank() == root)
     {
+      XmlDoc xml_doc("1.0", "ISO-8859-1");
+      XmlNode cfbinary = xml_doc.add_node("cfbinary");
+      cfbinary.set_attribute("version", to_str(version()));
+      cfbinary.set_attribute("shared_file", m_shared_file ? "true" : "false");
+      cfbinary.set_attribute("codec", m_codec_name);
+      cfbinary.set_attribute("chunk_size", to_str(m_chunk_size));
+      XmlNode node_list = cfbinary.add_node("nodes");
       const Uint nb_procs = comm.size();
+      const Uint nb_blocks = block_names.size();
       for(Uint i = 0; i != nb_procs; ++i)
       {
-        XmlNode block_xml = node_xml_data[i].add_node("block");
-        const Uint j = i*block_info_size;
-        block_xml.set_attribute("name", list_name);
-        block_xml.set_attribute("index", to_str(index));
-        block_xml.set_attribute("type_name", type_name);
-        block_xml.set_attribute("nb_rows", to_str(global_block_info[j]));
-        block_xml.set_attribute("nb_cols", to_str(global_block_info[j+1]));
-        block_xml.set_attribute("begin", to_str(global_block_info[j+2]));
-        block_xml.set_attribute("end", to_str(global_block_info[j+3]));
+        XmlNode node = node_list.add_node("node");
+        node.set_attribute("filename", m_shared_file ? filename : build_filename(xml_filename, i));
+        node.set_attribute("rank", to_str(i));
+        for(Uint block_idx = 0; block_idx != nb_blocks; ++block_idx)
+        {
+          XmlNode block_xml = node.add_node("block");
+          const Uint j = (i*nb_blocks + block_idx)*block_info_size;
+          block_xml.set_attribute("name", block_names[block_idx]);
+          block_xml.set_attribute("index", to_str(block_idx));
+          block_xml.set_attribute("type_name", block_type_names[block_idx]);
+          block_xml.set_attribute("nb_rows", to_str(global_block_info[j]));
+          block_xml.set_attribute("nb_cols", to_str(global_block_info[j+1]));
+          block_xml.set_attribute("begin", to_str(global_block_info[j+2]));
+          block_xml.set_attribute("end", to_str(global_block_info[j+3]));
+        }
       }
+      XML::to_file(xml_doc, xml_filename);
     }
 
-    ++index;
-    m_total_count += count;
+    comm.barrier();
 
-    return index - 1;
+    if(!m_error.empty())
+      throw FileSystemError(FromHere(), "Error writing to " + filename + ": " + m_error);
   }
 
   Uint version() const
   {
-    static const Uint current_version = 1;
+    static const Uint current_version = 2;
     return current_version;
   }
 
@@ -148,6 +195,12 @@ struct BinaryDataWriter::Implementation
     return result.path();
   }
 
+  std::string build_shared_filename(const URI& input)
+  {
+    const URI result(input.base_path() / (input.base_name() + ".cfbin"));
+    return result.path();
+  }
+
   const std::string filename;
   const URI xml_filename;
   boost::filesystem::fstream out_file;
@@ -155,11 +208,317 @@ struct BinaryDataWriter::Implementation
   // Index of the next block to write
   Uint index;
 
-  // XML document describing all data added (only valid on root process)
-  XmlDoc xml_doc;
+  // Name and type name for each block
+  std::vector<std::string> block_names;
+  std::vector<std::string> block_type_names;
+
+private:
+  // Offsets in the shared file may exceed the range of Uint
+  typedef boost::uint64_t OffsetT;
+
+  enum Codec
+  {
+    CODEC_ZLIB,
+    CODEC_ZLIB_FAST,
+    CODEC_NONE
+  };
+
+  // Number of rows, number of columns, begin and end offset for each block
+  static const Uint block_info_size = 4;
+
+  // A copy of the data for a block, waiting to be written by the I/O thread
+  struct PendingBlock
+  {
+    Uint index;
+    std::vector<char> data;
+  };
+
+  // Must be called with the mutex locked
+  void add_block_info(const Uint nb_rows, const Uint nb_cols)
+  {
+    m_block_info.push_back(nb_rows);
+    m_block_info.push_back(nb_cols);
+    m_block_info.push_back(0);
+    m_block_info.push_back(0);
+  }
+
+  // Compress and write the data for the given block to the binary file. This may run on the I/O thread, so errors are
+  // stored and reported by finish()
+  void compress_block(const Uint block_idx, const char* data, const std::streamsize count)
+  {
+    // Prefix and suffix markers
+    static const std::string block_prefix("__CFDATA_BEGIN");
+
+    // In shared file mode, offsets are relative to the start of the data for this rank until write_shared_file shifts them
+    std::vector<char> encoded_block;
+    std::vector<char>& out = m_shared_file ? m_shared_data : encoded_block;
+    const OffsetT encoded_begin = out.size();
+    out.insert(out.end(), block_prefix.begin(), block_prefix.end());
+    const std::string error = encode_block(data, count, out);
+
+    OffsetT block_begin = encoded_begin;
+    OffsetT block_end = out.size();
+    if(!m_shared_file)
+    {
+      block_begin = out_file.tellp();
+      out_file.write(&encoded_block[0], encoded_block.size());
+      block_end = out_file.tellp();
+    }
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if(!error.empty() && m_error.empty())
+      m_error = error;
+    if(!m_shared_file && !out_file.good() && m_error.empty())
+      m_error = "failed to write block " + to_str(block_idx);
+    m_block_info[block_idx*block_info_size + 2] = block_begin;
+    m_block_info[block_idx*block_info_size + 3] = block_end;
+  }
+
+  // Append the encoded data to out. With a chunk size of 0, this is a single compressed stream. Otherwise, the data is
+  // split into chunks of chunk_size bytes that are compressed independently, preceded by a table with the number of
+  // chunks and the end offset of each chunk, relative to the end of the table. Returns an error message on failure.
+  std::string encode_block(const char* data, const std::streamsize count, std::vector<char>& out) const
+  {
+    if(count == 0)
+      return std::string();
+
+    if(m_chunk_size == 0)
+      return encode_chunk(data, count, m_codec, out);
+
+    const OffsetT nb_chunks = (count + m_chunk_size - 1) / m_chunk_size;
+    std::vector< std::vector<char> > chunks(nb_chunks);
+    const Uint nb_threads = std::min(static_cast<OffsetT>(m_nb_threads), nb_chunks);
+    std::vector<std::string> errors(nb_threads);
+    if(nb_threads == 1)
+    {
+      ChunkEncoder(data, count, m_chunk_size, m_codec, 0, 1, chunks, errors[0])();
+    }
+    else
+    {
+      boost::thread_group threads;
+      for(Uint i = 0; i != nb_threads; ++i)
+        threads.create_thread(ChunkEncoder(data, count, m_chunk_size, m_codec, i, nb_threads, chunks, errors[i]));
+      threads.join_all();
+    }
+    BOOST_FOREACH(const std::string& error, errors)
+    {
+      if(!error.empty())
+        return error;
+    }
+
+    std::vector<OffsetT> chunk_table(nb_chunks + 1);
+    chunk_table[0] = nb_chunks;
+    OffsetT chunk_end = 0;
+    for(OffsetT i = 0; i != nb_chunks; ++i)
+    {
+      chunk_end += chunks[i].size();
+      chunk_table[i+1] = chunk_end;
+    }
+    const char* table_data = reinterpret_cast<const char*>(&chunk_table[0]);
+    out.insert(out.end(), table_data, table_data + sizeof(OffsetT)*chunk_table.size());
+    for(OffsetT i = 0; i != nb_chunks; ++i)
+    {
+      out.insert(out.end(), chunks[i].begin(), chunks[i].end());
+      std::vector<char>().swap(chunks[i]);
+    }
+
+    return std::string();
+  }
+
+  // Encode count bytes of data using the given codec, appending the result to out
+  static std::string encode_chunk(const char* data, const std::streamsize count, const Codec codec, std::vector<char>& out)
+  {
+    if(codec == CODEC_NONE)
+    {
+      out.insert(out.end(), data, data + count);
+      return std::string();
+    }
+
+    try
+    {
+      boost::iostreams::filtering_ostream compressing_stream;
+      compressing_stream.push(boost::iostreams::zlib_compressor(codec == CODEC_ZLIB_FAST ? boost::iostreams::zlib::best_speed : boost::iostreams::zlib::default_compression));
+      compressing_stream.push(boost::iostreams::back_inserter(out));
+      compressing_stream.write(data, count);
+      compressing_stream.pop();
+    }
+    catch(std::exception& e)
+    {
+      return e.what();
+    }
+    return std::string();
+  }
+
+  // Encodes the chunks thread_idx, thread_idx + nb_threads, ... of a block
+  struct ChunkEncoder
+  {
+    ChunkEncoder(const char* data, const std::streamsize count, const OffsetT chunk_size, const Codec codec, const Uint thread_idx, const Uint nb_threads, std::vector< std::vector<char> >& chunks, std::string& error) :
+      m_data(data),
+      m_count(count),
+      m_chunk_size(chunk_size),
+      m_codec(codec),
+      m_thread_idx(thread_idx),
+      m_nb_threads(nb_threads),
+      m_chunks(chunks),
+      m_error(error)
+    {
+    }
+
+    void operator()()
+    {
+      const OffsetT nb_chunks = m_chunks.size();
+      for(OffsetT i = m_thread_idx; i < nb_chunks; i += m_nb_threads)
+      {
+        const OffsetT chunk_begin = i*m_chunk_size;
+        const OffsetT chunk_count = std::min(m_chunk_size, static_cast<OffsetT>(m_count) - chunk_begin);
+        m_error = encode_chunk(m_data + chunk_begin, chunk_count, m_codec, m_chunks[i]);
+        if(!m_error.empty())
+          return;
+      }
+    }
+
+    const char* m_data;
+    const std::streamsize m_count;
+    const OffsetT m_chunk_size;
+    const Codec m_codec;
+    const Uint m_thread_idx;
+    const Uint m_nb_threads;
+    std::vector< std::vector<char> >& m_chunks;
+    std::string& m_error;
+  };
+
+  // Main loop of the I/O thread
+  void process_queue()
+  {
+    PendingBlock block;
+    while(true)
+    {
+      {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        while(m_queue.empty() && !m_finished)
+          m_condition.wait(lock);
+        if(m_queue.empty())
+          return;
+        block.index = m_queue.front().index;
+        block.data.swap(m_queue.front().data);
+        m_queue.pop_front();
+      }
+
+      try
+      {
+        compress_block(block.index, block.data.empty() ? 0 : &block.data[0], block.data.size());
+      }
+      catch(std::exception& e)
+      {
+        boost::lock_guard<boost::mutex> lock(m_mutex);
+        m_error = e.what();
+        m_queue.clear();
+        return;
+      }
+      std::vector<char>().swap(block.data);
+    }
+  }
+
+  // Write the data of all ranks into a single file, with the data for each rank starting at an offset obtained from the
+  // sizes of the data of the preceding ranks. Returns the number of bytes written by this rank. Collective.
+  OffsetT write_shared_file()
+  {
+    PE::Comm& comm = PE::Comm::instance();
+    const OffsetT my_size = m_shared_data.size();
+    std::vector<OffsetT> sizes(1, my_size);
+    if(comm.is_active())
+      comm.all_gather(my_size, sizes);
+
+    const OffsetT header_size = sizeof(Uint);
+    OffsetT my_begin = header_size;
+    OffsetT total_size = header_size;
+    for(Uint i = 0; i != sizes.size(); ++i)
+    {
+      if(i < comm.rank())
+        my_begin += sizes[i];
+      total_size += sizes[i];
+    }
+
+    const Uint nb_blocks = m_block_info.size() / block_info_size;
+    for(Uint i = 0; i != nb_blocks; ++i)
+    {
+      m_block_info[i*block_info_size + 2] += my_begin;
+      m_block_info[i*block_info_size + 3] += my_begin;
+    }
+
+    const Uint v = version();
+    if(comm.is_active())
+    {
+      MPI_File file_handle;
+      MPI_CHECK_RESULT(MPI_File_open, (comm.communicator(), const_cast<char*>(filename.c_str()), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file_handle));
+      MPI_CHECK_RESULT(MPI_File_set_size, (file_handle, total_size));
+      if(comm.rank() == 0)
+        MPI_CHECK_RESULT(MPI_File_write_at, (file_handle, 0, const_cast<Uint*>(&v), sizeof(Uint), MPI_BYTE, MPI_STATUS_IGNORE));
+
+      // MPI counts are ints, so write in chunks. The collective write needs the same number of calls on each rank.
+      const OffsetT chunk_size = 1 << 30;
+      const OffsetT my_nb_chunks = (my_size + chunk_size - 1) / chunk_size;
+      OffsetT nb_chunks = 0;
+      comm.all_reduce(PE::max(), &my_nb_chunks, 1, &nb_chunks);
+      for(OffsetT chunk = 0; chunk != nb_chunks; ++chunk)
+      {
+        const OffsetT chunk_begin = std::min(chunk*chunk_size, my_size);
+        const int chunk_count = static_cast<int>(std::min(chunk_size, my_size - chunk_begin));
+        MPI_CHECK_RESULT(MPI_File_write_at_all, (file_handle, my_begin + chunk_begin, chunk_count == 0 ? 0 : &m_shared_data[chunk_begin], chunk_count, MPI_BYTE, MPI_STATUS_IGNORE));
+      }
+      MPI_CHECK_RESULT(MPI_File_close, (&file_handle));
+    }
+    else
+    {
+      out_file.open(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+      out_file.write(reinterpret_cast<const char*>(&v), sizeof(Uint));
+      if(my_size != 0)
+        out_file.write(&m_shared_data[0], my_size);
+      out_file.close();
+    }
 
-  std::vector<XmlNode> node_xml_data;
-  Uint m_total_count;
+    std::vector<char>().swap(m_shared_data);
+    return my_size;
+  }
+
+  void stop_io_thread()
+  {
+    if(is_null(m_io_thread.get()))
+      return;
+
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_finished = true;
+    }
+    m_condition.notify_all();
+    m_io_thread->join();
+    m_io_thread.reset();
+  }
+
+  // True if all ranks write to a single file
+  const bool m_shared_file;
+
+  // Compressed data for this rank in shared file mode
+  std::vector<char> m_shared_data;
+
+  // Compression settings
+  const std::string m_codec_name;
+  Codec m_codec;
+  const OffsetT m_chunk_size;
+  const Uint m_nb_threads;
+
+  boost::uint64_t m_total_count;
+
+  // Block info for the current rank, protected by the mutex since the I/O thread fills in the offsets
+  std::vector<OffsetT> m_block_info;
+
+  // Thread doing the compression and writing in asynchronous mode
+  boost::scoped_ptr<boost::thread> m_io_thread;
+  boost::mutex m_mutex;
+  boost::condition_variable m_condition;
+  std::deque<PendingBlock> m_queue;
+  bool m_finished;
+  std::string m_error;
 };
   
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -170,23 +529,59 @@ BinaryDataWriter::BinaryDataWriter ( const std::string& name ) : Component(name)
     .pretty_name("File")
     .description("File name for the output file")
     .attach_trigger(boost::bind(&BinaryDataWriter::trigger_file, this));
+
+  options().add("asynchronous", false)
+    .pretty_name("Asynchronous")
+    .description("Return immediately from append_data, compressing and writing the data on a separate I/O thread");
+
+  options().add("shared_file", false)
+    .pretty_name("Shared File")
+    .description("Write the data of all ranks into a single binary file, instead of one file per rank");
+
+  std::vector<boost::any> codecs;
+  codecs.push_back(std::string("zlib"));
+  codecs.push_back(std::string("zlib_fast"));
+  codecs.push_back(std::string("none"));
+  options().add("codec", std::string("zlib"))
+    .pretty_name("Codec")
+    .description("Compression used for the data blocks: zlib, zlib_fast (fastest zlib level) or none")
+    .restricted_list() = codecs;
+
+  options().add("chunk_size", 1048576u)
+    .pretty_name("Chunk Size")
+    .description("Size in bytes of the independently compressed chunks each block is split into. 0 compresses each block as a single stream.");
+
+  options().add("nb_threads", 1u)
+    .pretty_name("Number of Threads")
+    .description("Number of threads used to compress the chunks of a block");
 }
 
 BinaryDataWriter::~BinaryDataWriter()
 {
-  close();
+  try
+  {
+    close();
+  }
+  catch(std::exception& e)
+  {
+    CFerror << e.what() << CFendl;
+  }
 }
 
 void BinaryDataWriter::close()
 {
-  m_implementation.reset();
+  boost::scoped_ptr<Implementation> implementation;
+  implementation.swap(m_implementation);
+  if(is_not_null(implementation.get()))
+    implementation->finish();
 }
 
 Uint BinaryDataWriter::write_data_block(const char* data, const std::streamsize count, const std::string& list_name, const Uint nb_rows, const Uint nb_cols, const std::string& type_name)
 {
   if(is_null(m_implementation.get()))
   {
-    m_implementation.reset(new Implementation(options().value<URI>("file")));
+    m_implementation.reset(new Implementation(options().value<URI>("file"), options().value<bool>("asynchronous"), options().value<bool>("shared_file"),
+                                              options().value<std::string>("codec"), options().value<Uint>("chunk_size"), options().value<Uint>("nb_threads")));
   }
 
   return m_implementation->write_data_block(data, count, list_name, nb_rows, nb_cols, type_name);
@@ -194,7 +589,7 @@ Uint BinaryDataWriter::write_data_block(const char* data, const std::streamsize
 
 void BinaryDataWriter::trigger_file()
 {
-  m_implementation.reset();
+  close();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -22,6 +22,10 @@ namespace common {
 
   
 /// Component for writing binary data collected into a single file
+/// If the option "asynchronous" is set, append_data copies the data into a staging buffer and returns immediately,
+/// while the compression and writing take place on a separate I/O thread. close() waits for that thread to finish.
+/// If the option "shared_file" is set, the compressed blocks are kept in memory until close(), which writes the data of all
+/// ranks into a single file at offsets computed from the data sizes, using collective MPI-IO.
 class Common_API BinaryDataWriter : public Component {
 
 public: // functions
@@ -48,7 +52,7 @@ public: // functions
     return write_data_block(reinterpret_cast<const char*>(list.array().data()), sizeof(T)*list.size(), list.name(), list.size(), 1, class_name<T>());
   }
 
-  /// Close the current file
+  /// Close the current file. This is a collective operation, which waits for any pending asynchronous writes.
   void close();
 
 private:
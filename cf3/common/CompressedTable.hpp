@@ -0,0 +1,146 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_CompressedTable_hpp
+#define cf3_common_CompressedTable_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/range/iterator_range.hpp>
+
+#include "common/Component.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Component holding a table with variable row-size per row, stored in compressed row format:
+/// all values are in one contiguous array, and an array of offsets marks the start of each row.
+/// Rows are accessed as in DynTable, but cannot change size once built. The table is filled
+/// using a Builder, which first counts the size of each row and then fills the values.
+template<typename T>
+class CompressedTable : public common::Component {
+
+public:
+
+  typedef std::vector<T> ValuesT;
+  typedef boost::iterator_range<typename ValuesT::iterator> Row;
+  typedef boost::iterator_range<typename ValuesT::const_iterator> ConstRow;
+
+  /// Fills a CompressedTable in two passes: first count the number of values in each row,
+  /// then call allocate() and add the values. Rows are filled in the order the values are added.
+  class Builder
+  {
+  public:
+    /// Clears the table, which will get nb_rows rows
+    Builder(CompressedTable& table, const Uint nb_rows) :
+      m_table(table),
+      m_positions(nb_rows, 0u)
+    {
+      m_table.m_offsets.assign(1, 0u);
+      m_table.m_values.clear();
+    }
+
+    /// Count nb_values extra values for the given row
+    void count(const Uint row, const Uint nb_values = 1)
+    {
+      cf3_assert(row < m_positions.size());
+      m_positions[row] += nb_values;
+    }
+
+    /// Allocate the table, after all values were counted
+    void allocate()
+    {
+      const Uint nb_rows = m_positions.size();
+      m_table.m_offsets.resize(nb_rows+1);
+      for(Uint i = 0; i != nb_rows; ++i)
+      {
+        m_table.m_offsets[i+1] = m_table.m_offsets[i] + m_positions[i];
+        m_positions[i] = m_table.m_offsets[i];
+      }
+      m_table.m_values.resize(m_table.m_offsets.back());
+    }
+
+    /// Add a value to the given row, after allocate() was called
+    void add(const Uint row, const T& value)
+    {
+      cf3_assert(row < m_positions.size());
+      cf3_assert(m_positions[row] < m_table.m_offsets[row+1]);
+      m_table.m_values[m_positions[row]++] = value;
+    }
+
+  private:
+    CompressedTable& m_table;
+    /// Number of values per row while counting, next position to fill after allocation
+    std::vector<Uint> m_positions;
+  };
+
+  /// Contructor
+  /// @param name of the component
+  CompressedTable ( const std::string& name ) : Component(name), m_offsets(1, 0u) { }
+
+  ~CompressedTable () {}
+
+  /// Get the class name
+  static std::string type_name () { return "CompressedTable<"+common::class_name<T>()+">"; }
+
+  Uint size() const { return m_offsets.size() - 1; }
+
+  /// Change the number of rows. Added rows are empty.
+  void resize(const Uint new_size)
+  {
+    const Uint end_offset = new_size < size() ? m_offsets[new_size] : m_offsets.back();
+    m_offsets.resize(new_size+1, end_offset);
+    m_values.resize(end_offset);
+  }
+
+  Uint row_size(const Uint i) const { return m_offsets[i+1] - m_offsets[i]; }
+
+  Row operator[] (const Uint idx)
+  {
+    return Row(m_values.begin() + m_offsets[idx], m_values.begin() + m_offsets[idx+1]);
+  }
+
+  ConstRow operator[] (const Uint idx) const
+  {
+    return ConstRow(m_values.begin() + m_offsets[idx], m_values.begin() + m_offsets[idx+1]);
+  }
+
+  /// Start of each row in values(), with one extra entry for the end of the last row
+  const std::vector<Uint>& offsets() const { return m_offsets; }
+
+  /// All values, row by row
+  const ValuesT& values() const { return m_values; }
+
+  /// Memory used by the offsets and values, in bytes
+  std::size_t memory_size() const { return m_offsets.capacity()*sizeof(Uint) + m_values.capacity()*sizeof(T); }
+
+private: // data
+
+  friend class Builder;
+
+  std::vector<Uint> m_offsets;
+  ValuesT m_values;
+
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::ostream& operator<<(std::ostream& os, const CompressedTable<Uint>& table);
+std::ostream& operator<<(std::ostream& os, const CompressedTable<int>& table);
+std::ostream& operator<<(std::ostream& os, const CompressedTable<Real>& table);
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_CompressedTable_hpp
@@ -0,0 +1,328 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_HashMap_hpp
+#define cf3_common_HashMap_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <limits>
+
+#include <boost/cstdint.hpp>
+
+#include "common/Component.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// This component class represents a map with integral keys, typically used
+/// to translate global indices to local indices.
+///
+/// Contrary to Map, entries can be inserted and looked up in any order, in
+/// constant time, without ever sorting. The pairs are stored contiguously in
+/// insertion order, and an open-addressing table with linear probing stores
+/// the index of the pair for each key. The table is kept at most half full.
+/// Iterating visits the pairs in insertion order.
+///
+/// @pre KEY is an integral type
+template <typename KEY, typename DATA>
+class HashMap : public Component {
+
+public: // typedefs
+
+  /// @brief Associative Container -- The map's key type, Key.
+  typedef KEY key_type;
+  /// @brief Pair Associative Container -- The type of object associated with the keys.
+  typedef DATA data_type;
+  /// @brief The type of object, pair<key_type, data_type>, stored in the map.
+  typedef std::pair<key_type, data_type> value_type;
+
+  /// @brief iterator definition for use in stl algorithms
+  typedef typename std::vector<value_type>::iterator         iterator;
+  /// @brief const_iterator definition for use in stl algorithms
+  typedef typename std::vector<value_type>::const_iterator   const_iterator;
+
+public: // functions
+
+  /// Contructor
+  /// @param[in] name of the component
+  HashMap ( const std::string& name ) : Component(name)
+  {
+    regist_typeinfo(this);
+    clear();
+  }
+
+  /// Virtual destructor
+  virtual ~HashMap() {}
+
+  /// Get the class name
+  static std::string type_name () { return "HashMap<"+common::class_name<KEY>()+","+common::class_name<DATA>()+">"; }
+
+  /// @brief Reserve memory
+  /// @param[in] max_size of the map to be set before starting inserting pairs in the map
+  /// @post no reallocation happens until more than max_size pairs are inserted
+  void reserve (size_t max_size);
+
+  /// @brief Insert a pair that is not yet in the map
+  /// @param[in] key   new key to be inserted
+  /// @param[in] data  new data to be inserted, corresponding to the given key
+  /// @return the index of the new pair in the iteration order
+  Uint push_back(const key_type& key, const data_type& data);
+
+  /// @brief Insert pair the same way a std::map would.
+  /// @returns a pair, with its member pair::first set to an
+  ///          iterator pointing to either the newly inserted element or to the element
+  ///          that already had its same value in the map. The pair::second element in
+  ///          the pair is set to true if a new element was inserted or false if an element
+  ///          with the same value existed.
+  std::pair<iterator,bool> insert(const value_type& v);
+
+  /// @brief Find the iterator matching with the given KEY
+  /// @return the iterator with key and value, the end() iterator is returned
+  ///         if no match is found
+  iterator find(const key_type& key);
+
+  /// @brief Find the iterator matching with the given KEY
+  /// @return the iterator with key and value, the end() iterator is returned
+  ///         if no match is found
+  const_iterator find(const key_type& key) const;
+
+  /// @brief Erase the entry with given key from the map
+  /// @note The last pair takes the place of the erased one in the iteration order
+  /// @returns true if element is erased, false if no element was erased
+  bool erase (const key_type& key);
+
+  /// @brief Check if the given KEY is existing in the map
+  bool exists(const key_type& key) const;
+
+  /// @brief Clear the content of the map, releasing its memory
+  void clear();
+
+  /// @brief Get the number of pairs already inserted
+  size_t size() const { return m_values.size(); }
+
+  /// @brief Get the capacity of the map (number of pairs that can be inserted without reallocation)
+  size_t capacity() const { return m_slots.size() / 2; }
+
+  /// @brief Overloading of the operator"[]" for assignment AND insertion
+  /// @param[in] key The key to look for. If the key is not found,
+  ///               it is inserted using push_back().
+  /// @return modifiable data. In case the key did not exist, this will assign the newly created data.
+  data_type& operator[] (const key_type& key);
+
+  /// @brief Overloading of the operator"[]" for lookup
+  /// @pre the key is in the map
+  /// @return non-modifiable data for the given key
+  const data_type& operator[] (const key_type& key) const;
+
+  /// @return the iterator pointing at the first element
+  iterator begin() { return m_values.begin(); }
+
+  /// @return the const_iterator pointing at the first element
+  const_iterator begin() const { return m_values.begin(); }
+
+  /// @return the end iterator
+  iterator end() { return m_values.end(); }
+
+  /// @return the end const_iterator
+  const_iterator end() const { return m_values.end(); }
+
+private: // helper functions
+
+  /// Marks an empty slot
+  static Uint empty_slot() { return std::numeric_limits<Uint>::max(); }
+
+  /// Hash of a key. The bits are mixed, so consecutive or strided keys spread over the slots.
+  static size_t hash(const key_type& key)
+  {
+    boost::uint64_t result = static_cast<boost::uint64_t>(key);
+    result ^= result >> 33;
+    result *= 0xff51afd7ed558ccdULL;
+    result ^= result >> 33;
+    result *= 0xc4ceb9fe1a85ec53ULL;
+    result ^= result >> 33;
+    return static_cast<size_t>(result);
+  }
+
+  /// Slot that holds the key, or the empty slot where it would be inserted
+  size_t probe(const key_type& key) const
+  {
+    const size_t mask = m_slots.size() - 1;
+    size_t slot = hash(key) & mask;
+    while(m_slots[slot] != empty_slot() && m_values[m_slots[slot]].first != key)
+      slot = (slot + 1) & mask;
+    return slot;
+  }
+
+  /// Resize the table to the given power of two, and reinsert all pairs
+  void rehash(const size_t nb_slots);
+
+private: //data
+
+  /// Index in m_values for each slot, or empty_slot(). The size is a power of two.
+  std::vector<Uint> m_slots;
+
+  /// storage of the inserted data, in insertion order
+  std::vector<value_type> m_values;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+void HashMap<KEY,DATA>::reserve (size_t max_size)
+{
+  m_values.reserve(max_size);
+  size_t nb_slots = m_slots.size();
+  while(nb_slots < 2*max_size)
+    nb_slots *= 2;
+  if(nb_slots != m_slots.size())
+    rehash(nb_slots);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+void HashMap<KEY,DATA>::rehash (const size_t nb_slots)
+{
+  m_slots.assign(nb_slots, empty_slot());
+  const size_t mask = nb_slots - 1;
+  const Uint nb_values = m_values.size();
+  for(Uint i = 0; i != nb_values; ++i)
+  {
+    size_t slot = hash(m_values[i].first) & mask;
+    while(m_slots[slot] != empty_slot())
+      slot = (slot + 1) & mask;
+    m_slots[slot] = i;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+Uint HashMap<KEY,DATA>::push_back(const key_type& key, const data_type& data)
+{
+  cf3_assert_desc("Duplicated key inserted in map "+uri().string(), !exists(key));
+  if(2*(m_values.size()+1) > m_slots.size())
+    rehash(2*m_slots.size());
+  m_slots[probe(key)] = m_values.size();
+  m_values.push_back(value_type(key,data));
+  return m_values.size()-1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+std::pair<typename HashMap<KEY,DATA>::iterator,bool> HashMap<KEY,DATA>::insert(const value_type& v)
+{
+  const Uint idx = m_slots[probe(v.first)];
+  if(idx != empty_slot())
+    return std::make_pair(begin()+idx, false);
+  return std::make_pair(begin()+push_back(v.first, v.second), true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+inline typename HashMap<KEY,DATA>::iterator HashMap<KEY,DATA>::find(const key_type& key)
+{
+  const Uint idx = m_slots[probe(key)];
+  return idx == empty_slot() ? end() : begin()+idx;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+inline typename HashMap<KEY,DATA>::const_iterator HashMap<KEY,DATA>::find(const key_type& key) const
+{
+  const Uint idx = m_slots[probe(key)];
+  return idx == empty_slot() ? end() : begin()+idx;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+inline bool HashMap<KEY,DATA>::exists(const key_type& key) const
+{
+  return m_slots[probe(key)] != empty_slot();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+bool HashMap<KEY,DATA>::erase(const key_type& key)
+{
+  size_t hole = probe(key);
+  const Uint idx = m_slots[hole];
+  if(idx == empty_slot())
+    return false;
+
+  // Shift the following pairs of the cluster back, so no probe sequence is interrupted
+  const size_t mask = m_slots.size() - 1;
+  for(size_t slot = (hole + 1) & mask; m_slots[slot] != empty_slot(); slot = (slot + 1) & mask)
+  {
+    const size_t home = hash(m_values[m_slots[slot]].first) & mask;
+    const bool home_between = hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot);
+    if(!home_between)
+    {
+      m_slots[hole] = m_slots[slot];
+      hole = slot;
+    }
+  }
+  m_slots[hole] = empty_slot();
+
+  // Move the last pair into the erased position
+  const Uint last = m_values.size()-1;
+  if(idx != last)
+  {
+    m_slots[probe(m_values[last].first)] = idx;
+    m_values[idx] = m_values[last];
+  }
+  m_values.pop_back();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+void HashMap<KEY,DATA>::clear()
+{
+  std::vector<value_type>().swap(m_values);
+  std::vector<Uint>(16, empty_slot()).swap(m_slots);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+inline typename HashMap<KEY,DATA>::data_type& HashMap<KEY,DATA>::operator[] (const key_type& key)
+{
+  const Uint idx = m_slots[probe(key)];
+  if(idx != empty_slot())
+    return m_values[idx].second;
+  return m_values[push_back(key,data_type())].second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename KEY, typename DATA>
+inline const typename HashMap<KEY,DATA>::data_type& HashMap<KEY,DATA>::operator[] (const key_type& key) const
+{
+  const Uint idx = m_slots[probe(key)];
+  cf3_assert_desc( "The key is not found in the HashMap, and can not be inserted in const version." , idx != empty_slot());
+  return m_values[idx].second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_HashMap_hpp
@@ -6,6 +6,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include "boost/lexical_cast.hpp"
 
 #include "common/BoostAssertions.hpp"
@@ -13,6 +15,7 @@
 #include "common/FindComponents.hpp"
 #include "common/Builder.hpp"
 #include "common/Log.hpp"
+#include "common/ScopedTimer.hpp"
 
 #include "common/PE/Comm.hpp"
 #include "common/PE/CommPattern.hpp"
@@ -51,7 +54,8 @@ CommPattern::CommPattern(const std::string& name): Component(name), m_gid(alloca
   m_sendCount(PE::Comm::instance().size(),0),
   m_sendMap(0),
   m_recvCount(PE::Comm::instance().size(),0),
-  m_recvMap(0)
+  m_recvMap(0),
+  m_comm(MPI_COMM_NULL)
 {
   //self->regist_signal ( "update" , "Executes communication patterns on all the registered data.", "" ).connect ( boost::bind ( &CommPattern2::update, self, _1 ) );
   m_isUpToDate=false;
@@ -63,6 +67,13 @@ CommPattern::CommPattern(const std::string& name): Component(name), m_gid(alloca
 CommPattern::~CommPattern()
 {
   if (m_gid.get()!=nullptr) m_gid->remove_tag("gid_of_"+this->name());
+
+  // requests and communicators can not be released anymore after MPI_Finalize
+  if (PE::Comm::instance().is_active())
+  {
+    free_exchanges();
+    if (m_comm!=MPI_COMM_NULL) MPI_Comm_free(&m_comm);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -475,6 +486,8 @@ void CommPattern::setup()
     if (global_nelems[i]!=0)
       delete[] global[i];
 
+  setup_neighbours();
+
 #undef COMPUTE_IRANK
 #undef COMPUTE_INODE
 }
@@ -566,47 +579,312 @@ void CommPattern::setup()
 
 void CommPattern::synchronize_all()
 {
-  std::vector<unsigned char> sndbuf(1);
-  std::vector<unsigned char> rcvbuf(1);
+  std::vector<const CommWrapper*> group;
   BOOST_FOREACH( CommWrapper& pobj, find_components_recursively<CommWrapper>(*this) )
   {
-    synchronize_this(pobj,sndbuf,rcvbuf);
+    if (pobj.needs_update()) group.push_back(&pobj);
   }
+  synchronize_group_this(group);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::synchronize_group( const std::vector<std::string>& names )
+{
+  std::vector<const CommWrapper*> group;
+  group.reserve(names.size());
+  BOOST_FOREACH( const std::string& name, names )
+  {
+    Handle<CommWrapper> pobj(get_child(name));
+    if (is_null(pobj)) throw common::ValueNotFound(FromHere(), type_name() + " at " + uri().path() + ": no data registered as " + name);
+    if (pobj->needs_update()) group.push_back(pobj.get());
+  }
+  synchronize_group_this(group);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void CommPattern::synchronize( const std::string& name )
 {
-  std::vector<unsigned char> sndbuf(1);
-  std::vector<unsigned char> rcvbuf(1);
   Handle<CommWrapper> pobj(get_child(name));
-  synchronize_this(*pobj,sndbuf,rcvbuf);
+  synchronize_this(*pobj);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void CommPattern::synchronize( const CommWrapper& pobj )
 {
-  std::vector<unsigned char> sndbuf(1);
-  std::vector<unsigned char> rcvbuf(1);
-  synchronize_this(pobj,sndbuf,rcvbuf);
+  synchronize_this(pobj);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::start_synchronize( const std::string& name )
+{
+  Handle<CommWrapper> pobj(get_child(name));
+  if (is_null(pobj)) throw common::ValueNotFound(FromHere(), type_name() + " at " + uri().path() + ": no data registered as " + name);
+  start_exchange(*pobj);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::finish_synchronize( const std::string& name )
+{
+  Handle<CommWrapper> pobj(get_child(name));
+  if (is_null(pobj)) throw common::ValueNotFound(FromHere(), type_name() + " at " + uri().path() + ": no data registered as " + name);
+  finish_exchange(*pobj);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::synchronize_this( const CommWrapper& pobj )
+{
+  CF3_SCOPED_TIMER("synchronize");
+  start_exchange(pobj);
+  finish_exchange(pobj);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::synchronize_group_this( const std::vector<const CommWrapper*>& group )
+{
+  // a single object goes through its persistent requests
+  if (group.size()<2)
+  {
+    if (group.size()==1) synchronize_this(*group[0]);
+    return;
+  }
+
+  const Uint nb_recv = m_recv_neighbours.size();
+  const Uint nb_send = m_send_neighbours.size();
+  if (nb_recv+nb_send==0)
+    return;
+
+  CF3_SCOPED_TIMER("synchronize");
+
+  // one item of the group holds one item of every object, each neighbour block is laid out object after object
+  int group_item_size=0;
+  BOOST_FOREACH( const CommWrapper* pobj, group )
+    group_item_size+=pobj->size_of()*pobj->stride();
+
+  // resize keeps the capacity, so the buffers only grow when a larger group is seen
+  m_group_sndbuf.resize(m_sendMap.size()*group_item_size);
+  m_group_rcvbuf.resize(m_recvMap.size()*group_item_size);
+  m_group_requests.assign(nb_recv+nb_send,MPI_REQUEST_NULL);
+
+  // tags of single exchanges are below 32767
+  const int tag=32767;
+
+  for (Uint i=0; i<nb_recv; ++i)
+  {
+    const int count=(m_recv_starts[i+1]-m_recv_starts[i])*group_item_size;
+    MPI_CHECK_RESULT(MPI_Irecv,(&m_group_rcvbuf[m_recv_starts[i]*group_item_size],count,MPI_BYTE,m_recv_neighbours[i],tag,m_comm,&m_group_requests[i]));
+  }
+
+  for (Uint i=0; i<nb_send; ++i)
+  {
+    unsigned char* buf=&m_group_sndbuf[m_send_starts[i]*group_item_size];
+    const int nb_items=m_send_starts[i+1]-m_send_starts[i];
+    BOOST_FOREACH( const CommWrapper* pobj, group )
+    {
+      pobj->pack(m_send_maps[i],buf);
+      buf+=nb_items*pobj->size_of()*pobj->stride();
+    }
+    MPI_CHECK_RESULT(MPI_Isend,(&m_group_sndbuf[m_send_starts[i]*group_item_size],nb_items*group_item_size,MPI_BYTE,m_send_neighbours[i],tag,m_comm,&m_group_requests[nb_recv+i]));
+  }
+
+  {
+    CF3_SCOPED_TIMER("mpi_wait");
+    MPI_CHECK_RESULT(MPI_Waitall,((int)m_group_requests.size(),&m_group_requests[0],MPI_STATUSES_IGNORE));
+  }
+
+  for (Uint i=0; i<nb_recv; ++i)
+  {
+    unsigned char* buf=&m_group_rcvbuf[m_recv_starts[i]*group_item_size];
+    const int nb_items=m_recv_starts[i+1]-m_recv_starts[i];
+    BOOST_FOREACH( const CommWrapper* pobj, group )
+    {
+      pobj->unpack(buf,m_recv_maps[i]);
+      buf+=nb_items*pobj->size_of()*pobj->stride();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::start_exchange( const CommWrapper& pobj )
+{
+  if ( !pobj.needs_update() )
+    return;
+
+  Exchange& ex = exchange(pobj);
+  if (ex.in_flight) throw common::ShouldNotBeHere(FromHere(), type_name() + " at " + uri().path() + ": synchronization of " + pobj.name() + " was already started.");
+
+  if (!m_sendMap.empty())
+    pobj.pack(ex.sndbuf,m_sendMap);
+  if (!ex.requests.empty())
+    MPI_CHECK_RESULT(MPI_Startall,((int)ex.requests.size(),&ex.requests[0]));
+  ex.in_flight=true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-// having the vectors for the intermediate buf coming from outside allows keeping them and reuse for all synchronize
-void CommPattern::synchronize_this( const CommWrapper& pobj, std::vector<unsigned char>& sndbuf, std::vector<unsigned char>& rcvbuf )
+void CommPattern::finish_exchange( const CommWrapper& pobj )
 {
-//  std::cout << PERank << pobj.name() << "\n" << std::flush;
-//  std::cout << PERank << pobj.needs_update() << "\n" << std::flush;
-  if ( pobj.needs_update() )
+  if ( !pobj.needs_update() )
+    return;
+
+  std::map<std::string, Exchange>::iterator ex_it = m_exchanges.find(pobj.name());
+  if (ex_it==m_exchanges.end() || !ex_it->second.in_flight)
+    throw common::ShouldNotBeHere(FromHere(), type_name() + " at " + uri().path() + ": synchronization of " + pobj.name() + " was not started.");
+
+  Exchange& ex = ex_it->second;
+  if (!ex.requests.empty())
   {
-    pobj.pack(sndbuf,m_sendMap);
-    rcvbuf.resize(m_recvMap.size()*pobj.size_of()*pobj.stride());
-    PE::Comm::instance().all_to_all(sndbuf,m_sendCount,rcvbuf,m_recvCount,pobj.size_of()*pobj.stride());
-    pobj.unpack(rcvbuf,m_recvMap);
+    CF3_SCOPED_TIMER("mpi_wait");
+    MPI_CHECK_RESULT(MPI_Waitall,((int)ex.requests.size(),&ex.requests[0],MPI_STATUSES_IGNORE));
   }
+  if (!m_recvMap.empty())
+    pobj.unpack(ex.rcvbuf,m_recvMap);
+  ex.in_flight=false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CommPattern::Exchange& CommPattern::exchange( const CommWrapper& pobj )
+{
+  Exchange& ex = m_exchanges[pobj.name()];
+  const int item_size = pobj.size_of()*pobj.stride();
+  if (ex.item_size==item_size)
+    return ex;
+
+  // the layout of the wrapped data changed, the requests must be rebuilt
+  free_exchange(pobj.name());
+  Exchange& new_ex = m_exchanges[pobj.name()];
+  new_ex.item_size = item_size;
+  new_ex.sndbuf.resize(m_sendMap.size()*item_size);
+  new_ex.rcvbuf.resize(m_recvMap.size()*item_size);
+
+  const Uint nb_requests = m_recv_neighbours.size() + m_send_neighbours.size();
+  if (nb_requests==0)
+    return new_ex;
+
+  // every registered name has its own tag, so the exchanges of different data never match
+  const int tag = this->tag(pobj.name());
+  new_ex.requests.resize(nb_requests,MPI_REQUEST_NULL);
+  Uint req=0;
+  for (Uint i=0; i<m_recv_neighbours.size(); ++i, ++req)
+  {
+    const int count = (m_recv_starts[i+1]-m_recv_starts[i])*item_size;
+    MPI_CHECK_RESULT(MPI_Recv_init,(&new_ex.rcvbuf[m_recv_starts[i]*item_size],count,MPI_BYTE,m_recv_neighbours[i],tag,m_comm,&new_ex.requests[req]));
+  }
+  for (Uint i=0; i<m_send_neighbours.size(); ++i, ++req)
+  {
+    const int count = (m_send_starts[i+1]-m_send_starts[i])*item_size;
+    MPI_CHECK_RESULT(MPI_Send_init,(&new_ex.sndbuf[m_send_starts[i]*item_size],count,MPI_BYTE,m_send_neighbours[i],tag,m_comm,&new_ex.requests[req]));
+  }
+  return new_ex;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::free_exchange( const std::string& name )
+{
+  std::map<std::string, Exchange>::iterator ex_it = m_exchanges.find(name);
+  if (ex_it==m_exchanges.end())
+    return;
+
+  Exchange& ex = ex_it->second;
+  if (!ex.requests.empty())
+  {
+    // a started exchange must complete before its requests can be released
+    if (ex.in_flight)
+      MPI_CHECK_RESULT(MPI_Waitall,((int)ex.requests.size(),&ex.requests[0],MPI_STATUSES_IGNORE));
+    BOOST_FOREACH(MPI_Request& request, ex.requests)
+      if (request!=MPI_REQUEST_NULL)
+        MPI_CHECK_RESULT(MPI_Request_free,(&request));
+  }
+  m_exchanges.erase(ex_it);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::free_exchanges()
+{
+  while (!m_exchanges.empty())
+    free_exchange(m_exchanges.begin()->first);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::register_tag( const std::string& name )
+{
+  if (std::find(m_tag_names.begin(),m_tag_names.end(),name)!=m_tag_names.end())
+    return;
+  std::vector<std::string>::iterator free_tag = std::find(m_tag_names.begin(),m_tag_names.end(),std::string());
+  if (free_tag!=m_tag_names.end())
+  {
+    *free_tag = name;
+    return;
+  }
+  // 32767 is the smallest MPI_TAG_UB allowed by the standard, and is used by the grouped synchronization
+  if (m_tag_names.size()==32767)
+    throw cf3::common::ParallelError(FromHere(),"Too many data arrays registered in CommPattern " + uri().path());
+  m_tag_names.push_back(name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::release_tag( const std::string& name )
+{
+  std::vector<std::string>::iterator found = std::find(m_tag_names.begin(),m_tag_names.end(),name);
+  if (found!=m_tag_names.end())
+    found->clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int CommPattern::tag( const std::string& name )
+{
+  std::vector<std::string>::iterator found = std::find(m_tag_names.begin(),m_tag_names.end(),name);
+  if (found!=m_tag_names.end())
+    return static_cast<int>(found-m_tag_names.begin());
+  // data not registered through insert, such as the gid
+  register_tag(name);
+  return tag(name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::setup_neighbours()
+{
+  free_exchanges();
+
+  // setup is collective, so this is the place to obtain the private communicator
+  if (m_comm==MPI_COMM_NULL)
+    MPI_CHECK_RESULT(MPI_Comm_dup,(PE::Comm::instance().communicator(),&m_comm));
+
+  // m_sendMap and m_recvMap are ordered by rank, so each neighbour owns a contiguous block
+  m_send_neighbours.clear();
+  m_send_starts.assign(1,0);
+  m_send_maps.clear();
+  for (int i=0; i<(const int)m_sendCount.size(); i++)
+    if (m_sendCount[i]!=0)
+    {
+      m_send_neighbours.push_back(i);
+      m_send_maps.push_back(std::vector<int>(m_sendMap.begin()+m_send_starts.back(),m_sendMap.begin()+m_send_starts.back()+m_sendCount[i]));
+      m_send_starts.push_back(m_send_starts.back()+m_sendCount[i]);
+    }
+  m_recv_neighbours.clear();
+  m_recv_starts.assign(1,0);
+  m_recv_maps.clear();
+  for (int i=0; i<(const int)m_recvCount.size(); i++)
+    if (m_recvCount[i]!=0)
+    {
+      m_recv_neighbours.push_back(i);
+      m_recv_maps.push_back(std::vector<int>(m_recvMap.begin()+m_recv_starts.back(),m_recvMap.begin()+m_recv_starts.back()+m_recvCount[i]));
+      m_recv_starts.push_back(m_recv_starts.back()+m_recvCount[i]);
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
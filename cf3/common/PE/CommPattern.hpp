@@ -7,6 +7,8 @@
 #ifndef cf3_common_PE_CommPattern_hpp
 #define cf3_common_PE_CommPattern_hpp
 
+#include <map>
+
 #include "common/Component.hpp"
 #include "common/BoostArray.hpp"
 #include "common/PE/Comm.hpp"
@@ -121,6 +123,8 @@ public:
   CommPattern(const std::string& name);
 
   /// destructor
+  /// Collective while MPI is active, since the private duplicate of the communicator is freed here,
+  /// so the CommPattern must be destroyed on all ranks before MPI is finalized.
   ~CommPattern();
 
   /// Get the class name
@@ -139,6 +143,7 @@ public:
   template<typename T> void insert(const std::string& name, T*& data, const int size, const unsigned int stride=1, const bool needs_update=true)
   {
     Handle< CommWrapperPtr<T> > ow = create_component< CommWrapperPtr<T> >(name);
+    register_tag(name);
     ow->setup(data,stride,needs_update);
   }
 
@@ -150,6 +155,7 @@ public:
   template<typename T> void insert(const std::string& name, T** data, const int size, const unsigned int stride=1, const bool needs_update=true)
   {
     Handle< CommWrapperPtr<T> > ow = create_component< CommWrapperPtr<T> >(name);
+    register_tag(name);
     ow->setup(data,stride,needs_update);
   }
 
@@ -160,6 +166,7 @@ public:
   template<typename T> void insert(const std::string& name, std::vector<T>& data, const unsigned int stride=1, const bool needs_update=true)
   {
     Handle< CommWrapperVector<T> > ow = create_component< CommWrapperVector<T> >(name);
+    register_tag(name);
     ow->setup(data,stride,needs_update);
   }
 
@@ -172,6 +179,7 @@ public:
   {
     typedef CommWrapperMArray<ValueT, NDims> CommWrapperT;
     Handle<CommWrapperT> ow = create_component<CommWrapperT>(name);
+    register_tag(name);
     ow->setup(data,needs_update);
   }
 
@@ -182,14 +190,16 @@ public:
   template<typename T> void insert(const std::string& name, std::vector<T>* data, const unsigned int stride=1, const bool needs_update=true)
   {
     Handle< CommWrapperVector<T> > ow = create_component< CommWrapperVector<T> >(name);
+    register_tag(name);
     ow->setup(data,stride,needs_update);
   }
 
   /// removes data by name
   void clear( const std::string& name)
   {
+    free_exchange(name);
+    release_tag(name);
     remove_component(name);
-    // anything to be deallocated?
   }
 
   //@} END DATA REGISTRATION
@@ -219,8 +229,14 @@ public:
   void setup();
 
   /// synchronize the all parallel objects
+  /// all objects needing update are packed together, so only one message per neighbour is sent
   void synchronize_all();
 
+  /// synchronize several parallel objects designated by their names at once
+  /// the data of all objects going to a neighbour is packed into one contiguous buffer and sent as a single message
+  /// @param names the names of the parallel objects
+  void synchronize_group( const std::vector<std::string>& names );
+
   /// synchronize the parallel object designated by its name
   /// @param name the name of the parallel object
   void synchronize( const std::string& name );
@@ -229,6 +245,16 @@ public:
   /// @param name the name of the parallel object
   void synchronize( const CommWrapper& pobj );
 
+  /// start a non-blocking synchronization of the parallel object designated by its name
+  /// only the neighbouring ranks are contacted, using persistent point-to-point requests
+  /// the ghost values are only valid after the matching finish_synchronize, so work not touching ghosts can be overlapped
+  /// @param name the name of the parallel object
+  void start_synchronize( const std::string& name );
+
+  /// complete a synchronization started by start_synchronize and write the received values into the ghosts
+  /// @param name the name of the parallel object
+  void finish_synchronize( const std::string& name );
+
   /// add element to the commpattern
   /// when all changes done, all needs to be committed by calling setup
   /// if global id is not on current rank, then a ghost is automatically created on current rank
@@ -284,6 +310,12 @@ public:
   /// Return the rank associated with the given local ID
   int rank(const Uint lid) const { return m_ranks[lid]; }
 
+  /// accessor to the ranks this process sends updatable values to, computed by setup
+  const std::vector<int>& send_neighbours() const { return m_send_neighbours; }
+
+  /// accessor to the ranks this process receives ghost values from, computed by setup
+  const std::vector<int>& recv_neighbours() const { return m_recv_neighbours; }
+
   //@} END ACCESSORS
 
 protected: // helper function
@@ -291,12 +323,59 @@ protected: // helper function
   /// function to synchronize this object
   /// useful for reusing in the different synchronize functions
   /// @param pobj reference to commwrapper object to synchronize to
-  /// @param sndbuf vector for intermediate buffer for send
-  /// @param rcvbuf vector for intermediate buffer for recieve
-  void synchronize_this( const CommWrapper& pobj, std::vector<unsigned char>& sndbuf, std::vector<unsigned char>& rcvbuf );
+  void synchronize_this( const CommWrapper& pobj );
+
+  /// function to synchronize a group of objects with one message per neighbour
+  /// @param group the commwrappers to synchronize, all must need update
+  void synchronize_group_this( const std::vector<const CommWrapper*>& group );
+
+  /// pack the updatable values of pobj and start the persistent requests of its exchange
+  void start_exchange( const CommWrapper& pobj );
+
+  /// wait for the requests of the exchange of pobj and unpack the received values into the ghosts
+  void finish_exchange( const CommWrapper& pobj );
 
 private:
 
+  /// state of the point-to-point exchange of one registered CommWrapper
+  /// the persistent requests point into the buffers, so these must never be reallocated while the requests live
+  struct Exchange
+  {
+    Exchange() : item_size(0), in_flight(false) {}
+    /// packed updatable values, ordered as m_sendMap
+    std::vector<unsigned char> sndbuf;
+    /// received ghost values, ordered as m_recvMap
+    std::vector<unsigned char> rcvbuf;
+    /// persistent receive requests (one per receive neighbour) followed by the send requests
+    std::vector<MPI_Request> requests;
+    /// size in bytes of one item (size_of()*stride()) the requests were built for
+    int item_size;
+    /// true between start_exchange and finish_exchange
+    bool in_flight;
+  };
+
+  /// get the exchange of pobj, (re)building its persistent requests if needed
+  Exchange& exchange( const CommWrapper& pobj );
+
+  /// release the persistent requests of the exchange registered under name, if any
+  void free_exchange( const std::string& name );
+
+  /// release the persistent requests of all exchanges
+  void free_exchanges();
+
+  /// assign the lowest free message tag to the data registered under name
+  /// registration happens in the same order on all ranks, so every rank assigns the same tags
+  void register_tag( const std::string& name );
+
+  /// make the tag of the data registered under name available again
+  void release_tag( const std::string& name );
+
+  /// message tag of the data registered under name, registering it if needed
+  int tag( const std::string& name );
+
+  /// build the neighbour lists from the send and receive counts, called at the end of setup
+  void setup_neighbours();
+
   /// @name PROPERTIES
   //@{
 
@@ -349,6 +428,42 @@ private:
   /// Rank for all the gids in local index space
   std::vector<int> m_ranks;
 
+  /// ranks with a non-zero m_sendCount
+  std::vector<int> m_send_neighbours;
+
+  /// start of the block of each send neighbour in m_sendMap, with one extra entry for the end
+  std::vector<int> m_send_starts;
+
+  /// the block of m_sendMap belonging to each send neighbour
+  std::vector< std::vector<int> > m_send_maps;
+
+  /// ranks with a non-zero m_recvCount
+  std::vector<int> m_recv_neighbours;
+
+  /// start of the block of each receive neighbour in m_recvMap, with one extra entry for the end
+  std::vector<int> m_recv_starts;
+
+  /// the block of m_recvMap belonging to each receive neighbour
+  std::vector< std::vector<int> > m_recv_maps;
+
+  /// send buffer of grouped synchronizations, kept to avoid reallocation on every call
+  std::vector<unsigned char> m_group_sndbuf;
+
+  /// receive buffer of grouped synchronizations, kept to avoid reallocation on every call
+  std::vector<unsigned char> m_group_rcvbuf;
+
+  /// requests of grouped synchronizations
+  std::vector<MPI_Request> m_group_requests;
+
+  /// point-to-point exchanges, by name of the CommWrapper
+  std::map<std::string, Exchange> m_exchanges;
+
+  /// name of the CommWrapper using each message tag, empty for free tags
+  std::vector<std::string> m_tag_names;
+
+  /// private duplicate of the communicator, so the exchanges never match messages of other CommPatterns
+  Communicator m_comm;
+
 }; // CommPattern
 
 ////////////////////////////////////////////////////////////////////////////////////////////
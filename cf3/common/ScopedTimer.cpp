@@ -0,0 +1,487 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+#ifdef CF3_OS_LINUX
+extern "C"
+{
+  #include <time.h>
+}
+#else
+#include <boost/date_time/posix_time/posix_time.hpp>
+#endif
+
+#include "common/BasicExceptions.hpp"
+#include "common/Foreach.hpp"
+#include "common/ScopedTimer.hpp"
+#include "common/StringConversion.hpp"
+#include "common/URI.hpp"
+
+#include "common/PE/Comm.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+/// Wall clock time in seconds, from an arbitrary but fixed origin
+inline double wall_time()
+{
+#ifdef CF3_OS_LINUX
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<double>(now.tv_sec) + 1e-9*static_cast<double>(now.tv_nsec);
+#else
+  static const boost::posix_time::ptime origin = boost::posix_time::microsec_clock::universal_time();
+  return 1e-6*static_cast<double>((boost::posix_time::microsec_clock::universal_time() - origin).total_microseconds());
+#endif
+}
+
+/// Accumulated statistics for one region at one place in the tree of a thread
+struct TimingNode
+{
+  TimingNode(const Uint a_region, const Uint a_parent) :
+    region(a_region),
+    parent(a_parent),
+    count(0),
+    total(0.),
+    minimum(std::numeric_limits<double>::max()),
+    maximum(0.)
+  {
+  }
+
+  Uint region;
+  Uint parent;
+  std::vector<Uint> children;
+  Uint count;
+  double total;
+  double minimum;
+  double maximum;
+};
+
+/// A single call, as stored in the trace
+struct TraceEvent
+{
+  Uint region;
+  double start;
+  double end;
+};
+
+/// All timing data for a single thread. Only the owning thread modifies it while timers are active.
+struct ThreadTimings
+{
+  ThreadTimings(const Uint idx) :
+    thread_idx(idx),
+    trace_next(0),
+    trace_full(false)
+  {
+    reset();
+    stack.reserve(64);
+    start_times.reserve(64);
+  }
+
+  void reset()
+  {
+    // Node 0 is the root, which is never timed itself
+    nodes.assign(1, TimingNode(std::numeric_limits<Uint>::max(), 0));
+    stack.assign(1, 0);
+    start_times.clear();
+    trace.clear();
+    trace_next = 0;
+    trace_full = false;
+  }
+
+  Uint thread_idx;
+  std::vector<TimingNode> nodes;
+  // Nodes of the active timers, starting with the root
+  std::vector<Uint> stack;
+  std::vector<double> start_times;
+  // Ring buffer with the recorded calls
+  std::vector<TraceEvent> trace;
+  Uint trace_next;
+  bool trace_full;
+};
+
+/// Called when a thread that used timers exits
+void release_thread_timings(ThreadTimings* timings);
+
+/// Global state, holding the data of all threads so it can be combined after they finished
+struct TimingRegistry
+{
+  TimingRegistry() :
+    current(&release_thread_timings),
+    trace_enabled(false),
+    trace_capacity(65536),
+    epoch(wall_time())
+  {
+  }
+
+  ~TimingRegistry()
+  {
+    // The slots are destroyed with the registry, so they must not be released anymore
+    current.release();
+  }
+
+  ThreadTimings& thread_timings()
+  {
+    ThreadTimings* result = current.get();
+    if(is_null(result))
+    {
+      boost::mutex::scoped_lock lock(mutex);
+      // The slot of a thread that exited is taken over, keeping its statistics, so the number of slots
+      // is bounded by the number of threads that run at the same time
+      if(free_slots.empty())
+      {
+        threads.push_back(boost::shared_ptr<ThreadTimings>(new ThreadTimings(threads.size())));
+        result = threads.back().get();
+      }
+      else
+      {
+        result = threads[free_slots.back()].get();
+        free_slots.pop_back();
+      }
+      current.reset(result);
+    }
+    return *result;
+  }
+
+  boost::mutex mutex;
+  std::vector<std::string> region_names;
+  std::vector< boost::shared_ptr<ThreadTimings> > threads;
+  // Indices of the slots of the threads that exited
+  std::vector<Uint> free_slots;
+  boost::thread_specific_ptr<ThreadTimings> current;
+  bool trace_enabled;
+  Uint trace_capacity;
+  double epoch;
+};
+
+TimingRegistry& timing_registry()
+{
+  static TimingRegistry registry;
+  return registry;
+}
+
+void release_thread_timings(ThreadTimings* timings)
+{
+  TimingRegistry& registry = timing_registry();
+  boost::mutex::scoped_lock lock(registry.mutex);
+  registry.free_slots.push_back(timings->thread_idx);
+}
+
+/// Statistics for a region, summed over threads or kept per rank
+struct RegionStats
+{
+  RegionStats() : count(0), total(0.), minimum(std::numeric_limits<double>::max()), maximum(0.)
+  {
+  }
+
+  void merge(const Uint a_count, const double a_total, const double a_min, const double a_max)
+  {
+    count += a_count;
+    total += a_total;
+    minimum = std::min(minimum, a_min);
+    maximum = std::max(maximum, a_max);
+  }
+
+  Uint count;
+  double total;
+  double minimum;
+  double maximum;
+};
+
+typedef std::map<std::vector<std::string>, RegionStats> PathStatsT;
+
+/// Statistics of this rank, summed over all threads, keyed by the path of region names from the root
+void local_region_stats(PathStatsT& result)
+{
+  TimingRegistry& registry = timing_registry();
+  boost::mutex::scoped_lock lock(registry.mutex);
+  BOOST_FOREACH(const boost::shared_ptr<ThreadTimings>& thread, registry.threads)
+  {
+    // Parents always precede their children
+    const Uint nb_nodes = thread->nodes.size();
+    std::vector< std::vector<std::string> > paths(nb_nodes);
+    for(Uint i = 1; i != nb_nodes; ++i)
+    {
+      const TimingNode& node = thread->nodes[i];
+      paths[i] = paths[node.parent];
+      paths[i].push_back(registry.region_names[node.region]);
+      if(node.count != 0)
+        result[paths[i]].merge(node.count, node.total, node.minimum, node.maximum);
+    }
+  }
+}
+
+void escape_json(std::ostream& out, const std::string& str)
+{
+  BOOST_FOREACH(const char c, str)
+  {
+    if(c == '"' || c == '\\')
+      out << '\\';
+    out << c;
+  }
+}
+
+} // detail
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+Uint timing_region(const std::string& name)
+{
+  detail::TimingRegistry& registry = detail::timing_registry();
+  boost::mutex::scoped_lock lock(registry.mutex);
+  const std::vector<std::string>::iterator found = std::find(registry.region_names.begin(), registry.region_names.end(), name);
+  if(found != registry.region_names.end())
+    return found - registry.region_names.begin();
+  registry.region_names.push_back(name);
+  return registry.region_names.size() - 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+ScopedTimer::ScopedTimer(const Uint region)
+{
+  detail::ThreadTimings& timings = detail::timing_registry().thread_timings();
+  const Uint parent = timings.stack.back();
+
+  // Find the node for the region below the active one, creating it the first time
+  Uint node = 0;
+  const std::vector<Uint>& children = timings.nodes[parent].children;
+  const Uint nb_children = children.size();
+  for(Uint i = 0; i != nb_children; ++i)
+  {
+    if(timings.nodes[children[i]].region == region)
+    {
+      node = children[i];
+      break;
+    }
+  }
+  if(node == 0)
+  {
+    node = timings.nodes.size();
+    timings.nodes.push_back(detail::TimingNode(region, parent));
+    timings.nodes[parent].children.push_back(node);
+  }
+
+  timings.stack.push_back(node);
+  timings.start_times.push_back(detail::wall_time());
+}
+
+ScopedTimer::~ScopedTimer()
+{
+  const double end = detail::wall_time();
+  detail::TimingRegistry& registry = detail::timing_registry();
+  detail::ThreadTimings& timings = registry.thread_timings();
+
+  const Uint node_idx = timings.stack.back();
+  const double start = timings.start_times.back();
+  timings.stack.pop_back();
+  timings.start_times.pop_back();
+
+  detail::TimingNode& node = timings.nodes[node_idx];
+  const double elapsed = end - start;
+  ++node.count;
+  node.total += elapsed;
+  node.minimum = std::min(node.minimum, elapsed);
+  node.maximum = std::max(node.maximum, elapsed);
+
+  if(registry.trace_enabled && registry.trace_capacity != 0)
+  {
+    if(timings.trace.size() != registry.trace_capacity)
+    {
+      timings.trace.resize(registry.trace_capacity);
+      timings.trace_next = 0;
+      timings.trace_full = false;
+    }
+    detail::TraceEvent& event = timings.trace[timings.trace_next];
+    event.region = node.region;
+    event.start = start;
+    event.end = end;
+    if(++timings.trace_next == registry.trace_capacity)
+    {
+      timings.trace_next = 0;
+      timings.trace_full = true;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+void enable_timing_trace(const bool enable)
+{
+  detail::timing_registry().trace_enabled = enable;
+}
+
+void set_timing_trace_capacity(const Uint nb_events)
+{
+  detail::timing_registry().trace_capacity = nb_events;
+}
+
+void reset_timing_regions()
+{
+  detail::TimingRegistry& registry = detail::timing_registry();
+  boost::mutex::scoped_lock lock(registry.mutex);
+  BOOST_FOREACH(const boost::shared_ptr<detail::ThreadTimings>& thread, registry.threads)
+  {
+    if(thread->stack.size() != 1)
+      throw SetupError(FromHere(), "Timing regions can not be reset while timers are active");
+    thread->reset();
+  }
+  registry.epoch = detail::wall_time();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+void print_timing_regions(std::ostream& out)
+{
+  detail::PathStatsT local_stats;
+  detail::local_region_stats(local_stats);
+
+  // Serialize as lines of path, count, total, min and max
+  std::ostringstream local_stream;
+  local_stream << std::setprecision(17);
+  for(detail::PathStatsT::const_iterator it = local_stats.begin(); it != local_stats.end(); ++it)
+  {
+    BOOST_FOREACH(const std::string& name, it->first)
+    {
+      local_stream << name << '\t';
+    }
+    local_stream << '\n' << it->second.count << ' ' << it->second.total << ' ' << it->second.minimum << ' ' << it->second.maximum << '\n';
+  }
+  const std::string local_str = local_stream.str();
+  // Null-terminated, so the gather buffer is never empty
+  std::vector<char> local_chars(local_str.begin(), local_str.end());
+  local_chars.push_back('\0');
+
+  PE::Comm& comm = PE::Comm::instance();
+  const bool parallel = comm.is_active() && comm.size() > 1;
+  const Uint nb_procs = parallel ? comm.size() : 1;
+
+  // One collective for all regions
+  std::vector<char> all_chars;
+  std::vector<int> rank_sizes(nb_procs, static_cast<int>(local_chars.size()));
+  if(parallel)
+  {
+    // Sizes of -1 make the gather collect the sizes first
+    std::fill(rank_sizes.begin(), rank_sizes.end(), -1);
+    comm.gather(local_chars, static_cast<int>(local_chars.size()), all_chars, rank_sizes, 0);
+    if(comm.rank() != 0)
+      return;
+  }
+  else
+  {
+    all_chars.swap(local_chars);
+  }
+
+  // Statistics for each rank
+  typedef std::map< std::vector<std::string>, std::vector<detail::RegionStats> > GlobalStatsT;
+  GlobalStatsT global_stats;
+  Uint offset = 0;
+  for(Uint rank = 0; rank != nb_procs; ++rank)
+  {
+    std::istringstream rank_stream(std::string(&all_chars[offset]));
+    offset += rank_sizes[rank];
+    std::string path_line;
+    while(std::getline(rank_stream, path_line))
+    {
+      std::vector<std::string> path;
+      boost::algorithm::split(path, path_line, boost::algorithm::is_any_of("\t"));
+      path.pop_back(); // Empty string after the last tab
+      Uint count;
+      double total, minimum, maximum;
+      rank_stream >> count >> total >> minimum >> maximum;
+      rank_stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      std::vector<detail::RegionStats>& stats = global_stats[path];
+      stats.resize(nb_procs);
+      stats[rank].merge(count, total, minimum, maximum);
+    }
+  }
+
+  out << "Timing regions in seconds, with [min, max] over ranks of the count and [min, mean, max] over ranks of the total time\n";
+  for(GlobalStatsT::const_iterator it = global_stats.begin(); it != global_stats.end(); ++it)
+  {
+    detail::RegionStats total_stats;
+    Real min_total = std::numeric_limits<Real>::max();
+    Real max_total = 0.;
+    Uint min_count = std::numeric_limits<Uint>::max();
+    Uint max_count = 0;
+    BOOST_FOREACH(const detail::RegionStats& rank_stats, it->second)
+    {
+      total_stats.merge(rank_stats.count, rank_stats.total, rank_stats.minimum, rank_stats.maximum);
+      min_total = std::min(min_total, rank_stats.total);
+      max_total = std::max(max_total, rank_stats.total);
+      min_count = std::min(min_count, rank_stats.count);
+      max_count = std::max(max_count, rank_stats.count);
+    }
+    out << std::string(2*(it->first.size()-1), ' ') << it->first.back()
+        << ": count: [" << min_count << ", " << max_count << "]"
+        << ", total: [" << min_total << ", " << total_stats.total / static_cast<Real>(nb_procs) << ", " << max_total << "]"
+        << ", per call: [" << total_stats.minimum << ", " << total_stats.total / static_cast<Real>(total_stats.count) << ", " << total_stats.maximum << "]\n";
+  }
+  out.flush();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+void write_timing_trace(const URI& file_base)
+{
+  const Uint rank = PE::Comm::instance().is_active() ? PE::Comm::instance().rank() : 0;
+  const boost::filesystem::path file_path(file_base.path() + "_P" + to_str(rank) + ".json");
+  boost::filesystem::fstream file(file_path, std::ios_base::out);
+  if(!file)
+    throw FileSystemError(FromHere(), "Failed to open file " + file_path.string() + " for writing the timing trace");
+
+  detail::TimingRegistry& registry = detail::timing_registry();
+  boost::mutex::scoped_lock lock(registry.mutex);
+
+  // Times are written in microseconds since the last reset, as expected by the trace viewers
+  file << std::fixed << std::setprecision(3);
+  file << "{\"traceEvents\":[\n";
+  file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank << ",\"tid\":0,\"args\":{\"name\":\"rank " << rank << "\"}}";
+  BOOST_FOREACH(const boost::shared_ptr<detail::ThreadTimings>& thread, registry.threads)
+  {
+    // Oldest event first
+    const Uint nb_events = thread->trace_full ? thread->trace.size() : thread->trace_next;
+    const Uint first_event = thread->trace_full ? thread->trace_next : 0;
+    for(Uint i = 0; i != nb_events; ++i)
+    {
+      const detail::TraceEvent& event = thread->trace[(first_event + i) % thread->trace.size()];
+      file << ",\n{\"name\":\"";
+      detail::escape_json(file, registry.region_names[event.region]);
+      file << "\",\"cat\":\"cf3\",\"ph\":\"X\",\"pid\":" << rank << ",\"tid\":" << thread->thread_idx
+           << ",\"ts\":" << 1e6*(event.start - registry.epoch) << ",\"dur\":" << 1e6*(event.end - event.start) << "}";
+    }
+  }
+  file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  file.close();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+/////////////////////////////////////////////////////////////////////////////////////
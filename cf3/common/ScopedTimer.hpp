@@ -0,0 +1,71 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_ScopedTimer_hpp
+#define cf3_common_ScopedTimer_hpp
+
+#include <iosfwd>
+
+#include <boost/preprocessor/cat.hpp>
+
+#include "common/CF.hpp"
+#include "common/CommonAPI.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+class URI;
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+/// Get the identifier for the timing region with the given name, registering it if needed.
+/// Registration takes a lock, so the result should be stored, as done by the CF3_SCOPED_TIMER macro.
+Common_API Uint timing_region(const std::string& name);
+
+/// Times the enclosing scope as the given region. Regions that are entered while another one is active on the same
+/// thread are recorded as its children, building a tree of regions for each thread. The statistics (count, total,
+/// minimum and maximum wall time) are kept per thread and, if tracing is enabled, each call is also stored in a
+/// fixed-size ring buffer per thread. No locks or allocations are needed once a thread has seen a region.
+class Common_API ScopedTimer
+{
+public:
+  ScopedTimer(const Uint region);
+  ~ScopedTimer();
+};
+
+/// Enable or disable recording of the individual calls for the trace output
+Common_API void enable_timing_trace(const bool enable);
+
+/// Number of calls kept in the trace buffer of each thread. The oldest calls are overwritten once it is full.
+Common_API void set_timing_trace_capacity(const Uint nb_events);
+
+/// Clear all statistics and traces. Must not be called while timers are active.
+Common_API void reset_timing_regions();
+
+/// Print the statistics of the timing regions, combining all threads of each rank. The statistics of all ranks are
+/// collected on rank 0 using a single gather, and printed there with the minimum, mean and maximum over the ranks.
+/// Collective, and must not be called while timers are active.
+Common_API void print_timing_regions(std::ostream& out);
+
+/// Write the recorded calls of this rank to file_base_P<rank>.json, in the Chrome trace event format that can be
+/// loaded in chrome://tracing or Perfetto. The process id is the rank and the thread id the index of the thread.
+Common_API void write_timing_trace(const URI& file_base);
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+/// Time the rest of the enclosing scope as a region with the given name
+#define CF3_SCOPED_TIMER(name) \
+  static const cf3::Uint BOOST_PP_CAT(cf3_timing_region_, __LINE__) = cf3::common::timing_region(name); \
+  cf3::common::ScopedTimer BOOST_PP_CAT(cf3_scoped_timer_, __LINE__)(BOOST_PP_CAT(cf3_timing_region_, __LINE__))
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_ScopedTimer_hpp
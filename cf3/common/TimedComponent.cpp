@@ -4,6 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <iostream>
 
 #include "common/Component.hpp"
@@ -35,75 +36,114 @@ void store_timings(Component& root)
 
 /////////////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+
+/// Collect root and all its descendants in depth-first order, with their depth in the tree
+void collect_timing_tree(Component& root, const Uint depth, std::vector<Component*>& components, std::vector<Uint>& depths)
+{
+  components.push_back(&root);
+  depths.push_back(depth);
+  BOOST_FOREACH(Component& component, root)
+  {
+    collect_timing_tree(component, depth+1, components, depths);
+  }
+}
+
+} // detail
+
 void print_timing_tree(cf3::common::Component& root, const bool print_untimed, const std::string& prefix)
 {
-  if(prefix.empty()) // Top-level recursion
+  store_timings(root);
+
+  std::vector<Component*> components;
+  std::vector<Uint> depths;
+  detail::collect_timing_tree(root, 0, components, depths);
+  const Uint nb_components = components.size();
+
+  // Mean, minimum, maximum and count for each timed component
+  const Uint nb_stats = 4;
+  std::vector<Real> local_stats;
+  BOOST_FOREACH(Component* component, components)
   {
-    store_timings(root);
-    if(PE::Comm::instance().rank() == 0)
-      std::cout << "<DartMeasurement name=\"Timings\" type=\"text/plain\"><![CDATA[<html><body><pre>\n";
+    if(component->properties().check("timer_mean"))
+    {
+      local_stats.push_back(component->properties().value<Real>("timer_mean"));
+      local_stats.push_back(component->properties().value<Real>("timer_minimum"));
+      local_stats.push_back(component->properties().value<Real>("timer_maximum"));
+      local_stats.push_back(static_cast<Real>(component->properties().value<Uint>("timer_count")));
+    }
   }
 
-  if(!root.properties().check("timer_mean") && print_untimed && PE::Comm::instance().rank() == 0)
+  // Only bother with global statistics if we have more than 1 process. All statistics are collected on rank 0 at once.
+  const bool parallel = PE::Comm::instance().is_active() && PE::Comm::instance().size() > 1;
+  const Uint nb_procs = parallel ? PE::Comm::instance().size() : 1;
+  std::vector<Real> all_stats;
+  if(parallel)
+  {
+    if(local_stats.empty()) // Gather requires a non-empty buffer
+      local_stats.push_back(0.);
+    PE::Comm::instance().gather(local_stats, all_stats, 0);
+    if(PE::Comm::instance().rank() != 0)
+      return;
+  }
+  else
   {
-    std::cout << prefix << root.name() << ": no timing info\n";
+    all_stats = local_stats;
   }
+  const Uint rank_stride = all_stats.size() / nb_procs;
 
+  const bool top_level = prefix.empty();
+  if(top_level)
+  {
+    std::cout << "<DartMeasurement name=\"Timings\" type=\"text/plain\"><![CDATA[<html><body><pre>\n";
+    if(parallel)
+      std::cout << "Timings in seconds, with [min, mean, max] over CPUs\n";
+  }
 
-  if(root.properties().check("timer_mean"))
+  Uint stats_idx = 0;
+  for(Uint i = 0; i != nb_components; ++i)
   {
-    const Real local_mean = root.properties().value<Real>("timer_mean");
-    const Real local_min = root.properties().value<Real>("timer_minimum");
-    const Real local_max = root.properties().value<Real>("timer_maximum");
-    const Uint local_count = root.properties().value<Uint>("timer_count");
+    const Component& component = *components[i];
+    const std::string indent = prefix + std::string(2*depths[i], ' ');
+    if(!component.properties().check("timer_mean"))
+    {
+      if(print_untimed)
+        std::cout << indent << component.name() << ": no timing info\n";
+      continue;
+    }
 
-    // Only bother with global averages if we have more than 1 process
-    if(PE::Comm::instance().is_active() && PE::Comm::instance().size() > 1)
+    if(parallel)
     {
-      // Average, minimum and maximum of each statistic over all CPUs
-      Real mean_mean, mean_min, mean_max, max_mean, max_min, max_max, min_mean, min_min, min_max;
-      Uint min_count, max_count;
-      PE::Comm::instance().all_reduce(PE::plus(), &local_mean, 1, &mean_mean);
-      PE::Comm::instance().all_reduce(PE::min(), &local_mean, 1, &mean_min);
-      PE::Comm::instance().all_reduce(PE::max(), &local_mean, 1, &mean_max);
-
-      PE::Comm::instance().all_reduce(PE::plus(), &local_min, 1, &min_mean);
-      PE::Comm::instance().all_reduce(PE::min(), &local_min, 1, &min_min);
-      PE::Comm::instance().all_reduce(PE::max(), &local_min, 1, &min_max);
-
-      PE::Comm::instance().all_reduce(PE::plus(), &local_max, 1, &max_mean);
-      PE::Comm::instance().all_reduce(PE::min(), &local_max, 1, &max_min);
-      PE::Comm::instance().all_reduce(PE::max(), &local_max, 1, &max_max);
-      
-      PE::Comm::instance().all_reduce(PE::min(), &local_count, 1, &min_count);
-      PE::Comm::instance().all_reduce(PE::max(), &local_count, 1, &max_count);
-      cf3_assert(min_count == max_count);
-
-      const Real nb_procs = static_cast<Real>(PE::Comm::instance().size());
-      mean_mean /= nb_procs; min_mean /= nb_procs; max_mean /= nb_procs;
-
-      if(PE::Comm::instance().rank() == 0)
+      // Average of the means, minimum of the minima and maximum of the maxima over all CPUs
+      Real mean_mean = 0.;
+      Real min_min = all_stats[stats_idx+1];
+      Real max_max = all_stats[stats_idx+2];
+      Real min_count = all_stats[stats_idx+3];
+      for(Uint rank = 0; rank != nb_procs; ++rank)
       {
-        if(prefix.empty()) std::cout << "Timings in seconds, with [min, mean, max] over CPUs\n";
-        std::cout << prefix << root.name()
-          << ": mean: "  << mean_mean
-          << ", min: " << min_min
-          << ", max: " << max_max
-          << ", count: " << min_count << "\n";
+        const Real* rank_stats = &all_stats[rank*rank_stride + stats_idx];
+        mean_mean += rank_stats[0];
+        min_min = std::min(min_min, rank_stats[1]);
+        max_max = std::max(max_max, rank_stats[2]);
+        min_count = std::min(min_count, rank_stats[3]);
       }
+      mean_mean /= static_cast<Real>(nb_procs);
+
+      std::cout << indent << component.name()
+        << ": mean: "  << mean_mean
+        << ", min: " << min_min
+        << ", max: " << max_max
+        << ", count: " << static_cast<Uint>(min_count) << "\n";
     }
     else
     {
-      std::cout << prefix << root.name() << ": mean: " << local_mean << ", max: " << local_max << ", min: " << local_min << ", count: " << local_count << "\n";
+      std::cout << indent << component.name() << ": mean: " << all_stats[stats_idx] << ", max: " << all_stats[stats_idx+2] << ", min: " << all_stats[stats_idx+1] << ", count: " << static_cast<Uint>(all_stats[stats_idx+3]) << "\n";
     }
+    stats_idx += nb_stats;
   }
 
-  BOOST_FOREACH(Component& component, root)
-  {
-    print_timing_tree(component, print_untimed, prefix + "  ");
-  }
-
-  if(prefix.empty() && PE::Comm::instance().rank() == 0)
+  if(top_level)
     std::cout << "</pre></body></html>]]></DartMeasurement>" << std::endl;
 }
 
@@ -30,7 +30,8 @@ public:
 /// Store accumulated timings in properties for readout
 void store_timings(Component& root);
 
-/// Print timing tree based on the existing properties
+/// Print timing tree based on the existing properties. The statistics of all ranks are collected on rank 0 using a single
+/// gather, so all ranks must have the same timed components. The prefix is prepended to each line.
 void print_timing_tree(Component& root, const bool print_untimed = false, const std::string& prefix="");
 
 }
@@ -101,7 +101,7 @@ void AnalyticalFunction::parse (const std::string& function)
   clear();
   m_function = function;
 
-  m_parser = boost::shared_ptr<FunctionParser>( new FunctionParser() );
+  m_parser = boost::shared_ptr<BatchFunctionParser>( new BatchFunctionParser() );
   m_parser->AddConstant("pi", Consts::pi());
 
     // CFinfo << "Parsing Function: \'" << m_functions[i] << "\' Vars: \'" << m_vars << "\'\n" << CFendl;
@@ -129,7 +129,7 @@ void AnalyticalFunction::parse_and_deduce_variables (const std::string& function
   clear();
   m_function = function;
 
-  m_parser = boost::shared_ptr<FunctionParser>( new FunctionParser() );
+  m_parser = boost::shared_ptr<BatchFunctionParser>( new BatchFunctionParser() );
   m_parser->AddConstant("pi", Consts::pi());
 
   const int r = m_parser->ParseAndDeduceVariables(m_function, vars);
@@ -170,6 +170,14 @@ void AnalyticalFunction::parse (const std::string& function, const std::string&
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void AnalyticalFunction::evaluate_batch(const Real* var_values, const Uint nb_points, Real* ret_values, const Uint ret_stride) const
+{
+  cf3_assert(m_is_parsed);
+  m_parser->eval_batch(var_values, nb_points, ret_values, ret_stride);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // math
 } // cf3
 
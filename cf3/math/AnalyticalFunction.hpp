@@ -9,9 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
-#include "fparser/fparser.hh"
-
 #include "math/LibMath.hpp"
+#include "math/BatchFunctionParser.hpp"
 #include "math/MatrixTypes.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -89,6 +88,14 @@ public: // functions
   template <typename var_t>
   Real operator()(const var_t& var_values) const;
 
+  /// Evaluate the Analytical Function in a number of points at once.
+  /// This is much faster than evaluating the points one by one.
+  /// @param var_values values of the variables, nbvars() values for each point
+  /// @param nb_points number of points to evaluate
+  /// @param ret_values placeholder for the result, the value of point i is stored at ret_values[i*ret_stride]
+  /// @param ret_stride distance between the results of consecutive points
+  void evaluate_batch(const Real* var_values, const Uint nb_points, Real* ret_values, const Uint ret_stride = 1) const;
+
 protected: // helper functions
 
   /// Clears the m_parser deallocating the memory.
@@ -106,7 +113,7 @@ private: // data
   std::string m_function;
 
   /// vector holding the parsers, one for each entry in the vector
-  boost::shared_ptr<FunctionParser> m_parser;
+  boost::shared_ptr<BatchFunctionParser> m_parser;
 
 }; // AnalyticalFunction
 
@@ -0,0 +1,335 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include "math/BatchFunctionParser.hpp"
+
+// internals of the parser, giving access to the byte code
+#include "fparser/extrasrc/fptypes.hh"
+#include "fparser/extrasrc/fpaux.hh"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace FUNCTIONPARSERTYPES;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The stack entry at index SP holds the values of all points in stack[SP*BLOCK_SIZE + i]
+
+/// Replace the top of the stack x by expr in all points
+#define CF3_BATCH_UNARY(expr) \
+  { Real* x = &stack[SP*BLOCK_SIZE]; for(Uint i = 0; i != nb_points; ++i) x[i] = (expr); }
+
+/// Replace the two values x and y on top of the stack by expr in all points
+#define CF3_BATCH_BINARY(expr) \
+  { Real* x = &stack[(SP-1)*BLOCK_SIZE]; const Real* y = x + BLOCK_SIZE; for(Uint i = 0; i != nb_points; ++i) x[i] = (expr); --SP; }
+
+/// Mark the points where the stack entry v satisfies the error condition of Eval() as failed,
+/// and replace their value by a harmless one so the rest of the block raises no floating point exception
+#define CF3_BATCH_CHECK(entry, condition, harmless) \
+  { Real* v = &stack[(entry)*BLOCK_SIZE]; \
+    for(Uint i = 0; i != nb_points; ++i) { const bool fail = (condition); failed[i] |= fail; v[i] = fail ? Real(harmless) : v[i]; } }
+
+////////////////////////////////////////////////////////////////////////////////
+
+BatchFunctionParser::BatchFunctionParser()
+  : FunctionParser(),
+    m_stack(),
+    m_failed(BLOCK_SIZE)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool BatchFunctionParser::batch_supported()
+{
+  const std::vector<unsigned>& byte_code = getParserData()->mByteCode;
+  for(Uint IP = 0; IP < byte_code.size(); ++IP)
+  {
+    switch(byte_code[IP])
+    {
+      // jumps would make the points of a block follow different paths
+      case cIf: case cAbsIf: case cJump:
+      // calls to other parsers or user functions take a single point
+      case cEval: case cFCall: case cPCall:
+      // complex functions
+      case cArg: case cConj: case cImag: case cPolar: case cReal:
+        return false;
+      case cFetch:
+        IP += 1; break;
+      case cPopNMov:
+        IP += 2; break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BatchFunctionParser::eval_batch(const Real* var_values, const Uint nb_points, Real* ret_values, const Uint ret_stride)
+{
+  Data& data = *getParserData();
+  const Uint nb_vars = data.mVariablesAmount;
+
+  if(data.mParseErrorType != FP_NO_ERROR || !batch_supported())
+  {
+    int first_error = 0;
+    for(Uint p = 0; p != nb_points; ++p)
+    {
+      ret_values[p*ret_stride] = Eval(var_values + p*nb_vars);
+      if(first_error == 0)
+        first_error = EvalError();
+    }
+    data.mEvalErrorType = first_error;
+    return;
+  }
+
+  m_stack.resize(data.mStackSize*BLOCK_SIZE);
+  int first_error = 0;
+  for(Uint begin = 0; begin < nb_points; begin += BLOCK_SIZE)
+  {
+    const Uint block_size = std::min(static_cast<Uint>(BLOCK_SIZE), nb_points - begin);
+    const Real* block_vars = var_values + begin*nb_vars;
+    Real* block_ret = ret_values + begin*ret_stride;
+    eval_block(block_vars, block_size);
+
+    for(Uint i = 0; i != block_size; ++i)
+    {
+      if(m_failed[i])
+      {
+        block_ret[i*ret_stride] = Eval(block_vars + i*nb_vars);
+        if(first_error == 0)
+          first_error = EvalError();
+      }
+      else
+      {
+        block_ret[i*ret_stride] = m_stack[i];
+      }
+    }
+  }
+  data.mEvalErrorType = first_error;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BatchFunctionParser::eval_block(const Real* var_values, const Uint nb_points)
+{
+  Data& data = *getParserData();
+  const std::vector<unsigned>& byte_code = data.mByteCode;
+  const Uint nb_vars = data.mVariablesAmount;
+  Real* stack = &m_stack[0];
+  char* failed = &m_failed[0];
+  std::fill(m_failed.begin(), m_failed.end(), 0);
+
+  Uint DP = 0;
+  int SP = -1;
+  for(Uint IP = 0; IP < byte_code.size(); ++IP)
+  {
+    switch(byte_code[IP])
+    {
+// Functions:
+      case cAbs:   CF3_BATCH_UNARY(fp_abs(x[i])); break;
+      case cAcos:
+        CF3_BATCH_CHECK(SP, v[i] < Real(-1) || v[i] > Real(1), 0);
+        CF3_BATCH_UNARY(fp_acos(x[i])); break;
+      case cAcosh:
+        CF3_BATCH_CHECK(SP, v[i] < Real(1), 1);
+        CF3_BATCH_UNARY(fp_acosh(x[i])); break;
+      case cAsin:
+        CF3_BATCH_CHECK(SP, v[i] < Real(-1) || v[i] > Real(1), 0);
+        CF3_BATCH_UNARY(fp_asin(x[i])); break;
+      case cAsinh: CF3_BATCH_UNARY(fp_asinh(x[i])); break;
+      case cAtan:  CF3_BATCH_UNARY(fp_atan(x[i])); break;
+      case cAtan2: CF3_BATCH_BINARY(fp_atan2(x[i], y[i])); break;
+      case cAtanh:
+        CF3_BATCH_CHECK(SP, v[i] <= Real(-1) || v[i] >= Real(1), 0);
+        CF3_BATCH_UNARY(fp_atanh(x[i])); break;
+      case cCbrt:  CF3_BATCH_UNARY(fp_cbrt(x[i])); break;
+      case cCeil:  CF3_BATCH_UNARY(fp_ceil(x[i])); break;
+      case cCos:   CF3_BATCH_UNARY(fp_cos(x[i])); break;
+      case cCosh:  CF3_BATCH_UNARY(fp_cosh(x[i])); break;
+      case cCot:
+        CF3_BATCH_UNARY(fp_tan(x[i]));
+        CF3_BATCH_CHECK(SP, v[i] == Real(0), 1);
+        CF3_BATCH_UNARY(Real(1) / x[i]); break;
+      case cCsc:
+        CF3_BATCH_UNARY(fp_sin(x[i]));
+        CF3_BATCH_CHECK(SP, v[i] == Real(0), 1);
+        CF3_BATCH_UNARY(Real(1) / x[i]); break;
+      case cExp:   CF3_BATCH_UNARY(fp_exp(x[i])); break;
+      case cExp2:  CF3_BATCH_UNARY(fp_exp2(x[i])); break;
+      case cFloor: CF3_BATCH_UNARY(fp_floor(x[i])); break;
+      case cHypot: CF3_BATCH_BINARY(fp_hypot(x[i], y[i])); break;
+      case cInt:   CF3_BATCH_UNARY(fp_int(x[i])); break;
+      case cLog:
+        CF3_BATCH_CHECK(SP, !(v[i] > Real(0)), 1);
+        CF3_BATCH_UNARY(fp_log(x[i])); break;
+      case cLog10:
+        CF3_BATCH_CHECK(SP, !(v[i] > Real(0)), 1);
+        CF3_BATCH_UNARY(fp_log10(x[i])); break;
+      case cLog2:
+        CF3_BATCH_CHECK(SP, !(v[i] > Real(0)), 1);
+        CF3_BATCH_UNARY(fp_log2(x[i])); break;
+      case cMax:   CF3_BATCH_BINARY(fp_max(x[i], y[i])); break;
+      case cMin:   CF3_BATCH_BINARY(fp_min(x[i], y[i])); break;
+      case cPow:
+      {
+        // Besides the error of Eval() for a zero base with a negative exponent, negative bases
+        // with a fractional exponent may raise an invalid operation, so Eval() handles these too
+        Real* base = &stack[(SP-1)*BLOCK_SIZE];
+        const Real* exponent = base + BLOCK_SIZE;
+        for(Uint i = 0; i != nb_points; ++i)
+        {
+          const bool fail = (base[i] == Real(0) && exponent[i] < Real(0)) || (base[i] < Real(0) && exponent[i] != fp_floor(exponent[i]));
+          failed[i] |= fail;
+          base[i] = fail ? Real(1) : base[i];
+        }
+        CF3_BATCH_BINARY(fp_pow(x[i], y[i])); break;
+      }
+      case cTrunc: CF3_BATCH_UNARY(fp_trunc(x[i])); break;
+      case cSec:
+        CF3_BATCH_UNARY(fp_cos(x[i]));
+        CF3_BATCH_CHECK(SP, v[i] == Real(0), 1);
+        CF3_BATCH_UNARY(Real(1) / x[i]); break;
+      case cSin:   CF3_BATCH_UNARY(fp_sin(x[i])); break;
+      case cSinh:  CF3_BATCH_UNARY(fp_sinh(x[i])); break;
+      case cSqrt:
+        CF3_BATCH_CHECK(SP, v[i] < Real(0), 1);
+        CF3_BATCH_UNARY(fp_sqrt(x[i])); break;
+      case cTan:   CF3_BATCH_UNARY(fp_tan(x[i])); break;
+      case cTanh:  CF3_BATCH_UNARY(fp_tanh(x[i])); break;
+
+// Misc:
+      case cImmed:
+      {
+        ++SP;
+        const Real value = data.mImmed[DP++];
+        CF3_BATCH_UNARY(value); break;
+      }
+
+// Operators:
+      case cNeg:   CF3_BATCH_UNARY(-x[i]); break;
+      case cAdd:   CF3_BATCH_BINARY(x[i] + y[i]); break;
+      case cSub:   CF3_BATCH_BINARY(x[i] - y[i]); break;
+      case cMul:   CF3_BATCH_BINARY(x[i] * y[i]); break;
+      case cDiv:
+        CF3_BATCH_CHECK(SP, v[i] == Real(0), 1);
+        CF3_BATCH_BINARY(x[i] / y[i]); break;
+      case cMod:
+        CF3_BATCH_CHECK(SP, v[i] == Real(0), 1);
+        CF3_BATCH_BINARY(fp_mod(x[i], y[i])); break;
+      case cEqual:       CF3_BATCH_BINARY(fp_equal(x[i], y[i])); break;
+      case cNEqual:      CF3_BATCH_BINARY(fp_nequal(x[i], y[i])); break;
+      case cLess:        CF3_BATCH_BINARY(fp_less(x[i], y[i])); break;
+      case cLessOrEq:    CF3_BATCH_BINARY(fp_lessOrEq(x[i], y[i])); break;
+      case cGreater:     CF3_BATCH_BINARY(fp_less(y[i], x[i])); break;
+      case cGreaterOrEq: CF3_BATCH_BINARY(fp_lessOrEq(y[i], x[i])); break;
+      case cNot:         CF3_BATCH_UNARY(fp_not(x[i])); break;
+      case cNotNot:      CF3_BATCH_UNARY(fp_notNot(x[i])); break;
+      case cAnd:         CF3_BATCH_BINARY(fp_and(x[i], y[i])); break;
+      case cOr:          CF3_BATCH_BINARY(fp_or(x[i], y[i])); break;
+
+// Degrees-radians conversion:
+      case cDeg:   CF3_BATCH_UNARY(RadiansToDegrees(x[i])); break;
+      case cRad:   CF3_BATCH_UNARY(DegreesToRadians(x[i])); break;
+
+      case cFetch:
+      {
+        const Real* source = &stack[byte_code[++IP]*BLOCK_SIZE];
+        ++SP;
+        CF3_BATCH_UNARY(source[i]); break;
+      }
+      case cPopNMov:
+      {
+        const Uint target = byte_code[++IP];
+        const Uint source = byte_code[++IP];
+        std::copy(&stack[source*BLOCK_SIZE], &stack[source*BLOCK_SIZE] + nb_points, &stack[target*BLOCK_SIZE]);
+        SP = target;
+        break;
+      }
+      case cLog2by:
+        CF3_BATCH_CHECK(SP-1, !(v[i] > Real(0)), 1);
+        CF3_BATCH_BINARY(fp_log2(x[i]) * y[i]); break;
+      case cNop: break;
+
+      case cSinCos:
+      {
+        Real* x = &stack[SP*BLOCK_SIZE];
+        Real* c = x + BLOCK_SIZE;
+        for(Uint i = 0; i != nb_points; ++i)
+        {
+          const Real angle = x[i];
+          fp_sinCos(x[i], c[i], angle);
+        }
+        ++SP;
+        break;
+      }
+      case cSinhCosh:
+      {
+        Real* x = &stack[SP*BLOCK_SIZE];
+        Real* c = x + BLOCK_SIZE;
+        for(Uint i = 0; i != nb_points; ++i)
+        {
+          const Real value = x[i];
+          fp_sinhCosh(x[i], c[i], value);
+        }
+        ++SP;
+        break;
+      }
+
+      case cAbsNot:    CF3_BATCH_UNARY(fp_absNot(x[i])); break;
+      case cAbsNotNot: CF3_BATCH_UNARY(fp_absNotNot(x[i])); break;
+      case cAbsAnd:    CF3_BATCH_BINARY(fp_absAnd(x[i], y[i])); break;
+      case cAbsOr:     CF3_BATCH_BINARY(fp_absOr(x[i], y[i])); break;
+
+      case cDup:
+      {
+        const Real* source = &stack[SP*BLOCK_SIZE];
+        ++SP;
+        CF3_BATCH_UNARY(source[i]); break;
+      }
+      case cInv:
+        CF3_BATCH_CHECK(SP, v[i] == Real(0), 1);
+        CF3_BATCH_UNARY(Real(1) / x[i]); break;
+      case cSqr:   CF3_BATCH_UNARY(x[i] * x[i]); break;
+      case cRDiv:
+        CF3_BATCH_CHECK(SP-1, v[i] == Real(0), 1);
+        CF3_BATCH_BINARY(y[i] / x[i]); break;
+      case cRSub:  CF3_BATCH_BINARY(y[i] - x[i]); break;
+      case cRSqrt:
+        // negative values raise an invalid operation, leave them to Eval() as well
+        CF3_BATCH_CHECK(SP, v[i] <= Real(0), 1);
+        CF3_BATCH_UNARY(Real(1) / fp_sqrt(x[i])); break;
+
+// Variables:
+      default:
+      {
+        const Real* variable = var_values + (byte_code[IP] - VarBegin);
+        ++SP;
+        CF3_BATCH_UNARY(variable[i*nb_vars]); break;
+      }
+    }
+  }
+}
+
+#undef CF3_BATCH_UNARY
+#undef CF3_BATCH_BINARY
+#undef CF3_BATCH_CHECK
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
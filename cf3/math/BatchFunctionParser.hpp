@@ -0,0 +1,76 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_BatchFunctionParser_hpp
+#define cf3_Math_BatchFunctionParser_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+
+#include "fparser/fparser.hh"
+
+#include "math/LibMath.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+
+  namespace math {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Function parser that evaluates the parsed function in many points at once.
+/// The byte code is interpreted once for a block of points, each instruction
+/// being applied to all points of the block, so the cost of the interpreter is
+/// shared by the points and the loops over the block can be vectorized.
+/// The result is the same as calling Eval() for each point:
+/// - functions containing conditions or calls to other functions are evaluated point by point
+/// - points where Eval() would report an evaluation error are evaluated again with Eval()
+class Math_API BatchFunctionParser : public FunctionParser {
+
+public: // functions
+
+  /// Number of points evaluated together
+  enum { BLOCK_SIZE = 64 };
+
+  /// Empty constructor
+  BatchFunctionParser();
+
+  /// Evaluate the function in a number of points.
+  /// EvalError() afterwards returns the error of the first point that failed, or 0.
+  /// @param var_values values of the variables, stored point after point
+  /// @param nb_points number of points to evaluate
+  /// @param ret_values result, the value of point i is stored at ret_values[i*ret_stride]
+  /// @param ret_stride distance between the results of consecutive points
+  void eval_batch(const Real* var_values, const Uint nb_points, Real* ret_values, const Uint ret_stride = 1);
+
+private: // functions
+
+  /// True if every instruction of the byte code can be applied to a block
+  bool batch_supported();
+
+  /// Evaluate the byte code in nb_points <= BLOCK_SIZE points, leaving the result in the first stack entry
+  void eval_block(const Real* var_values, const Uint nb_points);
+
+private: // data
+
+  /// Stack of the interpreter, each entry holds BLOCK_SIZE values
+  std::vector<Real> m_stack;
+
+  /// Points of the current block that must be evaluated again by Eval()
+  std::vector<char> m_failed;
+
+}; // BatchFunctionParser
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_Math_BatchFunctionParser_hpp
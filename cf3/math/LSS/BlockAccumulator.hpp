@@ -14,6 +14,12 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <vector>
+
+#include <boost/array.hpp>
+#include <boost/noncopyable.hpp>
+
 #include "math/MatrixTypes.hpp"
 #include "math/LSS/LibLSS.hpp"
 
@@ -79,6 +85,103 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+/// BlockAccumulator with the number of nodes and equations known at compile time. It needs no dynamic allocation and
+/// the Eigen operations on it can be unrolled. The set_values, add_values, set_rhs_values, add_rhs_values and get_sol_values
+/// functions of Matrix and Vector take it directly.
+template<int NbNodes, int NbEqs>
+class FixedBlockAccumulator {
+public:
+
+  /// Number of rows and columns of mat
+  static const int total_size = NbNodes*NbEqs;
+
+  /// Storage for the block matrix, row-major like in BlockAccumulator
+  typedef Eigen::Matrix<Real, total_size, total_size, Eigen::RowMajor> MatrixT;
+
+  /// Storage for the block vectors
+  typedef Eigen::Matrix<Real, total_size, 1> VectorT;
+
+  /// reset the values to the value of reset_to
+  void reset(Real reset_to=0.)
+  {
+    mat.setConstant(reset_to);
+    sol.setConstant(reset_to);
+    rhs.setConstant(reset_to);
+  }
+
+  /// entering the indices where the local matrix is lying
+  template<typename T> void neighbour_indices(const T& idx_vector )
+  {
+    cf3_assert(static_cast<Uint>(NbNodes)==idx_vector.size());
+    for (Uint i=0; i<NbNodes; i++)
+      indices[i]=idx_vector[i];
+  }
+
+  /// how many rows/columns
+  Uint size() const { return total_size; }
+
+  /// how many rows/columns
+  Uint block_size() const { return NbNodes; }
+
+  /// Copy into a dynamically sized block accumulator, for the interfaces that don't take a fixed size
+  void copy_to(BlockAccumulator& other) const
+  {
+    other.resize(NbNodes, NbEqs);
+    other.mat = mat;
+    other.sol = sol;
+    other.rhs = rhs;
+    std::copy(indices.begin(), indices.end(), other.indices.begin());
+  }
+
+  /// block matrix
+  MatrixT mat;
+
+  /// solution vector
+  VectorT sol;
+
+  /// right hand side vector
+  VectorT rhs;
+
+  /// local numbering of the unknowns
+  boost::array<Uint, NbNodes> indices;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Scratch space for the matrix indices of one block, used by the matrix implementations while adding a block.
+/// Blocks of up to max_stack_size entries, which covers a 27-node element with 8 equations, are stored on the stack,
+/// so element assembly does not allocate and threads assembling disjoint rows each use their own buffer.
+class BlockIndexBuffer : boost::noncopyable {
+public:
+
+  /// Number of entries stored without dynamic allocation
+  static const Uint max_stack_size = 216;
+
+  /// Buffer for size entries, only allocated if size exceeds max_stack_size
+  explicit BlockIndexBuffer(const Uint size)
+  {
+    if(size > max_stack_size)
+      m_heap.resize(size);
+    m_data = size > max_stack_size ? &m_heap[0] : m_stack;
+  }
+
+  int& operator[](const Uint i) { return m_data[i]; }
+  int operator[](const Uint i) const { return m_data[i]; }
+
+  /// Pointer to the first entry
+  int* data() { return m_data; }
+  const int* data() const { return m_data; }
+
+private:
+  int m_stack[max_stack_size];
+  std::vector<int> m_heap;
+  int* m_data;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 } // namespace LSS
 } // namespace math
 } // namespace cf3
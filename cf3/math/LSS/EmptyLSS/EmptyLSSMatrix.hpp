@@ -103,11 +103,17 @@ public:
   /// Set a list of values
   void set_values(const BlockAccumulator& values) { cf3_assert(m_is_created); }
 
+  /// Set a block of values
+  void set_block_values(const Uint nb_nodes, const Uint* indices, const Real* values) { cf3_assert(m_is_created); }
+
   /// Add a list of values
   /// local ibdices
   /// eigen, templatization on top level
   void add_values(const BlockAccumulator& values) { cf3_assert(m_is_created); }
 
+  /// Add a block of values
+  void add_block_values(const Uint nb_nodes, const Uint* indices, const Real* values) { cf3_assert(m_is_created); }
+
   /// Add a list of values
   void get_values(BlockAccumulator& values) { cf3_assert(m_is_created); values.mat.setConstant(0.); }
 
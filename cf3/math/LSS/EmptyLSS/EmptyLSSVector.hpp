@@ -114,9 +114,15 @@ public:
   /// Set a list of values to rhs
   void set_rhs_values(const BlockAccumulator& values) { cf3_assert(m_is_created); }
 
+  /// Set a block of values to rhs
+  void set_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values) { cf3_assert(m_is_created); }
+
   /// Add a list of values to rhs
   void add_rhs_values(const BlockAccumulator& values) { cf3_assert(m_is_created); }
 
+  /// Add a block of values to rhs
+  void add_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values) { cf3_assert(m_is_created); }
+
   /// Get a list of values from rhs
   void get_rhs_values(BlockAccumulator& values) { cf3_assert(m_is_created); values.rhs.setConstant(0.); }
 
@@ -129,6 +135,9 @@ public:
   /// Get a list of values from sol
   void get_sol_values(BlockAccumulator& values) { cf3_assert(m_is_created); values.sol.setConstant(0.); }
 
+  /// Get a block of values from sol
+  void get_sol_block_values(const Uint nb_nodes, const Uint* indices, Real* values) { cf3_assert(m_is_created); std::fill(values, values+nb_nodes*m_neq, 0.); }
+
   /// Reset Vector
   void reset(Real reset_to=0.) { cf3_assert(m_is_created); }
 
@@ -0,0 +1,58 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <boost/thread/mutex.hpp>
+
+#include "math/LSS/Matrix.hpp"
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////
+
+class Matrix::Implementation
+{
+public:
+  /// Storage returned by value_positions_storage, for each key
+  std::map< const void*, std::vector<int> > m_value_positions_storage;
+  boost::mutex m_value_positions_mutex;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+Matrix::Matrix(const std::string& name) :
+  Component(name),
+  m_is_frozen(false),
+  m_cache_value_positions(false),
+  m_implementation(new Implementation())
+{
+}
+
+Matrix::~Matrix()
+{
+}
+
+std::vector<int>& Matrix::value_positions_storage(const void* key, const Uint size, const int fill_value)
+{
+  boost::mutex::scoped_lock lock(m_implementation->m_value_positions_mutex);
+  std::vector<int>& storage = m_implementation->m_value_positions_storage[key];
+  if(storage.size() != size)
+    storage.assign(size, fill_value);
+  return storage;
+}
+
+void Matrix::clear_value_positions_storage()
+{
+  boost::mutex::scoped_lock lock(m_implementation->m_value_positions_mutex);
+  m_implementation->m_value_positions_storage.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // LSS
+} // math
+} // cf3
@@ -9,10 +9,16 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
 #include <boost/utility.hpp>
 
 #include "math/LSS/LibLSS.hpp"
 #include "common/PE/CommPattern.hpp"
+#include "common/BasicExceptions.hpp"
 #include "common/Log.hpp"
 #include "math/LSS/BlockAccumulator.hpp"
 #include "math/LSS/Vector.hpp"
@@ -48,7 +54,9 @@ public:
   virtual const bool is_swappable(const LSS::Vector& solution, const LSS::Vector& rhs) = 0;
 
   /// Default constructor
-  Matrix(const std::string& name) : Component(name) { }
+  Matrix(const std::string& name);
+
+  virtual ~Matrix();
 
   /// Setup sparsity structure
   /// should only work with local numbering (parallel computations, plus rcm could be a totally internal matter of the matrix)
@@ -86,11 +94,53 @@ public:
   /// Set a list of values
   virtual void set_values(const BlockAccumulator& values) = 0;
 
+  /// Set a block of values, given as the indices of the nb_nodes block rows and the row-major matrix of size nb_nodes*neq().
+  /// This is what set_values uses for a FixedBlockAccumulator. The default implementation copies the data into a
+  /// BlockAccumulator, implementations should override it to avoid the allocation.
+  virtual void set_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
+  {
+    const Uint size = nb_nodes*neq();
+    BlockAccumulator block;
+    block.resize(nb_nodes, neq());
+    std::copy(indices, indices+nb_nodes, block.indices.begin());
+    block.mat = Eigen::Map< const Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> >(values, size, size);
+    set_values(block);
+  }
+
+  /// Set the values of a block accumulator with a size known at compile time, without any dynamic allocation
+  template<int NbNodes, int NbEqs>
+  void set_values(const FixedBlockAccumulator<NbNodes, NbEqs>& values)
+  {
+    cf3_assert(neq() == static_cast<Uint>(NbEqs));
+    set_block_values(NbNodes, values.indices.data(), values.mat.data());
+  }
+
   /// Add a list of values
   /// local ibdices
   /// eigen, templatization on top level
   virtual void add_values(const BlockAccumulator& values) = 0;
 
+  /// Add a block of values, given as the indices of the nb_nodes block rows and the row-major matrix of size nb_nodes*neq().
+  /// This is what add_values uses for a FixedBlockAccumulator. The default implementation copies the data into a
+  /// BlockAccumulator, implementations should override it to avoid the allocation.
+  virtual void add_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
+  {
+    const Uint size = nb_nodes*neq();
+    BlockAccumulator block;
+    block.resize(nb_nodes, neq());
+    std::copy(indices, indices+nb_nodes, block.indices.begin());
+    block.mat = Eigen::Map< const Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> >(values, size, size);
+    add_values(block);
+  }
+
+  /// Add the values of a block accumulator with a size known at compile time, without any dynamic allocation
+  template<int NbNodes, int NbEqs>
+  void add_values(const FixedBlockAccumulator<NbNodes, NbEqs>& values)
+  {
+    cf3_assert(neq() == static_cast<Uint>(NbEqs));
+    add_block_values(NbNodes, values.indices.data(), values.mat.data());
+  }
+
   /// Add a list of values
   virtual void get_values(BlockAccumulator& values) = 0;
 
@@ -124,6 +174,53 @@ public:
 
   //@} END EFFICCIENT ACCESS
 
+  /// @name REUSE OF ASSEMBLED VALUES
+  //@{
+
+  /// Compute the position in the native value storage of the matrix for each entry of the row-major block matrix
+  /// that belongs to the nb_nodes block rows in indices. Entries in rows that are not stored on this rank get position -1.
+  /// @return false if the matrix does not provide direct access to its values
+  virtual bool value_positions(const Uint nb_nodes, const Uint* indices, int* positions) { return false; }
+
+  /// Add nb_values entries at the positions computed by value_positions. This skips the index lookups of add_values.
+  virtual void add_values_at(const Uint nb_values, const Real* values, const int* positions)
+  {
+    throw common::NotImplemented(FromHere(), "add_values_at is not implemented for matrix " + uri().string());
+  }
+
+  /// Compute the positions for the entries of values.mat, for BlockAccumulator or FixedBlockAccumulator
+  template<typename BlockAccumulatorT>
+  bool value_positions(const BlockAccumulatorT& values, int* positions)
+  {
+    return value_positions(values.block_size(), &values.indices[0], positions);
+  }
+
+  /// Add the entries of values.mat at the positions computed by value_positions for the same indices
+  template<typename BlockAccumulatorT>
+  void add_values_at(const BlockAccumulatorT& values, const int* positions)
+  {
+    add_values_at(values.mat.size(), values.mat.data(), positions);
+  }
+
+  /// Freeze the matrix values. Assembly, reset, dirichlet conditions and periodicity through System and the solver actions
+  /// leave a frozen matrix untouched, and the solution strategies reuse their preconditioner.
+  void freeze(const bool frozen) { m_is_frozen = frozen; }
+
+  /// True if the matrix is frozen
+  const bool is_frozen() const { return m_is_frozen; }
+
+  /// Indicate if assembly code should store the results of value_positions and assemble using add_values_at
+  void cache_value_positions(const bool cache) { m_cache_value_positions = cache; }
+
+  /// True if assembly code should cache the value positions
+  const bool caches_value_positions() const { return m_cache_value_positions; }
+
+  /// Storage of size entries for caching the results of value_positions, e.g. for all elements of the connectivity table
+  /// used as key. The storage belongs to the matrix, so it is discarded together with the sparsity. New storage is filled with fill_value.
+  std::vector<int>& value_positions_storage(const void* key, const Uint size, const int fill_value);
+
+  //@} END REUSE OF ASSEMBLED VALUES
+
   /// @name MISCELLANEOUS
   //@{
 
@@ -177,6 +274,17 @@ public:
 
   //@} END TEST ONLY
 
+protected:
+  /// Discard the storage returned by value_positions_storage, when the sparsity is destroyed
+  void clear_value_positions_storage();
+
+private:
+  bool m_is_frozen;
+  bool m_cache_value_positions;
+
+  /// Storage returned by value_positions_storage and its mutex, kept out of this header with the Boost.Thread headers
+  class Implementation;
+  boost::scoped_ptr<Implementation> m_implementation;
 
 }; // end of class Matrix
 
@@ -0,0 +1,779 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <fstream>
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "common/Assertions.hpp"
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+#include "math/LSS/Distribution.hpp"
+#include "math/LSS/Native/NativeCrsMatrix.hpp"
+#include "math/LSS/Native/NativeVector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file NativeCrsMatrix.cpp Implementation of the LSS::Matrix interface using compressed row storage
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/// Orders the entries of a block by their matrix column
+struct ColumnLess
+{
+  ColumnLess(const int* columns) : m_columns(columns) {}
+  bool operator()(const int a, const int b) const { return m_columns[a] < m_columns[b]; }
+  const int* m_columns;
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < LSS::NativeCrsMatrix, LSS::Matrix, LSS::LibLSS > NativeCrsMatrix_Builder;
+
+NativeCrsMatrix::NativeCrsMatrix(const std::string& name) :
+  LSS::Matrix(name),
+  m_nb_threads(1),
+  m_min_thread_entries(100000),
+  m_is_created(false),
+  m_neq(0),
+  m_num_my_elements(0)
+{
+  properties().add("vector_type", std::string("cf3.math.LSS.NativeVector"));
+
+  options().add("nb_threads", m_nb_threads)
+    .pretty_name("Number of Threads")
+    .description("Number of threads used for the matrix-vector product")
+    .link_to(&m_nb_threads);
+
+  options().add("min_thread_entries", m_min_thread_entries)
+    .pretty_name("Minimum Thread Entries")
+    .description("Minimum number of matrix entries for each thread in the matrix-vector product. Smaller matrices use less threads, since starting the threads would cost more than the product itself.")
+    .link_to(&m_min_thread_entries);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs, const std::vector<Uint>& periodic_links_nodes, const std::vector<bool>& periodic_links_active)
+{
+  boost::shared_ptr<VariablesDescriptor> single_var_descriptor = common::allocate_component<VariablesDescriptor>("SingleVariableDescriptor");
+  single_var_descriptor->options().set(common::Tags::dimension(), neq);
+  single_var_descriptor->push_back("LSSvars", VariablesDescriptor::Dimensionalities::VECTOR);
+  create_blocked(cp, *single_var_descriptor, node_connectivity, starting_indices, solution, rhs, periodic_links_nodes, periodic_links_active);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector< Uint >& node_connectivity, const std::vector< Uint >& starting_indices, Vector& solution, Vector& rhs, const std::vector<Uint>& periodic_links_nodes, const std::vector<bool>& periodic_links_active)
+{
+  // if already created
+  if (m_is_created) destroy();
+
+  // Copy node connectivity
+  m_node_connectivity = node_connectivity;
+  m_starting_indices = starting_indices;
+
+  // prepare intermediate data
+  std::vector<int> my_global_elements;
+  std::vector<Uint> my_ranks;
+
+  create_map_data(cp, vars, m_p2m, my_global_elements, my_ranks, m_num_my_elements, periodic_links_nodes, periodic_links_active);
+  std::vector<int> num_indices_per_row; num_indices_per_row.reserve(m_num_my_elements);
+  std::vector<int> indices_per_row;
+  create_indices_per_row(cp, vars, node_connectivity, starting_indices, m_p2m, num_indices_per_row, indices_per_row, periodic_links_nodes, periodic_links_active);
+  cf3_assert(num_indices_per_row.size() == static_cast<Uint>(m_num_my_elements));
+
+  // Sorted columns for each row
+  m_row_offsets.resize(m_num_my_elements+1);
+  m_row_offsets[0] = 0;
+  m_columns.reserve(indices_per_row.size());
+  m_diagonal_positions.resize(m_num_my_elements);
+  m_ghost_offsets.resize(m_num_my_elements);
+  Uint row_start = 0;
+  for(int row = 0; row != m_num_my_elements; ++row)
+  {
+    const Uint row_nb_elems = num_indices_per_row[row];
+    m_columns.insert(m_columns.end(), indices_per_row.begin() + row_start, indices_per_row.begin() + row_start + row_nb_elems);
+    const std::vector<Uint>::iterator row_begin = m_columns.begin() + m_row_offsets[row];
+    std::sort(row_begin, m_columns.end());
+    m_columns.erase(std::unique(row_begin, m_columns.end()), m_columns.end());
+    row_start += row_nb_elems;
+    m_row_offsets[row+1] = m_columns.size();
+
+    const std::vector<Uint>::const_iterator columns_begin = m_columns.begin() + m_row_offsets[row];
+    const std::vector<Uint>::const_iterator columns_end = m_columns.end();
+    const std::vector<Uint>::const_iterator diagonal = std::lower_bound(columns_begin, columns_end, static_cast<Uint>(row));
+    if(diagonal == columns_end || *diagonal != static_cast<Uint>(row))
+      throw common::SetupError(FromHere(), "Row " + common::to_str(row) + " of matrix " + uri().string() + " has no diagonal entry");
+    m_diagonal_positions[row] = diagonal - m_columns.begin();
+    m_ghost_offsets[row] = std::lower_bound(columns_begin, columns_end, static_cast<Uint>(m_num_my_elements)) - m_columns.begin();
+    if(m_ghost_offsets[row] != m_row_offsets[row+1])
+      m_ghost_rows.push_back(row);
+  }
+
+  m_values.assign(m_columns.size(), 0.);
+  m_thread_rows.clear();
+
+  // set class properties
+  m_is_created=true;
+  m_neq=vars.size();
+  CFdebug << "Rank " << common::PE::Comm::instance().rank() << ": Created a native matrix with " << m_columns.size() << " local non-zero elements and " << m_num_my_elements << " local rows" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::destroy()
+{
+  m_p2m.clear();
+  m_row_offsets.clear();
+  m_columns.clear();
+  m_values.clear();
+  m_diagonal_positions.clear();
+  m_ghost_offsets.clear();
+  m_ghost_rows.clear();
+  m_thread_rows.clear();
+  m_symmetric_dirichlet_values.clear();
+  clear_value_positions_storage();
+  m_neq=0;
+  m_num_my_elements=0;
+  m_is_created=false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+int NativeCrsMatrix::entry_position(const int row, const int col) const
+{
+  cf3_assert(row < m_num_my_elements);
+  const std::vector<Uint>::const_iterator row_begin = m_columns.begin() + m_row_offsets[row];
+  const std::vector<Uint>::const_iterator row_end = m_columns.begin() + m_row_offsets[row+1];
+  const std::vector<Uint>::const_iterator entry = std::lower_bound(row_begin, row_end, static_cast<Uint>(col));
+  if(entry == row_end || *entry != static_cast<Uint>(col))
+    return -1;
+  return entry - m_columns.begin();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Uint NativeCrsMatrix::checked_entry_position(const int row, const int col) const
+{
+  const int position = entry_position(row, col);
+  if(position < 0)
+    throw common::BadValue(FromHere(), "Column " + common::to_str(col) + " is not in the sparsity pattern of row " + common::to_str(row));
+  return position;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::convert_block_indices(const Uint nb_nodes, const Uint* indices, BlockIndexBuffer& converted_indices, BlockIndexBuffer& column_order) const
+{
+  const Uint num_entries = nb_nodes*m_neq;
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    const Uint local_start_idx = indices[i]*m_neq;
+    for(Uint j = 0; j != m_neq; ++j)
+      converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+  }
+  for(Uint i = 0; i != num_entries; ++i)
+    column_order[i] = i;
+  std::sort(column_order.data(), column_order.data() + num_entries, ColumnLess(converted_indices.data()));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::block_row_positions(const int row, const Uint num_entries, const BlockIndexBuffer& converted_indices, const BlockIndexBuffer& column_order, int* positions) const
+{
+  cf3_assert(row < m_num_my_elements);
+  // The columns of the row are sorted, so visiting the block columns in increasing order finds them all in one pass
+  const Uint row_end = m_row_offsets[row+1];
+  Uint entry = m_row_offsets[row];
+  for(Uint i = 0; i != num_entries; ++i)
+  {
+    const int block_col = column_order[i];
+    const Uint col = converted_indices[block_col];
+    while(entry != row_end && m_columns[entry] < col)
+      ++entry;
+    positions[block_col] = (entry != row_end && m_columns[entry] == col) ? static_cast<int>(entry) : -1;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::checked_block_row_positions(const int row, const Uint num_entries, const BlockIndexBuffer& converted_indices, const BlockIndexBuffer& column_order, int* positions) const
+{
+  block_row_positions(row, num_entries, converted_indices, column_order, positions);
+  for(Uint col = 0; col != num_entries; ++col)
+  {
+    if(positions[col] < 0)
+      throw common::BadValue(FromHere(), "Column " + common::to_str(converted_indices[col]) + " is not in the sparsity pattern of row " + common::to_str(row));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::set_value(const Uint icol, const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  if(m_p2m[irow] < m_num_my_elements)
+    m_values[checked_entry_position(m_p2m[irow], m_p2m[icol])] = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::add_value(const Uint icol, const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  if(m_p2m[irow] < m_num_my_elements)
+    m_values[checked_entry_position(m_p2m[irow], m_p2m[icol])] += value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::get_value(const Uint icol, const Uint irow, Real& value)
+{
+  cf3_assert(m_is_created);
+  const int position = m_p2m[irow] < m_num_my_elements ? entry_position(m_p2m[irow], m_p2m[icol]) : -1;
+  if(position < 0)
+    throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  value = m_values[position];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::set_values(const BlockAccumulator& values)
+{
+  cf3_assert(static_cast<Uint>(values.mat.rows()) == values.indices.size()*m_neq);
+  set_block_values(values.indices.size(), &values.indices[0], values.mat.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::set_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
+{
+  cf3_assert(m_is_created);
+  const Uint num_entries = nb_nodes*m_neq;
+  BlockIndexBuffer converted_indices(num_entries), column_order(num_entries), row_positions(num_entries);
+  convert_block_indices(nb_nodes, indices, converted_indices, column_order);
+  for(Uint row = 0; row != num_entries; ++row)
+  {
+    if(converted_indices[row] >= m_num_my_elements)
+      continue;
+    checked_block_row_positions(converted_indices[row], num_entries, converted_indices, column_order, row_positions.data());
+    const Real* row_values = values + num_entries*row;
+    for(Uint col = 0; col != num_entries; ++col)
+      m_values[row_positions[col]] = row_values[col];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::add_values(const BlockAccumulator& values)
+{
+  cf3_assert(static_cast<Uint>(values.mat.rows()) == values.indices.size()*m_neq);
+  add_block_values(values.indices.size(), &values.indices[0], values.mat.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::add_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
+{
+  cf3_assert(m_is_created);
+  const Uint num_entries = nb_nodes*m_neq;
+  // Scratch on the stack, so threads assembling disjoint rows can call this concurrently
+  BlockIndexBuffer converted_indices(num_entries), column_order(num_entries), row_positions(num_entries);
+  convert_block_indices(nb_nodes, indices, converted_indices, column_order);
+  for(Uint row = 0; row != num_entries; ++row)
+  {
+    if(converted_indices[row] >= m_num_my_elements)
+      continue;
+    checked_block_row_positions(converted_indices[row], num_entries, converted_indices, column_order, row_positions.data());
+    const Real* row_values = values + num_entries*row;
+    for(Uint col = 0; col != num_entries; ++col)
+      m_values[row_positions[col]] += row_values[col];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::get_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  values.mat.setZero();
+  const Uint nb_nodes = values.indices.size();
+  const Uint num_entries = nb_nodes*m_neq;
+  cf3_assert(values.mat.rows() == num_entries);
+  BlockIndexBuffer converted_indices(num_entries), column_order(num_entries), row_positions(num_entries);
+  convert_block_indices(nb_nodes, &values.indices[0], converted_indices, column_order);
+  for(Uint row = 0; row != num_entries; ++row)
+  {
+    if(converted_indices[row] >= m_num_my_elements)
+      continue;
+    block_row_positions(converted_indices[row], num_entries, converted_indices, column_order, row_positions.data());
+    for(Uint col = 0; col != num_entries; ++col)
+    {
+      if(row_positions[col] >= 0)
+        values.mat(row, col) = m_values[row_positions[col]];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval)
+{
+  cf3_assert(m_is_created);
+  const int row = m_p2m[iblockrow*m_neq+ieq];
+  if(row >= m_num_my_elements)
+    return;
+
+  const Uint row_end = m_row_offsets[row+1];
+  for(Uint i = m_row_offsets[row]; i != row_end; ++i)
+    m_values[i] = offdiagval;
+  m_values[m_diagonal_positions[row]] = diagval;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values)
+{
+  throw common::NotImplemented(FromHere(), "get_column_and_replace_to_zero is not implemented for NativeCrsMatrix");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, Vector& rhs)
+{
+  cf3_assert(m_is_created);
+  // The RHS has the same storage structure as the matrix
+  std::vector<Real>& rhs_data = dynamic_cast<NativeVector&>(rhs).data();
+
+  const int bc_col = m_p2m[blockrow*m_neq+ieq];
+
+  DirichletEntryT& cached_col_values = m_symmetric_dirichlet_values[bc_col];
+
+  if(cached_col_values.empty())
+  {
+    const Uint conn_start = m_starting_indices[blockrow];
+    const Uint conn_end = m_starting_indices[blockrow+1];
+    for(Uint i = conn_start; i != conn_end; ++i)
+    {
+      for(Uint j = 0; j != m_neq; ++j)
+      {
+        const int other_row = m_p2m[m_node_connectivity[i]*m_neq+j];
+        if(other_row >= m_num_my_elements)
+          continue;
+
+        if(other_row != bc_col)
+        {
+          const Uint position = checked_entry_position(other_row, bc_col);
+          cached_col_values[other_row] = m_values[position];
+          rhs_data[other_row] -= m_values[position] * value;
+          m_values[position] = 0.;
+        }
+        else
+        {
+          const Uint row_end = m_row_offsets[other_row+1];
+          for(Uint k = m_row_offsets[other_row]; k != row_end; ++k)
+            m_values[k] = 0.;
+          m_values[m_diagonal_positions[other_row]] = 1.;
+        }
+      }
+    }
+  }
+  else // Reuse the cached values, if the matrix wasn't reset since the previous BC application
+  {
+    for(DirichletEntryT::const_iterator it = cached_col_values.begin(); it != cached_col_values.end(); ++it)
+    {
+      rhs_data[it->first] -= it->second * value;
+    }
+  }
+
+  rhs.set_value(blockrow, ieq, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from)
+{
+  cf3_assert(m_is_created);
+  const int row_from_begin = iblockrow_from*m_neq;
+  const int row_to_begin = iblockrow_to*m_neq;
+
+  if(m_p2m[row_from_begin] >= m_num_my_elements || m_p2m[row_to_begin] >= m_num_my_elements)
+    return;
+
+  const int nb_eq = m_neq;
+  for(int i = 0; i != nb_eq; ++i)
+  {
+    const int row_from = m_p2m[row_from_begin+i];
+    const int row_to = m_p2m[row_to_begin+i];
+    const Uint num_entries = m_row_offsets[row_from+1] - m_row_offsets[row_from];
+    if (num_entries != m_row_offsets[row_to+1] - m_row_offsets[row_to])
+    {
+      throw common::BadValue(FromHere(),"Number of entries do not match for the two block rows to be tied together.");
+    }
+    const Uint* indices_from = &m_columns[m_row_offsets[row_from]];
+    const Uint* indices_to = &m_columns[m_row_offsets[row_to]];
+    Real* values_from = &m_values[m_row_offsets[row_from]];
+    Real* values_to = &m_values[m_row_offsets[row_to]];
+    int diag = 0, pair = 0;
+    for(Uint j = 0; j != num_entries; ++j)
+    {
+      if(indices_from[j] != indices_to[j])
+      {
+        throw common::BadValue(FromHere(),"Indices of the entries do not match for the two block rows to be tied together.");
+      }
+
+      if(indices_from[j] == static_cast<Uint>(row_from))
+        diag = j;
+      if(indices_to[j] == static_cast<Uint>(row_to))
+        pair = j;
+
+      values_to[j] += values_from[j];
+      values_from[j] = 0.;
+    }
+    values_from[diag] = 1.;
+    values_from[pair] = -1.;
+    for(int k = 0; k != nb_eq; ++k)
+    {
+      values_to[pair-i+k] += values_to[diag-i+k];
+      values_to[diag-i+k] = 0.;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::set_diagonal(const std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(diag.size() == m_p2m.size());
+  const Uint nb_entries = m_p2m.size();
+  for(Uint i = 0; i != nb_entries; ++i)
+  {
+    if(m_p2m[i] < m_num_my_elements)
+      m_values[m_diagonal_positions[m_p2m[i]]] = diag[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::add_diagonal(const std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(diag.size() == m_p2m.size());
+  const Uint nb_entries = m_p2m.size();
+  for(Uint i = 0; i != nb_entries; ++i)
+  {
+    if(m_p2m[i] < m_num_my_elements)
+      m_values[m_diagonal_positions[m_p2m[i]]] += diag[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::get_diagonal(std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_entries = m_p2m.size();
+  diag.resize(nb_entries);
+  for(Uint i = 0; i != nb_entries; ++i)
+  {
+    diag[i] = m_p2m[i] < m_num_my_elements ? m_values[m_diagonal_positions[m_p2m[i]]] : 0.;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::reset(Real reset_to)
+{
+  cf3_assert(m_is_created);
+  m_values.assign(m_values.size(), reset_to);
+  m_symmetric_dirichlet_values.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+bool NativeCrsMatrix::value_positions(const Uint nb_nodes, const Uint* indices, int* positions)
+{
+  cf3_assert(m_is_created);
+  const Uint num_entries = nb_nodes*m_neq;
+
+  BlockIndexBuffer converted_indices(num_entries), column_order(num_entries);
+  convert_block_indices(nb_nodes, indices, converted_indices, column_order);
+
+  for(Uint row = 0; row != num_entries; ++row)
+  {
+    int* row_positions = positions + row*num_entries;
+    const int matrix_row = converted_indices[row];
+    if(matrix_row >= m_num_my_elements)
+    {
+      std::fill(row_positions, row_positions + num_entries, -1);
+      continue;
+    }
+    checked_block_row_positions(matrix_row, num_entries, converted_indices, column_order, row_positions);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::add_values_at(const Uint nb_values, const Real* values, const int* positions)
+{
+  cf3_assert(m_is_created);
+  for(Uint i = 0; i != nb_values; ++i)
+  {
+    if(positions[i] >= 0)
+      m_values[positions[i]] += values[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::clone_to(Matrix &other)
+{
+  if(!m_is_created)
+    throw common::SetupError(FromHere(), "Matrix to clone " + uri().string() + " is not created");
+
+  NativeCrsMatrix* other_ptr = dynamic_cast<NativeCrsMatrix*>(&other);
+  if(is_null(other_ptr))
+    throw common::SetupError(FromHere(), "clone_to method of NativeCrsMatrix needs another NativeCrsMatrix, but a " + other.derived_type_name() + " was supplied instead.");
+
+  other_ptr->m_is_created = m_is_created;
+  other_ptr->m_neq = m_neq;
+  other_ptr->m_num_my_elements = m_num_my_elements;
+  other_ptr->m_p2m = m_p2m;
+  other_ptr->m_row_offsets = m_row_offsets;
+  other_ptr->m_columns = m_columns;
+  other_ptr->m_values = m_values;
+  other_ptr->m_diagonal_positions = m_diagonal_positions;
+  other_ptr->m_ghost_offsets = m_ghost_offsets;
+  other_ptr->m_ghost_rows = m_ghost_rows;
+  other_ptr->m_thread_rows.clear();
+  other_ptr->m_node_connectivity = m_node_connectivity;
+  other_ptr->m_starting_indices = m_starting_indices;
+  other_ptr->m_symmetric_dirichlet_values = m_symmetric_dirichlet_values;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::read_native(const common::URI& file)
+{
+  throw common::NotImplemented(FromHere(), "read_native is not implemented for NativeCrsMatrix");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::print(common::LogStream& stream)
+{
+  if (m_is_created)
+  {
+    const int nb_elems = m_p2m.size();
+    std::vector<int> m2p(nb_elems);
+    for (int i = 0; i != nb_elems; ++i)
+      m2p[m_p2m[i]]=i;
+
+    for(int row = 0; row != m_num_my_elements; ++row)
+    {
+      const Uint row_end = m_row_offsets[row+1];
+      for(Uint i = m_row_offsets[row]; i != row_end; ++i)
+        stream << row << " " << -m2p[m_columns[i]] << " " << m_values[i] << CFendl;
+    }
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_num_my_elements << "\n";
+    stream << "# number of cols:       " << m_p2m.size() << "\n";
+    stream << "# number of block rows: " << m_num_my_elements/neq() << "\n";
+    stream << "# number of block cols: " << m_p2m.size()/neq() << "\n";
+    stream << "# number of entries:    " << m_values.size() << "\n";
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::print(std::ostream& stream)
+{
+  if (m_is_created)
+  {
+    const int nb_elems = m_p2m.size();
+    std::vector<int> m2p(nb_elems);
+    for (int i = 0; i != nb_elems; ++i)
+      m2p[m_p2m[i]]=i;
+
+    for(int row = 0; row != m_num_my_elements; ++row)
+    {
+      const Uint row_end = m_row_offsets[row+1];
+      for(Uint i = m_row_offsets[row]; i != row_end; ++i)
+        stream << m2p[m_columns[i]] << " " << -m2p[row] << " " << m_values[i] << "\n";
+    }
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_num_my_elements << "\n";
+    stream << "# number of cols:       " << m_p2m.size() << "\n";
+    stream << "# number of block rows: " << m_num_my_elements/neq() << "\n";
+    stream << "# number of block cols: " << m_p2m.size()/neq() << "\n";
+    stream << "# number of entries:    " << m_values.size() << "\n" << std::flush;
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::print(const std::string& filename, std::ios_base::openmode mode )
+{
+  std::ofstream stream(filename.c_str(),mode);
+  stream << "VARIABLES=COL,ROW,VAL\n" << std::flush;
+  stream << "ZONE T=\"" << type_name() << "::" << name() <<  "\"\n" << std::flush;
+  print(stream);
+  stream.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::print_native(std::ostream& stream)
+{
+  for(int row = 0; row != m_num_my_elements; ++row)
+  {
+    stream << row << ":";
+    const Uint row_end = m_row_offsets[row+1];
+    for(Uint i = m_row_offsets[row]; i != row_end; ++i)
+      stream << " (" << m_columns[i] << ", " << m_values[i] << ")";
+    stream << "\n";
+  }
+  stream << std::flush;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values)
+{
+  row_indices.clear(); col_indices.clear(); values.clear();
+  const Uint nnz = m_values.size();
+  row_indices.reserve(nnz); col_indices.reserve(nnz); values.reserve(nnz);
+
+  const int nb_elems = m_p2m.size();
+  std::vector<int> m2p(nb_elems);
+  for (int i = 0; i != nb_elems; ++i)
+    m2p[m_p2m[i]]=i;
+
+  for(int row = 0; row != m_num_my_elements; ++row)
+  {
+    const Uint row_end = m_row_offsets[row+1];
+    for(Uint i = m_row_offsets[row]; i != row_end; ++i)
+    {
+      row_indices.push_back(m2p[row]);
+      col_indices.push_back(m2p[m_columns[i]]);
+      values.push_back(m_values[i]);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::multiply_owned(const Uint begin, const Uint end, Real* y, const Real* x, const Real alpha, const Real beta) const
+{
+  const Uint* columns = m_columns.empty() ? 0 : &m_columns[0];
+  const Real* values = m_values.empty() ? 0 : &m_values[0];
+  for(Uint row = begin; row != end; ++row)
+  {
+    Real sum = 0.;
+    const Uint row_end = m_ghost_offsets[row];
+    for(Uint i = m_row_offsets[row]; i != row_end; ++i)
+      sum += values[i] * x[columns[i]];
+    // beta == 0 must ignore the old values, which may be uninitialized
+    y[row] = beta == 0. ? alpha*sum : alpha*sum + beta*y[row];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeCrsMatrix::apply ( const Handle< Vector >& y, const cf3::Handle< const Vector >& x, const Real alpha, const Real beta )
+{
+  cf3_assert(m_is_created);
+  Handle<NativeVector> y_native(y);
+  Handle<NativeVector const> x_native(x);
+
+  if(is_null(y_native) || is_null(x_native))
+    throw common::SetupError(FromHere(), "NativeCrsMatrix::apply must be given NativeVector arguments");
+
+  cf3_assert(x_native->nb_owned() == static_cast<Uint>(m_num_my_elements));
+  cf3_assert(y_native->nb_owned() == static_cast<Uint>(m_num_my_elements));
+
+  const Real* x_data = x_native->data().empty() ? 0 : &x_native->data()[0];
+  Real* y_data = y_native->data().empty() ? 0 : &y_native->data()[0];
+
+  // Split the rows over the threads, so each thread gets about the same number of entries, but at least m_min_thread_entries
+  const Uint nb_entries = m_values.size();
+  const Uint max_threads = std::min(nb_entries / std::max(1u, m_min_thread_entries), static_cast<Uint>(m_num_my_elements));
+  const Uint nb_threads = std::max(1u, std::min(m_nb_threads, max_threads));
+  if(m_thread_rows.size() != nb_threads+1)
+  {
+    m_thread_rows.resize(nb_threads+1);
+    for(Uint i = 0; i != nb_threads; ++i)
+      m_thread_rows[i] = std::lower_bound(m_row_offsets.begin(), m_row_offsets.end()-1, (nb_entries * i) / nb_threads) - m_row_offsets.begin();
+    m_thread_rows[nb_threads] = m_num_my_elements;
+  }
+
+  // The owned columns are multiplied while the ghosts of x are exchanged
+  x_native->start_sync();
+  if(nb_threads == 1)
+  {
+    multiply_owned(0, m_num_my_elements, y_data, x_data, alpha, beta);
+  }
+  else
+  {
+    boost::thread_group threads;
+    for(Uint i = 1; i < nb_threads; ++i)
+      threads.create_thread(boost::bind(&NativeCrsMatrix::multiply_owned, this, m_thread_rows[i], m_thread_rows[i+1], y_data, x_data, alpha, beta));
+    multiply_owned(m_thread_rows[0], m_thread_rows[1], y_data, x_data, alpha, beta);
+    threads.join_all();
+  }
+  x_native->finish_sync();
+
+  // Contribution of the ghost columns
+  const Uint* columns = m_columns.empty() ? 0 : &m_columns[0];
+  const Real* values = m_values.empty() ? 0 : &m_values[0];
+  BOOST_FOREACH(const Uint row, m_ghost_rows)
+  {
+    Real sum = 0.;
+    const Uint row_end = m_row_offsets[row+1];
+    for(Uint i = m_ghost_offsets[row]; i != row_end; ++i)
+      sum += values[i] * x_data[columns[i]];
+    y_data[row] += alpha*sum;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
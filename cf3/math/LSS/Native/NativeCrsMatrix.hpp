@@ -0,0 +1,281 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_NativeCrsMatrix_hpp
+#define cf3_Math_LSS_NativeCrsMatrix_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+
+#include "math/LSS/LibLSS.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/Matrix.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file NativeCrsMatrix.hpp Definition of the LSS::Matrix interface using compressed row storage, without external dependencies
+
+  Only the rows owned by this rank are stored. The columns of each row are sorted in matrix local numbering, in which the
+  ghosts come after the owned values, so the entries that refer to ghosts are found at the end of each row. This lets
+  the matrix-vector product compute the owned part while the ghosts are being exchanged.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+class NativeVector;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class LSS_API NativeCrsMatrix : public LSS::Matrix {
+public:
+
+  /// @name CREATION, DESTRUCTION AND COMPONENT SYSTEM
+  //@{
+
+  /// name of the type
+  static std::string type_name () { return "NativeCrsMatrix"; }
+
+  /// Accessor to solver type
+  const std::string solvertype() { return "Native"; }
+
+  /// Accessor to the flag if matrix, solution and rhs are tied together or not
+  const bool is_swappable(const LSS::Vector& solution, const LSS::Vector& rhs) { return true; }
+
+  /// Default constructor
+  NativeCrsMatrix(const std::string& name);
+
+  /// Setup sparsity structure
+  void create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs, const std::vector<Uint>& periodic_links_nodes = std::vector<Uint>(), const std::vector<bool>& periodic_links_active = std::vector<bool>());
+  void create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector< Uint >& node_connectivity, const std::vector< Uint >& starting_indices, Vector& solution, Vector& rhs, const std::vector<Uint>& periodic_links_nodes = std::vector<Uint>(), const std::vector<bool>& periodic_links_active = std::vector<bool>());
+
+  /// Deallocate underlying data
+  void destroy();
+
+  //@} END CREATION, DESTRUCTION AND COMPONENT SYSTEM
+
+  /// @name INDIVIDUAL ACCESS
+  //@{
+
+  /// Set value at given location in the matrix
+  void set_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Add value at given location in the matrix
+  void add_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Get value at given location in the matrix
+  void get_value(const Uint icol, const Uint irow, Real& value);
+
+  //@} END INDIVIDUAL ACCESS
+
+  /// @name EFFICCIENT ACCESS
+  //@{
+
+  /// Set a list of values
+  void set_values(const BlockAccumulator& values);
+
+  /// Set a block of values, without copying them
+  void set_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
+  /// Add a list of values
+  void add_values(const BlockAccumulator& values);
+
+  /// Add a block of values, without copying them
+  void add_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
+  /// Get a list of values
+  void get_values(BlockAccumulator& values);
+
+  /// Set a row, diagonal and off-diagonals values separately (dirichlet-type boundaries)
+  void set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval);
+
+  /// Not supported, use symmetric_dirichlet instead
+  void get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values);
+
+  /// Apply a dirichlet condition, moving the column to the RHS. The column values are cached until the next reset,
+  /// so the condition can be applied again to a new RHS.
+  void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, Vector& rhs);
+
+  /// Add one line to another and tie to it via dirichlet-style (applying periodicity)
+  void tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from);
+
+  /// Set the diagonal
+  void set_diagonal(const std::vector<Real>& diag);
+
+  /// Add to the diagonal
+  void add_diagonal(const std::vector<Real>& diag);
+
+  /// Get the diagonal
+  void get_diagonal(std::vector<Real>& diag);
+
+  /// Reset Matrix
+  void reset(Real reset_to=0.);
+
+  //@} END EFFICCIENT ACCESS
+
+  /// @name REUSE OF ASSEMBLED VALUES
+  //@{
+
+  /// Positions are offsets in the value array
+  bool value_positions(const Uint nb_nodes, const Uint* indices, int* positions);
+
+  /// Add values directly into the value array
+  void add_values_at(const Uint nb_values, const Real* values, const int* positions);
+
+  //@} END REUSE OF ASSEMBLED VALUES
+
+  /// @name MISCELLANEOUS
+  //@{
+
+  /// Print to wherever
+  void print(common::LogStream& stream);
+
+  /// Print to wherever
+  void print(std::ostream& stream);
+
+  /// Print to file given by filename
+  void print(const std::string& filename, std::ios_base::openmode mode = std::ios_base::out );
+
+  /// Print the rows in storage order, using matrix local column indices
+  void print_native(std::ostream& stream);
+
+  /// Accessor to the state of create
+  const bool is_created() { return m_is_created; }
+
+  /// Accessor to the number of equations
+  const Uint neq() { cf3_assert(m_is_created); return m_neq; }
+
+  /// Accessor to the number of block rows
+  const Uint blockrow_size() {  cf3_assert(m_is_created); return m_num_my_elements/neq(); }
+
+  /// Accessor to the number of block columns
+  const Uint blockcol_size() {  cf3_assert(m_is_created); return m_p2m.size()/neq(); }
+
+  /// Make a deep copy of the current matrix into other
+  void clone_to(Matrix &other);
+
+  /// Not supported, there is no native file format for this matrix
+  void read_native(const common::URI& file);
+
+  //@} END MISCELLANEOUS
+
+  /// @name LINEAR ALGEBRA
+  //@{
+
+  /// Compute y = alpha*A*x + beta*y. The ghosts of x are updated, and the owned rows are computed while the ghosts are
+  /// exchanged. The ghosts of y are left untouched.
+  void apply(const Handle<Vector>& y, const Handle<Vector const>& x, const Real alpha = 1., const Real beta = 0.);
+
+  //@} END LINEAR ALGEBRA
+
+  /// @name NATIVE ACCESS
+  //@{
+
+  /// Number of rows stored on this rank
+  Uint nb_rows() const { return m_num_my_elements; }
+
+  /// Start of each row in columns() and values(), with one extra entry for the end
+  const std::vector<Uint>& row_offsets() const { return m_row_offsets; }
+
+  /// Sorted matrix local column index of each entry
+  const std::vector<Uint>& columns() const { return m_columns; }
+
+  /// Value of each entry
+  const std::vector<Real>& values() const { return m_values; }
+
+  /// Position of the diagonal entry of each row
+  const std::vector<Uint>& diagonal_positions() const { return m_diagonal_positions; }
+
+  /// Position of the first entry of each row that refers to a ghost, or the end of the row if there are none
+  const std::vector<Uint>& ghost_offsets() const { return m_ghost_offsets; }
+
+  //@} END NATIVE ACCESS
+
+  /// @name TEST ONLY
+  //@{
+
+  /// exports the matrix into big linear arrays
+  /// @attention only for debug and utest purposes
+  void debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values);
+
+  //@} END TEST ONLY
+
+private:
+
+  /// Position of the entry at the given matrix local row and column, or -1 if it is not in the sparsity pattern
+  int entry_position(const int row, const int col) const;
+
+  /// Position of the entry at the given matrix local row and column, throwing if it is not in the sparsity pattern
+  Uint checked_entry_position(const int row, const int col) const;
+
+  /// Convert the indices of the nb_nodes block nodes to matrix local indices, and sort the block entries by matrix column into column_order
+  void convert_block_indices(const Uint nb_nodes, const Uint* indices, BlockIndexBuffer& converted_indices, BlockIndexBuffer& column_order) const;
+
+  /// Positions of the num_entries block columns in the given matrix local row, or -1 for columns that are not in the sparsity pattern
+  void block_row_positions(const int row, const Uint num_entries, const BlockIndexBuffer& converted_indices, const BlockIndexBuffer& column_order, int* positions) const;
+
+  /// Positions of the num_entries block columns in the given matrix local row, throwing if a column is not in the sparsity pattern
+  void checked_block_row_positions(const int row, const Uint num_entries, const BlockIndexBuffer& converted_indices, const BlockIndexBuffer& column_order, int* positions) const;
+
+  /// Compute the given range of owned rows of y = alpha*A*x + beta*y, using only the owned columns
+  void multiply_owned(const Uint begin, const Uint end, Real* y, const Real* x, const Real alpha, const Real beta) const;
+
+  /// Number of threads for the matrix-vector product
+  Uint m_nb_threads;
+
+  /// Minimum number of entries handled by each thread in the matrix-vector product
+  Uint m_min_thread_entries;
+
+  /// state of creation
+  bool m_is_created;
+
+  /// number of equations
+  Uint m_neq;
+
+  /// number of local elements (rows)
+  int m_num_my_elements;
+
+  /// mapper array, maps from process local numbering to matrix local numbering (because ghost nodes need to be ordered to the back)
+  std::vector<int> m_p2m;
+
+  /// Compressed row storage
+  std::vector<Uint> m_row_offsets;
+  std::vector<Uint> m_columns;
+  std::vector<Real> m_values;
+
+  /// Position of the diagonal in each row
+  std::vector<Uint> m_diagonal_positions;
+
+  /// Position of the first ghost column in each row
+  std::vector<Uint> m_ghost_offsets;
+
+  /// Rows that have entries in ghost columns
+  std::vector<Uint> m_ghost_rows;
+
+  /// First row of the range handled by each thread, balanced by the number of entries, with one extra entry for the end
+  std::vector<Uint> m_thread_rows;
+
+  /// Copy of the connectivity data
+  std::vector<Uint> m_node_connectivity, m_starting_indices;
+
+  /// Cache matrix values in case of symmetric dirichlet, so they can be applied multiple times even if the matrix is not changed
+  typedef std::map<int, Real> DirichletEntryT;
+  typedef std::map<int, DirichletEntryT> DirichletMapT;
+  DirichletMapT m_symmetric_dirichlet_values;
+}; // end of class NativeCrsMatrix
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_NativeCrsMatrix_hpp
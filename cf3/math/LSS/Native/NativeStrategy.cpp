@@ -0,0 +1,586 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include <boost/bind.hpp>
+
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/LSS/Native/NativeCrsMatrix.hpp"
+#include "math/LSS/Native/NativeStrategy.hpp"
+#include "math/LSS/Native/NativeVector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+common::ComponentBuilder<NativeStrategy, SolutionStrategy, LibLSS> NativeStrategy_builder;
+
+NativeStrategy::NativeStrategy(const std::string& name) :
+  SolutionStrategy(name),
+  m_preconditioner_ready(false)
+{
+  std::vector<boost::any> solvers;
+  solvers.push_back(std::string("GMRES"));
+  solvers.push_back(std::string("BiCGStab"));
+  solvers.push_back(std::string("CG"));
+  options().add("solver", std::string("GMRES"))
+    .pretty_name("Solver")
+    .description("Krylov solver: GMRES (restarted), BiCGStab or CG. CG requires a symmetric positive definite matrix.")
+    .mark_basic()
+    .restricted_list() = solvers;
+
+  std::vector<boost::any> preconditioners;
+  preconditioners.push_back(std::string("ILU0"));
+  preconditioners.push_back(std::string("Jacobi"));
+  preconditioners.push_back(std::string("None"));
+  options().add("preconditioner", std::string("ILU0"))
+    .pretty_name("Preconditioner")
+    .description("Preconditioner, applied to the rows owned by each rank: ILU0 (incomplete LU without fill-in), Jacobi or None")
+    .mark_basic()
+    .attach_trigger(boost::bind(&NativeStrategy::reset_preconditioner, this))
+    .restricted_list() = preconditioners;
+
+  options().add("tolerance", 1e-8)
+    .pretty_name("Tolerance")
+    .description("Convergence criterion on the norm of the residual, relative to the norm of the right hand side")
+    .mark_basic();
+
+  options().add("max_iterations", 1000u)
+    .pretty_name("Maximum Iterations")
+    .description("Maximum number of iterations")
+    .mark_basic();
+
+  options().add("gmres_restart", 30u)
+    .pretty_name("GMRES Restart")
+    .description("Number of GMRES iterations after which the method is restarted");
+
+  options().add("compute_residual", false)
+    .pretty_name("Compute Residual")
+    .description("Print the norm of the residual after each solve, which costs an extra matrix application");
+
+  properties().add("iterations", 0u);
+  properties().add("relative_residual", 0.);
+}
+
+NativeStrategy::~NativeStrategy()
+{
+}
+
+void NativeStrategy::set_matrix(const Handle< Matrix >& matrix)
+{
+  // Other matrix types are accepted here, so a system can be created with them, but solving will fail
+  m_lss_matrix = matrix;
+  m_matrix = Handle<NativeCrsMatrix>(matrix);
+  reset_preconditioner();
+}
+
+void NativeStrategy::set_rhs(const Handle< Vector >& rhs)
+{
+  m_rhs = Handle<NativeVector>(rhs);
+}
+
+void NativeStrategy::set_solution(const Handle< Vector >& solution)
+{
+  m_solution = Handle<NativeVector>(solution);
+
+  // The work vectors are clones of the solution, so they depend on its structure
+  for(Uint i = 0; i != m_work.size(); ++i)
+  {
+    if(is_not_null(m_work[i]))
+      remove_component(*m_work[i]);
+  }
+  m_work.clear();
+}
+
+void NativeStrategy::set_coordinates(common::PE::CommPattern& cp, const common::Table< Real >& coords, const common::List< Uint >& used_nodes, const std::vector< bool >& periodic_links_active)
+{
+}
+
+void NativeStrategy::reset_preconditioner()
+{
+  m_preconditioner_ready = false;
+}
+
+NativeVector& NativeStrategy::work_vector(const Uint i)
+{
+  if(m_work.size() <= i)
+    m_work.resize(i+1);
+  if(is_null(m_work[i]))
+  {
+    m_work[i] = create_component<NativeVector>("Work" + common::to_str(i));
+    m_solution->clone_to(*m_work[i]);
+  }
+  return *m_work[i];
+}
+
+void NativeStrategy::global_sum(Real* values, const Uint nb_values) const
+{
+  common::PE::Comm& comm = common::PE::Comm::instance();
+  if(!comm.is_active() || comm.size() == 1)
+    return;
+
+  std::vector<Real> local_values(values, values + nb_values);
+  comm.all_reduce(common::PE::plus(), &local_values[0], nb_values, values);
+}
+
+Real NativeStrategy::dot(const NativeVector& a, const NativeVector& b) const
+{
+  const Uint nb_owned = a.nb_owned();
+  const Real* a_data = &a.data()[0];
+  const Real* b_data = &b.data()[0];
+  Real result = 0.;
+  for(Uint i = 0; i != nb_owned; ++i)
+    result += a_data[i]*b_data[i];
+  global_sum(&result, 1);
+  return result;
+}
+
+Real NativeStrategy::residual(NativeVector& r)
+{
+  r.assign(*m_rhs);
+  m_matrix->apply(r.handle<Vector>(), m_solution->handle<Vector const>(), -1., 1.);
+  return std::sqrt(dot(r, r));
+}
+
+void NativeStrategy::setup_preconditioner()
+{
+  const std::string preconditioner = options().value<std::string>("preconditioner");
+  const Uint nb_rows = m_matrix->nb_rows();
+  const std::vector<Uint>& row_offsets = m_matrix->row_offsets();
+  const std::vector<Uint>& columns = m_matrix->columns();
+  const std::vector<Uint>& diagonal_positions = m_matrix->diagonal_positions();
+  const std::vector<Uint>& ghost_offsets = m_matrix->ghost_offsets();
+
+  if(preconditioner == "Jacobi")
+  {
+    const std::vector<Real>& values = m_matrix->values();
+    m_inverse_diagonal.resize(nb_rows);
+    for(Uint row = 0; row != nb_rows; ++row)
+    {
+      const Real diagonal = values[diagonal_positions[row]];
+      m_inverse_diagonal[row] = diagonal == 0. ? 1. : 1./diagonal;
+    }
+  }
+  else if(preconditioner == "ILU0")
+  {
+    // Row-wise incomplete LU factorization restricted to the owned columns, with zero pivots replaced by one
+    m_ilu_values = m_matrix->values();
+    std::vector<int> row_positions(nb_rows, -1);
+    for(Uint row = 0; row != nb_rows; ++row)
+    {
+      const Uint row_begin = row_offsets[row];
+      const Uint row_diagonal = diagonal_positions[row];
+      const Uint row_end = ghost_offsets[row];
+      for(Uint p = row_begin; p != row_end; ++p)
+        row_positions[columns[p]] = p;
+
+      for(Uint p = row_begin; p != row_diagonal; ++p)
+      {
+        const Uint k = columns[p];
+        m_ilu_values[p] /= m_ilu_values[diagonal_positions[k]];
+        const Real multiplier = m_ilu_values[p];
+        const Uint k_end = ghost_offsets[k];
+        for(Uint q = diagonal_positions[k]+1; q != k_end; ++q)
+        {
+          const int position = row_positions[columns[q]];
+          if(position >= 0)
+            m_ilu_values[position] -= multiplier*m_ilu_values[q];
+        }
+      }
+
+      if(m_ilu_values[row_diagonal] == 0.)
+        m_ilu_values[row_diagonal] = 1.;
+
+      for(Uint p = row_begin; p != row_end; ++p)
+        row_positions[columns[p]] = -1;
+    }
+  }
+
+  m_preconditioner_ready = true;
+}
+
+void NativeStrategy::precondition(const NativeVector& in, NativeVector& out) const
+{
+  const std::string preconditioner = options().value<std::string>("preconditioner");
+  const Uint nb_rows = in.nb_owned();
+  const Real* in_data = &in.data()[0];
+  Real* out_data = &out.data()[0];
+
+  if(preconditioner == "Jacobi")
+  {
+    for(Uint row = 0; row != nb_rows; ++row)
+      out_data[row] = m_inverse_diagonal[row]*in_data[row];
+  }
+  else if(preconditioner == "ILU0")
+  {
+    const std::vector<Uint>& row_offsets = m_matrix->row_offsets();
+    const std::vector<Uint>& columns = m_matrix->columns();
+    const std::vector<Uint>& diagonal_positions = m_matrix->diagonal_positions();
+    const std::vector<Uint>& ghost_offsets = m_matrix->ghost_offsets();
+
+    // Forward substitution with the unit lower triangle
+    for(Uint row = 0; row != nb_rows; ++row)
+    {
+      Real sum = in_data[row];
+      const Uint row_diagonal = diagonal_positions[row];
+      for(Uint p = row_offsets[row]; p != row_diagonal; ++p)
+        sum -= m_ilu_values[p]*out_data[columns[p]];
+      out_data[row] = sum;
+    }
+
+    // Backward substitution with the upper triangle
+    for(Uint row = nb_rows; row != 0; --row)
+    {
+      const Uint i = row-1;
+      Real sum = out_data[i];
+      const Uint row_diagonal = diagonal_positions[i];
+      const Uint row_end = ghost_offsets[i];
+      for(Uint p = row_diagonal+1; p != row_end; ++p)
+        sum -= m_ilu_values[p]*out_data[columns[p]];
+      out_data[i] = sum / m_ilu_values[row_diagonal];
+    }
+  }
+  else
+  {
+    std::copy(in_data, in_data + nb_rows, out_data);
+  }
+}
+
+Real NativeStrategy::compute_residual()
+{
+  if(is_null(m_matrix))
+    throw common::SetupError(FromHere(), "No NativeCrsMatrix for " + uri().path());
+  if(is_null(m_rhs))
+    throw common::SetupError(FromHere(), "No NativeVector RHS for " + uri().path());
+  if(is_null(m_solution))
+    throw common::SetupError(FromHere(), "No NativeVector solution for " + uri().path());
+
+  return residual(work_vector(0));
+}
+
+void NativeStrategy::solve()
+{
+  if(is_null(m_matrix))
+    throw common::SetupError(FromHere(), "No NativeCrsMatrix for " + uri().path());
+  if(is_null(m_rhs))
+    throw common::SetupError(FromHere(), "No NativeVector RHS for " + uri().path());
+  if(is_null(m_solution))
+    throw common::SetupError(FromHere(), "No NativeVector solution for " + uri().path());
+
+  // The preconditioner of the previous solve remains valid for a frozen matrix
+  if(!m_preconditioner_ready || !m_lss_matrix->is_frozen())
+    setup_preconditioner();
+
+  const Real tolerance = options().value<Real>("tolerance");
+  const std::string solver = options().value<std::string>("solver");
+
+  Uint nb_iterations = 0;
+  if(solver == "CG")
+    nb_iterations = solve_cg(tolerance);
+  else if(solver == "BiCGStab")
+    nb_iterations = solve_bicgstab(tolerance);
+  else
+    nb_iterations = solve_gmres(tolerance);
+
+  // The solvers only update the owned values
+  m_solution->sync();
+
+  const Real rhs_norm = std::sqrt(dot(*m_rhs, *m_rhs));
+  const Real relative_residual = rhs_norm == 0. ? 0. : residual(work_vector(0)) / rhs_norm;
+  properties()["iterations"] = nb_iterations;
+  properties()["relative_residual"] = relative_residual;
+
+  if(relative_residual > tolerance)
+    CFwarn << solver << " did not converge in " << nb_iterations << " iterations, relative residual is " << relative_residual << CFendl;
+  else
+    CFinfo << solver << " converged in " << nb_iterations << " iterations, relative residual is " << relative_residual << CFendl;
+
+  if(options().value<bool>("compute_residual"))
+    CFinfo << "Solver residual: " << relative_residual*rhs_norm << CFendl;
+}
+
+Uint NativeStrategy::solve_cg(const Real tolerance)
+{
+  const Uint max_iterations = options().value<Uint>("max_iterations");
+  NativeVector& r = work_vector(0);
+  NativeVector& z = work_vector(1);
+  NativeVector& p = work_vector(2);
+  NativeVector& q = work_vector(3);
+  std::vector<Real>& x_data = m_solution->data();
+  std::vector<Real>& r_data = r.data();
+  std::vector<Real>& z_data = z.data();
+  std::vector<Real>& p_data = p.data();
+  std::vector<Real>& q_data = q.data();
+  const Uint nb_owned = r.nb_owned();
+
+  const Real rhs_norm = std::sqrt(dot(*m_rhs, *m_rhs));
+  if(rhs_norm == 0.)
+  {
+    m_solution->reset(0.);
+    return 0;
+  }
+
+  Real r_norm = residual(r);
+  precondition(r, z);
+  p.assign(z);
+  Real rz = dot(r, z);
+
+  Uint iteration = 0;
+  while(r_norm > tolerance*rhs_norm && iteration != max_iterations)
+  {
+    m_matrix->apply(q.handle<Vector>(), p.handle<Vector const>());
+    const Real alpha = rz / dot(p, q);
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      x_data[i] += alpha*p_data[i];
+      r_data[i] -= alpha*q_data[i];
+    }
+    ++iteration;
+
+    precondition(r, z);
+    // Both reductions of the iteration are done at once
+    Real sums[2] = {0., 0.};
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      sums[0] += r_data[i]*r_data[i];
+      sums[1] += r_data[i]*z_data[i];
+    }
+    global_sum(sums, 2);
+    r_norm = std::sqrt(sums[0]);
+
+    const Real beta = sums[1] / rz;
+    rz = sums[1];
+    for(Uint i = 0; i != nb_owned; ++i)
+      p_data[i] = z_data[i] + beta*p_data[i];
+  }
+
+  return iteration;
+}
+
+Uint NativeStrategy::solve_bicgstab(const Real tolerance)
+{
+  const Uint max_iterations = options().value<Uint>("max_iterations");
+  NativeVector& r = work_vector(0);
+  NativeVector& r0 = work_vector(1);
+  NativeVector& p = work_vector(2);
+  NativeVector& v = work_vector(3);
+  NativeVector& p_hat = work_vector(4);
+  NativeVector& s_hat = work_vector(5);
+  NativeVector& t = work_vector(6);
+  std::vector<Real>& x_data = m_solution->data();
+  std::vector<Real>& r_data = r.data();
+  std::vector<Real>& p_data = p.data();
+  std::vector<Real>& v_data = v.data();
+  std::vector<Real>& p_hat_data = p_hat.data();
+  std::vector<Real>& s_hat_data = s_hat.data();
+  std::vector<Real>& t_data = t.data();
+  const Uint nb_owned = r.nb_owned();
+
+  const Real rhs_norm = std::sqrt(dot(*m_rhs, *m_rhs));
+  if(rhs_norm == 0.)
+  {
+    m_solution->reset(0.);
+    return 0;
+  }
+
+  Real r_norm = residual(r);
+  r0.assign(r);
+  v.reset(0.);
+  p.reset(0.);
+  Real rho = 1., alpha = 1., omega = 1.;
+
+  Uint iteration = 0;
+  while(r_norm > tolerance*rhs_norm && iteration != max_iterations)
+  {
+    const Real rho_new = dot(r0, r);
+    if(rho_new == 0.)
+      break;
+    const Real beta = (rho_new/rho)*(alpha/omega);
+    rho = rho_new;
+    for(Uint i = 0; i != nb_owned; ++i)
+      p_data[i] = r_data[i] + beta*(p_data[i] - omega*v_data[i]);
+
+    precondition(p, p_hat);
+    m_matrix->apply(v.handle<Vector>(), p_hat.handle<Vector const>());
+    alpha = rho / dot(r0, v);
+
+    // r becomes s
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      x_data[i] += alpha*p_hat_data[i];
+      r_data[i] -= alpha*v_data[i];
+    }
+    ++iteration;
+
+    r_norm = std::sqrt(dot(r, r));
+    if(r_norm <= tolerance*rhs_norm)
+      break;
+
+    precondition(r, s_hat);
+    m_matrix->apply(t.handle<Vector>(), s_hat.handle<Vector const>());
+
+    // Both reductions for omega are done at once
+    Real sums[2] = {0., 0.};
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      sums[0] += t_data[i]*r_data[i];
+      sums[1] += t_data[i]*t_data[i];
+    }
+    global_sum(sums, 2);
+    if(sums[1] == 0.)
+      break;
+    omega = sums[0] / sums[1];
+
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      x_data[i] += omega*s_hat_data[i];
+      r_data[i] -= omega*t_data[i];
+    }
+
+    r_norm = std::sqrt(dot(r, r));
+    if(omega == 0.)
+      break;
+  }
+
+  return iteration;
+}
+
+Uint NativeStrategy::solve_gmres(const Real tolerance)
+{
+  const Uint max_iterations = options().value<Uint>("max_iterations");
+  const Uint restart = std::max(1u, options().value<Uint>("gmres_restart"));
+  std::vector<Real>& x_data = m_solution->data();
+
+  // Work vectors 0 and 1 are temporaries, the Krylov basis starts at 2
+  NativeVector& z = work_vector(0);
+  NativeVector& u = work_vector(1);
+  std::vector<Real>& z_data = z.data();
+  std::vector<Real>& u_data = u.data();
+  std::vector<NativeVector*> basis(restart+1);
+  for(Uint i = 0; i != restart+1; ++i)
+    basis[i] = &work_vector(i+2);
+  const Uint nb_owned = z.nb_owned();
+
+  const Real rhs_norm = std::sqrt(dot(*m_rhs, *m_rhs));
+  if(rhs_norm == 0.)
+  {
+    m_solution->reset(0.);
+    return 0;
+  }
+
+  // Hessenberg matrix, stored by column, and the Givens rotations that make it upper triangular
+  std::vector<Real> hessenberg((restart+1)*restart, 0.);
+  std::vector<Real> cosines(restart), sines(restart), g(restart+1), projections(restart+1);
+
+  Uint iteration = 0;
+  Real r_norm = residual(*basis[0]);
+  while(r_norm > tolerance*rhs_norm && iteration != max_iterations)
+  {
+    basis[0]->scale(1./r_norm);
+    std::fill(g.begin(), g.end(), 0.);
+    g[0] = r_norm;
+
+    Uint nb_vectors = 0;
+    while(nb_vectors != restart && iteration != max_iterations)
+    {
+      const Uint j = nb_vectors;
+      Real* h = &hessenberg[j*(restart+1)];
+      std::vector<Real>& w_data = basis[j+1]->data();
+
+      // Right preconditioning
+      precondition(*basis[j], z);
+      m_matrix->apply(basis[j+1]->handle<Vector>(), z.handle<Vector const>());
+
+      // Classical Gram-Schmidt with one reorthogonalization, which needs one reduction per pass
+      std::fill(h, h + j+2, 0.);
+      for(Uint pass = 0; pass != 2; ++pass)
+      {
+        std::fill(projections.begin(), projections.begin() + j+1, 0.);
+        for(Uint k = 0; k <= j; ++k)
+        {
+          const std::vector<Real>& v_data = basis[k]->data();
+          Real sum = 0.;
+          for(Uint i = 0; i != nb_owned; ++i)
+            sum += v_data[i]*w_data[i];
+          projections[k] = sum;
+        }
+        global_sum(&projections[0], j+1);
+        for(Uint k = 0; k <= j; ++k)
+        {
+          const std::vector<Real>& v_data = basis[k]->data();
+          const Real projection = projections[k];
+          for(Uint i = 0; i != nb_owned; ++i)
+            w_data[i] -= projection*v_data[i];
+          h[k] += projection;
+        }
+      }
+      h[j+1] = std::sqrt(dot(*basis[j+1], *basis[j+1]));
+      if(h[j+1] != 0.)
+        basis[j+1]->scale(1./h[j+1]);
+
+      // Apply the previous rotations to the new column, and compute the rotation that eliminates h[j+1]
+      for(Uint k = 0; k != j; ++k)
+      {
+        const Real temp = cosines[k]*h[k] + sines[k]*h[k+1];
+        h[k+1] = -sines[k]*h[k] + cosines[k]*h[k+1];
+        h[k] = temp;
+      }
+      const Real denominator = std::sqrt(h[j]*h[j] + h[j+1]*h[j+1]);
+      cosines[j] = denominator == 0. ? 1. : h[j] / denominator;
+      sines[j] = denominator == 0. ? 0. : h[j+1] / denominator;
+      h[j] = denominator;
+      h[j+1] = 0.;
+      g[j+1] = -sines[j]*g[j];
+      g[j] = cosines[j]*g[j];
+
+      ++nb_vectors;
+      ++iteration;
+      if(std::abs(g[j+1]) <= tolerance*rhs_norm || denominator == 0.)
+        break;
+    }
+
+    // Solve the triangular system for the coefficients of the update, stored in g
+    for(Uint k = nb_vectors; k != 0; --k)
+    {
+      const Uint row = k-1;
+      for(Uint col = k; col != nb_vectors; ++col)
+        g[row] -= hessenberg[col*(restart+1) + row]*g[col];
+      g[row] /= hessenberg[row*(restart+1) + row];
+    }
+
+    // x += M^-1 * (V*y)
+    u.reset(0.);
+    for(Uint k = 0; k != nb_vectors; ++k)
+    {
+      const std::vector<Real>& v_data = basis[k]->data();
+      for(Uint i = 0; i != nb_owned; ++i)
+        u_data[i] += g[k]*v_data[i];
+    }
+    precondition(u, z);
+    for(Uint i = 0; i != nb_owned; ++i)
+      x_data[i] += z_data[i];
+
+    // The estimate from the rotations is not used, to avoid stopping on round-off errors
+    r_norm = residual(*basis[0]);
+  }
+
+  return iteration;
+}
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
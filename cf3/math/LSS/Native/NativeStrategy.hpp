@@ -0,0 +1,109 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_NativeStrategy_hpp
+#define cf3_Math_LSS_NativeStrategy_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "math/LSS/SolutionStrategy.hpp"
+#include "math/LSS/LibLSS.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ *  @file NativeStrategy.hpp Krylov solvers for the native matrix and vectors
+ **/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+class NativeCrsMatrix;
+class NativeVector;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Solves a system built with NativeCrsMatrix, using CG, BiCGStab or restarted GMRES. The preconditioner is
+/// either Jacobi or ILU(0) on the rows owned by each rank, i.e. a block Jacobi preconditioner across the ranks.
+/// It is rebuilt for every solve, unless the matrix is frozen.
+class LSS_API NativeStrategy : public SolutionStrategy
+{
+public:
+
+  /// Default constructor
+  NativeStrategy(const std::string& name);
+
+  ~NativeStrategy();
+
+  /// name of the type
+  static std::string type_name () { return "NativeStrategy"; }
+
+  void set_matrix(const Handle<LSS::Matrix>& matrix);
+  void set_rhs(const Handle<LSS::Vector>& rhs);
+  void set_solution(const Handle<LSS::Vector>& solution);
+  void solve();
+
+  /// Norm of b - A*x
+  Real compute_residual();
+
+  /// Coordinates are not used
+  virtual void set_coordinates(common::PE::CommPattern& cp, const common::Table< Real >& coords, const common::List< Uint >& used_nodes, const std::vector< bool >& periodic_links_active);
+
+private:
+  /// Krylov solvers, returning the number of iterations
+  Uint solve_cg(const Real tolerance);
+  Uint solve_bicgstab(const Real tolerance);
+  Uint solve_gmres(const Real tolerance);
+
+  /// Build the preconditioner for the current matrix values
+  void setup_preconditioner();
+
+  /// Force a rebuild of the preconditioner on the next solve
+  void reset_preconditioner();
+
+  /// Apply the preconditioner to the owned values of in, storing the result in out
+  void precondition(const NativeVector& in, NativeVector& out) const;
+
+  /// Dot product of the owned values
+  Real dot(const NativeVector& a, const NativeVector& b) const;
+
+  /// Sum the given local values over all ranks, in place
+  void global_sum(Real* values, const Uint nb_values) const;
+
+  /// Work vector with the given index, created as a clone of the solution when needed
+  NativeVector& work_vector(const Uint i);
+
+  /// Store r = b - A*x and return its norm
+  Real residual(NativeVector& r);
+
+  Handle<LSS::Matrix> m_lss_matrix;
+  Handle<NativeCrsMatrix> m_matrix;
+  Handle<NativeVector> m_rhs;
+  Handle<NativeVector> m_solution;
+
+  /// Work vectors, as components that share the comm pattern of the solution
+  std::vector< Handle<NativeVector> > m_work;
+
+  /// Inverse of the diagonal, for Jacobi
+  std::vector<Real> m_inverse_diagonal;
+
+  /// ILU(0) factors, stored in the sparsity pattern of the matrix. Only the entries in owned columns are used.
+  std::vector<Real> m_ilu_values;
+
+  /// True if the preconditioner was built for the current matrix
+  bool m_preconditioner_ready;
+}; // end of class NativeStrategy
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_NativeStrategy_hpp
@@ -0,0 +1,471 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+
+#include "common/Assertions.hpp"
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+#include "math/LSS/Distribution.hpp"
+#include "math/LSS/Native/NativeVector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file NativeVector.cpp Implementation of the LSS::Vector interface without external dependencies
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+common::ComponentBuilder < LSS::NativeVector, LSS::Vector, LSS::LibLSS > NativeVector_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+NativeVector::NativeVector(const std::string& name) :
+  LSS::Vector(name),
+  m_neq(0),
+  m_blockrow_size(0),
+  m_num_my_elements(0),
+  m_is_created(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+NativeVector::~NativeVector()
+{
+  destroy();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::create(common::PE::CommPattern& cp, Uint neq, const std::vector<Uint>& periodic_links_nodes, const std::vector<bool>& periodic_links_active)
+{
+  boost::shared_ptr<VariablesDescriptor> single_var_descriptor = common::allocate_component<VariablesDescriptor>("SingleVariableDescriptor");
+  single_var_descriptor->options().set(common::Tags::dimension(), neq);
+  single_var_descriptor->push_back("LSSvars", VariablesDescriptor::Dimensionalities::VECTOR);
+  create_blocked(cp, *single_var_descriptor, periodic_links_nodes, periodic_links_active);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector<Uint>& periodic_links_nodes, const std::vector<bool>& periodic_links_active)
+{
+  // if built
+  if (m_is_created) destroy();
+
+  int num_my_elements = 0;
+  std::vector<int> my_global_elements;
+  std::vector<Uint> my_ranks;
+  create_map_data(cp, vars, m_p2m, my_global_elements, my_ranks, num_my_elements, periodic_links_nodes, periodic_links_active);
+
+  m_data.assign(my_global_elements.size(), 0.);
+
+  std::vector<Uint> gids(my_global_elements.begin(), my_global_elements.end()); // need Uint data for GIDs
+
+  m_comm_pattern = common::allocate_component<common::PE::CommPattern>("CommPattern");
+  m_comm_pattern->insert("gid",gids,1,false);
+  m_comm_pattern->setup(Handle<common::PE::CommWrapper>(m_comm_pattern->get_child("gid")),my_ranks);
+  m_comm_pattern->insert(name(), m_data, true);
+
+  m_neq=vars.size();
+  m_blockrow_size=cp.isUpdatable().size();
+  m_num_my_elements=num_my_elements;
+  m_is_created=true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::destroy()
+{
+  // The comm pattern may be shared with clones, so only our own data is unregistered
+  if (is_not_null(m_comm_pattern.get()) && is_not_null(m_comm_pattern->get_child(name())))
+    m_comm_pattern->clear(name());
+  m_comm_pattern.reset();
+  m_p2m.clear();
+  m_data.clear();
+  m_neq=0;
+  m_blockrow_size=0;
+  m_num_my_elements=0;
+  m_is_created=false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set_value(const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  m_data[storage_index(irow)]=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::add_value(const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  m_data[storage_index(irow)]+=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get_value(const Uint irow, Real& value)
+{
+  cf3_assert(m_is_created);
+  value=m_data[storage_index(irow)];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set_value(const Uint iblockrow, const Uint ieq, const Real value)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(iblockrow<m_blockrow_size);
+  m_data[storage_index(iblockrow*m_neq+ieq)]=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::add_value(const Uint iblockrow, const Uint ieq, const Real value)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(iblockrow<m_blockrow_size);
+  m_data[storage_index(iblockrow*m_neq+ieq)]+=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get_value(const Uint iblockrow, const Uint ieq, Real& value)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(iblockrow<m_blockrow_size);
+  value=m_data[storage_index(iblockrow*m_neq+ieq)];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set_rhs_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  set_rhs_block_values(values.indices.size(), &values.indices[0], values.rhs.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
+{
+  cf3_assert(m_is_created);
+  const Real* vals=values;
+  for (Uint i=0; i<nb_nodes; i++)
+  {
+    cf3_assert(indices[i] < m_blockrow_size);
+    for (Uint j=0; j<m_neq; j++)
+      m_data[storage_index(indices[i]*m_neq+j)]=*vals++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::add_rhs_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  add_rhs_block_values(values.indices.size(), &values.indices[0], values.rhs.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::add_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
+{
+  cf3_assert(m_is_created);
+  const Real* vals=values;
+  for (Uint i=0; i<nb_nodes; i++)
+  {
+    cf3_assert(indices[i] < m_blockrow_size);
+    for (Uint j=0; j<m_neq; j++)
+      m_data[storage_index(indices[i]*m_neq+j)]+=*vals++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get_rhs_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  Real* vals=values.rhs.data();
+  for (Uint i=0; i<numblocks; i++)
+  {
+    cf3_assert(values.indices[i] < m_blockrow_size);
+    for (Uint j=0; j<m_neq; j++)
+      *vals++=m_data[storage_index(values.indices[i]*m_neq+j)];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set_sol_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  const Real* vals=values.sol.data();
+  for (Uint i=0; i<numblocks; i++)
+  {
+    cf3_assert(values.indices[i] < m_blockrow_size);
+    for (Uint j=0; j<m_neq; j++)
+      m_data[storage_index(values.indices[i]*m_neq+j)]=*vals++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::add_sol_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint numblocks=values.indices.size();
+  const Real* vals=values.sol.data();
+  for (Uint i=0; i<numblocks; i++)
+  {
+    cf3_assert(values.indices[i] < m_blockrow_size);
+    for (Uint j=0; j<m_neq; j++)
+      m_data[storage_index(values.indices[i]*m_neq+j)]+=*vals++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get_sol_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  get_sol_block_values(values.indices.size(), &values.indices[0], values.sol.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get_sol_block_values(const Uint nb_nodes, const Uint* indices, Real* values)
+{
+  cf3_assert(m_is_created);
+  Real* vals=values;
+  for (Uint i=0; i<nb_nodes; i++)
+  {
+    cf3_assert(indices[i] < m_blockrow_size);
+    for (Uint j=0; j<m_neq; j++)
+      *vals++=m_data[storage_index(indices[i]*m_neq+j)];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::reset(Real reset_to)
+{
+  cf3_assert(m_is_created);
+  m_data.assign(m_data.size(), reset_to);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get( boost::multi_array<Real, 2>& data)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(data.shape()[0]==m_blockrow_size);
+  cf3_assert(data.shape()[1]==m_neq);
+  for (Uint i=0; i<m_blockrow_size; i++)
+    for (Uint j=0; j<m_neq; j++)
+      data[i][j]=m_data[m_p2m[i*m_neq+j]];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set( boost::multi_array<Real, 2>& data)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(data.shape()[0]==m_blockrow_size);
+  cf3_assert(data.shape()[1]==m_neq);
+  for (Uint i=0; i<m_blockrow_size; i++)
+    for (Uint j=0; j<m_neq; j++)
+      m_data[m_p2m[i*m_neq+j]]=data[i][j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::print(common::LogStream& stream)
+{
+  if (m_is_created)
+  {
+    for (Uint i=0; i<m_blockrow_size; i++)
+      for (Uint j=0; j<m_neq; j++)
+        stream << 0 << " " << -(int)(i*m_neq+j) << " " << m_data[m_p2m[i*m_neq+j]] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_blockrow_size*m_neq << "\n";
+    stream << "# number of block rows: " << m_blockrow_size << "\n";
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::print(std::ostream& stream)
+{
+  if (m_is_created)
+  {
+    for (Uint i=0; i<m_blockrow_size; i++)
+      for (Uint j=0; j<m_neq; j++)
+        stream << 0 << " " << -(int)(i*m_neq+j) << " " << m_data[m_p2m[i*m_neq+j]] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_blockrow_size*m_neq << "\n";
+    stream << "# number of block rows: " << m_blockrow_size << "\n" << std::flush;
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::print(const std::string& filename, std::ios_base::openmode mode)
+{
+  std::ofstream stream(filename.c_str(),mode);
+  stream << "VARIABLES=COL,ROW,VAL\n" << std::flush;
+  stream << "ZONE T=\"" << type_name() << "::" << name() <<  "\"\n" << std::flush;
+  print(stream);
+  stream.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::print_native(std::ostream& stream)
+{
+  const Uint nb_values = m_data.size();
+  for (Uint i=0; i<nb_values; i++)
+    stream << i << (i < m_num_my_elements ? " " : " (ghost) ") << m_data[i] << "\n";
+  stream << std::flush;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::debug_data(std::vector<Real>& values)
+{
+  cf3_assert(m_is_created);
+  values.clear();
+  for (Uint i=0; i<m_blockrow_size; i++)
+    for (Uint j=0; j<m_neq; j++)
+      values.push_back(m_data[m_p2m[i*m_neq+j]]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::clone_to(Vector &other)
+{
+  if(!m_is_created)
+    throw common::SetupError(FromHere(), "Vector to clone " + uri().string() + " is not created");
+
+  NativeVector* other_ptr = dynamic_cast<NativeVector*>(&other);
+  if(is_null(other_ptr))
+    throw common::SetupError(FromHere(), "clone_to method of NativeVector needs another NativeVector, but a " + other.derived_type_name() + " was supplied instead.");
+
+  if(other_ptr->m_is_created)
+    other_ptr->destroy();
+
+  other_ptr->m_data = m_data;
+  other_ptr->m_neq = m_neq;
+  other_ptr->m_blockrow_size = m_blockrow_size;
+  other_ptr->m_num_my_elements = m_num_my_elements;
+  other_ptr->m_is_created = m_is_created;
+  other_ptr->m_p2m = m_p2m;
+  other_ptr->m_comm_pattern = m_comm_pattern;
+  m_comm_pattern->insert(other_ptr->name(), other_ptr->m_data, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::assign(const Vector& source)
+{
+  NativeVector const* source_ptr = dynamic_cast<NativeVector const*>(&source);
+
+  if(is_null(source_ptr))
+    throw common::SetupError(FromHere(), "assign method of NativeVector needs another NativeVector, but a " + source.derived_type_name() + " was supplied instead.");
+
+  if(source_ptr->m_data.size() != m_data.size())
+    throw common::SetupError(FromHere(), "assign method of NativeVector got a vector with incorrect size");
+
+  m_data.assign(source_ptr->m_data.begin(), source_ptr->m_data.end());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::update ( const Vector& source, const Real alpha )
+{
+  NativeVector const* source_ptr = dynamic_cast<NativeVector const*>(&source);
+
+  if(is_null(source_ptr))
+    throw common::SetupError(FromHere(), "update method of NativeVector needs another NativeVector, but a " + source.derived_type_name() + " was supplied instead.");
+
+  if(source_ptr->m_data.size() != m_data.size())
+    throw common::SetupError(FromHere(), "update method of NativeVector got a vector with incorrect size");
+
+  const Uint size = m_data.size();
+  for(Uint i = 0; i != size; ++i)
+    m_data[i] += alpha*source_ptr->m_data[i];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::scale ( const Real alpha )
+{
+  const Uint size = m_data.size();
+  if(alpha != 1.)
+  {
+    for(Uint i = 0; i != size; ++i)
+      m_data[i] *= alpha;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::sync()
+{
+  cf3_assert(m_is_created);
+  m_comm_pattern->synchronize(name());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::start_sync() const
+{
+  cf3_assert(m_is_created);
+  m_comm_pattern->start_synchronize(name());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::finish_sync() const
+{
+  cf3_assert(m_is_created);
+  m_comm_pattern->finish_synchronize(name());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::read_native(const common::URI& filename, const std::string type)
+{
+  throw common::NotImplemented(FromHere(), "read_native is not implemented for NativeVector");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
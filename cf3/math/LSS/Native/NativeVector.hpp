@@ -0,0 +1,242 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_NativeVector_hpp
+#define cf3_Math_LSS_NativeVector_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/shared_ptr.hpp>
+
+#include "common/PE/CommPattern.hpp"
+
+#include "math/LSS/LibLSS.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/Vector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file NativeVector.hpp Definition of the LSS::Vector interface without external dependencies
+
+  The values owned by this rank are stored first, followed by the ghosts. The ghosts are updated through a CommPattern
+  that is shared with all clones of the vector.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class LSS_API NativeVector : public LSS::Vector {
+public:
+
+  /// @name CREATION, DESTRUCTION AND COMPONENT SYSTEM
+  //@{
+
+  /// name of the type
+  static std::string type_name () { return "NativeVector"; }
+
+  /// Accessor to solver type
+  const std::string solvertype() { return "Native"; }
+
+  /// Default constructor
+  NativeVector(const std::string& name);
+
+  ~NativeVector();
+
+  /// Setup sparsity structure
+  void create(common::PE::CommPattern& cp, Uint neq, const std::vector<Uint>& periodic_links_nodes = std::vector<Uint>(), const std::vector<bool>& periodic_links_active = std::vector<bool>());
+
+  /// Setup sparsity structure, the equations are interleaved per node
+  void create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector<Uint>& periodic_links_nodes = std::vector<Uint>(), const std::vector<bool>& periodic_links_active = std::vector<bool>());
+
+  /// Deallocate underlying data
+  void destroy();
+
+  //@} END CREATION, DESTRUCTION AND COMPONENT SYSTEM
+
+  /// @name INDIVIDUAL ACCESS
+  //@{
+
+  /// Set value at given location in the matrix
+  void set_value(const Uint irow, const Real value);
+
+  /// Add value at given location in the matrix
+  void add_value(const Uint irow, const Real value);
+
+  /// Get value at given location in the matrix
+  void get_value(const Uint irow, Real& value);
+
+  /// Set value at given location in the matrix
+  void set_value(const Uint iblockrow, const Uint ieq, const Real value);
+
+  /// Add value at given location in the matrix
+  void add_value(const Uint iblockrow, const Uint ieq, const Real value);
+
+  /// Get value at given location in the matrix
+  void get_value(const Uint iblockrow, const Uint ieq, Real& value);
+
+  //@} END INDIVIDUAL ACCESS
+
+  /// @name EFFICCIENT ACCESS
+  //@{
+
+  /// Set a list of values to rhs
+  void set_rhs_values(const BlockAccumulator& values);
+
+  /// Set a list of values to rhs, without copying them
+  void set_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
+  /// Add a list of values to rhs
+  void add_rhs_values(const BlockAccumulator& values);
+
+  /// Add a block of values to rhs
+  void add_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
+  /// Get a list of values from rhs
+  void get_rhs_values(BlockAccumulator& values);
+
+  /// Set a list of values to sol
+  void set_sol_values(const BlockAccumulator& values);
+
+  /// Add a list of values to sol
+  void add_sol_values(const BlockAccumulator& values);
+
+  /// Get a list of values from sol
+  void get_sol_values(BlockAccumulator& values);
+
+  /// Get a block of values from sol, without copying them
+  void get_sol_block_values(const Uint nb_nodes, const Uint* indices, Real* values);
+
+  /// Reset Vector
+  void reset(Real reset_to=0.);
+
+  /// Copies the contents out of the LSS::Vector to table.
+  void get( boost::multi_array<Real, 2>& data);
+
+  /// Copies the contents of the table into the LSS::Vector.
+  void set( boost::multi_array<Real, 2>& data);
+
+  //@} END EFFICCIENT ACCESS
+
+  /// @name MISCELLANEOUS
+  //@{
+
+  /// Print to wherever
+  void print(common::LogStream& stream);
+
+  /// Print to wherever
+  void print(std::ostream& stream);
+
+  /// Print to file given by filename
+  void print(const std::string& filename, std::ios_base::openmode mode = std::ios_base::out );
+
+  /// Print the values in storage order, owned values first
+  void print_native(std::ostream& stream);
+
+  /// Accessor to the state of create
+  const bool is_created() { return m_is_created; }
+
+  /// Accessor to the number of equations
+  const Uint neq() { cf3_assert(m_is_created); return m_neq; }
+
+  /// Accessor to the number of block rows
+  const Uint blockrow_size() { cf3_assert(m_is_created); return m_blockrow_size; }
+
+  /// Make other a copy of this vector, sharing the same comm pattern
+  void clone_to(Vector& other);
+
+  /// Copy the values of source, which must have the same structure
+  void assign(const Vector& source);
+
+  /// Add alpha*source to this vector
+  void update(const Vector& source, const Real alpha = 1.);
+
+  /// Multiply all values with alpha
+  void scale(const Real alpha);
+
+  /// Update the ghost values
+  void sync();
+
+  /// Start updating the ghost values, which are only valid after finish_sync. Work on the owned values can be overlapped with the communication.
+  void start_sync() const;
+
+  /// Wait for the ghost values started by start_sync
+  void finish_sync() const;
+
+  /// Not supported, there is no native file format for this vector
+  void read_native(const common::URI& filename, const std::string type = "");
+
+  //@} END MISCELLANEOUS
+
+  /// @name NATIVE ACCESS
+  //@{
+
+  /// All values in storage order: the nb_owned() owned values first, followed by the ghosts
+  std::vector<Real>& data() { return m_data; }
+
+  /// All values in storage order: the nb_owned() owned values first, followed by the ghosts
+  const std::vector<Real>& data() const { return m_data; }
+
+  /// Number of values owned by this rank
+  Uint nb_owned() const { return m_num_my_elements; }
+
+  /// Mapping from the process local row (iblockrow*neq+ieq) to the storage index
+  const std::vector<int>& p2m() const { return m_p2m; }
+
+  //@} END NATIVE ACCESS
+
+  /// @name TEST ONLY
+  //@{
+
+  /// exports the vector into big linear array
+  /// @attention only for debug and utest purposes
+  void debug_data(std::vector<Real>& values);
+
+  //@} END TEST ONLY
+
+private:
+
+  /// Storage index for each process local row, also used to check the indices in debug mode
+  int storage_index(const Uint irow) const
+  {
+    cf3_assert(irow < m_p2m.size());
+    return m_p2m[irow];
+  }
+
+  /// Actual vector data, owned values first
+  std::vector<Real> m_data;
+
+  /// number of equations
+  Uint m_neq;
+
+  /// number of blocks
+  Uint m_blockrow_size;
+
+  /// number of values owned by this rank
+  Uint m_num_my_elements;
+
+  /// status of the vector
+  bool m_is_created;
+
+  /// mapper array, maps from process local numbering to matrix local numbering (because ghost nodes need to be ordered to the back)
+  std::vector<int> m_p2m;
+
+  /// The comm pattern is kept as shared ptr, so it can be shared between any clones of this vector.
+  boost::shared_ptr<common::PE::CommPattern> m_comm_pattern;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_NativeVector_hpp
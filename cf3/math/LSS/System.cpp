@@ -14,6 +14,7 @@
 #include "common/Builder.hpp"
 #include "common/Component.hpp"
 #include "common/OptionT.hpp"
+#include "common/ScopedTimer.hpp"
 #include "common/PE/CommPattern.hpp"
 #include "common/Signal.hpp"
 
@@ -47,10 +48,26 @@ using namespace cf3::math;
 
 common::ComponentBuilder < LSS::System, LSS::System, LSS::LibLSS > System_Builder;
 
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Without Trilinos, the native matrix and solvers are the only ones that are available
+#ifdef CF3_HAVE_TRILINOS
+  const std::string default_matrix_builder = "cf3.math.LSS.TrilinosFEVbrMatrix";
+  const std::string default_solution_strategy = "cf3.math.LSS.TrilinosStratimikosStrategy";
+#else
+  const std::string default_matrix_builder = "cf3.math.LSS.NativeCrsMatrix";
+  const std::string default_solution_strategy = "cf3.math.LSS.NativeStrategy";
+#endif
+
+}
+
 LSS::System::System(const std::string& name) :
   Component(name)
 {
-  options().add( "matrix_builder" , "cf3.math.LSS.TrilinosFEVbrMatrix")
+  options().add( "matrix_builder" , default_matrix_builder)
     .pretty_name("Matrix Builder")
     .description("Name for the builder used to create the LSS matrix")
     .mark_basic();
@@ -60,7 +77,7 @@ LSS::System::System(const std::string& name) :
     .description("Name for the builder used for the vectors. If left empty, this is obtained from the vector_type property of the matrix")
     .mark_basic();
 
-  options().add("solution_strategy", "cf3.math.LSS.TrilinosStratimikosStrategy")
+  options().add("solution_strategy", default_solution_strategy)
     .pretty_name("Solution Strategy")
     .description("Name of the builder that will be used to create the solution strategy")
     .mark_basic();
@@ -202,6 +219,7 @@ void LSS::System::destroy()
 void LSS::System::solve()
 {
   cf3_assert(is_created());
+  CF3_SCOPED_TIMER("solve");
   m_solution_strategy->solve();
 }
 
@@ -210,7 +228,8 @@ void LSS::System::solve()
 void LSS::System::set_values(const LSS::BlockAccumulator& values)
 {
   cf3_assert(is_created());
-  m_mat->set_values(values);
+  if(!m_mat->is_frozen())
+    m_mat->set_values(values);
   m_sol->set_sol_values(values);
   m_rhs->set_rhs_values(values);
 }
@@ -220,7 +239,8 @@ void LSS::System::set_values(const LSS::BlockAccumulator& values)
 void LSS::System::add_values(const LSS::BlockAccumulator& values)
 {
   cf3_assert(is_created());
-  m_mat->add_values(values);
+  if(!m_mat->is_frozen())
+    m_mat->add_values(values);
   m_sol->add_sol_values(values);
   m_rhs->add_rhs_values(values);
 }
@@ -243,11 +263,13 @@ void LSS::System::dirichlet(const Uint iblockrow, const Uint ieq, const Real val
 
   if (preserve_symmetry)
   {
+    // For a frozen matrix, TrilinosCrsMatrix only updates the RHS using the column values it cached when the matrix was assembled
     m_mat->symmetric_dirichlet(iblockrow, ieq, value, *m_rhs);
   }
   else
   {
-    m_mat->set_row(iblockrow,ieq,1.,0.);
+    if(!m_mat->is_frozen())
+      m_mat->set_row(iblockrow,ieq,1.,0.);
     m_rhs->set_value(iblockrow,ieq,value);
   }
 
@@ -264,7 +286,8 @@ void LSS::System::periodicity (const Uint iblockrow_to, const Uint iblockrow_fro
   ba.resize(2,neq);
   ba.indices[0]=iblockrow_to;
   ba.indices[1]=iblockrow_from;
-  m_mat->tie_blockrow_pairs(iblockrow_to,iblockrow_from);
+  if(!m_mat->is_frozen())
+    m_mat->tie_blockrow_pairs(iblockrow_to,iblockrow_from);
   m_rhs->get_rhs_values(ba);
   for (int i=0; i<(const int)neq; i++)
   {
@@ -286,7 +309,8 @@ void LSS::System::periodicity (const Uint iblockrow_to, const Uint iblockrow_fro
 void LSS::System::set_diagonal(const std::vector<Real>& diag)
 {
   cf3_assert(is_created());
-  m_mat->set_diagonal(diag);
+  if(!m_mat->is_frozen())
+    m_mat->set_diagonal(diag);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -294,7 +318,8 @@ void LSS::System::set_diagonal(const std::vector<Real>& diag)
 void LSS::System::add_diagonal(const std::vector<Real>& diag)
 {
   cf3_assert(is_created());
-  m_mat->add_diagonal(diag);
+  if(!m_mat->is_frozen())
+    m_mat->add_diagonal(diag);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -310,7 +335,8 @@ void LSS::System::get_diagonal(std::vector<Real>& diag)
 void LSS::System::reset(Real reset_to)
 {
   cf3_assert(is_created());
-  m_mat->reset(reset_to);
+  if(!m_mat->is_frozen())
+    m_mat->reset(reset_to);
   m_sol->reset(reset_to);
   m_rhs->reset(reset_to);
 }
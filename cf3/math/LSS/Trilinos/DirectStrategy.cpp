@@ -97,7 +97,8 @@ struct DirectStrategy::Implementation
 
   void solve()
   {
-    if(m_interval != 0 && (m_count % m_interval) == 0)
+    // Keep the factorization of a frozen matrix
+    if(m_interval != 0 && (m_count % m_interval) == 0 && !m_matrix->is_frozen())
       reset_solver();
     
     if(is_null(m_solver.get()))
@@ -6,6 +6,7 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <iostream>
 #include <set>
 
@@ -38,6 +39,7 @@
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
 #include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
 #include "math/LSS/Trilinos/TrilinosCrsMatrix.hpp"
 #include "math/LSS/Trilinos/TrilinosDetail.hpp"
 #include "math/LSS/Trilinos/TrilinosVector.hpp"
@@ -69,7 +71,6 @@ TrilinosCrsMatrix::TrilinosCrsMatrix(const std::string& name) :
   m_neq(0),
   m_num_my_elements(0),
   m_p2m(0),
-  m_converted_indices(0),
   m_comm(common::PE::Comm::instance().communicator())
 {
   properties().add("vector_type", std::string("cf3.math.LSS.TrilinosVector"));
@@ -109,8 +110,6 @@ void TrilinosCrsMatrix::create_blocked(common::PE::CommPattern& cp, const Variab
   std::vector<int> indices_per_row;
   create_indices_per_row(cp, vars, node_connectivity, starting_indices, m_p2m, num_indices_per_row, indices_per_row, periodic_links_nodes, periodic_links_active);
 
-  m_converted_indices.resize(*std::max_element(num_indices_per_row.begin(), num_indices_per_row.end()));
-
   // rowmap, ghosts not present
   Epetra_Map rowmap(-1,m_num_my_elements,&my_global_elements[0],0,m_comm);
 
@@ -156,6 +155,7 @@ void TrilinosCrsMatrix::destroy()
   }
   m_p2m.resize(0);
   m_p2m.reserve(0);
+  clear_value_positions_storage();
   m_neq=0;
   m_num_my_elements=0;
   m_is_created=false;
@@ -200,25 +200,32 @@ void TrilinosCrsMatrix::get_value(const Uint icol, const Uint irow, Real& value)
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void TrilinosCrsMatrix::set_values(const BlockAccumulator& values)
+{
+  cf3_assert(static_cast<Uint>(values.mat.rows()) == values.indices.size()*m_neq);
+  set_block_values(values.indices.size(), &values.indices[0], values.mat.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosCrsMatrix::set_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
 {
   cf3_assert(m_is_created);
-  const Uint nb_nodes = values.indices.size();
   const int num_entries = nb_nodes*m_neq;
-  cf3_assert(values.mat.rows() == num_entries);
   // Convert the index vector
+  BlockIndexBuffer converted_indices(num_entries);
   for(Uint i = 0; i != nb_nodes; ++i)
   {
-    const Uint local_start_idx = values.indices[i]*m_neq;
+    const Uint local_start_idx = indices[i]*m_neq;
     for(int j = 0; j != m_neq; ++j)
-      m_converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+      converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
   }
   // insert the values
   for(Uint i = 0; i != nb_nodes; ++i)
   {
     for(int j = 0; j != m_neq; ++j)
     {
-      if(m_converted_indices[i*m_neq+j] < m_num_my_elements)
-        TRILINOS_THROW(m_mat->ReplaceMyValues(m_converted_indices[i*m_neq+j], num_entries, values.mat.data()+(num_entries*(i*m_neq+j)),&m_converted_indices[0]));
+      if(converted_indices[i*m_neq+j] < m_num_my_elements)
+        TRILINOS_THROW(m_mat->ReplaceMyValues(converted_indices[i*m_neq+j], num_entries, values+(num_entries*(i*m_neq+j)),converted_indices.data()));
     }
   }
 }
@@ -226,25 +233,32 @@ void TrilinosCrsMatrix::set_values(const BlockAccumulator& values)
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void TrilinosCrsMatrix::add_values(const BlockAccumulator& values)
+{
+  cf3_assert(static_cast<Uint>(values.mat.rows()) == values.indices.size()*m_neq);
+  add_block_values(values.indices.size(), &values.indices[0], values.mat.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosCrsMatrix::add_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
 {
   cf3_assert(m_is_created);
-  const Uint nb_nodes = values.indices.size();
   const int num_entries = nb_nodes*m_neq;
-  cf3_assert(values.mat.rows() == num_entries);
-  // Convert the index vector
+  // Convert the index vector, in a local buffer so threads assembling disjoint rows can call this concurrently
+  BlockIndexBuffer converted_indices(num_entries);
   for(Uint i = 0; i != nb_nodes; ++i)
   {
-    const Uint local_start_idx = values.indices[i]*m_neq;
+    const Uint local_start_idx = indices[i]*m_neq;
     for(int j = 0; j != m_neq; ++j)
-      m_converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+      converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
   }
   // insert the values
   for(Uint i = 0; i != nb_nodes; ++i)
   {
     for(int j = 0; j != m_neq; ++j)
     {
-      if(m_converted_indices[i*m_neq+j] < m_num_my_elements)
-        TRILINOS_THROW(m_mat->SumIntoMyValues(m_converted_indices[i*m_neq+j], num_entries, values.mat.data()+(num_entries*(i*m_neq+j)),&m_converted_indices[0]));
+      if(converted_indices[i*m_neq+j] < m_num_my_elements)
+        TRILINOS_THROW(m_mat->SumIntoMyValues(converted_indices[i*m_neq+j], num_entries, values+(num_entries*(i*m_neq+j)),converted_indices.data()));
     }
   }
 }
@@ -263,12 +277,13 @@ void TrilinosCrsMatrix::get_values(BlockAccumulator& values)
   cf3_assert(values.mat.rows() == num_entries);
   std::map<int, int> reverse_idx_map;
   // Convert the index vector
+  BlockIndexBuffer converted_indices(num_entries);
   for(Uint i = 0; i != nb_nodes; ++i)
   {
     const Uint local_start_idx = values.indices[i]*m_neq;
     for(int j = 0; j != m_neq; ++j)
     {
-      m_converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+      converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
       reverse_idx_map[m_p2m[local_start_idx+j]] = i*m_neq + j;
     }
   }
@@ -277,9 +292,9 @@ void TrilinosCrsMatrix::get_values(BlockAccumulator& values)
   {
     for(int j = 0; j != m_neq; ++j)
     {
-      if(m_converted_indices[i*m_neq+j] >= m_num_my_elements)
+      if(converted_indices[i*m_neq+j] >= m_num_my_elements)
         continue;
-      TRILINOS_THROW(m_mat->ExtractMyRowView(m_converted_indices[i*m_neq+j], extracted_num_entries, extracted_values, extracted_indices));
+      TRILINOS_THROW(m_mat->ExtractMyRowView(converted_indices[i*m_neq+j], extracted_num_entries, extracted_values, extracted_indices));
       for(int k = 0; k != extracted_num_entries; ++k)
       {
         const std::map<int,int>::const_iterator it = reverse_idx_map.find(extracted_indices[k]);
@@ -515,6 +530,72 @@ void TrilinosCrsMatrix::reset(Real reset_to)
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+bool TrilinosCrsMatrix::value_positions(const Uint nb_nodes, const Uint* indices, int* positions)
+{
+  cf3_assert(m_is_created);
+  int* index_offsets;
+  int* column_indices;
+  Real* matrix_values;
+  // Fails if the storage is not optimized, i.e. for a matrix read using read_native
+  if(m_mat->ExtractCrsDataPointers(index_offsets, column_indices, matrix_values) != 0)
+    return false;
+
+  const int num_entries = nb_nodes*m_neq;
+  const bool sorted = m_mat->Sorted();
+
+  // Local index buffer, so threads assembling disjoint rows can call this concurrently
+  BlockIndexBuffer converted_indices(num_entries);
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    const Uint local_start_idx = indices[i]*m_neq;
+    for(int j = 0; j != m_neq; ++j)
+      converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+  }
+
+  for(int row = 0; row != num_entries; ++row)
+  {
+    int* row_positions = positions + row*num_entries;
+    const int matrix_row = converted_indices[row];
+    if(matrix_row >= m_num_my_elements)
+    {
+      std::fill(row_positions, row_positions + num_entries, -1);
+      continue;
+    }
+
+    const int* row_begin = column_indices + index_offsets[matrix_row];
+    const int* row_end = column_indices + index_offsets[matrix_row+1];
+    for(int col = 0; col != num_entries; ++col)
+    {
+      // FillComplete sorts the column indices of each row, so a binary search suffices
+      const int* entry = sorted ? std::lower_bound(row_begin, row_end, converted_indices[col]) : std::find(row_begin, row_end, converted_indices[col]);
+      if(entry == row_end || *entry != converted_indices[col])
+        throw common::BadValue(FromHere(), "Column " + common::to_str(converted_indices[col]) + " is not in the sparsity pattern of row " + common::to_str(matrix_row));
+      row_positions[col] = entry - column_indices;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosCrsMatrix::add_values_at(const Uint nb_values, const Real* values, const int* positions)
+{
+  cf3_assert(m_is_created);
+  int* index_offsets;
+  int* column_indices;
+  Real* matrix_values;
+  TRILINOS_THROW(m_mat->ExtractCrsDataPointers(index_offsets, column_indices, matrix_values));
+
+  for(Uint i = 0; i != nb_values; ++i)
+  {
+    if(positions[i] >= 0)
+      matrix_values[positions[i]] += values[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void TrilinosCrsMatrix::clone_to(Matrix &other)
 {
   if(!m_is_created)
@@ -529,7 +610,6 @@ void TrilinosCrsMatrix::clone_to(Matrix &other)
   other_ptr->m_neq = m_neq;
   other_ptr->m_num_my_elements = m_num_my_elements;
   other_ptr->m_p2m = m_p2m;
-  other_ptr->m_converted_indices = m_converted_indices;
   other_ptr->m_node_connectivity = m_node_connectivity;
   other_ptr->m_starting_indices = m_starting_indices;
   other_ptr->m_symmetric_dirichlet_values = m_symmetric_dirichlet_values;
@@ -84,11 +84,17 @@ public:
   /// Set a list of values
   void set_values(const BlockAccumulator& values);
 
+  /// Set a block of values, without copying them
+  void set_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
   /// Add a list of values
   /// local ibdices
   /// eigen, templatization on top level
   void add_values(const BlockAccumulator& values);
 
+  /// Add a block of values, without copying them
+  void add_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
   /// Add a list of values
   void get_values(BlockAccumulator& values);
 
@@ -121,6 +127,17 @@ public:
 
   //@} END EFFICCIENT ACCESS
 
+  /// @name REUSE OF ASSEMBLED VALUES
+  //@{
+
+  /// Positions are offsets in the value array of the optimized Epetra storage
+  bool value_positions(const Uint nb_nodes, const Uint* indices, int* positions);
+
+  /// Add values directly into the Epetra value array
+  void add_values_at(const Uint nb_values, const Real* values, const int* positions);
+
+  //@} END REUSE OF ASSEMBLED VALUES
+
   /// @name MISCELLANEOUS
   //@{
 
@@ -222,9 +239,6 @@ private:
   /// mapper array, maps from process local numbering to matrix local numbering (because ghost nodes need to be ordered to the back)
   std::vector<int> m_p2m;
 
-  /// a helper array used in set/add/get_values to avoid frequent new+free combo
-  std::vector<int> m_converted_indices;
-
   /// Copy of the connectivity data
   std::vector<int> m_node_connectivity, m_starting_indices;
 
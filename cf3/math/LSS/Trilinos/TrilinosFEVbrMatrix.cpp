@@ -60,7 +60,6 @@ TrilinosFEVbrMatrix::TrilinosFEVbrMatrix(const std::string& name) :
   m_blockrow_size(0),
   m_blockcol_size(0),
   m_p2m(0),
-  m_converted_indices(0),
   m_comm(common::PE::Comm::instance().communicator())
 {
   properties().add("vector_type", std::string("cf3.math.LSS.TrilinosVector"));
@@ -224,6 +223,14 @@ void TrilinosFEVbrMatrix::get_value(const Uint icol, const Uint irow, Real& valu
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void TrilinosFEVbrMatrix::set_values(const BlockAccumulator& values)
+{
+  cf3_assert(static_cast<Uint>(values.mat.rows()) == values.indices.size()*m_neq);
+  set_block_values(values.indices.size(), &values.indices[0], values.mat.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosFEVbrMatrix::set_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
 {
   cf3_assert(m_is_created);
   Epetra_SerialDenseMatrix **val;
@@ -231,12 +238,13 @@ void TrilinosFEVbrMatrix::set_values(const BlockAccumulator& values)
   int blockrowsize;
   int dummyneq;
   int hits=0;
-  const int numblocks=values.indices.size();
+  const int numblocks=nb_nodes;
   const int rowoffset=(numblocks-1)*m_neq;
   const int neqneq=m_neq*m_neq;
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  for (int i=0; i<(const int)numblocks; i++) m_converted_indices[i]=m_p2m[values.indices[i]];
-  int* idxs=(int*)&m_converted_indices[0];
+  const int numcols=numblocks*m_neq; // row size of the row-major values
+  BlockIndexBuffer converted_indices(numblocks);
+  for (int i=0; i<(const int)numblocks; i++) converted_indices[i]=m_p2m[indices[i]];
+  int* idxs=converted_indices.data();
   for (int irow=0; irow<(const int)numblocks; irow++)
   {
     if (idxs[irow]<m_blockrow_size)
@@ -254,7 +262,7 @@ void TrilinosFEVbrMatrix::set_values(const BlockAccumulator& values)
             {
               int row_idx = irow*m_neq;
               for (double* m=emv; emv<(const double*)(m+m_neq);)
-                *emv++ = values.mat(row_idx++, col_idx);
+                *emv++ = values[(row_idx++)*numcols + col_idx];
             }
 
             hits++;
@@ -269,6 +277,14 @@ void TrilinosFEVbrMatrix::set_values(const BlockAccumulator& values)
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void TrilinosFEVbrMatrix::add_values(const BlockAccumulator& values)
+{
+  cf3_assert(static_cast<Uint>(values.mat.rows()) == values.indices.size()*m_neq);
+  add_block_values(values.indices.size(), &values.indices[0], values.mat.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosFEVbrMatrix::add_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
 {
 /* TRILINOS-ADVICED
   cf3_assert(m_is_created);
@@ -319,12 +335,13 @@ void TrilinosFEVbrMatrix::add_values(const BlockAccumulator& values)
   int blockrowsize;
   int dummyneq;
   int hits=0;
-  const int numblocks=values.indices.size();
+  const int numblocks=nb_nodes;
   const int rowoffset=(numblocks-1)*m_neq;
   const int neqneq=m_neq*m_neq;
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  for (int i=0; i<(const int)numblocks; i++) m_converted_indices[i]=m_p2m[values.indices[i]];
-  int* idxs=(int*)&m_converted_indices[0];
+  const int numcols=numblocks*m_neq; // row size of the row-major values
+  BlockIndexBuffer converted_indices(numblocks);
+  for (int i=0; i<(const int)numblocks; i++) converted_indices[i]=m_p2m[indices[i]];
+  int* idxs=converted_indices.data();
   for (int irow=0; irow<(const int)numblocks; irow++)
   {
     if (idxs[irow]<m_blockrow_size)
@@ -342,7 +359,7 @@ void TrilinosFEVbrMatrix::add_values(const BlockAccumulator& values)
             {
               int row_idx = irow*m_neq;
               for (double* m=emv; emv<(const double*)(m+m_neq);)
-                *emv++ += values.mat(row_idx++, col_idx);
+                *emv++ += values[(row_idx++)*numcols + col_idx];
             }
 
             hits++;
@@ -367,9 +384,9 @@ void TrilinosFEVbrMatrix::get_values(BlockAccumulator& values)
   const int numblocks=values.indices.size();
   const int rowoffset=(numblocks-1)*m_neq;
   const int neqneq=m_neq*m_neq;
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  for (int i=0; i<(const int)numblocks; i++) m_converted_indices[i]=m_p2m[values.indices[i]];
-  int* idxs=(int*)&m_converted_indices[0];
+  BlockIndexBuffer converted_indices(numblocks);
+  for (int i=0; i<(const int)numblocks; i++) converted_indices[i]=m_p2m[values.indices[i]];
+  int* idxs=converted_indices.data();
   values.mat.setConstant(0.);
   for (int irow=0; irow<(const int)numblocks; irow++)
   {
@@ -491,6 +508,21 @@ void TrilinosFEVbrMatrix::symmetric_dirichlet(const Uint blockrow, const Uint ie
 
   const Uint bc_col = m_p2m[blockrow];
 
+  DirichletEntryT& cached_col_values = m_symmetric_dirichlet_values[blockrow*m_neq+ieq];
+
+  // A frozen matrix keeps the values eliminated before it was frozen, so only the RHS needs to be updated using the cached column.
+  // The matrix values of a matrix that is not frozen may have changed since the last application, so they are always used directly.
+  if(is_frozen())
+  {
+    for(DirichletEntryT::const_iterator it = cached_col_values.begin(); it != cached_col_values.end(); ++it)
+    {
+      rhs.add_value(it->first / m_neq, it->first % m_neq, -it->second * value);
+    }
+    rhs.set_value(blockrow, ieq, value);
+    return;
+  }
+
+  const bool record_col_values = cached_col_values.empty();
   for(int col_idx = columns_begin; col_idx != columns_end; ++col_idx)
   {
     const int col = m_node_connectivity[col_idx];
@@ -523,6 +555,9 @@ void TrilinosFEVbrMatrix::symmetric_dirichlet(const Uint blockrow, const Uint ie
       {
         for(int j = 0; j != m_neq; ++j)
         {
+          // Only the first application after a reset sees the values that were assembled
+          if(record_col_values)
+            cached_col_values[col*m_neq+j] = val[i][0](j, ieq);
           rhs.add_value(col, j, -val[i][0](j, ieq) * value);
           val[i][0](j, ieq) = 0;
         }
@@ -662,6 +697,8 @@ void TrilinosFEVbrMatrix::reset(Real reset_to)
 {
   cf3_assert(m_is_created);
   m_mat->PutScalar(reset_to);
+
+  m_symmetric_dirichlet_values.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <map>
+
 #include <Epetra_MpiComm.h>
 #include <Epetra_FEVbrMatrix.h>
 #include <Teuchos_RCP.hpp>
@@ -85,11 +87,17 @@ public:
   /// Set a list of values
   void set_values(const BlockAccumulator& values);
 
+  /// Set a block of values, without copying them
+  void set_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
   /// Add a list of values
   /// local ibdices
   /// eigen, templatization on top level
   void add_values(const BlockAccumulator& values);
 
+  /// Add a block of values, without copying them
+  void add_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
   /// Add a list of values
   void get_values(BlockAccumulator& values);
 
@@ -194,12 +202,15 @@ private:
   /// mapper array, maps from process local numbering to matrix local numbering (because ghost nodes need to be ordered to the back)
   std::vector<int> m_p2m;
 
-  /// a helper array used in set/add/get_values to avoid frequent new+free combo
-  std::vector<int> m_converted_indices;
-
   /// Copy of the connectivity data
   std::vector<int> m_node_connectivity, m_starting_indices;
 
+  /// Matrix values eliminated by symmetric dirichlet since the last reset, so they can be applied to the RHS again while the matrix is frozen.
+  /// Maps the dirichlet row to the RHS entries (block row * neq + equation) and the eliminated matrix values
+  typedef std::map<int, Real> DirichletEntryT;
+  typedef std::map<int, DirichletEntryT> DirichletMapT;
+  DirichletMapT m_symmetric_dirichlet_values;
+
 }; // end of class Matrix
 
 ////////////////////////////////////////////////////////////////////////////////////////////
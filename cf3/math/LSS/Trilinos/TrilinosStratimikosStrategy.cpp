@@ -143,22 +143,27 @@ struct TrilinosStratimikosStrategy::Implementation
     if(is_null(m_solution))
       throw common::SetupError(FromHere(), "Null solution vector for " + m_self.uri().path());
 
+    bool lows_created = false;
     if(m_lows.is_null())
     {
       if(m_self.options().option("print_settings").value<bool>())
         m_parameter_list->print();
 
       m_lows = m_lows_factory->createOp();
+      lows_created = true;
     }
 
-    
-    if(m_iteration_count % m_preconditioner_reset == 0)
-    {
-      Thyra::initializeOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
-    }
-    else
+    // The operator and preconditioner of the previous solve remain valid for a frozen matrix
+    if(lows_created || !m_lss_matrix->is_frozen())
     {
-      Thyra::initializeAndReuseOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+      if(m_iteration_count % m_preconditioner_reset == 0)
+      {
+        Thyra::initializeOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+      }
+      else
+      {
+        Thyra::initializeAndReuseOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+      }
     }
 
     Teuchos::RCP< Thyra::VectorBase<Real> const > b = m_rhs->thyra_vector();
@@ -242,6 +247,7 @@ struct TrilinosStratimikosStrategy::Implementation
   Teuchos::RCP<Thyra::LinearOpWithSolveBase<double> > m_lows;
 
   Handle<ThyraOperator const> m_matrix;
+  Handle<Matrix const> m_lss_matrix;
   Handle<ThyraVector> m_rhs;
   Handle<ThyraVector> m_solution;
   Teuchos::RCP< Thyra::VectorBase<Real> > m_residual_vec;
@@ -275,6 +281,7 @@ TrilinosStratimikosStrategy::~TrilinosStratimikosStrategy()
 void TrilinosStratimikosStrategy::set_matrix(const Handle< Matrix >& matrix)
 {
   m_implementation->m_matrix = Handle<ThyraOperator>(matrix);
+  m_implementation->m_lss_matrix = matrix;
   m_implementation->setup_solver();
 }
 
@@ -49,7 +49,6 @@ TrilinosVector::TrilinosVector(const std::string& name) :
   m_blockrow_size(0),
   m_is_created(false),
   m_vec(0),
-  m_converted_indices(0),
   m_comm(common::PE::Comm::instance().communicator())
 {
   regist_signal( "print_native" )
@@ -170,17 +169,22 @@ void TrilinosVector::get_value(const Uint iblockrow, const Uint ieq, Real& value
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void TrilinosVector::set_rhs_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  set_rhs_block_values(values.indices.size(), &values.indices[0], values.rhs.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosVector::set_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
 {
   /// @note looked up the code and access mechanism is a mess, much less cpu to access here in a for loop and directly do whats desired
   cf3_assert(m_is_created);
-  const int numblocks=values.indices.size();
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  int *conv=&m_converted_indices[0];
-  double *vals=(double*)&values.rhs[0];
-  for (int i=0; i<(const int)numblocks; i++)
+  const Real* vals=values;
+  for (Uint i=0; i<nb_nodes; i++)
   {
     for (int j=0; j<(const int)m_neq; j++)
-      m_data[m_p2m[values.indices[i]*m_neq+j]]=*vals++;
+      m_data[m_p2m[indices[i]*m_neq+j]]=*vals++;
   }
 }
 
@@ -191,8 +195,6 @@ void TrilinosVector::add_rhs_values(const BlockAccumulator& values)
   /// @note looked up the code and access mechanism is a mess, much less cpu to access here in a for loop and directly do whats desired
   cf3_assert(m_is_created);
   const int numblocks=values.indices.size();
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  int *conv=&m_converted_indices[0];
   double *vals=(double*)&values.rhs[0];
   for (int i=0; i<(const int)numblocks; i++)
   {
@@ -205,13 +207,25 @@ void TrilinosVector::add_rhs_values(const BlockAccumulator& values)
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+void TrilinosVector::add_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
+{
+  cf3_assert(m_is_created);
+  const Real* vals=values;
+  for (Uint i=0; i<nb_nodes; i++)
+  {
+    cf3_assert(indices[i] < m_blockrow_size);
+    for (int j=0; j<(const int)m_neq; j++)
+      m_data[m_p2m[indices[i]*m_neq+j]]+=*vals++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void TrilinosVector::get_rhs_values(BlockAccumulator& values)
 {
   /// @note looked up the code and access mechanism is a mess, much less cpu to access here in a for loop and directly do whats desired
   cf3_assert(m_is_created);
   const int numblocks=values.indices.size();
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  int *conv=&m_converted_indices[0];
   double *vals=(double*)&values.rhs[0];
   for (int i=0; i<(const int)numblocks; i++)
   {
@@ -229,8 +243,6 @@ void TrilinosVector::set_sol_values(const BlockAccumulator& values)
   /// @note looked up the code and access mechanism is a mess, much less cpu to access here in a for loop and directly do whats desired
   cf3_assert(m_is_created);
   const int numblocks=values.indices.size();
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  int *conv=&m_converted_indices[0];
   double *vals=(double*)&values.sol[0];
   for (int i=0; i<(const int)numblocks; i++)
   {
@@ -248,8 +260,6 @@ void TrilinosVector::add_sol_values(const BlockAccumulator& values)
   /// @note looked up the code and access mechanism is a mess, much less cpu to access here in a for loop and directly do whats desired
   cf3_assert(m_is_created);
   const int numblocks=values.indices.size();
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  int *conv=&m_converted_indices[0];
   double *vals=(double*)&values.sol[0];
   for (int i=0; i<(const int)numblocks; i++)
   {
@@ -263,19 +273,23 @@ void TrilinosVector::add_sol_values(const BlockAccumulator& values)
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void TrilinosVector::get_sol_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  get_sol_block_values(values.indices.size(), &values.indices[0], values.sol.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosVector::get_sol_block_values(const Uint nb_nodes, const Uint* indices, Real* values)
 {
   /// @note looked up the code and access mechanism is a mess, much less cpu to access here in a for loop and directly do whats desired
   cf3_assert(m_is_created);
-  const int numblocks=values.indices.size();
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  int *conv=&m_converted_indices[0];
-  double *vals=(double*)&values.sol[0];
-  for (int i=0; i<(const int)numblocks; i++)
+  Real* vals=values;
+  for (Uint i=0; i<nb_nodes; i++)
   {
-    cf3_assert(values.indices[i] >= 0);
-    cf3_assert(values.indices[i] < m_blockrow_size);
+    cf3_assert(indices[i] < m_blockrow_size);
     for (int j=0; j<(const int)m_neq; j++)
-      *vals++=m_data[m_p2m[values.indices[i]*m_neq+j]];
+      *vals++=m_data[m_p2m[indices[i]*m_neq+j]];
   }
 }
 
@@ -422,7 +436,6 @@ void TrilinosVector::clone_to(Vector &other)
   other_ptr->m_blockrow_size = m_blockrow_size;
   other_ptr->m_is_created = m_is_created;
   other_ptr->m_p2m = m_p2m;
-  other_ptr->m_converted_indices = m_converted_indices;
   other_ptr->m_comm_pattern = m_comm_pattern;
   m_comm_pattern->insert(other_ptr->name(), other_ptr->m_data, true);
 }
@@ -101,9 +101,15 @@ public:
   /// Set a list of values to rhs
   void set_rhs_values(const BlockAccumulator& values);
 
+  /// Set a block of values to rhs, without copying them
+  void set_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
   /// Add a list of values to rhs
   void add_rhs_values(const BlockAccumulator& values);
 
+  /// Add a block of values to rhs, without copying them
+  void add_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values);
+
   /// Get a list of values from rhs
   void get_rhs_values(BlockAccumulator& values);
 
@@ -116,6 +122,9 @@ public:
   /// Get a list of values from sol
   void get_sol_values(BlockAccumulator& values);
 
+  /// Get a block of values from sol, without copying them
+  void get_sol_block_values(const Uint nb_nodes, const Uint* indices, Real* values);
+
   /// Reset Vector
   void reset(Real reset_to=0.);
 
@@ -208,9 +217,6 @@ private:
   /// mapper array, maps from process local numbering to matrix local numbering (because ghost nodes need to be ordered to the back)
   std::vector<int> m_p2m;
 
-  /// a helper array used in set/add/get_values to avoid frequent new+free combo
-  std::vector<int> m_converted_indices;
-
   /// The comm pattern is kept as shared ptr, so it can be shared between any clones of this vector.
   boost::shared_ptr<common::PE::CommPattern> m_comm_pattern;
 };
@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include <boost/utility.hpp>
 
 #include "math/LSS/LibLSS.hpp"
@@ -89,9 +91,49 @@ public:
   /// Set a list of values to rhs
   virtual void set_rhs_values(const BlockAccumulator& values) = 0;
 
+  /// Set nb_nodes*neq() values of rhs, given with the indices of the nb_nodes block rows.
+  /// This is what set_rhs_values uses for a FixedBlockAccumulator. The default implementation copies the data into a
+  /// BlockAccumulator, implementations should override it to avoid the allocation.
+  virtual void set_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
+  {
+    BlockAccumulator block;
+    block.resize(nb_nodes, neq());
+    std::copy(indices, indices+nb_nodes, block.indices.begin());
+    block.rhs = Eigen::Map<const RealVector>(values, nb_nodes*neq());
+    set_rhs_values(block);
+  }
+
+  /// Set the rhs of a block accumulator with a size known at compile time, without any dynamic allocation
+  template<int NbNodes, int NbEqs>
+  void set_rhs_values(const FixedBlockAccumulator<NbNodes, NbEqs>& values)
+  {
+    cf3_assert(neq() == static_cast<Uint>(NbEqs));
+    set_rhs_block_values(NbNodes, values.indices.data(), values.rhs.data());
+  }
+
   /// Add a list of values to rhs
   virtual void add_rhs_values(const BlockAccumulator& values) = 0;
 
+  /// Add nb_nodes*neq() values to rhs, given with the indices of the nb_nodes block rows.
+  /// This is what add_rhs_values uses for a FixedBlockAccumulator. The default implementation copies the data into a
+  /// BlockAccumulator, implementations should override it to avoid the allocation.
+  virtual void add_rhs_block_values(const Uint nb_nodes, const Uint* indices, const Real* values)
+  {
+    BlockAccumulator block;
+    block.resize(nb_nodes, neq());
+    std::copy(indices, indices+nb_nodes, block.indices.begin());
+    block.rhs = Eigen::Map<const RealVector>(values, nb_nodes*neq());
+    add_rhs_values(block);
+  }
+
+  /// Add the rhs of a block accumulator with a size known at compile time, without any dynamic allocation
+  template<int NbNodes, int NbEqs>
+  void add_rhs_values(const FixedBlockAccumulator<NbNodes, NbEqs>& values)
+  {
+    cf3_assert(neq() == static_cast<Uint>(NbEqs));
+    add_rhs_block_values(NbNodes, values.indices.data(), values.rhs.data());
+  }
+
   /// Get a list of values from rhs
   virtual void get_rhs_values(BlockAccumulator& values) = 0;
 
@@ -104,6 +146,26 @@ public:
   /// Get a list of values from sol
   virtual void get_sol_values(BlockAccumulator& values) = 0;
 
+  /// Get nb_nodes*neq() values from sol, for the nb_nodes block rows given by indices.
+  /// This is what get_sol_values uses for a FixedBlockAccumulator. The default implementation copies the data through a
+  /// BlockAccumulator, implementations should override it to avoid the allocation.
+  virtual void get_sol_block_values(const Uint nb_nodes, const Uint* indices, Real* values)
+  {
+    BlockAccumulator block;
+    block.resize(nb_nodes, neq());
+    std::copy(indices, indices+nb_nodes, block.indices.begin());
+    get_sol_values(block);
+    std::copy(block.sol.data(), block.sol.data()+nb_nodes*neq(), values);
+  }
+
+  /// Get the sol values of a block accumulator with a size known at compile time, without any dynamic allocation
+  template<int NbNodes, int NbEqs>
+  void get_sol_values(FixedBlockAccumulator<NbNodes, NbEqs>& values)
+  {
+    cf3_assert(neq() == static_cast<Uint>(NbEqs));
+    get_sol_block_values(NbNodes, values.indices.data(), values.sol.data());
+  }
+
   /// Reset Vector
   virtual void reset(Real reset_to=0.) = 0;
 
@@ -62,7 +62,11 @@ void ZeroLSS::execute ()
   bool reset_rhs = options().option("reset_rhs").value<bool>();
   bool reset_solution = options().option("reset_solution").value<bool>();
 
-  if(reset_matrix)
+  if(reset_matrix && m_lss->matrix()->is_frozen())
+  {
+    CFdebug << "Not resetting frozen matrix " << m_lss->matrix()->uri().string() << CFendl;
+  }
+  else if(reset_matrix)
   {
     CFdebug << "Resetting matrix " << m_lss->matrix()->uri().string() << CFendl;
     m_lss->matrix()->reset();
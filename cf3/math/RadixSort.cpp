@@ -0,0 +1,62 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include "math/RadixSort.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+//////////////////////////////////////////////////////////////////////////////
+
+void radix_sort(const std::vector<boost::uint64_t>& keys, std::vector<Uint>& permutation)
+{
+  const Uint nb_keys = keys.size();
+  permutation.resize(nb_keys);
+  for(Uint i = 0; i != nb_keys; ++i)
+    permutation[i] = i;
+  if(nb_keys == 0)
+    return;
+
+  std::vector<Uint> buffer(nb_keys);
+  std::vector<Uint> offsets(256);
+  for(Uint shift = 0; shift != 64; shift += 8)
+  {
+    // The histogram does not depend on the current order
+    std::fill(offsets.begin(), offsets.end(), 0u);
+    for(Uint i = 0; i != nb_keys; ++i)
+      ++offsets[(keys[i] >> shift) & 0xff];
+
+    // Nothing to do if all keys have the same digit
+    if(offsets[(keys[0] >> shift) & 0xff] == nb_keys)
+      continue;
+
+    Uint start = 0;
+    for(Uint digit = 0; digit != 256; ++digit)
+    {
+      const Uint count = offsets[digit];
+      offsets[digit] = start;
+      start += count;
+    }
+
+    for(Uint i = 0; i != nb_keys; ++i)
+    {
+      const Uint idx = permutation[i];
+      buffer[offsets[(keys[idx] >> shift) & 0xff]++] = idx;
+    }
+    permutation.swap(buffer);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+//////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,42 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_math_RadixSort_hpp
+#define cf3_math_RadixSort_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "math/LibMath.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Sort 64-bit keys, such as Hilbert indices, using a least significant digit radix sort
+///
+/// The keys are not modified: instead, the permutation that sorts them is returned, so
+/// keys[permutation[0]] <= keys[permutation[1]] <= ...
+/// The sort is stable, so equal keys keep their original order. Digits of one byte are used,
+/// and passes over bytes that are the same for all keys are skipped.
+/// @param [in]  keys         The keys to sort
+/// @param [out] permutation  Indices of the keys in sorted order, resized to the number of keys
+Math_API void radix_sort(const std::vector<boost::uint64_t>& keys, std::vector<Uint>& permutation);
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_math_RadixSort_hpp
@@ -65,7 +65,7 @@ void VectorialFunction::clear()
   for(Uint i = 0; i < m_parsers.size(); i++) {
       delete_ptr(m_parsers[i]);
   }
-  vector<FunctionParser*>().swap(m_parsers);
+  vector<BatchFunctionParser*>().swap(m_parsers);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -156,7 +156,7 @@ void VectorialFunction::parse()
 
   for(Uint i = 0; i < m_functions.size(); ++i)
   {
-    FunctionParser* ptr = new FunctionParser();
+    BatchFunctionParser* ptr = new BatchFunctionParser();
     ptr->AddConstant("pi", Consts::pi());
     m_parsers.push_back(ptr);
 
@@ -185,8 +185,8 @@ RealVector& VectorialFunction::operator()( const VariablesT& var_values)
   cf3_assert(var_values.size() == m_nbvars);
 
   // evaluate and store the functions line by line in the result vector
-  std::vector<FunctionParser*>::const_iterator parser = m_parsers.begin();
-  std::vector<FunctionParser*>::const_iterator end = m_parsers.end();
+  std::vector<BatchFunctionParser*>::const_iterator parser = m_parsers.begin();
+  std::vector<BatchFunctionParser*>::const_iterator end = m_parsers.end();
   Uint i = 0;
   for( ; parser != end ; ++parser, ++i )
     m_result[i] = (*parser)->Eval(&var_values[0]);
@@ -202,8 +202,8 @@ RealVector& VectorialFunction::operator()( const RealVector& var_values)
   cf3_assert(var_values.size() == m_nbvars);
 
   // evaluate and store the functions line by line in the result vector
-  std::vector<FunctionParser*>::const_iterator parser = m_parsers.begin();
-  std::vector<FunctionParser*>::const_iterator end = m_parsers.end();
+  std::vector<BatchFunctionParser*>::const_iterator parser = m_parsers.begin();
+  std::vector<BatchFunctionParser*>::const_iterator end = m_parsers.end();
   Uint i = 0;
   for( ; parser != end ; ++parser, ++i )
     m_result[i] = (*parser)->Eval(&var_values[0]);
@@ -213,6 +213,18 @@ RealVector& VectorialFunction::operator()( const RealVector& var_values)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void VectorialFunction::evaluate_batch(const Real* var_values, const Uint nb_points, Real* ret_values) const
+{
+  cf3_assert(m_is_parsed);
+
+  // the results of each function are interleaved, to give all functions of a point together
+  const Uint nb_funcs = m_parsers.size();
+  for(Uint i = 0; i < nb_funcs; ++i)
+    m_parsers[i]->eval_batch(var_values, nb_points, ret_values + i, nb_funcs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // math
 } // cf3
 
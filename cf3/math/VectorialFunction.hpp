@@ -9,11 +9,10 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
-#include "fparser/fparser.hh"
-
 #include "common/BasicExceptions.hpp"
 
 #include "math/LibMath.hpp"
+#include "math/BatchFunctionParser.hpp"
 #include "math/MatrixTypes.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -71,6 +70,13 @@ public: // functions
   /// @param var_values values of the variables to substitute in the function.
   RealVector& operator()(const RealVector& var_values);
 
+  /// Evaluate the Vectorial Function in a number of points at once.
+  /// This is much faster than evaluating the points one by one.
+  /// @param var_values values of the variables, nbvars() values for each point
+  /// @param nb_points number of points to evaluate
+  /// @param ret_values placeholder for the result, nbfuncs() values for each point
+  void evaluate_batch(const Real* var_values, const Uint nb_points, Real* ret_values) const;
+
   /// @return if the VectorialFunctionParser has been parsed yet.
   bool is_parsed() const { return m_is_parsed; }
 
@@ -120,7 +126,7 @@ private: // data
   std::vector<std::string> m_functions;
 
   /// vector holding the parsers, one for each entry in the vector
-  std::vector<FunctionParser*> m_parsers;
+  std::vector<BatchFunctionParser*> m_parsers;
 
   /// storage of the result for using the class as functor
   RealVector m_result;
@@ -136,8 +142,8 @@ void VectorialFunction::evaluate(const var_t& var_values, ret_t& ret_value) cons
   cf3_assert(var_values.size() == m_nbvars);
 
   // evaluate and store the functions line by line in the vector
-  std::vector<FunctionParser*>::const_iterator parser = m_parsers.begin();
-  std::vector<FunctionParser*>::const_iterator end = m_parsers.end();
+  std::vector<BatchFunctionParser*>::const_iterator parser = m_parsers.begin();
+  std::vector<BatchFunctionParser*>::const_iterator end = m_parsers.end();
   for(Uint i=0 ; parser != end ; ++parser, ++i )
   {
     // It is possible this function signals a FloatingPointException (FPE)
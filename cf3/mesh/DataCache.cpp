@@ -0,0 +1,60 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <map>
+
+#include <boost/thread/mutex.hpp>
+
+#include "mesh/DataCache.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+class DataCache::Implementation
+{
+public:
+  typedef std::map< std::string, boost::shared_ptr<void> > EntriesT;
+
+  boost::mutex m_mutex;
+  EntriesT m_entries;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+DataCache::DataCache() :
+  m_implementation(new Implementation())
+{
+}
+
+DataCache::~DataCache()
+{
+}
+
+void DataCache::clear()
+{
+  boost::mutex::scoped_lock lock(m_implementation->m_mutex);
+  m_implementation->m_entries.clear();
+}
+
+boost::shared_ptr<void> DataCache::get_entry(const std::string& key) const
+{
+  boost::mutex::scoped_lock lock(m_implementation->m_mutex);
+  const Implementation::EntriesT::const_iterator entry = m_implementation->m_entries.find(key);
+  return entry == m_implementation->m_entries.end() ? boost::shared_ptr<void>() : entry->second;
+}
+
+void DataCache::set_entry(const std::string& key, const boost::shared_ptr<void>& data)
+{
+  boost::mutex::scoped_lock lock(m_implementation->m_mutex);
+  m_implementation->m_entries[key] = data;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
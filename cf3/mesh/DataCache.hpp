@@ -0,0 +1,70 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_DataCache_hpp
+#define cf3_mesh_DataCache_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/type_traits/remove_const.hpp>
+
+#include "mesh/LibMesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Storage for data derived from a mesh, such as used node lists or element colourings
+/// The data is kept as plain objects instead of components, so it does not show up in the component tree.
+/// Each Mesh owns a cache, which is cleared by Mesh::raise_mesh_changed. Keys must identify both the data and its type,
+/// e.g. by combining a description of the data with the path of the component it belongs to.
+class Mesh_API DataCache
+{
+public:
+  DataCache();
+  ~DataCache();
+
+  /// The data stored under key, or a null pointer if there is none
+  template<typename T>
+  boost::shared_ptr<T> get(const std::string& key) const
+  {
+    return boost::static_pointer_cast<T>(get_entry(key));
+  }
+
+  /// Store data under key, replacing any existing data. Constness is restored by the type passed to get.
+  template<typename T>
+  void set(const std::string& key, const boost::shared_ptr<T>& data)
+  {
+    set_entry(key, boost::const_pointer_cast<typename boost::remove_const<T>::type>(data));
+  }
+
+  /// Remove all data. Holders of a pointer returned by get keep their copy of the data.
+  void clear();
+
+private:
+  boost::shared_ptr<void> get_entry(const std::string& key) const;
+  void set_entry(const std::string& key, const boost::shared_ptr<void>& data);
+
+  /// Holds the entries and their mutex, so the Boost.Thread headers stay out of this header
+  class Implementation;
+  boost::scoped_ptr<Implementation> m_implementation;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_DataCache_hpp
@@ -11,6 +11,7 @@
 
 #include "mesh/ElementFinder.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/Space.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -28,5 +29,27 @@ ElementFinder::ElementFinder(const std::string &name) : common::Component(name)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Uint ElementFinder::find_elements(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found)
+{
+  const Uint nb_coords = coordinates.rows();
+  elements.resize(nb_coords);
+  found.assign(nb_coords, false);
+
+  Uint nb_found = 0;
+  RealVector coord(coordinates.cols());
+  for(Uint i = 0; i != nb_coords; ++i)
+  {
+    coord = coordinates.row(i).transpose();
+    if(find_element(coord, elements[i]))
+    {
+      found[i] = true;
+      ++nb_found;
+    }
+  }
+  return nb_found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
@@ -40,6 +40,15 @@ public:
   /// @return if element was found
   virtual bool find_element(const RealVector& target_coord, SpaceElem& element) = 0;
 
+  /// @brief Find the elements containing a batch of coordinates
+  /// The default implementation calls find_element for each coordinate. Implementations can override this
+  /// to reorder the queries for better locality.
+  /// @param [in]  coordinates  The coordinates used to find the elements, one per row
+  /// @param [out] elements     The found elements, in the order of the coordinates
+  /// @param [out] found        For each coordinate, true if the element was found
+  /// @return the number of coordinates for which an element was found
+  virtual Uint find_elements(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found);
+
 protected:
   Handle<Dictionary> m_dict;
 };
@@ -0,0 +1,522 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+
+#include "common/Builder.hpp"
+#include "common/Core.hpp"
+#include "common/EventHandler.hpp"
+#include "common/Signal.hpp"
+#include "common/FindComponents.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
+#include "common/OptionComponent.hpp"
+#include "common/XML/SignalOptions.hpp"
+
+#include "math/Consts.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/ElementFinderBVH.hpp"
+#include "mesh/Tags.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+  using namespace common;
+
+namespace detail {
+
+/// Orders item indices by one component of their centroid
+struct CentroidLess
+{
+  CentroidLess(const std::vector<Real>& centroids, const Uint axis) : m_centroids(centroids), m_axis(axis)
+  {
+  }
+
+  bool operator()(const Uint a, const Uint b) const
+  {
+    return m_centroids[3*a+m_axis] < m_centroids[3*b+m_axis];
+  }
+
+  const std::vector<Real>& m_centroids;
+  const Uint m_axis;
+};
+
+/// True if the box given by min and max contains point
+inline bool box_contains(const Real* min, const Real* max, const RealVector& point, const Uint dim)
+{
+  for(Uint d = 0; d != dim; ++d)
+  {
+    if(point[d] < min[d] || point[d] > max[d])
+      return false;
+  }
+  return true;
+}
+
+/// Squared distance from point to the box given by min and max, zero if the point is inside
+inline Real box_distance2(const Real* min, const Real* max, const RealVector& point, const Uint dim)
+{
+  Real result = 0.;
+  for(Uint d = 0; d != dim; ++d)
+  {
+    const Real delta = point[d] < min[d] ? min[d] - point[d] : (point[d] > max[d] ? point[d] - max[d] : 0.);
+    result += delta*delta;
+  }
+  return result;
+}
+
+/// Key of the point with integer coordinates X on a Hilbert curve, using bits bits per coordinate.
+/// This is the transpose algorithm of J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004),
+/// which avoids the recursive box subdivision of math::Hilbert and is cheap enough to order large batches of queries.
+inline boost::uint64_t hilbert_key(boost::uint32_t* X, const Uint dim, const Uint bits)
+{
+  if(dim == 1)
+    return X[0];
+
+  const boost::uint32_t M = 1u << (bits-1);
+  // Inverse undo
+  for(boost::uint32_t Q = M; Q > 1; Q >>= 1)
+  {
+    const boost::uint32_t P = Q - 1;
+    for(Uint i = 0; i != dim; ++i)
+    {
+      if(X[i] & Q)
+      {
+        X[0] ^= P;
+      }
+      else
+      {
+        const boost::uint32_t t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+  // Gray encode
+  for(Uint i = 1; i < dim; ++i)
+    X[i] ^= X[i-1];
+  boost::uint32_t t = 0;
+  for(boost::uint32_t Q = M; Q > 1; Q >>= 1)
+  {
+    if(X[dim-1] & Q)
+      t ^= Q - 1;
+  }
+  for(Uint i = 0; i != dim; ++i)
+    X[i] ^= t;
+
+  // Interleave the bits of the transposed key
+  boost::uint64_t key = 0;
+  for(int b = bits-1; b >= 0; --b)
+  {
+    for(Uint i = 0; i != dim; ++i)
+      key = (key << 1) | ((X[i] >> b) & 1u);
+  }
+  return key;
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+cf3::common::ComponentBuilder < ElementFinderBVH, ElementFinder, LibMesh > ElementFinderBVH_Builder;
+
+////////////////////////////////////////////////////////////////////////////////
+
+ElementFinderBVH::ElementFinderBVH(const std::string &name) :
+  ElementFinder(name),
+  m_closest(true),
+  m_leaf_size(4),
+  m_dim(0)
+{
+  options().option("dict").attach_trigger( boost::bind( &ElementFinderBVH::trigger_dict, this ) );
+
+  options().add("find_closest",m_closest)
+    .description("If true, an inexact match is allowed, finding the element with the closest centroid")
+    .link_to(&m_closest);
+
+  options().add("leaf_size",m_leaf_size)
+    .pretty_name("Leaf Size")
+    .description("Maximum number of elements in a leaf of the hierarchy")
+    .link_to(&m_leaf_size)
+    .attach_trigger( boost::bind( &ElementFinderBVH::trigger_dict, this ) );
+
+  Core::instance().event_handler().connect_to_event(Tags::event_mesh_changed(), this, &ElementFinderBVH::on_mesh_changed_event);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ElementFinderBVH::~ElementFinderBVH()
+{
+  connection(Tags::event_mesh_changed())->disconnect();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ElementFinderBVH::trigger_dict()
+{
+  m_nodes.clear();
+  m_items.clear();
+  m_item_boxes.clear();
+  m_centroids.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ElementFinderBVH::on_mesh_changed_event(SignalArgs& args)
+{
+  if (is_null(m_dict) || !is_built())
+    return;
+
+  XML::SignalOptions options(args);
+  const URI mesh_uri = options.value<URI>("mesh_uri");
+
+  // Elements or nodes may have been renumbered or moved, so the tree is rebuilt at the next query
+  Handle<Mesh> mesh = find_parent_component_ptr<Mesh>(*m_dict);
+  if (is_not_null(mesh) && mesh->uri() == mesh_uri)
+    trigger_dict();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ElementFinderBVH::build()
+{
+  if (is_null(m_dict))
+    throw SetupError(FromHere(),"Option \"dict\" has not been configured for "+uri().string());
+
+  Handle<Mesh> mesh = find_parent_component_ptr<Mesh>(*m_dict);
+  if (is_null(mesh))
+    throw SetupError(FromHere(),"Mesh was not found as parent of "+m_dict->uri().string());
+
+  if (m_leaf_size == 0)
+    throw BadValue(FromHere(),"Option \"leaf_size\" of "+uri().string()+" must be at least 1");
+
+  trigger_dict();
+  m_dim = mesh->dimension();
+  m_point.resize(m_dim);
+
+  const Uint nb_elems = mesh->topology().recursive_filtered_elements_count(IsElementsVolume(),true);
+  m_items.reserve(nb_elems);
+  m_item_boxes.reserve(6*nb_elems);
+  m_centroids.reserve(3*nb_elems);
+
+  RealVector centroid(m_dim);
+  boost_foreach (Elements& elements, find_components_recursively_with_filter<Elements>(*mesh,IsElementsVolume()))
+  {
+    const Space& geometry_space = elements.geometry_space();
+    geometry_space.allocate_coordinates(m_coordinates);
+    const Uint nb_elements = elements.size();
+    for (Uint elem_idx=0; elem_idx<nb_elements; ++elem_idx)
+    {
+      geometry_space.put_coordinates(m_coordinates,elem_idx);
+      elements.element_type().compute_centroid(m_coordinates,centroid);
+      m_items.push_back(Entity(elements,elem_idx));
+
+      // Boxes get a small margin, so points on the element boundaries are not missed due to round-off
+      const RealVector min_coord = m_coordinates.colwise().minCoeff().transpose();
+      const RealVector max_coord = m_coordinates.colwise().maxCoeff().transpose();
+      const Real margin = 1e-8 * (max_coord - min_coord).maxCoeff();
+      for (Uint d=0; d<3; ++d)
+        m_item_boxes.push_back(d < m_dim ? min_coord[d] - margin : 0.);
+      for (Uint d=0; d<3; ++d)
+        m_item_boxes.push_back(d < m_dim ? max_coord[d] + margin : 0.);
+      for (Uint d=0; d<3; ++d)
+        m_centroids.push_back(d < m_dim ? centroid[d] : 0.);
+    }
+  }
+
+  const Uint nb_items = m_items.size();
+  m_order.resize(nb_items);
+  for (Uint i=0; i<nb_items; ++i)
+    m_order[i] = i;
+
+  m_nodes.reserve(2*(nb_items/m_leaf_size + 1));
+  m_nodes.resize(1);
+  build_node(0, 0, nb_items);
+
+  // Store the items in tree order, so each node covers a contiguous range
+  std::vector<Entity> items(nb_items);
+  std::vector<Real> item_boxes(6*nb_items);
+  std::vector<Real> centroids(3*nb_items);
+  for (Uint i=0; i<nb_items; ++i)
+  {
+    const Uint j = m_order[i];
+    items[i] = m_items[j];
+    std::copy(m_item_boxes.begin() + 6*j, m_item_boxes.begin() + 6*(j+1), item_boxes.begin() + 6*i);
+    std::copy(m_centroids.begin() + 3*j, m_centroids.begin() + 3*(j+1), centroids.begin() + 3*i);
+  }
+  m_items.swap(items);
+  m_item_boxes.swap(item_boxes);
+  m_centroids.swap(centroids);
+  std::vector<Uint>().swap(m_order);
+
+  CFdebug << "ElementFinderBVH: " << nb_items << " elements in " << m_nodes.size() << " nodes, using " << memory_size() << " bytes" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ElementFinderBVH::build_node(const Uint node_idx, const Uint begin, const Uint end)
+{
+  Node node;
+  node.begin = begin;
+  node.end = end;
+  node.first_child = 0;
+
+  Real centroid_min[3];
+  Real centroid_max[3];
+  for (Uint d=0; d<3; ++d)
+  {
+    const bool is_used = d < m_dim;
+    node.min[d] = is_used ? math::Consts::real_max() : 0.;
+    node.max[d] = is_used ? -math::Consts::real_max() : 0.;
+    centroid_min[d] = node.min[d];
+    centroid_max[d] = node.max[d];
+  }
+
+  for (Uint i=begin; i!=end; ++i)
+  {
+    const Uint item = m_order[i];
+    const Real* box = &m_item_boxes[6*item];
+    const Real* centroid = &m_centroids[3*item];
+    for (Uint d=0; d<m_dim; ++d)
+    {
+      node.min[d] = std::min(node.min[d], box[d]);
+      node.max[d] = std::max(node.max[d], box[3+d]);
+      centroid_min[d] = std::min(centroid_min[d], centroid[d]);
+      centroid_max[d] = std::max(centroid_max[d], centroid[d]);
+    }
+  }
+
+  // Split along the largest extent of the centroids
+  Uint axis = 0;
+  Real extent = 0.;
+  for (Uint d=0; d<m_dim; ++d)
+  {
+    if (centroid_max[d] - centroid_min[d] > extent)
+    {
+      extent = centroid_max[d] - centroid_min[d];
+      axis = d;
+    }
+  }
+
+  if (end - begin <= m_leaf_size || extent <= 0.)
+  {
+    m_nodes[node_idx] = node;
+    return;
+  }
+
+  const Uint mid = begin + (end - begin) / 2;
+  std::nth_element(m_order.begin() + begin, m_order.begin() + mid, m_order.begin() + end, detail::CentroidLess(m_centroids, axis));
+
+  node.first_child = m_nodes.size();
+  m_nodes[node_idx] = node;
+  m_nodes.resize(node.first_child + 2);
+  build_node(node.first_child, begin, mid);
+  build_node(node.first_child + 1, mid, end);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ElementFinderBVH::item_contains_point(const Uint item)
+{
+  const Real* box = &m_item_boxes[6*item];
+  if (!detail::box_contains(box, box+3, m_point, m_dim))
+    return false;
+
+  const Entity& entity = m_items[item];
+  entity.allocate_coordinates(m_coordinates);
+  entity.put_coordinates(m_coordinates);
+  return entity.element_type().is_coord_in_element(m_point, m_coordinates);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ElementFinderBVH::find_in_tree(Uint& item)
+{
+  m_stack.clear();
+  m_stack.push_back(0);
+  while (!m_stack.empty())
+  {
+    const Node& node = m_nodes[m_stack.back()];
+    m_stack.pop_back();
+    if (!detail::box_contains(node.min, node.max, m_point, m_dim))
+      continue;
+
+    if (node.first_child == 0)
+    {
+      for (Uint i=node.begin; i!=node.end; ++i)
+      {
+        if (item_contains_point(i))
+        {
+          item = i;
+          return true;
+        }
+      }
+    }
+    else
+    {
+      m_stack.push_back(node.first_child + 1);
+      m_stack.push_back(node.first_child);
+    }
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ElementFinderBVH::find_closest(Uint& item)
+{
+  Real min_distance2 = math::Consts::real_max();
+  bool found = false;
+
+  m_stack.clear();
+  m_stack.push_back(0);
+  while (!m_stack.empty())
+  {
+    const Node& node = m_nodes[m_stack.back()];
+    m_stack.pop_back();
+    // The centroids are inside the node box, so they can't be closer than the box
+    if (node.begin == node.end || detail::box_distance2(node.min, node.max, m_point, m_dim) >= min_distance2)
+      continue;
+
+    if (node.first_child == 0)
+    {
+      for (Uint i=node.begin; i!=node.end; ++i)
+      {
+        const Real* centroid = &m_centroids[3*i];
+        Real distance2 = 0.;
+        for (Uint d=0; d<m_dim; ++d)
+          distance2 += (centroid[d] - m_point[d]) * (centroid[d] - m_point[d]);
+        if (distance2 < min_distance2)
+        {
+          min_distance2 = distance2;
+          item = i;
+          found = true;
+        }
+      }
+    }
+    else
+    {
+      // Visit the nearest child first, so more of the other one gets pruned
+      const Node& first = m_nodes[node.first_child];
+      const Node& second = m_nodes[node.first_child + 1];
+      const bool first_is_nearest = detail::box_distance2(first.min, first.max, m_point, m_dim) <= detail::box_distance2(second.min, second.max, m_point, m_dim);
+      m_stack.push_back(first_is_nearest ? node.first_child + 1 : node.first_child);
+      m_stack.push_back(first_is_nearest ? node.first_child : node.first_child + 1);
+    }
+  }
+  return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SpaceElem ElementFinderBVH::space_elem(const Uint item) const
+{
+  const Entity& entity = m_items[item];
+  return SpaceElem(*const_cast<Space*>(&m_dict->space(*entity.comp)),entity.idx);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ElementFinderBVH::find_element(const RealVector& target_coord, SpaceElem& element)
+{
+  if (!is_built())
+    build();
+
+  cf3_assert(target_coord.size() >= m_dim);
+  for (Uint d=0; d<m_dim; ++d)
+    m_point[d] = target_coord[d];
+
+  Uint item = 0;
+  if (find_in_tree(item) || (m_closest && find_closest(item)))
+  {
+    element = space_elem(item);
+    return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint ElementFinderBVH::find_elements(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found)
+{
+  if (!is_built())
+    build();
+
+  const Uint nb_coords = coordinates.rows();
+  elements.resize(nb_coords);
+  found.assign(nb_coords, false);
+  if (nb_coords == 0 || m_dim == 0)
+    return 0;
+
+  cf3_assert(coordinates.cols() >= m_dim);
+
+  // Order the queries along a Hilbert curve through their bounding box, using 10 bits per coordinate
+  const Uint nb_bits = 10;
+  const Real nb_cells = static_cast<Real>((1u << nb_bits) - 1u);
+  const RealVector coords_min = coordinates.leftCols(m_dim).colwise().minCoeff().transpose();
+  const RealVector coords_max = coordinates.leftCols(m_dim).colwise().maxCoeff().transpose();
+  RealVector scale(m_dim);
+  for (Uint d=0; d<m_dim; ++d)
+    scale[d] = coords_max[d] > coords_min[d] ? nb_cells / (coords_max[d] - coords_min[d]) : 0.;
+  std::vector< std::pair<boost::uint64_t, Uint> > keys(nb_coords);
+  boost::uint32_t X[3];
+  for (Uint i=0; i<nb_coords; ++i)
+  {
+    for (Uint d=0; d<m_dim; ++d)
+      X[d] = static_cast<boost::uint32_t>((coordinates(i,d) - coords_min[d]) * scale[d]);
+    keys[i] = std::make_pair(detail::hilbert_key(X, m_dim, nb_bits), i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  Uint nb_found = 0;
+  bool has_last_item = false;
+  Uint last_item = 0;
+  for (Uint k=0; k<nb_coords; ++k)
+  {
+    const Uint i = keys[k].second;
+    for (Uint d=0; d<m_dim; ++d)
+      m_point[d] = coordinates(i,d);
+
+    // Neighbouring queries often end up in the same element
+    Uint item = last_item;
+    const bool is_found = (has_last_item && item_contains_point(last_item)) || find_in_tree(item) || (m_closest && find_closest(item));
+    if (is_found)
+    {
+      elements[i] = space_elem(item);
+      found[i] = true;
+      ++nb_found;
+      last_item = item;
+      has_last_item = true;
+    }
+  }
+
+  return nb_found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint ElementFinderBVH::memory_size() const
+{
+  return m_nodes.capacity()*sizeof(Node)
+       + m_items.capacity()*sizeof(Entity)
+       + (m_item_boxes.capacity() + m_centroids.capacity())*sizeof(Real);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
@@ -0,0 +1,139 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_ElementFinderBVH_hpp
+#define cf3_mesh_ElementFinderBVH_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/ElementFinder.hpp"
+#include "mesh/Entities.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Find elements using a bounding volume hierarchy
+///
+/// The volume elements of the mesh are stored in a binary tree of axis-aligned bounding boxes, built by splitting
+/// each node at the median element centroid along its largest extent. Unlike the uniform grid of the Octtree, the
+/// memory use is linear in the number of elements and the search depth does not depend on the grading of the mesh.
+/// The tree is built at the first query, and rebuilt at the next query after the dictionary option is set again
+/// or the mesh raises the mesh_changed event.
+class Mesh_API ElementFinderBVH : public ElementFinder
+{
+public:
+
+  /// @brief type name
+  static std::string type_name() {return "ElementFinderBVH"; }
+
+  /// @brief Constructor
+  ElementFinderBVH(const std::string& name);
+
+  /// @brief Destructor, disconnects from the mesh_changed event
+  virtual ~ElementFinderBVH();
+
+  virtual bool find_element(const RealVector& target_coord, SpaceElem& element);
+
+  /// Queries are processed in the order of the Hilbert key of the coordinates, so consecutive queries
+  /// visit the same parts of the tree and often end up in the element that was found last.
+  virtual Uint find_elements(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found);
+
+  /// Build the hierarchy for the volume elements of the mesh that holds the dictionary
+  void build();
+
+  /// True if the hierarchy is built
+  bool is_built() const { return !m_nodes.empty(); }
+
+  /// Number of nodes in the hierarchy
+  Uint nb_nodes() const { return m_nodes.size(); }
+
+  /// Memory used by the hierarchy, in bytes
+  Uint memory_size() const;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+
+  /// Node of the hierarchy, covering the elements in the range [begin, end) of m_items
+  struct Node
+  {
+    Real min[3];
+    Real max[3];
+    Uint begin;
+    Uint end;
+    /// Index of the first child, the second child directly follows it. Zero for leaves, since the root is never a child.
+    Uint first_child;
+  };
+
+  /// Called when the dictionary changes
+  void trigger_dict();
+
+  /// Drop the tree when the mesh of the dictionary changes
+  void on_mesh_changed_event(common::SignalArgs& args);
+
+  /// Fill in node node_idx for the items in [begin, end) of m_order, and recurse into its children
+  void build_node(const Uint node_idx, const Uint begin, const Uint end);
+
+  /// Find the element containing m_point, by descending the tree
+  bool find_in_tree(Uint& item);
+
+  /// Find the element with the centroid closest to m_point
+  bool find_closest(Uint& item);
+
+  /// True if item contains m_point
+  bool item_contains_point(const Uint item);
+
+  /// Convert the found item to a SpaceElem of the configured dictionary
+  SpaceElem space_elem(const Uint item) const;
+
+private:
+
+  /// Allow points that lie outside all elements, returning the closest element
+  bool m_closest;
+
+  /// Maximum number of elements in a leaf
+  Uint m_leaf_size;
+
+  /// Dimension of the mesh
+  Uint m_dim;
+
+  /// Nodes of the tree, with the root at index 0
+  std::vector<Node> m_nodes;
+
+  /// The elements, ordered so each node covers a contiguous range
+  std::vector<Entity> m_items;
+
+  /// Bounding boxes of the elements, stored as min followed by max, using 3 components each
+  std::vector<Real> m_item_boxes;
+
+  /// Centroids of the elements, using 3 components each
+  std::vector<Real> m_centroids;
+
+  /// Ordering of the items during the build
+  std::vector<Uint> m_order;
+
+  /// Stack of nodes to visit
+  std::vector<Uint> m_stack;
+
+  /// Coordinate that is searched
+  RealVector m_point;
+
+  /// Element coordinates
+  RealMatrix m_coordinates;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_ElementFinderBVH_hpp
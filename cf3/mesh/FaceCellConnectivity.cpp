@@ -4,6 +4,11 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+
+#include "common/BasicExceptions.hpp"
 #include "common/Log.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
@@ -17,6 +22,7 @@
 #include "math/Consts.hpp"
 
 #include "mesh/FaceCellConnectivity.hpp"
+#include "mesh/FaceHashTable.hpp"
 #include "mesh/NodeElementConnectivity.hpp"
 #include "mesh/Dictionary.hpp"
 #include "mesh/Mesh.hpp"
@@ -39,16 +45,92 @@ common::ComponentBuilder < FaceCellConnectivity , Component, LibMesh > FaceCellC
 
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+
+/// Computes the sorted nodes and their hash for each face of the elements in the range [begin, end), run by each thread
+struct FaceKeyLoop
+{
+  FaceKeyLoop(const Elements& elements,
+              const common::List<bool>* is_bdry_elem,
+              const std::vector<Uint>& face_offsets,
+              std::vector<Uint>& sorted_face_nodes,
+              std::vector<std::size_t>& face_hashes,
+              const Uint begin,
+              const Uint end,
+              std::string& error) :
+    m_elements(elements),
+    m_is_bdry_elem(is_bdry_elem),
+    m_face_offsets(face_offsets),
+    m_sorted_face_nodes(sorted_face_nodes),
+    m_face_hashes(face_hashes),
+    m_begin(begin),
+    m_end(end),
+    m_error(error)
+  {
+  }
+
+  void operator()()
+  {
+    try
+    {
+      const ElementType& etype = m_elements.element_type();
+      const Connectivity& connectivity = m_elements.geometry_space().connectivity();
+      const Uint nb_faces_in_elem = etype.nb_faces();
+      const Uint nb_nodes_in_faces = m_face_offsets.back();
+      for(Uint e = m_begin; e != m_end; ++e)
+      {
+        if(is_not_null(m_is_bdry_elem) && (*m_is_bdry_elem)[e] == false)
+          continue;
+
+        Connectivity::ConstRow elem_nodes = connectivity[e];
+        for(Uint face_idx = 0; face_idx != nb_faces_in_elem; ++face_idx)
+        {
+          Uint* key = &m_sorted_face_nodes[e*nb_nodes_in_faces + m_face_offsets[face_idx]];
+          Uint i = 0;
+          boost_foreach(const Uint face_node_idx, etype.faces().nodes_range(face_idx))
+            key[i++] = elem_nodes[face_node_idx];
+          std::sort(key, key + i);
+          m_face_hashes[e*nb_faces_in_elem + face_idx] = FaceHashTable::hash(key, i);
+        }
+      }
+    }
+    catch(std::exception& e)
+    {
+      m_error = e.what();
+    }
+  }
+
+  const Elements& m_elements;
+  const common::List<bool>* m_is_bdry_elem;
+  const std::vector<Uint>& m_face_offsets;
+  std::vector<Uint>& m_sorted_face_nodes;
+  std::vector<std::size_t>& m_face_hashes;
+  const Uint m_begin;
+  const Uint m_end;
+  std::string& m_error;
+};
+
+} // detail
+
+////////////////////////////////////////////////////////////////////////////////
+
 FaceCellConnectivity::FaceCellConnectivity ( const std::string& name ) :
   Component(name),
   m_nb_faces(0),
-  m_face_building_algorithm(false)
+  m_face_building_algorithm(false),
+  m_nb_threads(1)
 {
 
   options().add("face_building_algorithm", m_face_building_algorithm)
       .link_to(&m_face_building_algorithm)
       .description("Improves efficiency for face building algorithm");
 
+  options().add("nb_threads", m_nb_threads)
+      .link_to(&m_nb_threads)
+      .pretty_name("Number of Threads")
+      .description("Number of threads used to compute the face keys of each element type");
+
   m_used_components = create_static_component<Group>("used_components");
   m_connectivity = create_static_component<common::Table<Entity> >(mesh::Tags::connectivity_table());
   m_face_nb_in_elem = create_static_component<common::Table<Uint> >("face_number");
@@ -117,26 +199,15 @@ void FaceCellConnectivity::build_connectivity()
     return;
   }
 
-  // declartions
-  m_connectivity->resize(0);
-  common::Table<Entity>::Buffer f2c = m_connectivity->create_buffer();
-  common::Table<Uint>::Buffer face_number = m_face_nb_in_elem->create_buffer();
-  common::List<bool>::Buffer is_bdry_face = m_is_bdry_face->create_buffer();
-  common::Table<Uint>::Buffer cell_rotation = m_cell_rotation->create_buffer();
-  common::Table<bool>::Buffer cell_orientation = m_cell_orientation->create_buffer();
-
-  Dictionary& geometry_fields = find_parent_component<Mesh>(*used()[0]).geometry_fields();
-  Uint tot_nb_nodes = geometry_fields.size();
-  std::vector < std::vector<Uint> > mapNodeFace(tot_nb_nodes);
-  std::vector<Uint> face_nodes;  face_nodes.reserve(100);
-  std::vector<Entity> dummy_element_row(2);
-  std::vector<Uint> tmp_row(2);
+  std::vector< Handle<Elements> > used_elements;
+  boost_foreach ( Handle< Component > elements_comp, used() )
+    used_elements.push_back(Handle<Elements>(elements_comp));
+
   Uint max_nb_faces(0);
 
   // calculate max_nb_faces
-  boost_foreach ( Handle< Component > elements_comp, used() )
+  boost_foreach ( const Handle<Elements>& elements, used_elements )
   {
-    Handle<Elements> elements(elements_comp);
     if (elements->element_type().dimensionality() != elements->element_type().dimension() )
       continue;
     const Uint nb_faces = elements->element_type().nb_faces();
@@ -147,9 +218,9 @@ void FaceCellConnectivity::build_connectivity()
   {
     // allocate storage if doesn't exist that says if the element is at the boundary of a region
     // ( = not the same as the mesh boundary)
-    boost_foreach (Handle< Component > elements_comp, used())
+    boost_foreach ( const Handle<Elements>& elements_handle, used_elements )
     {
-      Elements& elements = dynamic_cast<Elements&>(*elements_comp);
+      Elements& elements = *elements_handle;
       Handle< Component > comp = elements.get_child("is_bdry");
       if ( is_null( comp ) || is_null(Handle< common::List<bool> >(comp)) )
       {
@@ -165,178 +236,134 @@ void FaceCellConnectivity::build_connectivity()
     }
   }
 
-  // Declarations to save frequent allocations in the loop algorithm
-  Uint nb_inner_faces = 0;
-  Uint nb_matched_nodes = 1;
-  Uint face_node_idx;
-  Uint face_node;
-  Uint face;
-  Uint connected_face;
-  Uint node;
-  Uint nb_nodes;
-  bool found_face = false;
-  Handle< Component > elem_location_comp;
-  Uint elem_location_idx;
-
-  // loop over the element types
-  m_nb_faces=0;
-  boost_foreach (Handle< Component > elements_comp, used() )
+  // Compute the sorted nodes of every face of every element, and their hashes, in parallel
+  const Uint nb_types = used_elements.size();
+  std::vector< std::vector<Uint> > sorted_face_nodes(nb_types);
+  std::vector< std::vector<std::size_t> > face_hashes(nb_types);
+  std::vector< std::vector<Uint> > face_offsets(nb_types);
+  std::vector< Handle< common::List<bool> > > is_bdry_elems(nb_types);
+  for (Uint t=0; t<nb_types; ++t)
   {
-    Elements& elements = dynamic_cast<Elements&>(*elements_comp);
+    Elements& elements = *used_elements[t];
     const Uint nb_faces_in_elem = elements.element_type().nb_faces();
-
-    Handle< common::List<bool> > is_bdry_elem;
-
+    face_offsets[t].resize(nb_faces_in_elem+1, 0);
+    for (Uint face_idx=0; face_idx<nb_faces_in_elem; ++face_idx)
+      face_offsets[t][face_idx+1] = face_offsets[t][face_idx] + elements.element_type().face_type(face_idx).nb_nodes();
+    sorted_face_nodes[t].resize(elements.size()*face_offsets[t].back());
+    face_hashes[t].resize(elements.size()*nb_faces_in_elem);
     if (m_face_building_algorithm)
-      is_bdry_elem = Handle< common::List<bool> >(elements.get_child("is_bdry"));
-
-    // loop over the elements of this type
-    Uint loc_elem_idx=0;
-    boost_foreach(Connectivity::ConstRow elem_nodes, elements.geometry_space().connectivity().array() )
+      is_bdry_elems[t] = Handle< common::List<bool> >(elements.get_child("is_bdry"));
+
+    const Uint nb_elems = elements.size();
+    const Uint nb_threads = std::max(1u, std::min(m_nb_threads, nb_elems));
+    std::vector<std::string> errors(nb_threads);
+    boost::thread_group threads;
+    for(Uint i = 1; i < nb_threads; ++i)
+      threads.create_thread(detail::FaceKeyLoop(elements, is_bdry_elems[t].get(), face_offsets[t], sorted_face_nodes[t], face_hashes[t], (nb_elems * i) / nb_threads, (nb_elems * (i+1)) / nb_threads, errors[i]));
+    detail::FaceKeyLoop(elements, is_bdry_elems[t].get(), face_offsets[t], sorted_face_nodes[t], face_hashes[t], 0, nb_elems / nb_threads, errors[0])();
+    threads.join_all();
+
+    for(Uint i = 0; i != nb_threads; ++i)
     {
-      if ( is_not_null(is_bdry_elem) )
-        if ( (*is_bdry_elem)[loc_elem_idx] == false )
-          continue;
+      if(!errors[i].empty())
+        throw common::ParallelError(FromHere(), "Error in face building thread " + common::to_str(i) + ": " + errors[i]);
+    }
+  }
 
-      Entity element(elements,loc_elem_idx);
+  // Match the faces in element order, so the face numbering does not depend on the number of threads
+  FaceHashTable face_table(max_nb_faces/2);
+  std::vector<Entity> left_cells, right_cells;
+  std::vector<Uint> left_face_nb, right_face_nb, right_rotation, first_nodes;
+  left_cells.reserve(max_nb_faces);
+  left_face_nb.reserve(max_nb_faces);
+  first_nodes.reserve(max_nb_faces);
+  Uint nb_inner_faces = 0;
+  m_nb_faces=0;
+  for (Uint t=0; t<nb_types; ++t)
+  {
+    const Elements& elements = *used_elements[t];
+    const ElementType& etype = elements.element_type();
+    const Connectivity& elem_connectivity = elements.geometry_space().connectivity();
+    const Uint nb_faces_in_elem = etype.nb_faces();
+    const Uint nb_nodes_in_faces = face_offsets[t].back();
+    const Uint nb_elems = elements.size();
+
+    for (Uint e=0; e<nb_elems; ++e)
+    {
+      if ( is_not_null(is_bdry_elems[t]) && (*is_bdry_elems[t])[e] == false )
+        continue;
 
-      // loop over the faces in the current element
+      Connectivity::ConstRow elem_nodes = elem_connectivity[e];
       for (Uint face_idx = 0; face_idx != nb_faces_in_elem; ++face_idx)
       {
-        // construct sets of nodes that make the corresponding face in this element
-        nb_nodes = elements.element_type().face_type(face_idx).nb_nodes();
-        face_nodes.resize(nb_nodes);
-
-        Uint i(0);
-        boost_foreach(const Uint face_node_idx, elements.element_type().faces().nodes_range(face_idx))
-            face_nodes[i++] = elem_nodes[face_node_idx];
+        const Uint nb_nodes = face_offsets[t][face_idx+1] - face_offsets[t][face_idx];
+        const Uint* key = &sorted_face_nodes[t][e*nb_nodes_in_faces + face_offsets[t][face_idx]];
+        const Uint face = face_table.insert(key, nb_nodes, m_nb_faces, face_hashes[t][e*nb_faces_in_elem + face_idx]);
+        const ElementType::FaceConnectivity::RangeT local_face_nodes = etype.faces().nodes_range(face_idx);
 
-
-        // consider the first node belonging to the current face
-        // check if you find a face ID shared between all the other
-        // nodes building a face
-        node = face_nodes[0];
-        cf3_assert(node<tot_nb_nodes);
-
-        found_face = false;
-        // search for matching face if they are registered to the node yet
-        boost_foreach( face, mapNodeFace[node] )
+        if (face == m_nb_faces)
         {
-          nb_matched_nodes = 1;
-          if (nb_nodes > 1)
-          {
-            for (face_node_idx=1; face_node_idx!=nb_nodes; ++face_node_idx)
-            {
-              boost_foreach (connected_face, mapNodeFace[face_nodes[face_node_idx]])
-              {
-                if (connected_face == face)
-                {
-                  ++nb_matched_nodes;
-                  break;
-                }
-              }
-
-
-              if (nb_matched_nodes == nb_nodes) // face matches the nodes
-              {
-                // the corresponding face already exists, meaning
-                // that the face is an internal one, shared by two elements
-                // here you set the second element (==state) neighbor of the face
-                found_face = true;
-                f2c.get_row(face)[1]=element;
-                face_number.get_row(face)[1]=face_idx;
-                // since it has two neighbor cells,
-                // this face is surely NOT a boundary face
-                is_bdry_face.get_row(face)=false;
-
-                // First node in first face element:
-                Uint first_node_loc_idx = f2c.get_row(face)[0].get_nodes()[
-                                            f2c.get_row(face)[0].element_type().faces().nodes_range(
-                                              face_number.get_row(face)[0])[0]
-                                          ];
-
-                // Find orientation ( or find match between first face-nodes of both neighbouring elements )
-                Uint rotation;
-                for (rotation=0; rotation<=nb_nodes; ++rotation)
-                {
-                  if (face_nodes[rotation] == first_node_loc_idx)
-                  {
-                    cell_rotation.get_row(face)[1]=rotation;
-                    break;
-                  }
-                }
-                // Following assertion fails, it means the correct orientation was not found! This should never happen!
-                cf3_always_assert(rotation != nb_nodes);
-
-                // increment number of inner faces (they always have 2 states)
-                ++nb_inner_faces;
-                break;
-              }
-            }
-          }
-          else // this only applies to the 1D case
-          {
-            // the corresponding faceID already exists, meaning
-            // that the face is an internal one, shared by two elements
-            // here you set the second element (==state) neighbor of the face
-            found_face = true;
-            //(*elem_to_face)[elemID][iFace] = currFaceID;
-            f2c.get_row(face)[1]=element;
-            face_number.get_row(face)[1]=face_idx;
-            is_bdry_face.get_row(face)=false;
-
-            // increment number of inner faces (they always have 2 states)
-            ++nb_inner_faces;
-            break;
-          }
+          // a new face has been found
+          left_cells.push_back(Entity(elements,e));
+          left_face_nb.push_back(face_idx);
+          first_nodes.push_back(elem_nodes[local_face_nodes[0]]);
+          right_cells.push_back(Entity());
+          right_face_nb.push_back(0);
+          right_rotation.push_back(0);
+          ++m_nb_faces;
         }
-        if (found_face == false)
+        else
         {
-          // a new face has been found
-          // add the ID of the new face in the corresponding nodes
-          // referencing it
-          boost_foreach (face_node, face_nodes)
+          // the corresponding face already exists, meaning
+          // that the face is an internal one, shared by two elements
+          right_cells[face] = Entity(elements,e);
+          right_face_nb[face] = face_idx;
+
+          // Find orientation ( or find match between first face-nodes of both neighbouring elements )
+          Uint rotation;
+          for (rotation=0; rotation<nb_nodes; ++rotation)
           {
-            mapNodeFace[face_node].push_back(m_nb_faces);
+            if (elem_nodes[local_face_nodes[rotation]] == first_nodes[face])
+            {
+              right_rotation[face]=rotation;
+              break;
+            }
           }
+          // Following assertion fails, it means the correct orientation was not found! This should never happen!
+          cf3_always_assert(rotation != nb_nodes);
 
-          // increment the number of faces
-          dummy_element_row[0]=element;
-          f2c.add_row(dummy_element_row);
-
-          tmp_row[0]=face_idx;
-          face_number.add_row(tmp_row);
-          tmp_row[0] = MATCHED;
-          tmp_row[1] = INVERTED;
-          cell_orientation.add_row(tmp_row);
-          tmp_row[0] = 0;
-          tmp_row[1] = 0;
-          cell_rotation.add_row(tmp_row);
-          is_bdry_face.add_row(true);
-          ++m_nb_faces;
+          // increment number of inner faces (they always have 2 states)
+          ++nb_inner_faces;
         }
       }
-      ++loc_elem_idx;
     } // end foreach element
   } // end foreach elements component
 
-  f2c.flush();
-  face_number.flush();
-  is_bdry_face.flush();
-  cell_rotation.flush();
-  cell_orientation.flush();
+  // Write the tables directly, now their size is known
+  m_connectivity->resize(m_nb_faces);
+  m_face_nb_in_elem->resize(m_nb_faces);
+  m_is_bdry_face->resize(m_nb_faces);
+  m_cell_rotation->resize(m_nb_faces);
+  m_cell_orientation->resize(m_nb_faces);
+  for (Uint f=0; f<m_nb_faces; ++f)
+  {
+    (*m_connectivity)[f][0] = left_cells[f];
+    (*m_connectivity)[f][1] = right_cells[f];
+    (*m_face_nb_in_elem)[f][0] = left_face_nb[f];
+    (*m_face_nb_in_elem)[f][1] = right_face_nb[f];
+    (*m_is_bdry_face)[f] = is_null(right_cells[f].comp);
+    (*m_cell_rotation)[f][0] = 0;
+    (*m_cell_rotation)[f][1] = right_rotation[f];
+    (*m_cell_orientation)[f][0] = MATCHED;
+    (*m_cell_orientation)[f][1] = INVERTED;
+  }
 
   // CFinfo << "Total nb faces [" << m_nb_faces << "]" << CFendl;
   // CFinfo << "Inner nb faces [" << nb_inner_faces << "]" << CFendl;
 
-  // total number of boundary + partition boundary faces
-  //const Uint nb_bdry_plus_partition_faces = m_nb_faces - nb_inner_faces;
-  //CFinfo << "Boundary and Partition faces [" << nb_bdry_plus_partition_faces << "]" << CFendl;
-
   cf3_assert(m_nb_faces <= max_nb_faces);
   cf3_assert(nb_inner_faces <= max_nb_faces);
 
-
   cf3_assert(m_nb_faces == m_connectivity->size());
 
   if (m_face_building_algorithm)
@@ -349,7 +376,7 @@ void FaceCellConnectivity::build_connectivity()
         if ( is_not_null(elem.comp) )
         {
           common::List<bool>& is_bdry_elem = *Handle< common::List<bool> >(elem.comp->get_child("is_bdry"));
-          is_bdry_elem[elem.idx] = is_bdry_elem[elem.idx] || is_bdry_face.get_row(f) ;
+          is_bdry_elem[elem.idx] = is_bdry_elem[elem.idx] || (*m_is_bdry_face)[f] ;
         }
       }
     }
@@ -60,7 +60,7 @@ public:
   void setup(Region& region);
 
   /// Build the connectivity table
-  /// Build the connectivity table as a DynTable<Uint>
+  /// Faces are matched by hashing their sorted nodes, and the tables are filled directly once the number of faces is known
   /// @pre set_nodes() and set_elements() must have been called
 
   void build_connectivity();
@@ -116,6 +116,9 @@ private: // data
 
   bool m_face_building_algorithm;
 
+  /// Number of threads used to compute the face keys
+  Uint m_nb_threads;
+
 }; // FaceCellConnectivity
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,109 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include <boost/cstdint.hpp>
+
+#include "math/Consts.hpp"
+
+#include "mesh/FaceHashTable.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+const Uint FaceHashTable::not_found = math::Consts::uint_max();
+
+FaceHashTable::FaceHashTable(const Uint nb_faces)
+{
+  // Keep the load factor below one half
+  Uint nb_slots = 16;
+  while(nb_slots < 2*nb_faces)
+    nb_slots *= 2;
+  m_slots.assign(nb_slots, not_found);
+  m_hashes.reserve(nb_faces);
+  m_offsets.reserve(nb_faces+1);
+  m_offsets.push_back(0);
+  m_values.reserve(nb_faces);
+}
+
+std::size_t FaceHashTable::hash(const Uint* sorted_nodes, const Uint nb_nodes)
+{
+  // Combine the nodes, and mix the result so the low bits used for the slots depend on all nodes
+  boost::uint64_t result = nb_nodes;
+  for(Uint i = 0; i != nb_nodes; ++i)
+    result = (result ^ sorted_nodes[i]) * 0x100000001b3ULL;
+  result ^= result >> 33;
+  result *= 0xff51afd7ed558ccdULL;
+  result ^= result >> 33;
+  return static_cast<std::size_t>(result);
+}
+
+Uint FaceHashTable::insert(const Uint* sorted_nodes, const Uint nb_nodes, const Uint value, const std::size_t node_hash)
+{
+  Uint slot = probe(sorted_nodes, nb_nodes, node_hash);
+  if(m_slots[slot] != not_found)
+    return m_values[m_slots[slot]];
+
+  if(2*(m_values.size()+1) > m_slots.size())
+  {
+    grow();
+    slot = probe(sorted_nodes, nb_nodes, node_hash);
+  }
+
+  m_slots[slot] = m_values.size();
+  m_hashes.push_back(node_hash);
+  m_nodes.insert(m_nodes.end(), sorted_nodes, sorted_nodes + nb_nodes);
+  m_offsets.push_back(m_nodes.size());
+  m_values.push_back(value);
+  return value;
+}
+
+Uint FaceHashTable::find(const Uint* sorted_nodes, const Uint nb_nodes, const std::size_t node_hash) const
+{
+  const Uint face = m_slots[probe(sorted_nodes, nb_nodes, node_hash)];
+  return face == not_found ? not_found : m_values[face];
+}
+
+Uint FaceHashTable::probe(const Uint* sorted_nodes, const Uint nb_nodes, const std::size_t node_hash) const
+{
+  const std::size_t mask = m_slots.size() - 1;
+  for(std::size_t slot = node_hash & mask; ; slot = (slot + 1) & mask)
+  {
+    const Uint face = m_slots[slot];
+    if(face == not_found)
+      return slot;
+    if(m_hashes[face] != node_hash || m_offsets[face+1] - m_offsets[face] != nb_nodes)
+      continue;
+    if(std::equal(sorted_nodes, sorted_nodes + nb_nodes, m_nodes.begin() + m_offsets[face]))
+      return slot;
+  }
+}
+
+void FaceHashTable::grow()
+{
+  m_slots.assign(2*m_slots.size(), not_found);
+  const std::size_t mask = m_slots.size() - 1;
+  const Uint nb_faces = m_values.size();
+  for(Uint face = 0; face != nb_faces; ++face)
+  {
+    std::size_t slot = m_hashes[face] & mask;
+    while(m_slots[slot] != not_found)
+      slot = (slot + 1) & mask;
+    m_slots[slot] = face;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
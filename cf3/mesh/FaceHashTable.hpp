@@ -0,0 +1,86 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_FaceHashTable_hpp
+#define cf3_mesh_FaceHashTable_hpp
+
+#include <cstddef>
+#include <vector>
+
+#include "mesh/LibMesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Open-addressing hash table that identifies faces by their sorted node indices,
+/// used to match the faces of neighbouring elements. Each face stores a single value,
+/// typically the index of the face. The keys are copied into one contiguous array,
+/// so no allocations are done per face.
+class Mesh_API FaceHashTable
+{
+public:
+
+  /// Value returned by find if the face is not in the table
+  static const Uint not_found;
+
+  /// @param [in] nb_faces  Expected number of faces. The table grows when more are inserted.
+  FaceHashTable(const Uint nb_faces = 0);
+
+  /// Hash for the given sorted nodes
+  static std::size_t hash(const Uint* sorted_nodes, const Uint nb_nodes);
+
+  /// Find the face with the given sorted nodes, inserting it with the given value if it is not present
+  /// @return the value stored for the face, which is value if the face was inserted
+  Uint insert(const Uint* sorted_nodes, const Uint nb_nodes, const Uint value) { return insert(sorted_nodes, nb_nodes, value, hash(sorted_nodes, nb_nodes)); }
+
+  /// Insert, with the hash computed beforehand
+  Uint insert(const Uint* sorted_nodes, const Uint nb_nodes, const Uint value, const std::size_t node_hash);
+
+  /// Find the value stored for the face with the given sorted nodes, or not_found
+  Uint find(const Uint* sorted_nodes, const Uint nb_nodes) const { return find(sorted_nodes, nb_nodes, hash(sorted_nodes, nb_nodes)); }
+
+  /// Find, with the hash computed beforehand
+  Uint find(const Uint* sorted_nodes, const Uint nb_nodes, const std::size_t node_hash) const;
+
+  /// Number of faces in the table
+  Uint size() const { return m_values.size(); }
+
+private:
+
+  /// Slot for the given key, which is either empty or holds the key
+  Uint probe(const Uint* sorted_nodes, const Uint nb_nodes, const std::size_t node_hash) const;
+
+  /// Double the number of slots
+  void grow();
+
+  /// Index of the face in each slot, or not_found for empty slots. The size is a power of two.
+  std::vector<Uint> m_slots;
+
+  /// Hash of each face
+  std::vector<std::size_t> m_hashes;
+
+  /// Start of the nodes of each face in m_nodes, with one extra entry for the end
+  std::vector<Uint> m_offsets;
+
+  /// Sorted nodes of all faces
+  std::vector<Uint> m_nodes;
+
+  /// Value for each face
+  std::vector<Uint> m_values;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_FaceHashTable_hpp
@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/date_time/gregorian/gregorian.hpp>
 
 #include "common/Signal.hpp"
@@ -176,6 +178,69 @@ void Field::synchronize()
   m_comm_pattern->synchronize( name() );
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+void Field::start_synchronize()
+{
+  if(!common::PE::Comm::instance().is_active())
+    return;
+
+  if(is_null(m_comm_pattern))
+  {
+    CFdebug << "Applying default parallelization from dict for field " << uri().path() << CFendl;
+    parallelize();
+  }
+
+  cf3_assert(is_not_null(m_comm_pattern));
+  m_comm_pattern->start_synchronize( name() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Field::finish_synchronize()
+{
+  if(!common::PE::Comm::instance().is_active())
+    return;
+
+  cf3_assert(is_not_null(m_comm_pattern));
+  m_comm_pattern->finish_synchronize( name() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Field::synchronize_fields(const std::vector< Handle<Field> >& fields)
+{
+  if(!common::PE::Comm::instance().is_active())
+    return;
+
+  // Group the field names per comm pattern, keeping the order in which the patterns are first seen
+  std::vector<CommPattern*> patterns;
+  std::vector< std::vector<std::string> > names;
+  boost_foreach(const Handle<Field>& field, fields)
+  {
+    if(is_null(field))
+      continue;
+
+    if(is_null(field->m_comm_pattern))
+    {
+      CFdebug << "Applying default parallelization from dict for field " << field->uri().path() << CFendl;
+      field->parallelize();
+    }
+
+    CommPattern* pattern = field->m_comm_pattern.get();
+    const Uint idx = std::find(patterns.begin(), patterns.end(), pattern) - patterns.begin();
+    if(idx == patterns.size())
+    {
+      patterns.push_back(pattern);
+      names.push_back(std::vector<std::string>());
+    }
+    names[idx].push_back(field->name());
+  }
+
+  for(Uint i = 0; i != patterns.size(); ++i)
+    patterns[i]->synchronize_group(names[i]);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void Field::set_descriptor(math::VariablesDescriptor& descriptor)
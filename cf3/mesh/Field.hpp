@@ -124,6 +124,16 @@ public: // functions
 
   void synchronize();
 
+  /// Start a non-blocking synchronization, ghost values are only valid after finish_synchronize()
+  void start_synchronize();
+
+  /// Complete the synchronization started by start_synchronize()
+  void finish_synchronize();
+
+  /// Synchronize several fields at once, sending a single message per neighbouring rank for all fields sharing a CommPattern
+  /// @pre the order of the fields is the same on all ranks
+  static void synchronize_fields(const std::vector< Handle<Field> >& fields);
+
   math::VariablesDescriptor& descriptor() const { return *m_descriptor; }
 
   void set_descriptor(math::VariablesDescriptor& descriptor);
@@ -8,9 +8,13 @@
 #include "common/List.hpp"
 
 #include "mesh/Connectivity.hpp"
+#include "mesh/DataCache.hpp"
 #include "mesh/Dictionary.hpp"
 #include "mesh/Space.hpp"
 #include "mesh/Entities.hpp"
+#include "mesh/Functions.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Tags.hpp"
 
 namespace cf3 {
 namespace mesh {
@@ -128,5 +132,21 @@ boost::shared_ptr< common::List< Uint > > build_used_nodes_list( const Component
 
 ////////////////////////////////////////////////////////////////////////////////
 
+boost::shared_ptr< List< Uint > const > cached_used_nodes_list( const Component& node_user, const Dictionary& dictionary )
+{
+  DataCache& cache = find_parent_component<Mesh>(dictionary).cache();
+  const std::string key = "used_nodes:" + node_user.uri().path() + ":" + dictionary.uri().path();
+  boost::shared_ptr< List<Uint> const > used_nodes = cache.get< List<Uint> const >(key);
+  if(!used_nodes)
+  {
+    used_nodes = build_used_nodes_list(node_user, dictionary, true);
+    cache.set(key, used_nodes);
+  }
+
+  return used_nodes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
@@ -39,6 +39,14 @@ boost::shared_ptr< common::List< Uint > > build_used_nodes_list( const std::vect
 /// @return used_nodes  List of used nodes
 boost::shared_ptr< common::List< Uint > > build_used_nodes_list( const common::Component& node_user, const Dictionary& dictionary, const bool include_ghost_elems, const bool follow_periodic_links = true);
 
+/// cached_used_nodes_list
+/// @brief Get the nodes used by node_user, including ghost elements and periodic links, building the list only when needed
+/// The list is kept in the DataCache of the mesh that holds the dictionary, so it is rebuilt after Mesh::raise_mesh_changed.
+/// @param [in]  node_user   component being entities, or holding entities somewhere down in his tree
+/// @param [in]  dictionary  dictionary where the nodes are stored
+/// @return used_nodes  List of used nodes, shared with the cache
+boost::shared_ptr< common::List< Uint > const > cached_used_nodes_list( const common::Component& node_user, const Dictionary& dictionary );
+
 ////////////////////////////////////////////////////////////////////////////////
 
 } // mesh
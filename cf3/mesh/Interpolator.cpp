@@ -153,29 +153,29 @@ void Interpolator::store(const Dictionary& dict, const Table<Real>& target_coord
 
     std::vector<Uint> send_found_coords;  send_found_coords.reserve(nb_received_coords);
 
-    Uint dim = target_coords.row_size();
-    RealVector t_point(dim);
-    SpaceElem element;
-    std::vector<SpaceElem> stencil;
-    std::vector<Uint> points;
-    std::vector<Real> weights;
+    RealMatrix t_points(nb_received_coords,dim);
+    for (Uint t=0; t<nb_received_coords; ++t)
+    {
+      for (Uint d=0; d<dim; ++d)
+        t_points(t,d) = received_coords[t*dim+d];
+    }
+
+    // Find all received coordinates in one batch
+    std::vector<SpaceElem> elements;
+    std::vector<bool> found;
+    std::vector< std::vector<SpaceElem> > stencils;
+    std::vector< std::vector<Uint> > points;
+    std::vector< std::vector<Real> > weights;
+    m_point_interpolator->compute_storage(t_points, elements, found, stencils, points, weights);
 
     for (Uint t=0; t<nb_received_coords; ++t)
     {
-      t_point = RealVector::MapType(&received_coords[t*dim],dim);
-      bool interpolation_possible_on_this_proc =
-          m_point_interpolator->compute_storage(t_point,
-                                                element,
-                                                stencil,
-                                                points,
-                                                weights);
-
-      if (interpolation_possible_on_this_proc)
+      if (found[t])
       {
-        m_stored_element[pid_recv_coords].push_back(element);
-        m_stored_stencil[pid_recv_coords].push_back(stencil);
-        m_stored_source_field_points[pid_recv_coords].push_back(points);
-        m_stored_source_field_weights[pid_recv_coords].push_back(weights);
+        m_stored_element[pid_recv_coords].push_back(elements[t]);
+        m_stored_stencil[pid_recv_coords].push_back(stencils[t]);
+        m_stored_source_field_points[pid_recv_coords].push_back(points[t]);
+        m_stored_source_field_weights[pid_recv_coords].push_back(weights[t]);
 
         // mark found
         send_found_coords.push_back(t);
@@ -330,22 +330,34 @@ void Interpolator::unstored_interpolation(const Field& source_field, const commo
     // storage for interpolated variables, which will be sent to the pid that reqests it (pid_recv_interpolated)
     std::vector<Real> send_interpolated; send_interpolated.reserve(nb_received_coords*nb_vars);
 
-    Uint dim = target_coords.row_size();
-    RealVector t_point(dim);
-    RealVector t_val(source_field.row_size());
+    RealMatrix t_points(nb_received_coords,dim);
+    for (Uint t=0; t<nb_received_coords; ++t)
+    {
+      for (Uint d=0; d<dim; ++d)
+        t_points(t,d) = received_coords[t*dim+d];
+    }
+
+    // Find all received coordinates in one batch
+    std::vector<SpaceElem> elements;
+    std::vector<bool> found;
+    std::vector< std::vector<SpaceElem> > stencils;
+    std::vector< std::vector<Uint> > points;
+    std::vector< std::vector<Real> > weights;
+    m_point_interpolator->compute_storage(t_points, elements, found, stencils, points, weights);
 
     for (Uint t=0; t<nb_received_coords; ++t)
     {
-      t_point = RealVector::MapType(&received_coords[t*dim],dim);
-      bool interpolation_possible_on_this_proc =
-          m_point_interpolator->interpolate(source_field,t_point,t_val);
-      if (interpolation_possible_on_this_proc)
+      if (found[t])
       {
         // mark found
         send_found_coords.push_back(t);
 
         for (Uint v=0; v<nb_vars; ++v)
-          send_interpolated.push_back(t_val[ m_source_vars[v] ] );
+        {
+          send_interpolated.push_back(0.);
+          for (Uint s=0; s<points[t].size(); ++s)
+            send_interpolated.back() += source_field[ points[t][s] ][ m_source_vars[v] ] * weights[t][s];
+        }
       }
     }
 
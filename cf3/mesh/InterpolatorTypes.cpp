@@ -8,6 +8,7 @@
 
 #include "mesh/PointInterpolatorT.hpp"
 #include "mesh/Interpolator.hpp"
+#include "mesh/ElementFinderBVH.hpp"
 #include "mesh/ElementFinderOcttree.hpp"
 #include "mesh/StencilComputerOcttree.hpp"
 #include "mesh/StencilComputerRings.hpp"
@@ -45,5 +46,17 @@ ComponentBuilder< ShapeFunctionInterpolator , AInterpolator, LibMesh>
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// ShapeFunctionBVHPointInterpolator is a ShapeFunctionPointInterpolator that finds the elements using a bounding volume hierarchy
+typedef PointInterpolatorT<ElementFinderBVH,StencilComputerOneCell,ShapeFunctionInterpolation> ShapeFunctionBVHPointInterpolator;
+ComponentBuilder< ShapeFunctionBVHPointInterpolator , APointInterpolator, LibMesh>
+  ShapeFunctionBVHPointInterpolator_builder(LibMesh::library_namespace()+".ShapeFunctionBVHPointInterpolator");
+
+// ShapeFunctionBVHInterpolator using ShapeFunctionBVHPointInterpolator
+typedef InterpolatorT<ShapeFunctionBVHPointInterpolator> ShapeFunctionBVHInterpolator;
+ComponentBuilder< ShapeFunctionBVHInterpolator , AInterpolator, LibMesh>
+  ShapeFunctionBVHInterpolator_builder(LibMesh::library_namespace()+".ShapeFunctionBVHInterpolator");
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
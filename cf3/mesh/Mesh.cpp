@@ -49,6 +49,7 @@
 #include "mesh/Cells.hpp"
 #include "mesh/Faces.hpp"
 #include "mesh/BoundingBox.hpp"
+#include "mesh/DataCache.hpp"
 #include "mesh/Space.hpp"
 
 namespace cf3 {
@@ -66,7 +67,8 @@ Mesh::Mesh ( const std::string& name  ) :
   Component ( name ),
   m_dimension(0u),
   m_dimensionality(0u),
-  m_block_mesh_changed(false)
+  m_block_mesh_changed(false),
+  m_cache(new DataCache())
 {
   mark_basic(); // by default meshes are visible
 
@@ -506,6 +508,7 @@ void Mesh::raise_mesh_loaded()
 
 void Mesh::raise_mesh_changed()
 {
+  m_cache->clear();
   update_structures();
   update_statistics();
 
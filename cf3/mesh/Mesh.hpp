@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <boost/scoped_ptr.hpp>
+
 #include "common/Component.hpp"
 #include "mesh/LibMesh.hpp"
 #include "mesh/Dictionary.hpp"
@@ -25,6 +27,7 @@ namespace mesh {
   class MeshElements;
   class MeshMetadata;
   class BoundingBox;
+  class DataCache;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -100,6 +103,9 @@ public: // functions
   /// If true, block subsequent raise_mesh_changed event.
   void block_mesh_changed(const bool block);
 
+  /// Data derived from the mesh, cleared by raise_mesh_changed
+  DataCache& cache() const { return *m_cache; }
+
   const Handle<BoundingBox>& local_bounding_box()  const { return m_local_bounding_box; }
   const Handle<BoundingBox>& global_bounding_box() const { return m_global_bounding_box; }
 
@@ -124,6 +130,8 @@ private: // data
   
   bool m_block_mesh_changed;
 
+  boost::scoped_ptr<DataCache> m_cache;
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
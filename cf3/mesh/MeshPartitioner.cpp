@@ -4,6 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <set>
 
 #include "common/Foreach.hpp"
@@ -51,7 +52,7 @@ MeshPartitioner::MeshPartitioner ( const std::string& name ) :
       .link_to(&m_nb_parts)
       .mark_basic();
 
-  m_global_to_local = create_static_component<common::Map<Uint,Uint> >("global_to_local");
+  m_global_to_local = create_static_component<common::HashMap<Uint,Uint> >("global_to_local");
   m_lookup = create_static_component<UnifiedData >("lookup");
 
   regist_signal( "load_balance" )
@@ -227,7 +228,8 @@ void MeshPartitioner::build_global_to_local_index(Mesh& mesh)
   }
 
   const Uint tot_nb_obj = m_lookup->size();
-  m_global_to_local->reserve(tot_nb_obj);
+  std::vector< std::pair<Uint,Uint> > glb_to_loc;
+  glb_to_loc.reserve(tot_nb_obj);
   Uint loc_idx=0;
   //CFinfo << "adding nodes to map " << CFendl;
   boost_foreach (const Uint glb_idx, node_glb_idx.array())
@@ -249,7 +251,7 @@ void MeshPartitioner::build_global_to_local_index(Mesh& mesh)
                 glb_idx <= m_end_node_per_part[PE::Comm::instance().rank()]);
     }
 
-    m_global_to_local->push_back(glb_idx,loc_idx++);
+    glb_to_loc.push_back(std::make_pair(glb_idx,loc_idx++));
   }
 
   //CFinfo << "adding elements " << CFendl;
@@ -260,12 +262,18 @@ void MeshPartitioner::build_global_to_local_index(Mesh& mesh)
       cf3_assert_desc(to_str(glb_idx)+"<"+to_str(m_start_elem_per_part[PE::Comm::instance().rank()]),glb_idx >= m_start_elem_per_part[PE::Comm::instance().rank()]);
       cf3_assert_desc(to_str(glb_idx)+">="+to_str(m_end_elem_per_part[PE::Comm::instance().rank()]),glb_idx < m_end_elem_per_part[PE::Comm::instance().rank()]);
       cf3_assert_desc(to_str(glb_idx)+">="+to_str(m_end_id_per_part[PE::Comm::instance().rank()]),glb_idx < m_end_id_per_part[PE::Comm::instance().rank()]);
-      m_global_to_local->push_back(glb_idx,loc_idx++);
+      glb_to_loc.push_back(std::make_pair(glb_idx,loc_idx++));
       //CFinfo << "  adding element with glb " << glb_idx << CFendl;
     }
   }
 
-  m_global_to_local->sort_keys();
+  // The objects are listed to the partitioner in the iteration order of the map,
+  // which must follow the global numbering
+  std::sort(glb_to_loc.begin(), glb_to_loc.end());
+  m_global_to_local->clear();
+  m_global_to_local->reserve(glb_to_loc.size());
+  for (Uint i=0; i<glb_to_loc.size(); ++i)
+    m_global_to_local->push_back(glb_to_loc[i].first,glb_to_loc[i].second);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -314,7 +322,7 @@ void MeshPartitioner::show_changes()
 
 boost::tuple<Uint,Uint> MeshPartitioner::location_idx(const Uint glb_obj) const
 {
-  common::Map<Uint,Uint>::const_iterator itr = m_global_to_local->find(glb_obj);
+  common::HashMap<Uint,Uint>::const_iterator itr = m_global_to_local->find(glb_obj);
   if (itr != m_global_to_local->end() )
   {
     return m_lookup->location_idx(itr->second);
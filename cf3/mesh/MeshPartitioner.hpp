@@ -12,9 +12,9 @@
 #include <boost/tuple/tuple.hpp>
 
 #include "common/FindComponents.hpp"
-#include "common/Map.hpp"
+#include "common/HashMap.hpp"
 #include "common/Foreach.hpp"
-#include "common/DynTable.hpp"
+#include "common/CompressedTable.hpp"
 #include "common/Table.hpp"
 #include "common/List.hpp"
 
@@ -156,7 +156,7 @@ private: // data
   Uint m_nb_owned_obj;
 
 
-  Handle< common::Map<Uint,Uint> > m_global_to_local;
+  Handle< common::HashMap<Uint,Uint> > m_global_to_local;
 
   std::vector<Uint> m_start_id_per_part;
   std::vector<Uint> m_end_id_per_part;
@@ -214,7 +214,7 @@ Uint MeshPartitioner::nb_connected_objects_in_part(const Uint part, VectorT& nb_
       {
         if(!m_periodic_links[loc_idx].first)
         {
-          const common::DynTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
+          const common::CompressedTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
           nb_connections_per_obj[idx] = node_to_glb_elm.row_size(loc_idx);
           BOOST_FOREACH(const Uint linked_loc_idx, m_inverse_periodic_links[loc_idx])
           {
@@ -258,7 +258,7 @@ void MeshPartitioner::list_of_connected_objects_in_part(const Uint part, VectorT
       {
         if(!m_periodic_links[loc_idx].first)
         {
-          const common::DynTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
+          const common::CompressedTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
           boost_foreach (const Uint glb_elm , node_to_glb_elm[loc_idx])
           {
             edge_weights[idx] = 1.;
@@ -311,7 +311,7 @@ void MeshPartitioner::list_of_connected_procs_in_part(const Uint part, VectorT&
       {
         if(!m_periodic_links[loc_idx].first)
         {
-          const common::DynTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
+          const common::CompressedTable<Uint>& node_to_glb_elm = nodes->glb_elem_connectivity();
           boost_foreach (const Uint glb_elm , node_to_glb_elm[loc_idx])
             connected_procs[idx++] = part_of_obj(glb_elm); /// @todo should be proc of obj, not part!!!
             
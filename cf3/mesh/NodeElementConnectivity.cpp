@@ -5,7 +5,7 @@
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
 #include "common/FindComponents.hpp"
-#include "common/DynTable.hpp"
+#include "common/CompressedTable.hpp"
 #include "common/Link.hpp"
 #include "common/Builder.hpp"
 
@@ -31,7 +31,7 @@ NodeElementConnectivity::NodeElementConnectivity ( const std::string& name ) :
 {
   m_nodes = create_static_component<common::Link>(mesh::Tags::nodes());
   m_elements = create_static_component<UnifiedData>("elements");
-  m_connectivity = create_static_component<DynTable<Uint> >(mesh::Tags::connectivity_table());
+  m_connectivity = create_static_component<CompressedTable<Uint> >(mesh::Tags::connectivity_table());
   mark_basic();
 }
 
@@ -70,8 +70,8 @@ void NodeElementConnectivity::build_connectivity()
   cf3_assert(m_nodes->follow());
   Dictionary const& nodes = *Handle<Dictionary>(m_nodes->follow());
 
-  // Reserve memory in m_connectivity->array()
-  std::vector<Uint> connectivity_sizes(nodes.size());
+  // Count the elements connected to each node
+  CompressedTable<Uint>::Builder builder(*m_connectivity, nodes.size());
   boost_foreach(Handle<Component> elements_comp, m_elements->components() )
   {
     Entities& elements = dynamic_cast<Entities&>(*elements_comp);
@@ -80,17 +80,13 @@ void NodeElementConnectivity::build_connectivity()
       boost_foreach (const Uint node_idx, elem_nodes)
       {
         cf3_assert(node_idx<nodes.size());
-        ++connectivity_sizes[node_idx];
+        builder.count(node_idx);
       }
     }
   }
-  Uint i(0);
-  boost_foreach (DynTable<Uint>::Row row, m_connectivity->array() )
-  {
-    row.reserve(connectivity_sizes[i++]);
-  }
+  builder.allocate();
 
-  // fill m_connectivity->array()
+  // fill m_connectivity
   Uint glb_elem_idx = 0;
   boost_foreach(Handle<Component> elements_comp, m_elements->components() )
   {
@@ -99,7 +95,7 @@ void NodeElementConnectivity::build_connectivity()
     {
       boost_foreach (const Uint node_idx, elem_nodes)
       {
-        m_connectivity->array()[node_idx].push_back(glb_elem_idx);
+        builder.add(node_idx, glb_elem_idx);
       }
       ++glb_elem_idx;
     }
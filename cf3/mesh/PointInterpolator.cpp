@@ -154,5 +154,15 @@ bool PointInterpolator::compute_storage(const RealVector& coordinate, SpaceElem&
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Uint PointInterpolator::compute_storage(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found, std::vector< std::vector<SpaceElem> >& stencils, std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights)
+{
+  cf3_assert(m_element_finder);
+  cf3_assert(m_stencil_computer);
+  cf3_assert(m_interpolator_function);
+  return compute_batch_storage(*m_element_finder,*m_stencil_computer,*m_interpolator_function,coordinates,elements,found,stencils,points,weights);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
@@ -55,6 +55,23 @@ public: // functions
 
   virtual bool compute_storage(const RealVector& coordinate, SpaceElem& element, std::vector<SpaceElem>& stencil, std::vector<Uint>& points, std::vector<Real>& weights) = 0;
 
+  /// @brief Compute the interpolation storage for a batch of coordinates
+  ///
+  /// The elements are found in a single query of the element finder, which may reorder the searches for locality.
+  /// The stencil, points and weights of coordinates that are not found are left empty.
+  /// @param [in]  coordinates  The coordinates to interpolate to, one per row
+  /// @param [out] found        For each coordinate, true if it can be interpolated
+  /// @return the number of coordinates that can be interpolated
+  virtual Uint compute_storage(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found, std::vector< std::vector<SpaceElem> >& stencils, std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights) = 0;
+
+protected: // functions
+
+  /// Batched compute_storage in terms of the element finder, stencil computer and interpolation function,
+  /// shared by the implementations that hold them as base or concrete types
+  template<typename ElementFinderT, typename StencilComputerT, typename InterpolationFunctionT>
+  static Uint compute_batch_storage(ElementFinderT& element_finder, StencilComputerT& stencil_computer, InterpolationFunctionT& interpolator_function,
+                                    const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found, std::vector< std::vector<SpaceElem> >& stencils, std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights);
+
 private: // functions
 
   void configure_dict();
@@ -101,6 +118,39 @@ bool APointInterpolator::interpolate(const Field& field, const RealVector& coord
 
 ////////////////////////////////////////////////////////////////////////////////
 
+template<typename ElementFinderT, typename StencilComputerT, typename InterpolationFunctionT>
+Uint APointInterpolator::compute_batch_storage(ElementFinderT& element_finder, StencilComputerT& stencil_computer, InterpolationFunctionT& interpolator_function,
+                                               const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found, std::vector< std::vector<SpaceElem> >& stencils, std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights)
+{
+  // 1) Find the elements of all coordinates at once
+  const Uint nb_found = element_finder.find_elements(coordinates,elements,found);
+
+  const Uint nb_coords = coordinates.rows();
+  stencils.resize(nb_coords);
+  points.resize(nb_coords);
+  weights.resize(nb_coords);
+  RealVector coordinate(coordinates.cols());
+  for (Uint i=0; i<nb_coords; ++i)
+  {
+    stencils[i].clear();
+    points[i].clear();
+    weights[i].clear();
+    if (!found[i])
+      continue;
+
+    // 2) Find stencil of elements to use
+    stencil_computer.compute_stencil(elements[i],stencils[i]);
+
+    // 3) Find interpolation
+    coordinate = coordinates.row(i).transpose();
+    interpolator_function.compute_interpolation_weights(coordinate,stencils[i],points[i],weights[i]);
+  }
+
+  return nb_found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 /// @brief A general configurable point interpolator
 class Mesh_API PointInterpolator : public APointInterpolator {
 public: // functions
@@ -119,6 +169,8 @@ public: // functions
 
   virtual bool compute_storage(const RealVector& coordinate, SpaceElem& element, std::vector<SpaceElem>& stencil, std::vector<Uint>& points, std::vector<Real>& weights);
 
+  virtual Uint compute_storage(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found, std::vector< std::vector<SpaceElem> >& stencils, std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights);
+
 private: // functions
 
   void configure_element_finder();
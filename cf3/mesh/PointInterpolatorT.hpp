@@ -40,6 +40,8 @@ public: // functions
 
   virtual bool compute_storage(const RealVector& coordinate, SpaceElem& element, std::vector<SpaceElem>& stencil, std::vector<Uint>& points, std::vector<Real>& weights);
 
+  virtual Uint compute_storage(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found, std::vector< std::vector<SpaceElem> >& stencils, std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights);
+
 private: // functions
 
   void configure();
@@ -114,6 +116,14 @@ bool PointInterpolatorT<ELEMENTFINDER,STENCILCOMPUTER,INTERPOLATIONFUNCTION>::co
 
 ////////////////////////////////////////////////////////////////////////////////
 
+template< typename ELEMENTFINDER, typename STENCILCOMPUTER, typename INTERPOLATIONFUNCTION>
+Uint PointInterpolatorT<ELEMENTFINDER,STENCILCOMPUTER,INTERPOLATIONFUNCTION>::compute_storage(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found, std::vector< std::vector<SpaceElem> >& stencils, std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights)
+{
+  return compute_batch_storage(*m_element_finder,*m_stencil_computer,*m_interpolator_function,coordinates,elements,found,stencils,points,weights);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
 
@@ -13,6 +13,7 @@
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/Builder.hpp"
+#include "common/CompressedTable.hpp"
 #include "common/FindComponents.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
@@ -4,10 +4,10 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <set>
 
 #include <boost/foreach.hpp>
-#include <boost/functional/hash.hpp>
 
 #include "common/Log.hpp"
 #include "common/Builder.hpp"
@@ -31,8 +31,8 @@
 #include "mesh/Region.hpp"
 #include "mesh/MeshElements.hpp"
 #include "mesh/FaceCellConnectivity.hpp"
+#include "mesh/FaceHashTable.hpp"
 #include "mesh/NodeElementConnectivity.hpp"
-#include "mesh/Node2FaceCellConnectivity.hpp"
 #include "mesh/Cells.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Connectivity.hpp"
@@ -51,21 +51,6 @@ namespace actions {
   using namespace common;
   using namespace math::Functions;
 
-struct FaceCompare
-{
-  bool operator()(const Face2Cell& face1, const Face2Cell& face2) const
-  {
-    std::size_t seed1=0;
-    std::size_t seed2=0;
-
-    boost::hash_combine(seed1,face1.comp->uri().string());
-    boost::hash_combine(seed2,face2.comp->uri().string());
-    boost::hash_combine(seed1,face1.idx);
-    boost::hash_combine(seed2,face2.idx);
-    return seed1 < seed2;
-  }
-};
-
 ////////////////////////////////////////////////////////////////////////////////
 
 common::ComponentBuilder < BuildFaces, MeshTransformer, mesh::actions::LibActions> BuildFaces_Builder;
@@ -74,7 +59,8 @@ common::ComponentBuilder < BuildFaces, MeshTransformer, mesh::actions::LibAction
 
 BuildFaces::BuildFaces( const std::string& name )
 : MeshTransformer(name),
-  m_store_cell2face(false)
+  m_store_cell2face(false),
+  m_nb_threads(1)
 {
 
   properties()["brief"] = std::string("Print information of the mesh");
@@ -90,6 +76,11 @@ BuildFaces::BuildFaces( const std::string& name )
       .pretty_name("Store Cell to Face")
       .mark_basic()
       .link_to(&m_store_cell2face);
+
+  options().add("nb_threads", m_nb_threads)
+      .description("Number of threads used to compute the face keys of each element type")
+      .pretty_name("Number of Threads")
+      .link_to(&m_nb_threads);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -198,6 +189,7 @@ void BuildFaces::build_face_cell_connectivity_bottom_up(Component& parent)
 //      CFdebug << PERank << "building face_cell connectivity for region " << region.uri().path() << CFendl;
       Handle<FaceCellConnectivity> face_to_cell = region.create_component<FaceCellConnectivity>("face_to_cell");
       face_to_cell->options().set("face_building_algorithm",true);
+      face_to_cell->options().set("nb_threads",m_nb_threads);
       face_to_cell->add_tag(mesh::Tags::inner_faces());
       face_to_cell->setup(region);
       PE::Comm::instance().barrier();
@@ -266,21 +258,24 @@ void BuildFaces::build_face_elements(Region& region, FaceCellConnectivity& face_
 {
   Mesh& mesh = *m_mesh;
   std::set<std::string> face_types;
-  std::map<std::string,boost::shared_ptr< ElementConnectivity::Buffer > > f2c_buffer_map;
-  std::map<std::string,boost::shared_ptr< common::Table<Uint>::Buffer > > fnb_buffer_map;
-  std::map<std::string,boost::shared_ptr< common::List<bool>::Buffer > > bdry_buffer_map;
-  std::map<std::string,boost::shared_ptr< common::Table<Uint>::Buffer > > cell_rotation_buffer_map;
-  std::map<std::string,boost::shared_ptr< common::Table<bool>::Buffer > > cell_orientation_buffer_map;
-
-  Handle< Component > elem_comp;
-  Uint elem_idx;
 
   common::Table<Uint>& face_number = *Handle< common::Table<Uint> >(face_to_cell.get_child("face_number"));
 
+  // Face type of each face, looked up by the address of the face ElementType to avoid string comparisons per face
+  std::map<const ElementType*, std::string> face_type_names;
+  std::vector<const ElementType*> face_etypes(face_to_cell.size());
   for (Uint idx=0; idx<face_to_cell.size(); ++idx)
   {
-    Face2Cell face(face_to_cell,idx);
-    face_types.insert( face.element_type().derived_type_name()  );
+    Entity element = face_to_cell.connectivity()[idx][0];
+    if ( is_null(element.comp) )
+      throw InvalidStructure(FromHere(),"Face matching messed up in region "+region.uri().string());
+    const ElementType* face_etype = &element.element_type().face_type(face_number[idx][0]);
+    face_etypes[idx] = face_etype;
+    if (face_type_names.find(face_etype) == face_type_names.end())
+    {
+      face_type_names[face_etype] = face_etype->derived_type_name();
+      face_types.insert( face_type_names[face_etype] );
+    }
   }
 
   if (PE::Comm::instance().is_active())
@@ -311,6 +306,7 @@ void BuildFaces::build_face_elements(Region& region, FaceCellConnectivity& face_
     cf3_assert_desc("tree will not be synchrone!!!",pass);
     // end for debug
   }
+  std::map<std::string, FaceCellConnectivity*> face_connectivities;
   boost_foreach( const std::string& face_type , face_types)
   {
     const std::string shape_name = build_component_abstract_type<ElementType>(face_type,"tmp")->shape_name();
@@ -330,55 +326,49 @@ void BuildFaces::build_face_elements(Region& region, FaceCellConnectivity& face_
     raw_table.set_row_size(is_inner?2:1);
     boost_foreach(Handle< Component > cells, face_to_cell.used())
       f2c.add_used(*cells);
-    f2c_buffer_map[face_type] = raw_table.create_buffer_ptr();
-    fnb_buffer_map[face_type] = Handle< common::Table<Uint> >(f2c.get_child("face_number"))->create_buffer_ptr();
-    bdry_buffer_map[face_type] = Handle< common::List<bool> >(f2c.get_child("is_bdry_face"))->create_buffer_ptr();
-    cell_rotation_buffer_map[face_type] = Handle< common::Table<Uint> >(f2c.get_child("cell_rotation"))->create_buffer_ptr();
-    cell_orientation_buffer_map[face_type] = Handle< common::Table<bool> >(f2c.get_child("cell_orientation"))->create_buffer_ptr();
+    face_connectivities[face_type] = &f2c;
   }
 
+  // Count the faces of each type, so the tables can be written directly
+  std::map<const ElementType*, FaceCellConnectivity*> face_type_connectivities;
+  for (std::map<const ElementType*, std::string>::const_iterator it = face_type_names.begin(); it != face_type_names.end(); ++it)
+    face_type_connectivities[it->first] = face_connectivities[it->second];
+  std::map<FaceCellConnectivity*, Uint> nb_faces;
   for (Uint f=0; f<face_to_cell.size(); ++f)
   {
-    Entity element = face_to_cell.connectivity()[f][0];
-    if ( is_null(element.comp) )
-      throw InvalidStructure(FromHere(),"Face matching messed up in region "+region.uri().string());
-    const Uint face_nb = face_number[f][0];
-    const std::string face_type = element.element_type().face_type(face_nb).derived_type_name();
-
-    if (is_inner)
-    {
-      if (face_to_cell.is_bdry_face()[f] == false)
-      {
-        f2c_buffer_map[face_type]->add_row(face_to_cell.connectivity()[f]);
-        fnb_buffer_map[face_type]->add_row(face_number[f]);
-        bdry_buffer_map[face_type]->add_row(face_to_cell.is_bdry_face()[f]);
-        cell_rotation_buffer_map[face_type]->add_row(face_to_cell.cell_rotation()[f]);
-        cell_orientation_buffer_map[face_type]->add_row(face_to_cell.cell_orientation()[f]);
-      }
-    }
-    else
-    {
-      if (face_to_cell.is_bdry_face()[f] == true)
-      {
-        std::vector<Entity> dummy(1,face_to_cell.connectivity()[f][0]);
-        f2c_buffer_map[face_type]->add_row(dummy);
-        fnb_buffer_map[face_type]->add_row(face_number[f]);
-        bdry_buffer_map[face_type]->add_row(face_to_cell.is_bdry_face()[f]);
-        cell_rotation_buffer_map[face_type]->add_row(face_to_cell.cell_rotation()[f]);
-        cell_orientation_buffer_map[face_type]->add_row(face_to_cell.cell_orientation()[f]);
-      }
-    }
+    if (face_to_cell.is_bdry_face()[f] != is_inner)
+      ++nb_faces[face_type_connectivities[face_etypes[f]]];
   }
-
   boost_foreach( const std::string& face_type , face_types)
   {
-    f2c_buffer_map[face_type]->flush();
-    fnb_buffer_map[face_type]->flush();
-    bdry_buffer_map[face_type]->flush();
-    cell_rotation_buffer_map[face_type]->flush();
-    cell_orientation_buffer_map[face_type]->flush();
+    FaceCellConnectivity& f2c = *face_connectivities[face_type];
+    f2c.connectivity().resize(nb_faces[&f2c]);
+    f2c.face_number().resize(nb_faces[&f2c]);
+    f2c.is_bdry_face().resize(nb_faces[&f2c]);
+    f2c.cell_rotation().resize(nb_faces[&f2c]);
+    f2c.cell_orientation().resize(nb_faces[&f2c]);
+  }
 
+  std::map<FaceCellConnectivity*, Uint> next_face;
+  for (Uint f=0; f<face_to_cell.size(); ++f)
+  {
+    // Inner faces have 2 cells, outer faces only one
+    if (face_to_cell.is_bdry_face()[f] == is_inner)
+      continue;
+
+    FaceCellConnectivity& f2c = *face_type_connectivities[face_etypes[f]];
+    const Uint idx = next_face[&f2c]++;
+    ElementConnectivity::Row cells = f2c.connectivity()[idx];
+    for (Uint i=0; i<cells.size(); ++i)
+      cells[i] = face_to_cell.connectivity()[f][i];
+    f2c.face_number().set_row(idx, face_number[f]);
+    f2c.is_bdry_face()[idx] = face_to_cell.is_bdry_face()[f];
+    f2c.cell_rotation().set_row(idx, face_to_cell.cell_rotation()[f]);
+    f2c.cell_orientation().set_row(idx, face_to_cell.cell_orientation()[f]);
+  }
 
+  boost_foreach( const std::string& face_type , face_types)
+  {
     const std::string shape_name = build_component_abstract_type<ElementType>(face_type,"tmp")->shape_name();
     CellFaces& faces = *Handle<CellFaces>(region.get_child(shape_name));
     FaceCellConnectivity&  f2c  = *faces.connectivity_face2cell();
@@ -449,7 +439,6 @@ boost::shared_ptr< FaceCellConnectivity > BuildFaces::match_faces(Region& region
 
   CFdebug << "matching faces between regions " << region1.uri().path() << "  and  " << region2.uri().path() << CFendl;
 
-  Mesh& mesh = *m_mesh;
   // interface connectivity
   boost::shared_ptr<FaceCellConnectivity> interface = allocate_component<FaceCellConnectivity>("interface_connectivity");
   interface->options().set("face_building_algorithm",true);
@@ -467,9 +456,10 @@ boost::shared_ptr< FaceCellConnectivity > BuildFaces::match_faces(Region& region
   std::map<FaceCellConnectivity*,boost::shared_ptr<common::Table<bool>::Buffer> > buf_cell_orientation;
   std::map<FaceCellConnectivity*,boost::shared_ptr<common::Table<Uint>::Buffer> > buf_cell_rotation;
 
-  // Build a node to face connectivity matching faces2
-  boost::shared_ptr<Node2FaceCellConnectivity> node2faces2_ptr = allocate_component<Node2FaceCellConnectivity>("node2faces");
-  Node2FaceCellConnectivity& node2faces2 = *node2faces2_ptr;
+  // Hash the faces of region2 by their sorted nodes
+  std::vector<Face2Cell> faces2_list;
+  FaceHashTable faces2_table;
+  std::vector<Uint> sorted_nodes;
   boost_foreach(FaceCellConnectivity& faces2, find_components_recursively_with_tag<FaceCellConnectivity>(region2,mesh::Tags::inner_faces()))
   {
     buf_fnb [&faces2] = boost::shared_ptr<common::Table<Uint>::Buffer> ( new common::Table<Uint>::Buffer(faces2.face_number().create_buffer()));
@@ -477,10 +467,14 @@ boost::shared_ptr< FaceCellConnectivity > BuildFaces::match_faces(Region& region
     buf_f2c [&faces2] = boost::shared_ptr<ElementConnectivity::Buffer> ( new ElementConnectivity::Buffer(faces2.connectivity().create_buffer()));
     buf_cell_rotation [&faces2] = boost::shared_ptr<common::Table<Uint>::Buffer> ( new common::Table<Uint>::Buffer(faces2.cell_rotation().create_buffer()));
     buf_cell_orientation [&faces2] = boost::shared_ptr<common::Table<bool>::Buffer> ( new common::Table<bool>::Buffer(faces2.cell_orientation().create_buffer()));
-    node2faces2.add_used(faces2); // it is assumed this is only face types
+    for (Uint idx=0; idx<faces2.size(); ++idx)
+    {
+      sorted_nodes = faces2.face_nodes(idx);
+      std::sort(sorted_nodes.begin(), sorted_nodes.end());
+      if (faces2_table.insert(&sorted_nodes[0], sorted_nodes.size(), faces2_list.size()) == faces2_list.size())
+        faces2_list.push_back(Face2Cell(faces2,idx));
+    }
   }
-  node2faces2.set_nodes(mesh.geometry_fields());
-  node2faces2.build_connectivity();
 
   Uint f1(0);
   Uint faces1_idx(0);
@@ -509,75 +503,55 @@ boost::shared_ptr< FaceCellConnectivity > BuildFaces::match_faces(Region& region
       face1_nodes = face1.nodes();
       const Uint nb_nodes_per_face = face1_nodes.size();
 
-      std::map<Face2Cell,Uint,FaceCompare> found_faces;
-      std::map<Face2Cell,Uint,FaceCompare>::iterator not_found = found_faces.end();
-
-      bool match_found = false;
-      boost_foreach(const Uint face1_node, face1_nodes)
+      sorted_nodes = face1_nodes;
+      std::sort(sorted_nodes.begin(), sorted_nodes.end());
+      const Uint match = faces2_table.find(&sorted_nodes[0], nb_nodes_per_face);
+      if (match != FaceHashTable::not_found)
       {
-        boost_foreach(Face2Cell face2, node2faces2.connectivity()[face1_node])
+        Face2Cell& face2 = faces2_list[match];
+        elems[LEFT]  = face1.cells()[0];
+        elems[RIGHT] = face2.cells()[0];
+        face_nb[LEFT] = face1.face_nb_in_cells()[0];
+        face_nb[RIGHT] = face2.face_nb_in_cells()[0];
+        orientation[LEFT] = FaceCellConnectivity::MATCHED;
+        orientation[RIGHT] = FaceCellConnectivity::INVERTED;
+        rotation[LEFT] = 0;
+
+        // NOW find the rotation and orientation of this new face to the RIGHT cell
+
+        // Find orientation ( or find match between first face-nodes of both neighbouring elements )
+        face2_nodes = face2.nodes();
+
+        Uint rot;
+        for (rot=0; rot<nb_nodes_per_face; ++rot)
         {
-          std::map<Face2Cell,Uint,FaceCompare>::iterator it = found_faces.find(face2);
-          if ( it == not_found)
-          {
-            found_faces[face2]=1;
-          }
-          else
+          if (face2_nodes[rot] == face1_nodes[0])
           {
-            Uint& nb_faces = it->second;
-            ++nb_faces;
-            if (nb_faces == nb_nodes_per_face)
-            {
-              match_found = true;
-              elems[LEFT]  = face1.cells()[0];
-              elems[RIGHT] = face2.cells()[0];
-              face_nb[LEFT] = face1.face_nb_in_cells()[0];
-              face_nb[RIGHT] = face2.face_nb_in_cells()[0];
-              orientation[LEFT] = FaceCellConnectivity::MATCHED;
-              orientation[RIGHT] = FaceCellConnectivity::INVERTED;
-              rotation[LEFT] = 0;
-
-              // NOW find the rotation and orientation of this new face to the RIGHT cell
-
-              // Find orientation ( or find match between first face-nodes of both neighbouring elements )
-              face2_nodes = face2.nodes();
-
-              Uint rot;
-              for (rot=0; rot<=nb_nodes_per_face; ++rot)
-              {
-                if (face2_nodes[rot] == face1_nodes[0])
-                {
-                  rotation[RIGHT] = rot;
-                  break;
-                }
-              }
-              cf3_assert(rot != nb_nodes_per_face); // means that the break worked and the rotation was found
-
-
-              // Remove matches from the 2 connectivity tables and add to the interface
-              i2c.add_row(elems);
-              fnb.add_row(face_nb);
-              bdry.add_row(false);
-              cell_rotation.add_row(rotation);
-              cell_orientation.add_row(orientation);
-
-              buf_f2c [face1.comp]->rm_row(face1.idx);
-              buf_f2c [face2.comp]->rm_row(face2.idx);
-              buf_fnb [face1.comp]->rm_row(face1.idx);
-              buf_fnb [face2.comp]->rm_row(face2.idx);
-              buf_bdry[face1.comp]->rm_row(face1.idx);
-              buf_bdry[face2.comp]->rm_row(face2.idx);
-              buf_cell_orientation[face1.comp]->rm_row(face1.idx);
-              buf_cell_orientation[face2.comp]->rm_row(face2.idx);
-              buf_cell_rotation[face1.comp]->rm_row(face1.idx);
-              buf_cell_rotation[face2.comp]->rm_row(face2.idx);
-              ++nb_matches;
-              break;
-            }
+            rotation[RIGHT] = rot;
+            break;
           }
         }
-        if (match_found)
-          break;
+        cf3_assert(rot != nb_nodes_per_face); // means that the break worked and the rotation was found
+
+
+        // Remove matches from the 2 connectivity tables and add to the interface
+        i2c.add_row(elems);
+        fnb.add_row(face_nb);
+        bdry.add_row(false);
+        cell_rotation.add_row(rotation);
+        cell_orientation.add_row(orientation);
+
+        buf_f2c [face1.comp]->rm_row(face1.idx);
+        buf_f2c [face2.comp]->rm_row(face2.idx);
+        buf_fnb [face1.comp]->rm_row(face1.idx);
+        buf_fnb [face2.comp]->rm_row(face2.idx);
+        buf_bdry[face1.comp]->rm_row(face1.idx);
+        buf_bdry[face2.comp]->rm_row(face2.idx);
+        buf_cell_orientation[face1.comp]->rm_row(face1.idx);
+        buf_cell_orientation[face2.comp]->rm_row(face2.idx);
+        buf_cell_rotation[face1.comp]->rm_row(face1.idx);
+        buf_cell_rotation[face2.comp]->rm_row(face2.idx);
+        ++nb_matches;
       }
       ++f1;
     }
@@ -592,7 +566,6 @@ boost::shared_ptr< FaceCellConnectivity > BuildFaces::match_faces(Region& region
 
 void BuildFaces::match_boundary(Region& bdry_region, Region& inner_region)
 {
-  Mesh& mesh = *m_mesh;
   const Uint INNER=0;
   // create buffers for each face_cell_connectivity of unified_inner_faces_to_cells
   std::map<FaceCellConnectivity*,boost::shared_ptr<common::Table<Uint>::Buffer> >  buf_inner_face_nb;
@@ -601,9 +574,10 @@ void BuildFaces::match_boundary(Region& bdry_region, Region& inner_region)
   std::map<FaceCellConnectivity*,boost::shared_ptr<common::Table<bool>::Buffer> >  buf_inner_orientation;
   std::map<FaceCellConnectivity*,boost::shared_ptr<common::Table<Uint>::Buffer> >  buf_inner_rotation;
 
-  // Build a node to face connectivity matching faces2
-  boost::shared_ptr<Node2FaceCellConnectivity> nodes_to_inner_faces_ptr = allocate_component<Node2FaceCellConnectivity>("node2faces");
-  Node2FaceCellConnectivity& nodes_to_inner_faces = *nodes_to_inner_faces_ptr;
+  // Hash the inner faces by their sorted nodes
+  std::vector<Face2Cell> inner_faces;
+  FaceHashTable inner_face_table;
+  std::vector<Uint> sorted_nodes;
   boost_foreach(FaceCellConnectivity& f2c, find_components_recursively_with_tag<FaceCellConnectivity>(inner_region,mesh::Tags::inner_faces()))
   {
     buf_inner_face_nb          [&f2c] = boost::shared_ptr<common::Table<Uint>::Buffer> ( new common::Table<Uint>::Buffer(f2c.face_number().create_buffer()));
@@ -612,10 +586,14 @@ void BuildFaces::match_boundary(Region& bdry_region, Region& inner_region)
     buf_inner_rotation          [&f2c] = boost::shared_ptr<common::Table<Uint>::Buffer> ( new common::Table<Uint>::Buffer(f2c.cell_rotation().create_buffer()));
     buf_inner_orientation       [&f2c] = boost::shared_ptr<common::Table<bool>::Buffer> ( new common::Table<bool>::Buffer(f2c.cell_orientation().create_buffer()));
 
-    nodes_to_inner_faces.add_used(f2c);
+    for (Uint idx=0; idx<f2c.size(); ++idx)
+    {
+      sorted_nodes = f2c.face_nodes(idx);
+      std::sort(sorted_nodes.begin(), sorted_nodes.end());
+      if (inner_face_table.insert(&sorted_nodes[0], sorted_nodes.size(), inner_faces.size()) == inner_faces.size())
+        inner_faces.push_back(Face2Cell(f2c,idx));
+    }
   }
-  nodes_to_inner_faces.set_nodes(mesh.geometry_fields());
-  nodes_to_inner_faces.build_connectivity();
 
   boost_foreach(Elements& bdry_faces, find_components<Elements>(bdry_region))
   {
@@ -655,92 +633,55 @@ void BuildFaces::match_boundary(Region& bdry_region, Region& inner_region)
       Connectivity::ConstRow bdry_face_nodes = bdry_entity.get_nodes();
       const Uint nb_nodes_per_face = bdry_face_nodes.size();
 
-      std::map<Face2Cell,Uint,FaceCompare> found_faces;
-      std::map<Face2Cell,Uint,FaceCompare>::iterator not_found = found_faces.end();
+      sorted_nodes.assign(bdry_face_nodes.begin(), bdry_face_nodes.end());
+      std::sort(sorted_nodes.begin(), sorted_nodes.end());
+      const Uint match = inner_face_table.find(&sorted_nodes[0], nb_nodes_per_face);
+      if (match == FaceHashTable::not_found)
+        continue;
+
+      Face2Cell& inner_face = inner_faces[match];
+      elems[INNER] = inner_face.cells()[INNER];
+
+      // Remove matches from the inner_faces_connectivity tables and add to the boundary
+      bdry_face_connectivity.set_row(bdry_entity.idx,elems);
+      bdry_face_nb[bdry_entity.idx][INNER] = inner_face.face_nb_in_cells()[INNER];
+      bdry_face_is_bdry[bdry_entity.idx] = true;
 
-      bool match_found = false;
-      boost_foreach(const Uint bdry_face_node, bdry_face_nodes)
+      if (nb_nodes_per_face == 1)
+      {
+        bdry_rotation[bdry_entity.idx][INNER] = 0;
+        bdry_orientation[bdry_entity.idx][INNER] = FaceCellConnectivity::MATCHED;
+      }
+      else
       {
-        boost_foreach( Face2Cell& inner_face, nodes_to_inner_faces.connectivity()[bdry_face_node])
+        std::vector<Uint> inner_face_nodes = inner_face.nodes();
+        Uint rot;
+        for (rot=0; rot<nb_nodes_per_face; ++rot)
         {
-          std::map<Face2Cell,Uint,FaceCompare>::iterator it = found_faces.find(inner_face);
-          if ( it == not_found)
+          if (inner_face_nodes[rot] == bdry_face_nodes[0])
           {
-            found_faces[inner_face]=1;
-
-            it = found_faces.find(inner_face);
-
-            if (nb_nodes_per_face == 1)
-            {
-              match_found = true;
-              elems[INNER] = inner_face.cells()[INNER];
-
-              // Remove matches from the inner_faces_connectivity tables and add to the boundary
-              bdry_face_connectivity.set_row(bdry_entity.idx,elems);
-              bdry_face_nb[bdry_entity.idx][INNER] = inner_face.face_nb_in_cells()[INNER];
-              bdry_face_is_bdry[bdry_entity.idx] = true;
-              bdry_rotation[bdry_entity.idx][INNER] = 0;
-              bdry_orientation[bdry_entity.idx][INNER] = FaceCellConnectivity::MATCHED;
-
-              buf_inner_face_connectivity[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_face_nb[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_face_is_bdry[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_orientation[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_rotation[inner_face.comp]->rm_row(inner_face.idx);
-
-              ++nb_matches;
-              break;
-            }
-          }
-          else
-          {
-            Uint& nb_faces = it->second;
-            ++nb_faces;
-
-            if (nb_faces == nb_nodes_per_face)
-            {
-              match_found = true;
-              elems[0] = inner_face.cells()[INNER];
-
-              // Remove matches from the inner_faces_connectivity tables and add to the boundary
-              bdry_face_connectivity.set_row(bdry_entity.idx,elems);
-              bdry_face_nb[bdry_entity.idx][INNER] = inner_face.face_nb_in_cells()[INNER];
-              bdry_face_is_bdry[bdry_entity.idx] = true;
-
-              std::vector<Uint> inner_face_nodes = inner_face.nodes();
-              Uint rot;
-              for (rot=0; rot<=nb_nodes_per_face; ++rot)
-              {
-                if (inner_face_nodes[rot] == bdry_face_nodes[0])
-                {
-                  bdry_rotation[bdry_entity.idx][INNER] = rot;
-                  break;
-                }
-              }
-
-              // Now find the orientation (outward or inward)
-              Uint next_node = rot+1;
-              if (next_node == nb_nodes_per_face)
-                next_node = 0;
-              if (inner_face_nodes[next_node]==bdry_face_nodes[1])
-                bdry_orientation[bdry_entity.idx][INNER] = FaceCellConnectivity::MATCHED;
-              else
-                bdry_orientation[bdry_entity.idx][INNER] = FaceCellConnectivity::INVERTED;
-
-              buf_inner_face_connectivity[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_face_nb[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_face_is_bdry[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_orientation[inner_face.comp]->rm_row(inner_face.idx);
-              buf_inner_rotation[inner_face.comp]->rm_row(inner_face.idx);
-
-              ++nb_matches;
-              break;
-            }
+            bdry_rotation[bdry_entity.idx][INNER] = rot;
+            break;
           }
         }
-        if (match_found)
-          break;
+
+        // Now find the orientation (outward or inward)
+        Uint next_node = rot+1;
+        if (next_node == nb_nodes_per_face)
+          next_node = 0;
+        if (inner_face_nodes[next_node]==bdry_face_nodes[1])
+          bdry_orientation[bdry_entity.idx][INNER] = FaceCellConnectivity::MATCHED;
+        else
+          bdry_orientation[bdry_entity.idx][INNER] = FaceCellConnectivity::INVERTED;
       }
+
+      buf_inner_face_connectivity[inner_face.comp]->rm_row(inner_face.idx);
+      buf_inner_face_nb[inner_face.comp]->rm_row(inner_face.idx);
+      buf_inner_face_is_bdry[inner_face.comp]->rm_row(inner_face.idx);
+      buf_inner_orientation[inner_face.comp]->rm_row(inner_face.idx);
+      buf_inner_rotation[inner_face.comp]->rm_row(inner_face.idx);
+
+      ++nb_matches;
     }
   }
 
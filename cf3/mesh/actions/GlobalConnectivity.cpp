@@ -122,7 +122,7 @@ void GlobalConnectivity::execute()
     {
       ghostnode_glb_idx[cnt] = nodes_glb_idx[i];
 
-      DynTable<Uint>::ConstRow elems = node2elem.connectivity()[i];
+      CompressedTable<Uint>::ConstRow elems = node2elem.connectivity()[i];
       boost_foreach(const Uint e, elems)
       {
         boost::tie(elem_comp,elem_idx) = node2elem.elements().location(e);
@@ -172,31 +172,25 @@ void GlobalConnectivity::execute()
   }
 
 
-  DynTable<Uint>& nodes_glb_elem_connectivity = mesh.geometry_fields().glb_elem_connectivity();
-//  CFinfo << "nodes_glb_elem_connectivity = " << nodes_glb_elem_connectivity.uri() << CFendl;
-  nodes_glb_elem_connectivity.resize(glb_elem_connectivity.size());
+  CompressedTable<Uint>& nodes_glb_elem_connectivity = mesh.geometry_fields().glb_elem_connectivity();
+  CompressedTable<Uint>::Builder builder(nodes_glb_elem_connectivity, glb_elem_connectivity.size());
   for (Uint i=0; i<glb_elem_connectivity.size(); ++i)
   {
-//    CFinfo << "i = " << i << CFendl;
     cf3_assert(i<node2elem.connectivity().size());
-    DynTable<Uint>::ConstRow elems = node2elem.connectivity()[i];
-    cf3_assert(i<nodes_glb_elem_connectivity.size());
-    cf3_assert(i<glb_elem_connectivity.size());
-    nodes_glb_elem_connectivity[i].resize(glb_elem_connectivity[i].size() + elems.size());
-    cnt = 0;
-    boost_foreach(const Uint e, elems)
+    builder.count(i, node2elem.connectivity().row_size(i) + glb_elem_connectivity[i].size());
+  }
+  builder.allocate();
+  for (Uint i=0; i<glb_elem_connectivity.size(); ++i)
+  {
+    boost_foreach(const Uint e, node2elem.connectivity()[i])
     {
       cf3_assert(e<node2elem.elements().size());
       boost::tie(elem_comp,elem_idx) = node2elem.elements().location(e);
       cf3_assert(elem_idx < Handle<Elements>(elem_comp)->glb_idx().size());
-      nodes_glb_elem_connectivity[i][cnt++] = Handle<Elements>(elem_comp)->glb_idx()[elem_idx];
+      builder.add(i, Handle<Elements>(elem_comp)->glb_idx()[elem_idx]);
     }
-    for (Uint j=0; j<glb_elem_connectivity[i].size(); ++j)
-    {
-      cf3_assert(cnt < nodes_glb_elem_connectivity[i].size());
-      nodes_glb_elem_connectivity[i][cnt++] = glb_elem_connectivity[i][j];
-    }
-
+    boost_foreach(const Uint glb_elem, glb_elem_connectivity[i])
+      builder.add(i, glb_elem);
   }
 
 }
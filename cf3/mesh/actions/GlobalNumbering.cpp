@@ -4,7 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
-#include <set>
+#include <algorithm>
 
 #include "common/Log.hpp"
 #include "common/Builder.hpp"
@@ -24,6 +24,7 @@
 
 #include "math/MatrixTypesConversion.hpp"
 #include "math/Hilbert.hpp"
+#include "math/RadixSort.hpp"
 #include "math/Functions.hpp"
 #include "math/Consts.hpp"
 
@@ -55,6 +56,148 @@ common::ComponentBuilder < GlobalNumbering, MeshTransformer, mesh::actions::LibA
 
 //////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+
+/// Index of a duplicated key, or uint_max() if all keys are unique
+Uint find_duplicate(const std::vector<boost::uint64_t>& keys)
+{
+  std::vector<Uint> order;
+  math::radix_sort(keys, order);
+  for(Uint i = 1; i < order.size(); ++i)
+  {
+    if(keys[order[i]] == keys[order[i-1]])
+      return order[i];
+  }
+  return uint_max();
+}
+
+/// Look up the global index and rank of the ghosts, identified by their hash.
+/// The owned hashes are distributed over the processes by a sample sort: each process
+/// becomes responsible for a range of hashes, and answers the queries for that range.
+/// If several processes own the same hash, the lowest rank wins.
+/// @param [in]     hashes   Hash of each local entry
+/// @param [in,out] glb_idx  Global index of each local entry. Ghosts are marked with uint_max(),
+///                          and get the global index of the owned entry with the same hash, if found.
+/// @param [out]    owners   Rank owning each entry, or uint_max() for ghosts that were not found
+void find_ghosts(const std::vector<boost::uint64_t>& hashes, common::List<Uint>& glb_idx, std::vector<Uint>& owners)
+{
+  const Uint nb_procs = PE::Comm::instance().size();
+  const Uint my_rank = PE::Comm::instance().rank();
+  const Uint nb_entries = hashes.size();
+  cf3_assert(glb_idx.size() == nb_entries);
+
+  std::vector<Uint> order;
+  math::radix_sort(hashes, order);
+
+  // Sorted owned entries, and regular samples of their hashes
+  std::vector<Uint> owned;
+  owned.reserve(nb_entries);
+  for(Uint i = 0; i != nb_entries; ++i)
+  {
+    if(glb_idx[order[i]] != uint_max())
+      owned.push_back(order[i]);
+  }
+  std::vector<boost::uint64_t> samples;
+  if(!owned.empty())
+  {
+    for(Uint p = 1; p != nb_procs; ++p)
+      samples.push_back(hashes[owned[(p*owned.size())/nb_procs]]);
+  }
+
+  // Splitters dividing the hashes over the processes
+  std::vector< std::vector<boost::uint64_t> > recv_samples;
+  PE::Comm::instance().all_gather(samples, recv_samples);
+  samples.clear();
+  for(Uint p = 0; p != nb_procs; ++p)
+    samples.insert(samples.end(), recv_samples[p].begin(), recv_samples[p].end());
+  std::sort(samples.begin(), samples.end());
+  std::vector<boost::uint64_t> splitters;
+  if(!samples.empty())
+  {
+    for(Uint p = 1; p != nb_procs; ++p)
+      splitters.push_back(samples[(p*samples.size())/nb_procs]);
+  }
+
+  // Send the owned entries and the ghost queries to the process responsible for their hash
+  std::vector< std::vector<boost::uint64_t> > send_owned_hashes(nb_procs), send_queries(nb_procs);
+  std::vector< std::vector<Uint> > send_owned_ids(nb_procs), query_entries(nb_procs);
+  for(Uint i = 0; i != nb_entries; ++i)
+  {
+    const Uint entry = order[i];
+    const Uint dest = std::upper_bound(splitters.begin(), splitters.end(), hashes[entry]) - splitters.begin();
+    if(glb_idx[entry] != uint_max())
+    {
+      send_owned_hashes[dest].push_back(hashes[entry]);
+      send_owned_ids[dest].push_back(glb_idx[entry]);
+    }
+    else
+    {
+      send_queries[dest].push_back(hashes[entry]);
+      query_entries[dest].push_back(entry);
+    }
+  }
+
+  std::vector< std::vector<boost::uint64_t> > recv_owned_hashes, recv_queries;
+  std::vector< std::vector<Uint> > recv_owned_ids;
+  PE::Comm::instance().all_to_all(send_owned_hashes, recv_owned_hashes);
+  PE::Comm::instance().all_to_all(send_owned_ids, recv_owned_ids);
+  PE::Comm::instance().all_to_all(send_queries, recv_queries);
+
+  // Sorted table of the owned hashes in the range of this process. Ranks are concatenated
+  // in increasing order, and the sort is stable, so the lowest rank comes first for duplicates.
+  std::vector<boost::uint64_t> table_hashes;
+  std::vector<Uint> table_ids, table_ranks;
+  for(Uint p = 0; p != nb_procs; ++p)
+  {
+    table_hashes.insert(table_hashes.end(), recv_owned_hashes[p].begin(), recv_owned_hashes[p].end());
+    table_ids.insert(table_ids.end(), recv_owned_ids[p].begin(), recv_owned_ids[p].end());
+    table_ranks.insert(table_ranks.end(), recv_owned_hashes[p].size(), p);
+  }
+  math::radix_sort(table_hashes, order);
+  std::vector<boost::uint64_t> sorted_hashes(order.size());
+  for(Uint i = 0; i != order.size(); ++i)
+    sorted_hashes[i] = table_hashes[order[i]];
+
+  // Answer the queries with pairs of global index and rank
+  std::vector< std::vector<Uint> > send_answers(nb_procs), recv_answers;
+  for(Uint p = 0; p != nb_procs; ++p)
+  {
+    send_answers[p].reserve(2*recv_queries[p].size());
+    boost_foreach(const boost::uint64_t hash, recv_queries[p])
+    {
+      const std::vector<boost::uint64_t>::const_iterator found = std::lower_bound(sorted_hashes.begin(), sorted_hashes.end(), hash);
+      if(found != sorted_hashes.end() && *found == hash)
+      {
+        const Uint entry = order[found - sorted_hashes.begin()];
+        send_answers[p].push_back(table_ids[entry]);
+        send_answers[p].push_back(table_ranks[entry]);
+      }
+      else
+      {
+        send_answers[p].push_back(uint_max());
+        send_answers[p].push_back(uint_max());
+      }
+    }
+  }
+  PE::Comm::instance().all_to_all(send_answers, recv_answers);
+
+  owners.assign(nb_entries, my_rank);
+  for(Uint p = 0; p != nb_procs; ++p)
+  {
+    cf3_assert(recv_answers[p].size() == 2*query_entries[p].size());
+    for(Uint q = 0; q != query_entries[p].size(); ++q)
+    {
+      glb_idx[query_entries[p][q]] = recv_answers[p][2*q];
+      owners[query_entries[p][q]] = recv_answers[p][2*q+1];
+    }
+  }
+}
+
+} // detail
+
+//////////////////////////////////////////////////////////////////////////////
+
 GlobalNumbering::GlobalNumbering( const std::string& name )
 : MeshTransformer(name),
   m_debug(false)
@@ -162,22 +305,25 @@ void GlobalNumbering::execute()
   // In debug mode, check if no hashes are duplicated
   if (m_debug)
   {
-    std::set<boost::uint64_t> hilbert_set;
-    for (Uint i=0; i<hilbert_indices.data().size(); ++i)
-    {
-      if (hilbert_set.insert(hilbert_indices.data()[i]).second == false)  // it was already in the set
-        throw ValueExists(FromHere(), "node "+to_str(i)+" ("+to_str(coordinates[i])+") is duplicated");
-    }
+    const Uint duplicate_node = detail::find_duplicate(hilbert_indices.data());
+    if (duplicate_node != uint_max())
+      throw ValueExists(FromHere(), "node "+to_str(duplicate_node)+" ("+to_str(coordinates[duplicate_node])+") is duplicated");
 
-    hilbert_set.clear();
+    std::vector<boost::uint64_t> elem_hashes;
+    std::vector<Uint> elem_offsets(1,0);
+    std::vector<Handle<Entities> > elem_entities;
     boost_foreach( Entities& elements, find_components_recursively<Entities>(mesh) )
     {
-      CVector_uint64& hilbert_indices = *Handle<CVector_uint64>(elements.get_child("hilbert_indices"));
-      for (Uint i=0; i<hilbert_indices.data().size(); ++i)
-      {
-        if (hilbert_set.insert(hilbert_indices.data()[i]).second == false)  // it was already in the set
-          throw ValueExists(FromHere(), "elem "+elements.uri().path()+"["+to_str(i)+"] is duplicated");
-      }
+      const std::vector<boost::uint64_t>& hashes = Handle<CVector_uint64>(elements.get_child("hilbert_indices"))->data();
+      elem_hashes.insert(elem_hashes.end(), hashes.begin(), hashes.end());
+      elem_offsets.push_back(elem_hashes.size());
+      elem_entities.push_back(elements.handle<Entities>());
+    }
+    const Uint duplicate_elem = detail::find_duplicate(elem_hashes);
+    if (duplicate_elem != uint_max())
+    {
+      const Uint comp = std::upper_bound(elem_offsets.begin(), elem_offsets.end(), duplicate_elem) - elem_offsets.begin() - 1;
+      throw ValueExists(FromHere(), "elem "+elem_entities[comp]->uri().path()+"["+to_str(duplicate_elem-elem_offsets[comp])+"] is duplicated");
     }
     std::cout << "["<<PE::Comm::instance().rank() << "]  start renumbering" << std::endl;
   }
@@ -185,20 +331,10 @@ void GlobalNumbering::execute()
 
   // now renumber
 
-  //------------------------------------------------------------------------------
-  // create node_hilbert2loc mapping
-  Dictionary& nodes = mesh.geometry_fields();
-  std::map<boost::uint64_t,Uint> node_hilbert2loc;
-  Uint loc_node_idx(0);
-  boost_foreach(boost::uint64_t hilbert_idx, hilbert_indices.data())
-    node_hilbert2loc[hilbert_idx]=loc_node_idx++;
-
-  // Check if all nodes have been added to the map
-  cf3_assert(loc_node_idx==nodes.size());
-
   //------------------------------------------------------------------------------
   // get tot nb of owned indexes and communicate
 
+  Dictionary& nodes = mesh.geometry_fields();
   Uint nb_owned_nodes(0);
   common::List<Uint>& nodes_rank = mesh.geometry_fields().rank();
   nodes_rank.resize(nodes.size());
@@ -244,76 +380,31 @@ void GlobalNumbering::execute()
 
 
   //------------------------------------------------------------------------------
-  // add glb_idx to owned nodes, broadcast/receive glb_idx for ghost nodes
-
-  std::vector<boost::uint64_t> node_from(nb_owned_nodes);
-  std::vector<boost::uint64_t> node_to(nb_owned_nodes);
+  // add glb_idx to owned nodes, look up glb_idx for ghost nodes
 
   common::List<Uint>& nodes_glb_idx = mesh.geometry_fields().glb_idx();
   nodes_glb_idx.resize(nodes.size());
 
-  Uint cnt=0;
   Uint glb_id = start_id_per_proc[PE::Comm::instance().rank()];
   for (Uint i=0; i<nodes.size(); ++i)
   {
     cf3_assert(nodes.rank()[i] < PE::Comm::instance().size());
     if ( ! nodes.is_ghost(i) )
-    {
       nodes_glb_idx[i] = glb_id++;
-      node_from[cnt] = hilbert_indices.data()[i];
-      node_to[cnt]   = nodes_glb_idx[i];
-      ++cnt;
-    }
     else
-    {
       nodes_glb_idx[i] = uint_max();
-    }
   }
 
-  for (Uint root=0; root<PE::Comm::instance().size(); ++root)
+  std::vector<Uint> owners;
+  detail::find_ghosts(hilbert_indices.data(), nodes_glb_idx, owners);
+  for (Uint i=0; i<nodes.size(); ++i)
   {
-
-    std::vector<boost::uint64_t> rcv_node_from(0);
-    PE::Comm::instance().broadcast(node_from,rcv_node_from,root);
-    std::vector<boost::uint64_t>        rcv_node_to(0);
-    PE::Comm::instance().broadcast(node_to,rcv_node_to,root);
-
-    if (m_debug)
-    {
-      std::cout << "["<<PE::Comm::instance().rank() << "]  received nodes from " << root << std::endl;
-    }
-
-    if (PE::Comm::instance().rank() != root)
-    {
-      for (Uint p=0; p<PE::Comm::instance().size(); ++p)
-      {
-        if (p == PE::Comm::instance().rank())
-        {
-          Uint rcv_idx(0);
-          boost_foreach(const boost::uint64_t hilbert_idx, rcv_node_from)
-          {
-            if ( node_hilbert2loc.count(hilbert_idx) )
-            {
-              const Uint loc_idx = node_hilbert2loc[hilbert_idx];
-              if (m_debug)
-                std::cout << "["<<PE::Comm::instance().rank() << "]  will change node "<< hilbert_idx << " (local " << loc_idx<< ") to (global " << rcv_node_to[rcv_idx] << ")" << std::endl;
-              cf3_assert(rcv_idx < rcv_node_to.size());
-              nodes_glb_idx[loc_idx]=rcv_node_to[rcv_idx];
-              cf3_assert(loc_idx < nodes_rank.size());
-              cf3_assert_desc("node "+to_str(loc_idx)+ " with hilbert_idx " +to_str(hilbert_idx) +" must be a ghost, but is owned by "+to_str(nodes_rank[loc_idx]),nodes.is_ghost(loc_idx));
-              nodes_rank[loc_idx]=std::min(root,nodes_rank[loc_idx]);
-            }
-            ++rcv_idx;
-          }
-          break;
-        }
-      }
-    }
-    if (m_debug)
+    if ( nodes.is_ghost(i) && owners[i] != uint_max() )
     {
-      std::cout << "["<<PE::Comm::instance().rank() << "]  changed nodes based on " << root << std::endl;
+      if (m_debug)
+        std::cout << "["<<PE::Comm::instance().rank() << "]  changed ghost node "<< hilbert_indices.data()[i] << " (local " << i << ") to (global " << nodes_glb_idx[i] << ")" << std::endl;
+      nodes_rank[i]=std::min(owners[i],nodes_rank[i]);
     }
-
   }
 
   if (m_debug)
@@ -341,109 +432,69 @@ void GlobalNumbering::execute()
     common::List<Uint>& elem_rank = elements.rank();
     elem_rank.resize(elements.size());
 
-    //------------------------------------------------------------------------------
-    // create elem_glb2loc mapping
-    Uint nb_owned_elems=0;
-    std::map<boost::uint64_t,Uint> elem_glb2loc;
-    std::map<boost::uint64_t,Uint>::iterator elem_glb2loc_it;
-    std::map<boost::uint64_t,Uint>::iterator hash_not_found = elem_glb2loc.end();
-
-    for (Uint e=0; e<elements.size(); ++e)
-    {
-      elem_glb2loc [ hilbert_indices[e] ] = e;
-      if ( ! elements.is_ghost(e) )
-        ++nb_owned_elems;
-    }
-
-
-    std::vector<boost::uint64_t> send_hash(nb_owned_elems);
-    std::vector<boost::uint64_t>   send_id(nb_owned_elems);
-
     common::List<Uint>& elements_glb_idx = elements.glb_idx();
     elements_glb_idx.resize(elements.size());
     cf3_assert(hilbert_indices.size() == elements.size());
 
-    Uint cnt(0);
     for (Uint e=0; e<elements.size(); ++e)
     {
-
       if ( ! elements.is_ghost(e) )
       {
         if (m_debug)
           std::cout << "["<<PE::Comm::instance().rank() << "]  will change owned elem "<< hilbert_indices[e] << " (" << elements.uri().path() << "["<<e<<"]) to " << glb_id << std::endl;
-
         elements_glb_idx[e] = glb_id++;
-        send_hash[cnt] = hilbert_indices[e];
-        send_id[cnt]   = elements_glb_idx[e];
-        ++cnt;
       }
       else
       {
         elements_glb_idx[e] = uint_max();
       }
     } // end foreach elem_idx
-    cf3_assert(cnt == nb_owned_elems);
 
-    for (Uint root=0; root<PE::Comm::instance().size(); ++root)
+    detail::find_ghosts(hilbert_indices, elements_glb_idx, owners);
+    for (Uint e=0; e<elements.size(); ++e)
     {
-      std::vector<boost::uint64_t> recv_hash(0);
-      PE::Comm::instance().broadcast(send_hash,recv_hash,root);
-      std::vector<boost::uint64_t>        recv_id(0);
-      PE::Comm::instance().broadcast(send_id,recv_id,root);
-      if (PE::Comm::instance().rank() != root)
+      if ( elements.is_ghost(e) && owners[e] != uint_max() )
       {
-        for (Uint p=0; p<PE::Comm::instance().size(); ++p)
-        {
-          if (p == PE::Comm::instance().rank())
-          {
-            Uint recv_idx(0);
-            boost_foreach(const boost::uint64_t hash, recv_hash)
-            {
-              elem_glb2loc_it = elem_glb2loc.find(hash);
-              if ( elem_glb2loc_it != hash_not_found )
-              {
-                if (m_debug)
-                  std::cout << "["<<PE::Comm::instance().rank() << "]  will change ghost elem "<< elem_glb2loc_it->first << " (" << elements.uri() << "[" << elem_glb2loc_it->second << "]) to " << recv_id[recv_idx] << std::endl;
-                elements_glb_idx[elem_glb2loc_it->second]=recv_id[recv_idx];
-                cf3_assert(elements.is_ghost(elem_glb2loc_it->second));
-                elem_rank[elem_glb2loc_it->second]=root;
-              }
-              ++recv_idx;
-            }
-            break;
-          }
-        }
+        if (m_debug)
+          std::cout << "["<<PE::Comm::instance().rank() << "]  changed ghost elem "<< hilbert_indices[e] << " (" << elements.uri() << "[" << e << "]) to " << elements_glb_idx[e] << std::endl;
+        elem_rank[e]=owners[e];
       }
-    } // end foreach broadcasting process
-
-
-
+    }
   } // end foreach elements
 
 
-  // In debug mode, check if no hashes are duplicated
+  // In debug mode, check if no global indices are duplicated
   if (m_debug)
   {
-    std::set<boost::uint64_t> hilbert_set;
+    std::vector<boost::uint64_t> glb_indices(nodes_glb_idx.array().begin(), nodes_glb_idx.array().end());
     for (Uint i=0; i<nodes_glb_idx.size(); ++i)
     {
-      if (hilbert_set.insert(nodes_glb_idx[i]).second == false)  // it was already in the set
-        throw ValueExists(FromHere(), "node "+to_str(i)+" is duplicated");
       if (nodes_glb_idx[i] == uint_max())
         throw BadValue(FromHere(), "node " + to_str(i)+" doesn't have glb_idx");
     }
 
+    std::vector<Uint> elem_offsets(1,glb_indices.size());
+    std::vector<Handle<Entities> > elem_entities;
     boost_foreach( Entities& elements, find_components_recursively<Entities>(mesh) )
     {
       common::List<Uint>& elements_glb_idx = elements.glb_idx();
       for (Uint i=0; i<elements.size(); ++i)
       {
-        if (hilbert_set.insert(elements_glb_idx[i]).second == false)  // it was already in the set
-          throw ValueExists(FromHere(), "elem "+elements.uri().path()+"["+to_str(i)+"] is duplicated");
         if (elements_glb_idx[i] == uint_max())
           throw BadValue(FromHere(), "elem "+elements.uri().path()+"["+to_str(i)+"] doesn't have glb_idx");
-
       }
+      glb_indices.insert(glb_indices.end(), elements_glb_idx.array().begin(), elements_glb_idx.array().end());
+      elem_offsets.push_back(glb_indices.size());
+      elem_entities.push_back(elements.handle<Entities>());
+    }
+
+    const Uint duplicate = detail::find_duplicate(glb_indices);
+    if (duplicate != uint_max())
+    {
+      if (duplicate < elem_offsets[0])
+        throw ValueExists(FromHere(), "node "+to_str(duplicate)+" is duplicated");
+      const Uint comp = std::upper_bound(elem_offsets.begin(), elem_offsets.end(), duplicate) - elem_offsets.begin() - 1;
+      throw ValueExists(FromHere(), "elem "+elem_entities[comp]->uri().path()+"["+to_str(duplicate-elem_offsets[comp])+"] is duplicated");
     }
   }
 
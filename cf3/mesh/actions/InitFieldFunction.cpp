@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
 
@@ -197,25 +199,39 @@ void InitFieldFunction::execute()
   std::vector<Real> constants;
   constants.push_back( options().value<Real>("time") );
 
-  std::vector<Real> variables(variable_names.size());
+  // Points are evaluated in blocks, gathering the variables of all points of the block
+  const Uint nb_vars = variable_names.size();
+  const Uint block_size = 16*math::BatchFunctionParser::BLOCK_SIZE;
+  std::vector<Real> variables(block_size*nb_vars);
+  std::vector<Real> values(block_size);
 
-  for (Uint pt=0; pt<dict.size(); ++pt)
+  for (Uint begin=0; begin<dict.size(); begin+=block_size)
   {
+    const Uint nb_pts = std::min(block_size, dict.size()-begin);
+
     // Assemble variables per point
-    Uint c=0;
-    for (Uint j=0; j<field_comps.size(); ++j, ++c)
+    for (Uint pt=0; pt<nb_pts; ++pt)
     {
-      variables[c] = field_comps[j]->array()[pt][field_cols[j]];
-    }
-    for (Uint j=0; j<constants.size(); ++j, ++c)
-    {
-      variables[c] = constants[j];
+      Real* pt_variables = &variables[pt*nb_vars];
+      Uint c=0;
+      for (Uint j=0; j<field_comps.size(); ++j, ++c)
+      {
+        pt_variables[c] = field_comps[j]->array()[begin+pt][field_cols[j]];
+      }
+      for (Uint j=0; j<constants.size(); ++j, ++c)
+      {
+        pt_variables[c] = constants[j];
+      }
     }
 
     // Evaluate functions
     for (Uint f=0; f<cols.size(); ++f)
     {
-      m_field->array()[pt][f] = functions[f](variables);
+      functions[f].evaluate_batch(&variables[0], nb_pts, &values[0]);
+      for (Uint pt=0; pt<nb_pts; ++pt)
+      {
+        m_field->array()[begin+pt][f] = values[pt];
+      }
     }
   }
 }
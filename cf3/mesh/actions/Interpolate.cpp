@@ -11,10 +11,12 @@
 #include "common/Signal.hpp"
 
 #include "common/PE/Comm.hpp"
+#include "common/PE/datatype.hpp"
 #include "common/PE/debug.hpp"
 
 #include "math/Consts.hpp"
 
+#include "mesh/DataCache.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Region.hpp"
 #include "mesh/Space.hpp"
@@ -40,6 +42,83 @@ common::ComponentBuilder < Interpolate, MeshTransformer, mesh::actions::LibActio
 
 //////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+
+/// Bounding boxes of the source mesh on all ranks, each stored as the minimum followed by the maximum for each dimension.
+/// The boxes are gathered once and kept in the cache of the mesh until the mesh changes. Since gathering them is collective,
+/// all ranks must use the same mesh, which is the case because Mesh::raise_mesh_changed clears the cache on every rank.
+boost::shared_ptr< std::vector<Real> const > rank_bounding_boxes(const Mesh& mesh, const Uint coord_dim)
+{
+  const std::string key = "interpolate_bounding_boxes:" + to_str(coord_dim);
+  boost::shared_ptr< std::vector<Real> const > cached_boxes = mesh.cache().get< std::vector<Real> const >(key);
+  if(cached_boxes)
+    return cached_boxes;
+
+  // An empty mesh has an inverted box, which contains no points.
+  std::vector<Real> local_box(2*coord_dim);
+  for(Uint d=0; d<coord_dim; ++d)
+  {
+    local_box[d] = math::Consts::real_max();
+    local_box[coord_dim+d] = -math::Consts::real_max();
+  }
+  const Field& coordinates = mesh.geometry_fields().coordinates();
+  for(Uint i=0; i<coordinates.size(); ++i)
+  {
+    for(Uint d=0; d<coord_dim; ++d)
+    {
+      local_box[d] = std::min(local_box[d], coordinates[i][d]);
+      local_box[coord_dim+d] = std::max(local_box[coord_dim+d], coordinates[i][d]);
+    }
+  }
+
+  // Grow the box slightly, so points on its boundary are not lost to round-off
+  Real extent = 0.;
+  for(Uint d=0; d<coord_dim; ++d)
+    extent = std::max(extent, local_box[coord_dim+d] - local_box[d]);
+  const Real tolerance = 1e-8*extent;
+  for(Uint d=0; d<coord_dim; ++d)
+  {
+    local_box[d] -= tolerance;
+    local_box[coord_dim+d] += tolerance;
+  }
+
+  boost::shared_ptr< std::vector<Real> > boxes(new std::vector<Real>());
+  Comm::instance().all_gather(local_box, *boxes);
+  mesh.cache().set(key, boxes);
+  return boxes;
+}
+
+/// Send send[p] to rank p and receive recv[p] from rank p, where recv is already sized to the incoming data.
+/// Unlike an all-to-all, only the ranks with a non-empty buffer are contacted.
+template<typename T>
+void exchange_with_neighbours(const std::vector< std::vector<T> >& send, std::vector< std::vector<T> >& recv)
+{
+  Comm& comm = Comm::instance();
+  std::vector<MPI_Request> requests;
+  requests.reserve(send.size() + recv.size());
+  for(Uint p=0; p<recv.size(); ++p)
+  {
+    if(recv[p].empty())
+      continue;
+    requests.push_back(MPI_REQUEST_NULL);
+    MPI_CHECK_RESULT(MPI_Irecv,(&recv[p][0],(int)recv[p].size(),get_mpi_datatype<T>(),(int)p,0,comm.communicator(),&requests.back()));
+  }
+  for(Uint p=0; p<send.size(); ++p)
+  {
+    if(send[p].empty())
+      continue;
+    requests.push_back(MPI_REQUEST_NULL);
+    MPI_CHECK_RESULT(MPI_Isend,(const_cast<T*>(&send[p][0]),(int)send[p].size(),get_mpi_datatype<T>(),(int)p,0,comm.communicator(),&requests.back()));
+  }
+  if(!requests.empty())
+    MPI_CHECK_RESULT(MPI_Waitall,((int)requests.size(),&requests[0],MPI_STATUSES_IGNORE));
+}
+
+} // detail
+
+//////////////////////////////////////////////////////////////////////////////
+
 Interpolate::Interpolate( const std::string& name )
 : MeshTransformer(name)
 {
@@ -62,6 +141,11 @@ Interpolate::Interpolate( const std::string& name )
       .mark_basic()
       .link_to(&m_target);
 
+  options().add("bounding_box_search", false)
+      .description("Send coordinates that are not found on this rank only to the ranks whose source mesh bounding box "
+                   "contains them, instead of broadcasting them from each rank in turn")
+      .pretty_name("Bounding Box Search");
+
   regist_signal ( "interpolate" )
       .description( "Interpolate to given coordinates, not mesh-related" )
       .pretty_name("Interpolate" )
@@ -196,6 +280,55 @@ void Interpolate::interpolate(const Field& source, const common::Table<Real>& co
     }
   }
 
+  if(options().value<bool>("bounding_box_search"))
+    interpolate_in_bounding_boxes(coordinates, missing_cells, target);
+  else
+    interpolate_by_broadcast(coordinates, missing_cells, target);
+
+  missing_cells.clear();
+  for (Uint i=0; i<target.size(); ++i)
+  {
+    bool found = true;
+    for (Uint v=0; v<target.row_size(); ++v)
+    {
+      if (target[i][v] == math::Consts::real_max())
+      {
+        target[i][v] = 0.;
+        found &= false;
+      }
+    }
+    if (!found)
+      missing_cells.push_back(i);
+  }
+  if(missing_cells.size())
+  {
+    std::cout << PERank << "could not interpolate " << missing_cells.size() << " coordinates because point was not found on source mesh. Values set to zero for coordinates : ";
+    for(Uint i=0; i<missing_cells.size(); ++i)
+    {
+      std::cout << "(";
+      for(Uint d=0; d<target_dim; ++d)
+      {
+        if (d!=0) std::cout << " ";
+        std::cout << coordinates[missing_cells[i]][d];
+      }
+      std::cout << ")  ";
+    }
+    std::cout << std::endl;
+  }
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Interpolate::interpolate_by_broadcast(const common::Table<Real>& coordinates, const std::deque<Uint>& missing_cells, common::Table<Real>& target)
+{
+  const Uint dimension = find_parent_component<Mesh>(*m_source).dimension();
+  const Uint nb_vars = m_source->row_size();
+  const Uint target_dim = coordinates.row_size();
+
+  Entity element;
+  RealVector coord(dimension); coord.setZero();
+
   std::vector<Real> send_coords(target_dim*missing_cells.size());
   std::vector<Real> recv_coords;
 
@@ -229,7 +362,7 @@ void Interpolate::interpolate(const Field& source, const common::Table<Real>& co
 
 
     // size is only because it doesn't get resized for this rank
-    std::vector<Real> send_target_rows(nb_vars*missing_cells.size(),math::Consts::uint_max());
+    std::vector<Real> send_target_rows(nb_vars*missing_cells.size(),math::Consts::real_max());
 
     if (root!=Comm::instance().rank())
     {
@@ -283,39 +416,102 @@ void Interpolate::interpolate(const Field& source, const common::Table<Real>& co
       }
     } // endif root==rank
   } // end foreach root
+}
 
+//////////////////////////////////////////////////////////////////////////////
 
-  missing_cells.clear();
-  for (Uint i=0; i<target.size(); ++i)
+void Interpolate::interpolate_in_bounding_boxes(const common::Table<Real>& coordinates, const std::deque<Uint>& missing_cells, common::Table<Real>& target)
+{
+  Comm& comm = Comm::instance();
+  if(!comm.is_active() || comm.size() == 1)
+    return;
+
+  const Uint nb_procs = comm.size();
+  const Uint my_rank = comm.rank();
+  const Mesh& source_mesh = find_parent_component<Mesh>(*m_source);
+  const Uint dimension = source_mesh.dimension();
+  const Uint nb_vars = m_source->row_size();
+  const Uint target_dim = coordinates.row_size();
+  const Uint coord_dim = std::min(dimension, target_dim);
+
+  const std::vector<Real>& boxes = *detail::rank_bounding_boxes(source_mesh, coord_dim);
+
+  // Send each missing coordinate only to the ranks whose box contains it
+  std::vector< std::vector<Real> > send_coords(nb_procs);
+  std::vector< std::vector<Uint> > sent_cells(nb_procs);
+  boost_foreach(const Uint i, missing_cells)
   {
-    bool found = true;
-    for (Uint v=0; v<target.row_size(); ++v)
+    for(Uint p=0; p<nb_procs; ++p)
     {
-      if (target[i][v] == math::Consts::uint_max())
-      {
-        target[i][v] = 0.;
-        found &= false;
-      }
+      if(p == my_rank)
+        continue;
+
+      const Real* box = &boxes[2*coord_dim*p];
+      bool inside = true;
+      for(Uint d=0; d<coord_dim && inside; ++d)
+        inside = coordinates[i][d] >= box[d] && coordinates[i][d] <= box[coord_dim+d];
+      if(!inside)
+        continue;
+
+      for(Uint d=0; d<coord_dim; ++d)
+        send_coords[p].push_back(coordinates[i][d]);
+      sent_cells[p].push_back(i);
     }
-    if (!found)
-      missing_cells.push_back(i);
   }
-  if(missing_cells.size())
+
+  // Only the counts go to every rank, the coordinates themselves only to the ranks that need them
+  std::vector<int> send_counts(nb_procs);
+  std::vector<int> recv_counts(nb_procs);
+  for(Uint p=0; p<nb_procs; ++p)
+    send_counts[p] = send_coords[p].size();
+  comm.all_to_all(send_counts, recv_counts);
+
+  std::vector< std::vector<Real> > recv_coords(nb_procs);
+  for(Uint p=0; p<nb_procs; ++p)
+    recv_coords[p].resize(recv_counts[p]);
+  detail::exchange_with_neighbours(send_coords, recv_coords);
+
+  // Interpolate at the received coordinates, answering real_max for coordinates that are not found here either
+  Entity element;
+  RealVector coord(dimension); coord.setZero();
+  boost::multi_array<Real,2> target_row(boost::extents[1][nb_vars]);
+  std::vector< std::vector<Real> > send_target_rows(nb_procs);
+  for(Uint p=0; p<nb_procs; ++p)
   {
-    std::cout << PERank << "could not interpolate " << missing_cells.size() << " coordinates because point was not found on source mesh. Values set to zero for coordinates : ";
-    for(Uint i=0; i<missing_cells.size(); ++i)
+    const Uint nb_received = recv_coords[p].size() / coord_dim;
+    send_target_rows[p].resize(nb_received*nb_vars, math::Consts::real_max());
+    for(Uint i=0; i<nb_received; ++i)
     {
-      std::cout << "(";
-      for(Uint d=0; d<target_dim; ++d)
+      for(Uint d=0; d<coord_dim; ++d)
+        coord[d] = recv_coords[p][i*coord_dim+d];
+
+      if( m_octtree->find_element(coord,element) )
       {
-        if (d!=0) std::cout << " ";
-        std::cout << coordinates[missing_cells[i]][d];
+        interpolate_coordinate( coord, *element.comp, element.idx, target_row[0] );
+        for (Uint v=0; v<nb_vars; ++v)
+          send_target_rows[p][i*nb_vars+v] = target_row[0][v];
       }
-      std::cout << ")  ";
     }
-    std::cout << std::endl;
   }
 
+  // The answers follow the same pattern in reverse, so their sizes are known on both sides
+  std::vector< std::vector<Real> > recv_target_rows(nb_procs);
+  for(Uint p=0; p<nb_procs; ++p)
+    recv_target_rows[p].resize(sent_cells[p].size()*nb_vars);
+  detail::exchange_with_neighbours(send_target_rows, recv_target_rows);
+
+  // The first rank that found a coordinate provides its value
+  for(Uint p=0; p<nb_procs; ++p)
+  {
+    for(Uint j=0; j<sent_cells[p].size(); ++j)
+    {
+      const Uint i = sent_cells[p][j];
+      if(recv_target_rows[p][j*nb_vars] == math::Consts::real_max() || target[i][0] != math::Consts::real_max())
+        continue;
+      for (Uint v=0; v<nb_vars; ++v)
+        target[i][v] = recv_target_rows[p][j*nb_vars+v];
+    }
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <deque>
+
 #include "math/MatrixTypes.hpp"
 
 #include "mesh/MeshTransformer.hpp"
@@ -50,7 +52,8 @@ public: // functions
   /// @param [out] target       Table of interpolated values at the given coordinates
   /// @post target is resized: row-size from source, nb_rows from coordinates
   /// @note MPI communication is used if coordinates are not found on this rank. Other ranks
-  ///       then interpolate and send result back
+  ///       then interpolate and send result back. With the option bounding_box_search, coordinates are only sent
+  ///       to the ranks whose source mesh bounding box contains them.
   void interpolate(const Field& source, const common::Table<Real>& coordinates, common::Table<Real>& target);
 
   void signal_interpolate ( common::SignalArgs& node);
@@ -69,6 +72,13 @@ private:
 
   void interpolate_coordinate(const RealVector& target_coord, const Entities& element_component, const Uint element_idx, Field::Row target_row);
 
+  /// Interpolate at the missing coordinates by broadcasting them from each rank in turn, to be searched on all other ranks
+  void interpolate_by_broadcast(const common::Table<Real>& coordinates, const std::deque<Uint>& missing_cells, common::Table<Real>& target);
+
+  /// Interpolate at the missing coordinates by sending them only to the ranks whose source mesh bounding box
+  /// contains them, and receiving the interpolated rows back. Only the number of coordinates is exchanged with all ranks.
+  void interpolate_in_bounding_boxes(const common::Table<Real>& coordinates, const std::deque<Uint>& missing_cells, common::Table<Real>& target);
+
 
 }; // end Interpolate
 
@@ -15,6 +15,7 @@
 #include "common/OptionList.hpp"
 
 #include "mesh/ConnectivityData.hpp"
+#include "mesh/DataCache.hpp"
 #include "mesh/DiscontinuousDictionary.hpp"
 #include "mesh/Faces.hpp"
 #include "mesh/Region.hpp"
@@ -180,6 +181,9 @@ void LinkPeriodicNodes::execute()
     }
   }
 
+  // Cached used node lists follow the periodic links, so they are outdated now
+  mesh.cache().clear();
+
   boost::shared_ptr<CNodeConnectivity> node_connectivity = common::allocate_component<CNodeConnectivity>("node_connectivity");
   node_connectivity->initialize(common::find_components_recursively_with_filter<mesh::Elements>(*m_destination_region, IsElementsSurface()));
 
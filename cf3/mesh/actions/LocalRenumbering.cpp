@@ -0,0 +1,518 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <limits>
+
+#include "common/Builder.hpp"
+#include "common/CompressedTable.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/Link.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Table.hpp"
+
+#include "math/BoundingBox.hpp"
+#include "math/Hilbert.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/DataCache.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementConnectivity.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+
+#include "mesh/actions/LocalRenumbering.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace actions {
+
+  using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < LocalRenumbering, MeshTransformer, mesh::actions::LibActions> LocalRenumbering_Builder;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+/// Move row i of the table to row new_index[i]
+template<typename T>
+void permute_rows(Table<T>& table, const std::vector<Uint>& new_index)
+{
+  cf3_assert(table.size() == new_index.size());
+  const Uint row_size = table.row_size();
+  if(row_size == 0 || table.size() == 0)
+    return;
+
+  T* values = table.array().data();
+  const std::vector<T> old_values(values, values + table.size()*row_size);
+  for(Uint i = 0; i != new_index.size(); ++i)
+    std::copy(old_values.begin() + i*row_size, old_values.begin() + (i+1)*row_size, values + new_index[i]*row_size);
+}
+
+/// Move entry i of the list to entry new_index[i]
+template<typename T>
+void permute_entries(List<T>& list, const std::vector<Uint>& new_index)
+{
+  cf3_assert(list.size() == new_index.size());
+  const std::vector<T> old_values(list.array().begin(), list.array().end());
+  for(Uint i = 0; i != new_index.size(); ++i)
+    list[new_index[i]] = old_values[i];
+}
+
+/// Move row i of the compressed table to row new_index[i]
+void permute_rows(CompressedTable<Uint>& table, const std::vector<Uint>& new_index)
+{
+  cf3_assert(table.size() == new_index.size());
+  const std::vector<Uint> offsets = table.offsets();
+  const std::vector<Uint> values(table.values().begin(), table.values().end());
+
+  const Uint nb_rows = new_index.size();
+  CompressedTable<Uint>::Builder builder(table, nb_rows);
+  for(Uint i = 0; i != nb_rows; ++i)
+    builder.count(new_index[i], offsets[i+1] - offsets[i]);
+  builder.allocate();
+  for(Uint i = 0; i != nb_rows; ++i)
+  {
+    for(Uint j = offsets[i]; j != offsets[i+1]; ++j)
+      builder.add(new_index[i], values[j]);
+  }
+}
+
+/// Replace every value v of the table with new_index[v]
+void renumber_values(Table<Uint>& table, const std::vector<Uint>& new_index)
+{
+  Uint* values = table.array().data();
+  const Uint nb_values = table.size()*table.row_size();
+  for(Uint i = 0; i != nb_values; ++i)
+  {
+    cf3_assert(values[i] < new_index.size());
+    values[i] = new_index[values[i]];
+  }
+}
+
+/// Check that new_index is a permutation of the given size
+void check_permutation(const std::vector<Uint>& new_index, const Uint size, const Component& component)
+{
+  if(new_index.size() != size)
+    throw BadValue(FromHere(), "Renumbering of " + component.uri().path() + " has " + to_str(new_index.size()) + " entries, expected " + to_str(size));
+
+  std::vector<bool> used(size, false);
+  for(Uint i = 0; i != size; ++i)
+  {
+    if(new_index[i] >= size || used[new_index[i]])
+      throw BadValue(FromHere(), "Renumbering of " + component.uri().path() + " is not a permutation");
+    used[new_index[i]] = true;
+  }
+}
+
+/// Graph of the nodes of a dictionary, where nodes are neighbours if they share an element
+struct NodeGraph
+{
+  NodeGraph(const Dictionary& dict) : offsets(1, 0u)
+  {
+    const Uint nb_nodes = dict.size();
+    const CompressedTable<SpaceElem>& node_elements = dict.connectivity();
+    cf3_assert(node_elements.size() == nb_nodes);
+
+    // marker[j] == i+1 if j was already added as neighbour of i
+    std::vector<Uint> marker(nb_nodes, 0u);
+    offsets.reserve(nb_nodes+1);
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      marker[i] = i+1;
+      boost_foreach(const SpaceElem& elem, node_elements[i])
+      {
+        boost_foreach(const Uint j, elem.comp->connectivity()[elem.idx])
+        {
+          if(marker[j] != i+1)
+          {
+            marker[j] = i+1;
+            neighbours.push_back(j);
+          }
+        }
+      }
+      offsets.push_back(neighbours.size());
+    }
+  }
+
+  Uint size() const { return offsets.size() - 1; }
+
+  Uint degree(const Uint i) const { return offsets[i+1] - offsets[i]; }
+
+  std::vector<Uint> offsets;
+  std::vector<Uint> neighbours;
+};
+
+/// Orders nodes by increasing degree
+struct LessDegree
+{
+  LessDegree(const NodeGraph& graph) : graph(graph) {}
+
+  bool operator()(const Uint a, const Uint b) const
+  {
+    const Uint degree_a = graph.degree(a);
+    const Uint degree_b = graph.degree(b);
+    return degree_a < degree_b || (degree_a == degree_b && a < b);
+  }
+
+  const NodeGraph& graph;
+};
+
+/// Breadth first search from root, filling nodes in order of increasing distance.
+/// Returns the eccentricity of root, last_level_begin is set to the position in nodes where the farthest nodes start.
+Uint level_structure(const NodeGraph& graph, const Uint root, std::vector<Uint>& stamps, const Uint stamp, std::vector<Uint>& nodes, Uint& last_level_begin)
+{
+  nodes.clear();
+  nodes.push_back(root);
+  stamps[root] = stamp;
+  Uint level_begin = 0;
+  Uint eccentricity = 0;
+  while(true)
+  {
+    const Uint level_end = nodes.size();
+    for(Uint k = level_begin; k != level_end; ++k)
+    {
+      const Uint node = nodes[k];
+      for(Uint l = graph.offsets[node]; l != graph.offsets[node+1]; ++l)
+      {
+        const Uint neighbour = graph.neighbours[l];
+        if(stamps[neighbour] != stamp)
+        {
+          stamps[neighbour] = stamp;
+          nodes.push_back(neighbour);
+        }
+      }
+    }
+    if(nodes.size() == level_end)
+    {
+      last_level_begin = level_begin;
+      return eccentricity;
+    }
+    level_begin = level_end;
+    ++eccentricity;
+  }
+}
+
+/// Find a node of maximal eccentricity in the connected part of the graph containing start, using the method of George and Liu
+Uint pseudo_peripheral_node(const NodeGraph& graph, const Uint start, std::vector<Uint>& stamps, Uint& stamp)
+{
+  std::vector<Uint> nodes;
+  Uint last_level_begin;
+  Uint root = start;
+  Uint eccentricity = level_structure(graph, root, stamps, ++stamp, nodes, last_level_begin);
+  while(true)
+  {
+    const Uint candidate = *std::min_element(nodes.begin() + last_level_begin, nodes.end(), LessDegree(graph));
+    const Uint candidate_eccentricity = level_structure(graph, candidate, stamps, ++stamp, nodes, last_level_begin);
+    if(candidate_eccentricity <= eccentricity)
+      return root;
+    root = candidate;
+    eccentricity = candidate_eccentricity;
+  }
+}
+
+} // detail
+
+////////////////////////////////////////////////////////////////////////////////
+
+LocalRenumbering::LocalRenumbering( const std::string& name )
+: MeshTransformer(name)
+{
+  properties()["brief"] = std::string("Reorder the local nodes and elements for memory locality");
+  std::string desc;
+  desc =
+      "  Usage: LocalRenumbering \n\n"
+      "  Nodes of continuous dictionaries are put in reverse Cuthill-McKee order,\n"
+      "  cells in the order of their centroids along a Hilbert curve.\n"
+      "  Only the local numbering changes, global indices are kept.\n"
+      "\n"
+      "  Optional arguments:\n"
+      "    - Renumber the nodes\n"
+      "        nodes:bool=true\n"
+      "    - Renumber the cells\n"
+      "        elements:bool=true\n";
+  properties()["description"] = desc;
+
+  options().add("nodes", true)
+      .description("Put the nodes of continuous dictionaries in reverse Cuthill-McKee order and the nodes of discontinuous dictionaries in order of the cells")
+      .pretty_name("Nodes")
+      .mark_basic();
+
+  options().add("elements", true)
+      .description("Put the cells in order along a Hilbert space filling curve")
+      .pretty_name("Elements")
+      .mark_basic();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void LocalRenumbering::execute()
+{
+  Mesh& mesh = this->mesh();
+
+  // Elements first, so the order of the nodes of discontinuous dictionaries can follow them
+  if(options().value<bool>("elements"))
+  {
+    boost_foreach(Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+    {
+      renumber_elements(elements, hilbert_order(elements));
+    }
+  }
+
+  if(options().value<bool>("nodes"))
+  {
+    boost_foreach(const Handle<Dictionary>& dict, mesh.dictionaries())
+    {
+      renumber_nodes(*dict, dict->continuous() ? reverse_cuthill_mckee_order(*dict) : element_order(*dict));
+    }
+  }
+
+  mesh.raise_mesh_changed();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void LocalRenumbering::renumber_nodes(Dictionary& dict, const std::vector<Uint>& new_index)
+{
+  detail::check_permutation(new_index, dict.size(), dict);
+
+  boost_foreach(Field& field, find_components<Field>(dict))
+  {
+    detail::permute_rows(field, new_index);
+  }
+  detail::permute_entries(dict.glb_idx(), new_index);
+  detail::permute_entries(dict.rank(), new_index);
+
+  Handle< CompressedTable<Uint> > glb_elem_connectivity(dict.get_child("glb_elem_connectivity"));
+  if(is_not_null(glb_elem_connectivity) && glb_elem_connectivity->size() == new_index.size())
+    detail::permute_rows(*glb_elem_connectivity, new_index);
+
+  // Periodic links point to the local index of the linked node
+  Handle< List<Uint> > periodic_links_nodes(dict.get_child("periodic_links_nodes"));
+  Handle< List<bool> > periodic_links_active(dict.get_child("periodic_links_active"));
+  if(is_not_null(periodic_links_nodes))
+  {
+    cf3_assert(is_not_null(periodic_links_active));
+    detail::permute_entries(*periodic_links_nodes, new_index);
+    detail::permute_entries(*periodic_links_active, new_index);
+    for(Uint i = 0; i != new_index.size(); ++i)
+    {
+      if((*periodic_links_active)[i])
+        (*periodic_links_nodes)[i] = new_index[(*periodic_links_nodes)[i]];
+    }
+  }
+
+  boost_foreach(const Handle<Space>& space, dict.spaces())
+  {
+    detail::renumber_values(space->connectivity(), new_index);
+  }
+
+  // The comm pattern holds local indices, removing it also resets the handles of the fields parallelized with it
+  if(is_not_null(dict.get_child("CommPattern")))
+    dict.remove_component("CommPattern");
+
+  dict.rebuild_map_glb_to_loc();
+  dict.rebuild_node_to_element_connectivity();
+
+  Handle<Mesh> mesh = find_parent_component_ptr<Mesh>(dict);
+  if(is_not_null(mesh))
+    mesh->cache().clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void LocalRenumbering::renumber_elements(Entities& entities, const std::vector<Uint>& new_index)
+{
+  detail::check_permutation(new_index, entities.size(), entities);
+
+  boost_foreach(const Handle<Space>& space, entities.spaces())
+  {
+    detail::permute_rows(space->connectivity(), new_index);
+  }
+  detail::permute_entries(entities.glb_idx(), new_index);
+  detail::permute_entries(entities.rank(), new_index);
+
+  if(is_not_null(entities.connectivity_cell2face()))
+    detail::permute_rows(*entities.connectivity_cell2face(), new_index);
+  if(is_not_null(entities.connectivity_cell2cell()))
+    detail::permute_rows(*entities.connectivity_cell2cell(), new_index);
+
+  Handle< List<Uint> > periodic_links_elements(entities.get_child("periodic_links_elements"));
+  if(is_not_null(periodic_links_elements))
+    detail::permute_entries(*periodic_links_elements, new_index);
+
+  Handle<Mesh> mesh = find_parent_component_ptr<Mesh>(entities);
+  if(is_not_null(mesh))
+  {
+    // References to the renumbered elements, e.g. from faces to cells
+    boost_foreach(ElementConnectivity& connectivity, find_components_recursively<ElementConnectivity>(*mesh))
+    {
+      Entity* elements = connectivity.array().data();
+      const Uint nb_values = connectivity.size()*connectivity.row_size();
+      for(Uint i = 0; i != nb_values; ++i)
+      {
+        if(elements[i].comp == &entities)
+          elements[i].idx = new_index[elements[i].idx];
+      }
+    }
+
+    boost_foreach(List<Uint>& links, find_components_recursively_with_name< List<Uint> >(*mesh, "periodic_links_elements"))
+    {
+      Handle<Link> link(links.get_child("periodic_link"));
+      if(is_not_null(link) && link->follow().get() == &entities)
+      {
+        for(Uint i = 0; i != links.size(); ++i)
+          links[i] = new_index[links[i]];
+      }
+    }
+
+    mesh->cache().clear();
+  }
+
+  boost_foreach(const Handle<Space>& space, entities.spaces())
+  {
+    space->dict().rebuild_node_to_element_connectivity();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<Uint> LocalRenumbering::reverse_cuthill_mckee_order(const Dictionary& dict)
+{
+  const detail::NodeGraph graph(dict);
+  const Uint nb_nodes = graph.size();
+
+  std::vector<Uint> order;
+  order.reserve(nb_nodes);
+  std::vector<bool> visited(nb_nodes, false);
+  std::vector<Uint> stamps(nb_nodes, 0u);
+  Uint stamp = 0;
+  std::vector<Uint> neighbours;
+
+  // Cuthill-McKee numbering of each connected part, starting from a peripheral node
+  for(Uint start = 0; start != nb_nodes; ++start)
+  {
+    if(visited[start])
+      continue;
+
+    Uint head = order.size();
+    const Uint root = detail::pseudo_peripheral_node(graph, start, stamps, stamp);
+    order.push_back(root);
+    visited[root] = true;
+    while(head != order.size())
+    {
+      const Uint node = order[head++];
+      neighbours.clear();
+      for(Uint l = graph.offsets[node]; l != graph.offsets[node+1]; ++l)
+      {
+        const Uint neighbour = graph.neighbours[l];
+        if(!visited[neighbour])
+        {
+          visited[neighbour] = true;
+          neighbours.push_back(neighbour);
+        }
+      }
+      std::sort(neighbours.begin(), neighbours.end(), detail::LessDegree(graph));
+      order.insert(order.end(), neighbours.begin(), neighbours.end());
+    }
+  }
+  cf3_assert(order.size() == nb_nodes);
+
+  std::vector<Uint> new_index(nb_nodes);
+  for(Uint i = 0; i != nb_nodes; ++i)
+    new_index[order[i]] = nb_nodes - 1 - i;
+  return new_index;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<Uint> LocalRenumbering::element_order(const Dictionary& dict)
+{
+  const Uint nb_nodes = dict.size();
+  const Uint unnumbered = std::numeric_limits<Uint>::max();
+  std::vector<Uint> new_index(nb_nodes, unnumbered);
+  Uint next_index = 0;
+  boost_foreach(const Handle<Space>& space, dict.spaces())
+  {
+    const Connectivity& connectivity = space->connectivity();
+    const Uint* nodes = connectivity.array().data();
+    const Uint nb_values = connectivity.size()*connectivity.row_size();
+    for(Uint i = 0; i != nb_values; ++i)
+    {
+      if(new_index[nodes[i]] == unnumbered)
+        new_index[nodes[i]] = next_index++;
+    }
+  }
+
+  // Nodes that are not used by any element go last
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    if(new_index[i] == unnumbered)
+      new_index[i] = next_index++;
+  }
+
+  return new_index;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<Uint> LocalRenumbering::hilbert_order(const Entities& entities)
+{
+  const Uint nb_elems = entities.size();
+  const Field& coordinates = entities.geometry_fields().coordinates();
+  const Connectivity& connectivity = entities.geometry_space().connectivity();
+  const Uint dim = coordinates.row_size();
+  const Uint nb_elem_nodes = connectivity.row_size();
+
+  std::vector<Uint> new_index(nb_elems);
+  if(nb_elems == 0)
+    return new_index;
+
+  // Centroids, taken as the average of the element nodes
+  std::vector<RealVector> centroids(nb_elems, RealVector(dim));
+  math::BoundingBox bounding_box;
+  for(Uint elem = 0; elem != nb_elems; ++elem)
+  {
+    RealVector& centroid = centroids[elem];
+    centroid.setZero();
+    boost_foreach(const Uint node, connectivity[elem])
+    {
+      for(Uint d = 0; d != dim; ++d)
+        centroid[d] += coordinates[node][d];
+    }
+    centroid /= static_cast<Real>(nb_elem_nodes);
+    bounding_box.extend(centroid);
+  }
+
+  math::Hilbert compute_key(bounding_box, 20);
+  std::vector< std::pair<boost::uint64_t, Uint> > keys(nb_elems);
+  for(Uint elem = 0; elem != nb_elems; ++elem)
+    keys[elem] = std::make_pair(compute_key(centroids[elem]), elem);
+  std::sort(keys.begin(), keys.end());
+
+  for(Uint i = 0; i != nb_elems; ++i)
+    new_index[keys[i].second] = i;
+  return new_index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // mesh
+} // cf3
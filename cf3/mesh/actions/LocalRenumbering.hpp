@@ -0,0 +1,73 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_actions_LocalRenumbering_hpp
+#define cf3_mesh_actions_LocalRenumbering_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/actions/LibActions.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+class Dictionary;
+class Entities;
+
+namespace actions {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Reorder the local nodes and elements of a mesh, so neighbouring entities are close in memory.
+/// Nodes of continuous dictionaries are put in reverse Cuthill-McKee order, the cells are put in the
+/// order of their centroids along a Hilbert space filling curve and the nodes of discontinuous dictionaries
+/// follow the order of the cells. Global indices and ranks move along with the entities, so only the local
+/// numbering changes.
+/// All fields, connectivity tables and periodic links are permuted, the comm patterns of the dictionaries
+/// are rebuilt the next time they are needed.
+class mesh_actions_API LocalRenumbering : public MeshTransformer
+{
+public: // functions
+
+  /// constructor
+  LocalRenumbering( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "LocalRenumbering"; }
+
+  virtual void execute();
+
+  /// Move every node of dict from index i to new_index[i], updating everything that refers to it.
+  /// new_index must be a permutation of the node indices.
+  static void renumber_nodes(Dictionary& dict, const std::vector<Uint>& new_index);
+
+  /// Move every element of entities from index i to new_index[i], updating everything that refers to it.
+  /// new_index must be a permutation of the element indices.
+  static void renumber_elements(Entities& entities, const std::vector<Uint>& new_index);
+
+  /// New index of each node of a continuous dictionary, in reverse Cuthill-McKee order
+  static std::vector<Uint> reverse_cuthill_mckee_order(const Dictionary& dict);
+
+  /// New index of each node of a dictionary, in order of first use by the elements
+  static std::vector<Uint> element_order(const Dictionary& dict);
+
+  /// New index of each element, in order of the centroids along a Hilbert curve
+  static std::vector<Uint> hilbert_order(const Entities& entities);
+
+}; // end LocalRenumbering
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_actions_LocalRenumbering_hpp
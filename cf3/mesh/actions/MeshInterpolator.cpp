@@ -106,16 +106,23 @@ void MeshInterpolator::execute()
     std::vector<Real> my_missing_points; my_missing_points.reserve(nb_target_points/10);
     
     
+    // All target points are searched in one batch
+    RealMatrix target_points(nb_target_points, dim);
     for(Uint i = 0; i != nb_target_points; ++i)
     {
-      std::vector<Uint> points;
-      std::vector<Real> weights;
-      std::vector<SpaceElem> dummy_stencil;
-      Field::ConstRow coordrow = target_coords[i];
-      Eigen::Map<RealVector const> coord(&coordrow[0], dim);
-      bool found = point_interpolator->compute_storage(coord, space_elems[i], dummy_stencil, points, weights);
-      if(!found)
+      for(Uint d = 0; d != dim; ++d)
+        target_points(i, d) = target_coords[i][d];
+    }
+    std::vector<bool> found;
+    std::vector< std::vector<SpaceElem> > stencils;
+    std::vector< std::vector<Uint> > points;
+    std::vector< std::vector<Real> > weights;
+    point_interpolator->compute_storage(target_points, space_elems, found, stencils, points, weights);
+    for(Uint i = 0; i != nb_target_points; ++i)
+    {
+      if(!found[i])
       {
+        Field::ConstRow coordrow = target_coords[i];
         my_missing_points.insert(my_missing_points.end(), coordrow.begin(), coordrow.end());
       }
     }
@@ -138,15 +145,18 @@ void MeshInterpolator::execute()
         const std::vector<Real>& other_missing_points = recv_missing_points[rank];
         cf3_assert(other_missing_points.size() % dim == 0);
         const Uint missing_end = other_missing_points.size() / dim;
+        RealMatrix missing_coords(missing_end, dim);
         for(Uint missing_idx = 0; missing_idx != missing_end; ++missing_idx)
         {
-          std::vector<Uint> points;
-          std::vector<Real> weights;
-          std::vector<SpaceElem> dummy_stencil;
-          SpaceElem space_elem;
-          Eigen::Map<RealVector const> coord(&other_missing_points[missing_idx*dim], dim);
-          bool found = point_interpolator->compute_storage(coord, space_elem, dummy_stencil, points, weights);
-          if(found && !space_elem.is_ghost())
+          for(Uint d = 0; d != dim; ++d)
+            missing_coords(missing_idx, d) = other_missing_points[missing_idx*dim + d];
+        }
+        std::vector<SpaceElem> missing_elems;
+        point_interpolator->compute_storage(missing_coords, missing_elems, found, stencils, points, weights);
+        for(Uint missing_idx = 0; missing_idx != missing_end; ++missing_idx)
+        {
+          const SpaceElem& space_elem = missing_elems[missing_idx];
+          if(found[missing_idx] && !space_elem.is_ghost())
           {
             elements_to_send[rank][space_elem.comp->support().entities_idx()].push_back(space_elem.idx);
           }
@@ -190,34 +200,30 @@ void MeshInterpolator::execute()
       perturbations[2*i+1][i] = -1e-8;
     }
 
+    point_interpolator->compute_storage(target_points, space_elems, found, stencils, points, weights);
     for(Uint i = 0; i != nb_target_points; ++i)
     {
-      std::vector<Uint> points;
-      std::vector<Real> weights;
-      std::vector<SpaceElem> dummy_stencil;
-      Field::ConstRow coordrow = target_coords[i];
-      Eigen::Map<RealVector const> coord(&coordrow[0], dim);
-      bool found = point_interpolator->compute_storage(coord, space_elems[i], dummy_stencil, points, weights);
-      if(!found)
+      bool point_found = found[i];
+      if(!point_found)
       {
+        Field::ConstRow coordrow = target_coords[i];
+        Eigen::Map<RealVector const> coord(&coordrow[0], dim);
         BOOST_FOREACH(const RealVector& perturbation, perturbations)
         {
-          found = point_interpolator->compute_storage(coord+perturbation, space_elems[i], dummy_stencil, points, weights);
-          if(found)
+          point_found = point_interpolator->compute_storage(coord+perturbation, space_elems[i], stencils[i], points[i], weights[i]);
+          if(point_found)
             break;
         }
+        if(!point_found && !target_dict->is_ghost(i))
+        {
+          CFerror << " Point " << coord.transpose() << " was not found in source mesh" << CFendl;
+          continue;
+        }
       }
-      if(!found && !target_dict->is_ghost(i))
-      {
-        CFerror << " Point " << coord.transpose() << " was not found in source mesh" << CFendl;
-      }
-      else
-      {
-        points_begin_idxs[i] = all_points.size();
-        all_points.insert(all_points.end(), points.begin(), points.end());
-        all_weights.insert(all_weights.end(), weights.begin(), weights.end());
-        points_end_idxs[i] = all_points.size();
-      }
+      points_begin_idxs[i] = all_points.size();
+      all_points.insert(all_points.end(), points[i].begin(), points[i].end());
+      all_weights.insert(all_weights.end(), weights[i].begin(), weights[i].end());
+      points_end_idxs[i] = all_points.size();
     }
 
     BOOST_FOREACH(const Handle<Field>& source_field, source_dict->fields())
@@ -4,7 +4,10 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
-#include <set>
+#include <limits>
+#include <map>
+
+#include <boost/thread/thread.hpp>
 
 #include "common/Builder.hpp"
 
@@ -13,18 +16,19 @@
 #include "common/Option.hpp"
 #include "common/OptionList.hpp"
 #include "common/List.hpp"
+#include "common/StringConversion.hpp"
+
+#include "common/PE/Comm.hpp"
 
-#include "mesh/ConnectivityData.hpp"
-#include "mesh/DiscontinuousDictionary.hpp"
+#include "mesh/Dictionary.hpp"
 #include "mesh/ElementData.hpp"
-#include "mesh/Faces.hpp"
+#include "mesh/Elements.hpp"
 #include "mesh/Region.hpp"
 #include "mesh/Space.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Field.hpp"
 #include "mesh/Functions.hpp"
 #include "mesh/Connectivity.hpp"
-#include "mesh/ElementData.hpp"
 
 #include "mesh/LagrangeP1/Triag2D.hpp"
 #include "mesh/LagrangeP1/Quad2D.hpp"
@@ -46,107 +50,340 @@ common::ComponentBuilder < WallDistance, MeshTransformer, mesh::actions::LibActi
 namespace detail
 {
 
-/// Helper struct to handle projection to the wall near a given surface node
-struct WallProjection
+/// Wall surface, gathered from all ranks. Coordinates always have 3 components, with Z zero in 2D.
+struct WallSurface
 {
-  WallProjection(const Field& coordinates, const CNodeConnectivity& node_connectivity) :
-    m_coords(coordinates),
-    m_node_connectivity(node_connectivity)
+  /// Number of surface nodes
+  Uint nb_nodes() const
+  {
+    return ids.size();
+  }
+
+  /// Coordinates of a surface node
+  RealVector3 coord(const Uint node) const
   {
+    return RealVector3(coords[3*node], coords[3*node+1], coords[3*node+2]);
   }
 
-  // Get the wall distance for an inner node, looking at the elements that are adjacent to the given surface node
-  Real operator()(const Uint inner_node_idx, const Uint surface_node_idx)
+  /// Fill the faces around each node, from the nodes of each face
+  void build_node_faces()
   {
-    RealMatrix elem_coords;
-    const Uint dim = m_coords.row_size();
-    const RealVector inner_coord = to_vector(m_coords[inner_node_idx]);
-    std::vector<Uint> neighbor_nodes; // Collect neighboring nodes, so we can project onto a sharp corner in 3D if needed (i.e. near a step)
-    // Loop over all surface elements around the given node
-    BOOST_FOREACH(const Uint elem_idx, m_node_connectivity.node_element_range(surface_node_idx))
+    const Uint nb_faces = face_offsets.size() - 1;
+    node_face_offsets.assign(nb_nodes() + 1, 0);
+    for(Uint face = 0; face != nb_faces; ++face)
     {
-      // Get the element coordinates
-      const CNodeConnectivity::ElementReferenceT element_ref = m_node_connectivity.element(elem_idx);
-      const ElementType& etype = element_ref.first->element_type();
-      const Uint element_nb_nodes = etype.nb_nodes();
-      elem_coords.resize(element_nb_nodes, dim);
-      const Connectivity::ConstRow conn_row = element_ref.first->geometry_space().connectivity()[element_ref.second];
-      fill(elem_coords, m_coords, conn_row);
-
-      // We consider lines, triangles and quads as viable surface elements
-      if(element_nb_nodes < 2 || element_nb_nodes > 4 || etype.order() != 1)
+      for(Uint i = face_offsets[face]; i != face_offsets[face+1]; ++i)
+        ++node_face_offsets[face_nodes[i]+1];
+    }
+    for(Uint node = 0; node != nb_nodes(); ++node)
+      node_face_offsets[node+1] += node_face_offsets[node];
+
+    node_faces.resize(face_nodes.size());
+    std::vector<Uint> positions(node_face_offsets.begin(), node_face_offsets.end() - 1);
+    for(Uint face = 0; face != nb_faces; ++face)
+    {
+      for(Uint i = face_offsets[face]; i != face_offsets[face+1]; ++i)
+        node_faces[positions[face_nodes[i]]++] = face;
+    }
+  }
+
+  /// Identifier of each surface node: the global index in parallel, the local index otherwise
+  std::vector<Uint> ids;
+  /// Coordinates of the surface nodes, 3 per node
+  std::vector<Real> coords;
+  /// Nodes of each face, with face f stored in [face_offsets[f], face_offsets[f+1])
+  std::vector<Uint> face_nodes;
+  std::vector<Uint> face_offsets;
+  /// Faces around each node, with node n stored in [node_face_offsets[n], node_face_offsets[n+1])
+  std::vector<Uint> node_faces;
+  std::vector<Uint> node_face_offsets;
+};
+
+/// Collect the wall faces of all ranks. Nodes on the local wall are marked in is_wall_node.
+void build_wall_surface(const std::vector< Handle<Entities const> >& surface_entities, const Dictionary& geometry, WallSurface& surface, std::vector<bool>& is_wall_node)
+{
+  common::PE::Comm& comm = common::PE::Comm::instance();
+  const bool is_parallel = comm.is_active() && comm.size() > 1;
+  const Field& coords = geometry.coordinates();
+  const Uint dim = coords.row_size();
+
+  // Nodes, including the nodes linked periodically to the wall
+  std::vector< std::vector<Uint> > node_ids(1);
+  std::vector< std::vector<Real> > node_coords(1);
+  is_wall_node.assign(coords.size(), false);
+  boost::shared_ptr< common::List< Uint > > surface_nodes = build_used_nodes_list(surface_entities, geometry, true);
+  BOOST_FOREACH(const Uint node, surface_nodes->array())
+  {
+    is_wall_node[node] = true;
+    node_ids[0].push_back(is_parallel ? geometry.glb_idx()[node] : node);
+    for(Uint i = 0; i != 3; ++i)
+      node_coords[0].push_back(i < dim ? coords[node][i] : 0.);
+  }
+
+  // Faces, by number of nodes and node identifiers
+  std::vector< std::vector<Uint> > face_sizes(1);
+  std::vector< std::vector<Uint> > face_node_ids(1);
+  BOOST_FOREACH(const Handle<Entities const>& entities, surface_entities)
+  {
+    const ElementType& etype = entities->element_type();
+    const Uint element_nb_nodes = etype.nb_nodes();
+    // We consider lines, triangles and quads as viable surface elements
+    if(element_nb_nodes < 2 || element_nb_nodes > 4 || etype.order() != 1)
+    {
+      throw common::SetupError(FromHere(), "Unsupported surface element of type " + etype.name() + " in surface region " + entities->uri().path());
+    }
+
+    const Connectivity& connectivity = entities->geometry_space().connectivity();
+    const Uint nb_elems = connectivity.size();
+    for(Uint elem_idx = 0; elem_idx != nb_elems; ++elem_idx)
+    {
+      face_sizes[0].push_back(element_nb_nodes);
+      BOOST_FOREACH(const Uint node, connectivity[elem_idx])
       {
-        throw common::SetupError(FromHere(), "Unsupported surface element of type " + etype.name() + " in surface region " + element_ref.first->uri().path());
+        face_node_ids[0].push_back(is_parallel ? geometry.glb_idx()[node] : node);
       }
-      
+    }
+  }
+
+  if(is_parallel)
+  {
+    std::vector< std::vector<Uint> > recv_uint;
+    std::vector< std::vector<Real> > recv_real;
+    comm.all_gather(node_ids[0], recv_uint);
+    node_ids.swap(recv_uint);
+    comm.all_gather(node_coords[0], recv_real);
+    node_coords.swap(recv_real);
+    comm.all_gather(face_sizes[0], recv_uint);
+    face_sizes.swap(recv_uint);
+    comm.all_gather(face_node_ids[0], recv_uint);
+    face_node_ids.swap(recv_uint);
+  }
+
+  // Merge the nodes that are on the wall of several ranks
+  std::map<Uint, Uint> id_to_node;
+  const Uint nb_parts = node_ids.size();
+  for(Uint part = 0; part != nb_parts; ++part)
+  {
+    const Uint nb_part_nodes = node_ids[part].size();
+    for(Uint i = 0; i != nb_part_nodes; ++i)
+    {
+      if(id_to_node.insert(std::make_pair(node_ids[part][i], surface.ids.size())).second)
+      {
+        surface.ids.push_back(node_ids[part][i]);
+        surface.coords.insert(surface.coords.end(), node_coords[part].begin() + 3*i, node_coords[part].begin() + 3*(i+1));
+      }
+    }
+  }
+
+  surface.face_offsets.assign(1, 0);
+  for(Uint part = 0; part != nb_parts; ++part)
+  {
+    std::vector<Uint>::const_iterator id_it = face_node_ids[part].begin();
+    BOOST_FOREACH(const Uint face_size, face_sizes[part])
+    {
+      for(Uint i = 0; i != face_size; ++i, ++id_it)
+      {
+        cf3_assert(id_to_node.count(*id_it));
+        surface.face_nodes.push_back(id_to_node[*id_it]);
+      }
+      surface.face_offsets.push_back(surface.face_nodes.size());
+    }
+  }
+
+  surface.build_node_faces();
+}
+
+/// Orders surface nodes by one of their coordinates
+struct CoordLess
+{
+  CoordLess(const std::vector<Real>& coords, const Uint axis) : m_coords(coords), m_axis(axis)
+  {
+  }
+
+  bool operator()(const Uint a, const Uint b) const
+  {
+    return m_coords[3*a+m_axis] < m_coords[3*b+m_axis];
+  }
+
+  const std::vector<Real>& m_coords;
+  const Uint m_axis;
+};
+
+/// Balanced k-d tree over the surface nodes. The node splitting the range [begin, end) is stored at its middle.
+class NodeTree
+{
+public:
+  NodeTree(const WallSurface& surface) :
+    m_surface(surface),
+    m_axes(surface.nb_nodes(), 0)
+  {
+    m_nodes.reserve(surface.nb_nodes());
+    for(Uint i = 0; i != surface.nb_nodes(); ++i)
+      m_nodes.push_back(i);
+    build(0, m_nodes.size());
+  }
+
+  /// Surface node closest to point. As in a linear search over the nodes ordered by id, ties go to the lowest id.
+  Uint closest(const RealVector3& point) const
+  {
+    Uint result = 0;
+    Real distance2 = std::numeric_limits<Real>::max();
+    search(0, m_nodes.size(), point, result, distance2);
+    return result;
+  }
+
+private:
+  void build(const Uint begin, const Uint end)
+  {
+    if(end - begin < 2)
+      return;
+
+    // Split along the largest extent of the nodes in the range
+    RealVector3 min = RealVector3::Constant(std::numeric_limits<Real>::max());
+    RealVector3 max = -min;
+    for(Uint i = begin; i != end; ++i)
+    {
+      const RealVector3 coord = m_surface.coord(m_nodes[i]);
+      min = min.cwiseMin(coord);
+      max = max.cwiseMax(coord);
+    }
+    RealVector3::Index axis;
+    (max - min).maxCoeff(&axis);
+
+    const Uint mid = (begin + end) / 2;
+    std::nth_element(m_nodes.begin() + begin, m_nodes.begin() + mid, m_nodes.begin() + end, CoordLess(m_surface.coords, axis));
+    m_axes[mid] = axis;
+    build(begin, mid);
+    build(mid + 1, end);
+  }
+
+  void search(const Uint begin, const Uint end, const RealVector3& point, Uint& result, Real& distance2) const
+  {
+    if(begin == end)
+      return;
+
+    const Uint mid = (begin + end) / 2;
+    const Uint node = m_nodes[mid];
+    const Real* coord = &m_surface.coords[3*node];
+    Real node_distance2 = 0.;
+    for(Uint i = 0; i != 3; ++i)
+      node_distance2 += (point[i] - coord[i]) * (point[i] - coord[i]);
+    if(node_distance2 < distance2 || (node_distance2 == distance2 && m_surface.ids[node] < m_surface.ids[result]))
+    {
+      result = node;
+      distance2 = node_distance2;
+    }
+
+    // Visit the side containing the point first, and the other side only if it may hold a node at the same distance
+    const Uint axis = m_axes[mid];
+    const Real delta = point[axis] - coord[axis];
+    if(delta < 0.)
+    {
+      search(begin, mid, point, result, distance2);
+      if(delta*delta <= distance2)
+        search(mid + 1, end, point, result, distance2);
+    }
+    else
+    {
+      search(mid + 1, end, point, result, distance2);
+      if(delta*delta <= distance2)
+        search(begin, mid, point, result, distance2);
+    }
+  }
+
+  const WallSurface& m_surface;
+  std::vector<Uint> m_nodes;
+  std::vector<Uint> m_axes;
+};
+
+/// Helper struct to handle projection to the wall near a given surface node
+struct WallProjection
+{
+  WallProjection(const WallSurface& surface) :
+    m_surface(surface)
+  {
+  }
+
+  // Get the wall distance for an inner node, looking at the faces that are adjacent to the given surface node
+  Real operator()(const RealVector3& inner_coord, const Uint surface_node_idx)
+  {
+    // Smallest normal distance to the faces the inner node projects into. On a curved wall the node may project into several faces.
+    Real face_distance = std::numeric_limits<Real>::max();
+    m_neighbor_nodes.clear(); // Collect neighboring nodes, so we can project onto a sharp corner in 3D if needed (i.e. near a step)
+    // Loop over all surface faces around the given node
+    for(Uint i = m_surface.node_face_offsets[surface_node_idx]; i != m_surface.node_face_offsets[surface_node_idx+1]; ++i)
+    {
+      const Uint face = m_surface.node_faces[i];
+      const Uint* conn_row = &m_surface.face_nodes[m_surface.face_offsets[face]];
+      const Uint element_nb_nodes = m_surface.face_offsets[face+1] - m_surface.face_offsets[face];
+      for(Uint j = 0; j != element_nb_nodes; ++j)
+        m_elem_coords.row(j) = m_surface.coord(conn_row[j]).transpose();
+
       bool in_element = false;
+      RealVector3 n; // normal vector
 
       if(element_nb_nodes == 2) // line segment
       {
-        cf3_assert(dim == 2);
-        cf3_assert(etype.shape() == GeoShape::LINE);
-        RealVector e1 = elem_coords.row(1) - elem_coords.row(0); // line segment vector
+        RealVector3 e1 = m_elem_coords.row(1) - m_elem_coords.row(0); // line segment vector
         Real e1_len = e1.norm();
         e1 /= e1_len;
-        const Real projection = e1.dot(inner_coord - elem_coords.row(0).transpose());
+        const Real projection = e1.dot(inner_coord - m_elem_coords.row(0).transpose());
         // If the projection of the node along the normal fits inside the element, we can take the normal distance
         in_element = projection > 0 && projection < e1_len;
+        n << e1[YY], -e1[XX], 0.;
       }
       if(element_nb_nodes == 3)
       {
-        cf3_assert(dim == 3);
-        cf3_assert(etype.shape() == GeoShape::TRIAG);
-        RealVector3 e1 = (elem_coords.row(1) - elem_coords.row(0)).normalized();
-        RealVector3 en = elem_coords.row(2) - elem_coords.row(0);
+        RealVector3 e1 = (m_elem_coords.row(1) - m_elem_coords.row(0)).normalized();
+        RealVector3 en = m_elem_coords.row(2) - m_elem_coords.row(0);
         RealVector3 e2 = (e1.cross(en)).cross(e1).normalized();
-        RealVector3 p = inner_coord - elem_coords.row(0).transpose();
-        
+        RealVector3 p = inner_coord - m_elem_coords.row(0).transpose();
+
         // Construct 2D coordinates for the boundary element
         Eigen::Matrix<Real, 3, 2> triag_coords_2d;
         triag_coords_2d.row(0).setZero();
-        triag_coords_2d(1,0) = e1.dot(elem_coords.row(1) - elem_coords.row(0));
+        triag_coords_2d(1,0) = e1.dot(m_elem_coords.row(1) - m_elem_coords.row(0));
         triag_coords_2d(1,1) = 0.;
-        triag_coords_2d(2,0) = e1.dot(elem_coords.row(2) - elem_coords.row(0));
-        triag_coords_2d(2,1) = e2.dot(elem_coords.row(2) - elem_coords.row(0));
-        
+        triag_coords_2d(2,0) = e1.dot(m_elem_coords.row(2) - m_elem_coords.row(0));
+        triag_coords_2d(2,1) = e2.dot(m_elem_coords.row(2) - m_elem_coords.row(0));
+
         RealVector2 p_proj(2);
         p_proj[0] = p.dot(e1);
         p_proj[1] = p.dot(e2);
-        
+
         in_element = LagrangeP1::Triag2D::is_coord_in_element(p_proj, triag_coords_2d);
-        const Uint origin_corner = std::find(conn_row.begin(), conn_row.end(), surface_node_idx) - conn_row.begin();
+        const Uint origin_corner = std::find(conn_row, conn_row + 3, surface_node_idx) - conn_row;
         if(origin_corner == 0)
         {
-          neighbor_nodes.push_back(conn_row[1]);
-          neighbor_nodes.push_back(conn_row[2]);
+          m_neighbor_nodes.push_back(conn_row[1]);
+          m_neighbor_nodes.push_back(conn_row[2]);
         }
         else if(origin_corner == 1)
         {
-          neighbor_nodes.push_back(conn_row[0]);
-          neighbor_nodes.push_back(conn_row[2]);
+          m_neighbor_nodes.push_back(conn_row[0]);
+          m_neighbor_nodes.push_back(conn_row[2]);
         }
         else
         {
-          neighbor_nodes.push_back(conn_row[0]);
-          neighbor_nodes.push_back(conn_row[1]);
+          m_neighbor_nodes.push_back(conn_row[0]);
+          m_neighbor_nodes.push_back(conn_row[1]);
         }
+        n = e1.cross(en);
       }
       if(element_nb_nodes == 4)
       {
-        cf3_assert(dim == 3);
-        cf3_assert(etype.shape() == GeoShape::QUAD);
-        RealVector3 e1 = (elem_coords.row(1) - elem_coords.row(0)).normalized();
-        RealVector3 en = elem_coords.row(3) - elem_coords.row(0);
+        RealVector3 e1 = (m_elem_coords.row(1) - m_elem_coords.row(0)).normalized();
+        RealVector3 en = m_elem_coords.row(3) - m_elem_coords.row(0);
         RealVector3 e2 = (e1.cross(en)).cross(e1).normalized();
-        RealVector3 p = inner_coord - elem_coords.row(0).transpose();
+        RealVector3 p = inner_coord - m_elem_coords.row(0).transpose();
 
         // Construct 2D coordinates for the boundary element
         Eigen::Matrix<Real, 4, 2> quad_coords_2d;
         quad_coords_2d.row(0).setZero();
         for(int i = 1; i != 4; ++i)
         {
-          quad_coords_2d(i, 0) = e1.dot(elem_coords.row(i) - elem_coords.row(0));
-          quad_coords_2d(i, 1) = e2.dot(elem_coords.row(i) - elem_coords.row(0));
+          quad_coords_2d(i, 0) = e1.dot(m_elem_coords.row(i) - m_elem_coords.row(0));
+          quad_coords_2d(i, 1) = e2.dot(m_elem_coords.row(i) - m_elem_coords.row(0));
         }
 
         RealVector2 p_proj(2);
@@ -154,34 +391,39 @@ struct WallProjection
         p_proj[1] = p.dot(e2);
 
         in_element = LagrangeP1::Quad2D::is_coord_in_element(p_proj, quad_coords_2d);
-        const Uint origin_corner = std::find(conn_row.begin(), conn_row.end(), surface_node_idx) - conn_row.begin();
+        const Uint origin_corner = std::find(conn_row, conn_row + 4, surface_node_idx) - conn_row;
         if(origin_corner == 0 || origin_corner == 2)
         {
-          neighbor_nodes.push_back(conn_row[1]);
-          neighbor_nodes.push_back(conn_row[3]);
+          m_neighbor_nodes.push_back(conn_row[1]);
+          m_neighbor_nodes.push_back(conn_row[3]);
         }
         else
         {
-          neighbor_nodes.push_back(conn_row[0]);
-          neighbor_nodes.push_back(conn_row[2]);
+          m_neighbor_nodes.push_back(conn_row[0]);
+          m_neighbor_nodes.push_back(conn_row[2]);
         }
+        // Normal at the centre of the quad, as computed by LagrangeP1::Quad3D
+        const RealVector3 d_ksi = m_elem_coords.row(1) + m_elem_coords.row(2) - m_elem_coords.row(0) - m_elem_coords.row(3);
+        const RealVector3 d_eta = m_elem_coords.row(2) + m_elem_coords.row(3) - m_elem_coords.row(0) - m_elem_coords.row(1);
+        n = d_ksi.cross(d_eta);
       }
-      
+
       // If the projection was in an element, we can just proceed to compute the normal distance
       if(in_element)
       {
-        RealVector n(dim); // normal vector
-        etype.compute_normal(elem_coords, n);
-        return fabs((n/n.norm()).dot(inner_coord - elem_coords.row(0).transpose()));
+        face_distance = std::min(face_distance, fabs((n/n.norm()).dot(inner_coord - m_elem_coords.row(0).transpose())));
       }
     }
+    if(face_distance != std::numeric_limits<Real>::max())
+      return face_distance;
+
     // If we got here, no projections on the elements gave a result
     // First, verify the 3D case where we need to project on "step" edges
-    BOOST_FOREACH(const Uint neighbor_node, neighbor_nodes)
+    const RealVector3 surface_coord = m_surface.coord(surface_node_idx);
+    BOOST_FOREACH(const Uint neighbor_node, m_neighbor_nodes)
     {
-      const RealVector surface_coord = to_vector(m_coords[surface_node_idx]);
-      const RealVector neighbor_coord = to_vector(m_coords[neighbor_node]);
-      RealVector e1 = neighbor_coord - surface_coord;
+      const RealVector3 neighbor_coord = m_surface.coord(neighbor_node);
+      RealVector3 e1 = neighbor_coord - surface_coord;
       Real e1_len = e1.norm();
       e1 /= e1_len;
       const Real projection = e1.dot(inner_coord - surface_coord);
@@ -190,33 +432,93 @@ struct WallProjection
         return (inner_coord - (surface_coord + e1*projection)).norm();
       }
     }
-    return (inner_coord - to_vector(m_coords[surface_node_idx])).norm();
+    return (inner_coord - surface_coord).norm();
+  }
+
+  const WallSurface& m_surface;
+  Eigen::Matrix<Real, 4, 3> m_elem_coords;
+  std::vector<Uint> m_neighbor_nodes;
+};
+
+/// Computes the wall distance for the nodes in the range [begin, end), run by each thread
+struct WallDistanceLoop
+{
+  WallDistanceLoop(const WallSurface& surface, const NodeTree& tree, const Field& coords, const std::vector<bool>& is_wall_node, Field& distance, const Uint begin, const Uint end, std::string& error) :
+    m_surface(surface),
+    m_tree(tree),
+    m_coords(coords),
+    m_is_wall_node(is_wall_node),
+    m_distance(distance),
+    m_begin(begin),
+    m_end(end),
+    m_error(error)
+  {
+  }
+
+  void operator()()
+  {
+    try
+    {
+      WallProjection normal_distance(m_surface);
+      const Uint dim = m_coords.row_size();
+      RealVector3 inner_coord = RealVector3::Zero();
+      for(Uint inner_node_idx = m_begin; inner_node_idx != m_end; ++inner_node_idx)
+      {
+        if(m_is_wall_node[inner_node_idx])
+        {
+          m_distance[inner_node_idx][0] = 0.;
+          continue;
+        }
+        for(Uint i = 0; i != dim; ++i)
+          inner_coord[i] = m_coords[inner_node_idx][i];
+        m_distance[inner_node_idx][0] = normal_distance(inner_coord, m_tree.closest(inner_coord));
+      }
+    }
+    catch(std::exception& e)
+    {
+      m_error = e.what();
+    }
   }
 
+  const WallSurface& m_surface;
+  const NodeTree& m_tree;
   const Field& m_coords;
-  const CNodeConnectivity& m_node_connectivity;
+  const std::vector<bool>& m_is_wall_node;
+  Field& m_distance;
+  const Uint m_begin;
+  const Uint m_end;
+  std::string& m_error;
 };
+
 }
 
-WallDistance::WallDistance(const std::string& name) : MeshTransformer(name)
+WallDistance::WallDistance(const std::string& name) :
+  MeshTransformer(name),
+  m_nb_threads(1)
 {
   options().add("regions", m_regions)
       .pretty_name("Regions")
       .description("Regions that are to be considered as part of the wall")
       .link_to(&m_regions)
       .mark_basic();
+
+  options().add("nb_threads", m_nb_threads)
+      .pretty_name("Number of Threads")
+      .description("Number of threads used to compute the distance for the nodes of each rank")
+      .link_to(&m_nb_threads);
 }
 
 void WallDistance::execute()
 {
   Mesh& mesh = *m_mesh;
 
-  Field& d = mesh.geometry_fields().create_field("WallDistance", "wall_distance");
+  // Reuse the field when the distance is recomputed
+  Handle<Field> existing_field(mesh.geometry_fields().get_child("WallDistance"));
+  Field& d = is_null(existing_field) ? mesh.geometry_fields().create_field("WallDistance", "wall_distance") : *existing_field;
   d.add_tag("wall_distance");
   const Field& coords = mesh.geometry_fields().coordinates();
   const Uint nb_nodes = coords.size();
 
-  boost::shared_ptr<CNodeConnectivity> node_connectivity = common::allocate_component<CNodeConnectivity>("NodeConnectivity");
   std::vector< Handle<Entities const> > surface_entities;
   BOOST_FOREACH(const Handle<Region const>& region, m_regions)
   {
@@ -226,38 +528,28 @@ void WallDistance::execute()
     }
   }
 
-  node_connectivity->initialize(nb_nodes, surface_entities);
+  // The complete wall is available on each rank
+  detail::WallSurface surface;
+  std::vector<bool> is_wall_node;
+  detail::build_wall_surface(surface_entities, mesh.geometry_fields(), surface, is_wall_node);
+  if(surface.nb_nodes() == 0)
+    throw common::SetupError(FromHere(), "No wall nodes found in the regions of " + uri().path());
 
-  boost::shared_ptr< common::List< Uint > > surface_nodes_ptr = build_used_nodes_list(surface_entities, mesh.geometry_fields(), true);
-  const common::List<Uint>& surface_nodes = *surface_nodes_ptr;
-  const Uint nb_surface_nodes = surface_nodes.size();
+  const detail::NodeTree tree(surface);
 
-  detail::WallProjection normal_distance(coords, *node_connectivity);
+  const Uint nb_threads = std::max(1u, std::min(m_nb_threads, nb_nodes));
+  std::vector<std::string> errors(nb_threads);
+  boost::thread_group threads;
+  for(Uint i = 1; i < nb_threads; ++i)
+    threads.create_thread(detail::WallDistanceLoop(surface, tree, coords, is_wall_node, d, (nb_nodes * i) / nb_threads, (nb_nodes * (i+1)) / nb_threads, errors[i]));
+  detail::WallDistanceLoop(surface, tree, coords, is_wall_node, d, 0, nb_nodes / nb_threads, errors[0])();
+  threads.join_all();
 
-  for(Uint inner_node_idx = 0; inner_node_idx != nb_nodes; ++inner_node_idx)
+  for(Uint i = 0; i != nb_threads; ++i)
   {
-    bool is_surface_node = false;
-    Real shortest_distance = 1e20;
-    Uint closest_surface_node = 0;
-    for(Uint j = 0; j != nb_surface_nodes; ++j)
-    {
-      const Uint surface_node_idx = surface_nodes[j];
-      if(surface_node_idx == inner_node_idx)
-      {
-        is_surface_node = true;
-        break;
-      }
-      const Real d2 = (to_vector(coords[inner_node_idx]) - to_vector(coords[surface_node_idx])).squaredNorm();
-      if(d2 < shortest_distance)
-      {
-        shortest_distance = d2;
-        closest_surface_node = surface_node_idx;
-      }
-    }
-
-    d[inner_node_idx][0] = is_surface_node ? 0. : normal_distance(inner_node_idx, closest_surface_node);
+    if(!errors[i].empty())
+      throw common::ParallelError(FromHere(), "Error in wall distance thread " + common::to_str(i) + ": " + errors[i]);
   }
-
 }
 
 //////////////////////////////////////////////////////////////////////////////
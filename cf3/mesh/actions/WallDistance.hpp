@@ -22,6 +22,9 @@ namespace actions {
 
 //////////////////////////////////////////////////////////////////////////////
 
+/// Compute the distance to the wall for every node of the geometry dictionary, stored in the field "WallDistance"
+/// as the variable "wall_distance". The wall faces of all ranks are gathered and the closest wall node is looked up in
+/// a k-d tree, after which the distance is projected onto the wall faces around that node.
 class WallDistance : public MeshTransformer
 {
 public:
@@ -32,6 +35,9 @@ public:
 private:
   /// Wall regions to operate over
   std::vector< Handle<Region> > m_regions;
+
+  /// Number of threads used in the loop over the nodes
+  Uint m_nb_threads;
 };
 
 
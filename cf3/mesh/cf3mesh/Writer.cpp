@@ -12,6 +12,7 @@
 #include "common/BoostFilesystem.hpp"
 #include "common/Foreach.hpp"
 #include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
 #include "common/Log.hpp"
 #include "common/PE/Comm.hpp"
 #include "common/Builder.hpp"
@@ -162,7 +163,22 @@ namespace detail
 Writer::Writer( const std::string& name )
 : MeshWriter(name)
 {
+  std::vector<boost::any> codecs;
+  codecs.push_back(std::string("zlib"));
+  codecs.push_back(std::string("zlib_fast"));
+  codecs.push_back(std::string("none"));
+  options().add("codec", std::string("zlib"))
+    .pretty_name("Codec")
+    .description("Compression used for the binary data: zlib, zlib_fast (fastest zlib level) or none")
+    .restricted_list() = codecs;
 
+  options().add("chunk_size", 1048576u)
+    .pretty_name("Chunk Size")
+    .description("Size in bytes of the independently compressed chunks of each binary data block. 0 compresses each block as a single stream.");
+
+  options().add("nb_threads", 1u)
+    .pretty_name("Number of Threads")
+    .description("Number of threads used to compress the chunks of a binary data block");
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -186,6 +202,9 @@ void Writer::write()
   boost::shared_ptr<common::BinaryDataWriter> data_writer = common::allocate_component<common::BinaryDataWriter>("DataWriter");
   const common::URI binfile = m_file_path.base_path() / (m_file_path.base_name() + ".cfbinxml");
   data_writer->options().set("file", binfile);
+  data_writer->options().set("codec", options().value<std::string>("codec"));
+  data_writer->options().set("chunk_size", options().value<Uint>("chunk_size"));
+  data_writer->options().set("nb_threads", options().value<Uint>("nb_threads"));
   
   common::XML::XmlDoc xml_doc("1.0", "ISO-8859-1");
   common::XML::XmlNode mesh_node = xml_doc.add_node("mesh");
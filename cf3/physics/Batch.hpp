@@ -0,0 +1,168 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+/// @file Batch.hpp
+/// @brief Structure of arrays storage of the states and fluxes of a batch of faces, shared by all physics
+
+#ifndef cf3_physics_Batch_hpp
+#define cf3_physics_Batch_hpp
+
+#include "math/Defs.hpp"
+#include "physics/MatrixTypes.hpp"
+
+namespace cf3 {
+namespace physics {
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Number of faces in a batch, processed together by the batched flux functions
+enum {BATCH_SIZE=8};
+
+/// @brief The variables of DATA used by the Riemann solvers of a gas, for BATCH_SIZE states.
+/// Each variable is stored contiguously for all states, so loops over the batch vectorize.
+/// The velocity is read through velocity_component(data, d), which each physics provides next to its DATA.
+template < typename DATA, Uint NB_DIM, Uint NB_EQS >
+struct StateBatchT
+{
+  Real gamma[BATCH_SIZE];           ///< specific heat ratio
+  Real rho[BATCH_SIZE];             ///< density
+  Real U[NB_DIM][BATCH_SIZE];       ///< velocity
+  Real H[BATCH_SIZE];               ///< specific enthalpy
+  Real c[BATCH_SIZE];               ///< speed of sound
+  Real p[BATCH_SIZE];               ///< pressure
+  Real cons[NB_EQS][BATCH_SIZE];    ///< conservative state
+
+  /// @brief Copy the state in the given lane
+  void set(const Uint lane, const DATA& data)
+  {
+    gamma[lane] = data.gamma;
+    rho[lane]   = data.rho;
+    for (Uint d=0; d<NB_DIM; ++d)
+      U[d][lane] = velocity_component(data, d);
+    H[lane]     = data.H;
+    c[lane]     = data.c;
+    p[lane]     = data.p;
+    for (Uint eq=0; eq<NB_EQS; ++eq)
+      cons[eq][lane] = data.cons[eq];
+  }
+};
+
+/// @brief Left and right states and normals of a batch of faces.
+/// All lanes are initialized to a gas at rest, so lanes that are not set still give valid fluxes.
+template < typename DATA, Uint NB_DIM, Uint NB_EQS >
+struct FaceBatchT
+{
+  typedef typename MatrixTypes<NB_DIM,NB_EQS>::ColVector_NDIM ColVector_NDIM;
+  typedef typename MatrixTypes<NB_DIM,NB_EQS>::RowVector_NEQS RowVector_NEQS;
+
+  FaceBatchT()
+  {
+    // Gas at rest with unit density and pressure, the primitive state being density, velocity and pressure
+    DATA rest;
+    rest.gamma = 1.4;
+    rest.R = 287.05;
+    RowVector_NEQS prim = RowVector_NEQS::Zero();
+    prim[0] = 1.;
+    prim[NB_EQS-1] = 1.;
+    rest.compute_from_primitive(prim);
+    ColVector_NDIM unit_normal = ColVector_NDIM::Zero();
+    unit_normal[XX] = 1.;
+    for (Uint lane=0; lane<BATCH_SIZE; ++lane)
+      set_face(lane, rest, rest, unit_normal);
+  }
+
+  StateBatchT<DATA,NB_DIM,NB_EQS> left;    ///< states on the left of the faces
+  StateBatchT<DATA,NB_DIM,NB_EQS> right;   ///< states on the right of the faces
+  Real normal[NB_DIM][BATCH_SIZE];         ///< unit normals, pointing from left to right
+
+  /// @brief Copy the states and normal of a face in the given lane
+  void set_face(const Uint lane, const DATA& left_data, const DATA& right_data, const ColVector_NDIM& face_normal)
+  {
+    left.set(lane, left_data);
+    right.set(lane, right_data);
+    for (Uint d=0; d<NB_DIM; ++d)
+      normal[d][lane] = face_normal[d];
+  }
+};
+
+/// @brief Fluxes and wave speeds of a batch of faces
+template < Uint NB_EQS >
+struct FluxBatchT
+{
+  typedef typename MatrixTypes<1,NB_EQS>::RowVector_NEQS RowVector_NEQS;
+
+  Real flux[NB_EQS][BATCH_SIZE];    ///< flux through each face
+  Real wave_speed[BATCH_SIZE];      ///< maximum absolute wave speed in each face
+
+  /// @brief Copy the flux and wave speed of the given lane
+  void get(const Uint lane, RowVector_NEQS& face_flux, Real& face_wave_speed) const
+  {
+    for (Uint eq=0; eq<NB_EQS; ++eq)
+      face_flux[eq] = flux[eq][lane];
+    face_wave_speed = wave_speed[lane];
+  }
+};
+
+/// @brief The variables of DATA used by the diffusive flux of a viscous gas, for a batch of faces.
+/// The velocity gradients are read through velocity_gradient(data, i), giving the gradient of velocity component i.
+/// All lanes are initialized to a gas at rest, so lanes that are not set still give valid fluxes.
+template < typename DATA, Uint NB_DIM >
+struct DiffusiveFaceBatchT
+{
+  typedef typename MatrixTypes<NB_DIM>::ColVector_NDIM ColVector_NDIM;
+
+  DiffusiveFaceBatchT()
+  {
+    for (Uint lane=0; lane<BATCH_SIZE; ++lane)
+    {
+      mu[lane] = 0.;
+      kappa[lane] = 0.;
+      Cp[lane] = 1.;
+      rho[lane] = 1.;
+      for (Uint d=0; d<NB_DIM; ++d)
+      {
+        U[d][lane] = 0.;
+        for (Uint i=0; i<NB_DIM; ++i)
+          grad_U[i][d][lane] = 0.;
+        grad_T[d][lane] = 0.;
+        normal[d][lane] = (d == XX ? 1. : 0.);
+      }
+    }
+  }
+
+  Real mu[BATCH_SIZE];                      ///< dynamic viscosity
+  Real kappa[BATCH_SIZE];                   ///< thermal conductivity
+  Real Cp[BATCH_SIZE];                      ///< heat capacity
+  Real rho[BATCH_SIZE];                     ///< density
+  Real U[NB_DIM][BATCH_SIZE];               ///< velocity
+  Real grad_U[NB_DIM][NB_DIM][BATCH_SIZE];  ///< gradient of each velocity component
+  Real grad_T[NB_DIM][BATCH_SIZE];          ///< gradient of temperature
+  Real normal[NB_DIM][BATCH_SIZE];          ///< unit normals
+
+  /// @brief Copy the face state and normal in the given lane
+  void set_face(const Uint lane, const DATA& data, const ColVector_NDIM& face_normal)
+  {
+    mu[lane]    = data.mu;
+    kappa[lane] = data.kappa;
+    Cp[lane]    = data.Cp;
+    rho[lane]   = data.rho;
+    for (Uint d=0; d<NB_DIM; ++d)
+    {
+      U[d][lane] = velocity_component(data, d);
+      for (Uint i=0; i<NB_DIM; ++i)
+        grad_U[i][d][lane] = velocity_gradient(data, i)[d];
+      grad_T[d][lane] = data.grad_T[d];
+      normal[d][lane] = face_normal[d];
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+} // physics
+} // cf3
+
+#endif // cf3_physics_Batch_hpp
@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include "common/Builder.hpp"
 #include "common/FindComponents.hpp"
 #include "common/OptionList.hpp"
@@ -33,7 +35,7 @@ common::ComponentBuilder < ComputeRHS, common::Action, solver::LibSolver > Compu
 
 ////////////////////////////////////////////////////////////////////////////////
 
-ComputeRHS::ComputeRHS ( const std::string& name ) : common::Action(name)
+ComputeRHS::ComputeRHS ( const std::string& name ) : common::Action(name), m_block_size(32)
 {
   options().add("rhs",m_rhs).link_to(&m_rhs)
       .description("Right-Hand-Side of equations")
@@ -41,6 +43,9 @@ ComputeRHS::ComputeRHS ( const std::string& name ) : common::Action(name)
   options().add("wave_speed",m_ws).link_to(&m_ws)
       .description("Wave speed")
       .mark_basic();
+  options().add("block_size",m_block_size).link_to(&m_block_size)
+      .pretty_name("Block Size")
+      .description("Maximum number of elements computed by each term at once");
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -104,9 +109,38 @@ void ComputeRHS::compute_rhs(const Uint elem_idx, std::vector<RealVector>& rhs,
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void ComputeRHS::compute_rhs_block(const Uint begin, const Uint end, const Uint nb_nodes, const Uint nb_eqs, Real* rhs, Real* wave_speed)
+{
+  const Uint nb_term_values = (end-begin)*nb_nodes*nb_eqs;
+  const Uint nb_ws_values = (end-begin)*nb_nodes;
+  std::fill(rhs, rhs+nb_term_values, 0.);
+  std::fill(wave_speed, wave_speed+nb_ws_values, 0.);
+
+  m_tmp_block_term.resize(nb_term_values);
+  m_tmp_block_ws.resize(nb_ws_values);
+  for (Uint t=0; t<m_term_computers.size(); ++t)
+  {
+    if (m_loop_cells[t])
+    {
+      m_term_computers[t]->compute_term_block(begin,end,nb_nodes,nb_eqs,&m_tmp_block_term[0],&m_tmp_block_ws[0]);
+      for (Uint i=0; i<nb_term_values; ++i)
+      {
+        rhs[i] += m_tmp_block_term[i];
+      }
+      for (Uint i=0; i<nb_ws_values; ++i)
+      {
+        wave_speed[i] = std::max(wave_speed[i],m_tmp_block_ws[i]);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void ComputeRHS::compute_rhs(mesh::Field& rhs, mesh::Field& wave_speed)
 {
   const Uint nb_eqs = rhs.row_size();
+  const Uint block_size = std::max(1u, m_block_size);
   mesh::Dictionary& dict = rhs.dict();
   boost_foreach(const Handle<mesh::Entities>& cells, dict.entities_range() )
   {
@@ -114,29 +148,44 @@ void ComputeRHS::compute_rhs(mesh::Field& rhs, mesh::Field& wave_speed)
     {
       const Space& space = dict.space(*cells);
 
-      // Element-loop
+      // Element-loop, in blocks of consecutive owned elements
       const Uint nb_elems = cells->size();
       const Uint nb_sol_pts = space.shape_function().nb_nodes();
 
-      std::vector<RealVector> elem_rhs(nb_sol_pts,RealVector(nb_eqs));
-      std::vector<Real> elem_wave_speed(nb_sol_pts);
+      std::vector<Real> block_rhs(block_size*nb_sol_pts*nb_eqs);
+      std::vector<Real> block_wave_speed(block_size*nb_sol_pts);
 
-      for (Uint elem_idx=0; elem_idx<nb_elems; ++elem_idx)
+      Uint begin = 0;
+      while (begin<nb_elems)
       {
-        if (cells->is_ghost(elem_idx)==false)
+        if (cells->is_ghost(begin))
         {
-          compute_rhs(elem_idx,elem_rhs,elem_wave_speed);
+          ++begin;
+          continue;
+        }
+        Uint end = begin+1;
+        while (end<nb_elems && end-begin<block_size && cells->is_ghost(end)==false)
+          ++end;
 
+        compute_rhs_block(begin,end,nb_sol_pts,nb_eqs,&block_rhs[0],&block_wave_speed[0]);
+
+        const Real* elem_rhs = &block_rhs[0];
+        const Real* elem_wave_speed = &block_wave_speed[0];
+        for (Uint elem_idx=begin; elem_idx<end; ++elem_idx)
+        {
           mesh::Connectivity::ConstRow nodes = space.connectivity()[elem_idx];
           for (Uint sol_pt=0; sol_pt<nb_sol_pts; ++sol_pt)
           {
             for (Uint eq=0; eq<nb_eqs; ++eq)
             {
-              rhs[nodes[sol_pt]][eq] = elem_rhs[sol_pt][eq];
+              rhs[nodes[sol_pt]][eq] = elem_rhs[eq];
             }
             wave_speed[nodes[sol_pt]][0] = elem_wave_speed[sol_pt];
+            elem_rhs += nb_eqs;
           }
+          elem_wave_speed += nb_sol_pts;
         }
+        begin = end;
       }
     }
   }
@@ -58,6 +58,10 @@ public:
   /// @brief Compute the complete rhs for a given element, as well as the wave-speeds
   virtual void compute_rhs(const Uint elem_idx, std::vector<RealVector>& rhs, std::vector<Real>& wave_speed);
 
+  /// @brief Compute the complete rhs for the elements in [begin, end), as well as the wave-speeds
+  /// @note The buffers are laid out as in TermComputer::compute_term_block
+  virtual void compute_rhs_block(const Uint begin, const Uint end, const Uint nb_nodes, const Uint nb_eqs, Real* rhs, Real* wave_speed);
+
   /// @brief Compute the complete rhs in a field, as well as wave speeds
   virtual void compute_rhs(mesh::Field& rhs, mesh::Field& wave_speed);
 
@@ -66,11 +70,16 @@ private:
   Handle< mesh::Field > m_rhs;  ///! Right hand side field
   Handle< mesh::Field > m_ws;   ///! Wave speed field
 
+  Uint m_block_size;            ///! Number of elements computed at once
+
   std::vector< Handle<TermComputer> > m_term_computers;
   std::vector< bool > m_loop_cells;
 
   std::vector< RealVector > m_tmp_term;
   std::vector< Real > m_tmp_ws;
+
+  std::vector< Real > m_tmp_block_term;
+  std::vector< Real > m_tmp_block_ws;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -42,6 +42,15 @@ public:
 
   virtual void compute_riemann_flux( const Data& left, const Data& right, const ColVector_NDIM& normal,
                                      RowVector_NEQS& flux, Real& wave_speed ) = 0;
+
+  /// Compute the fluxes through nb_faces faces, given as arrays of states, normals and results.
+  /// The default computes the faces one by one, solvers with a batched implementation override it.
+  virtual void compute_riemann_fluxes( const Uint nb_faces, const Data* left, const Data* right, const ColVector_NDIM* normal,
+                                       RowVector_NEQS* flux, Real* wave_speed )
+  {
+    for (Uint f=0; f<nb_faces; ++f)
+      compute_riemann_flux( left[f], right[f], normal[f], flux[f], wave_speed[f] );
+  }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
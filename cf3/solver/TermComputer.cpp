@@ -4,10 +4,16 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+
 #include "common/Builder.hpp"
 #include "common/OptionList.hpp"
+#include "mesh/Dictionary.hpp"
 #include "mesh/Entities.hpp"
 #include "mesh/Field.hpp"
+#include "mesh/ShapeFunction.hpp"
 #include "mesh/Space.hpp"
 #include "mesh/Connectivity.hpp"
 #include "solver/TermComputer.hpp"
@@ -19,8 +25,87 @@ namespace solver {
   
 /////////////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+
+/// Computes the elements in [begin, end) block by block, and adds each block to the fields
+struct TermBlockLoop
+{
+  TermBlockLoop(TermComputer& computer, const mesh::Space& space, mesh::Field& term, mesh::Field& wave_speed, const Uint block_size, const Uint begin, const Uint end, std::string& error) :
+    m_computer(computer),
+    m_space(space),
+    m_term(term),
+    m_wave_speed(wave_speed),
+    m_block_size(block_size),
+    m_begin(begin),
+    m_end(end),
+    m_error(error)
+  {
+  }
+
+  void run()
+  {
+    const Uint nb_eqs = m_term.row_size();
+    const Uint nb_nodes = m_space.shape_function().nb_nodes();
+    const mesh::Connectivity& connectivity = m_space.connectivity();
+
+    std::vector<Real> block_term(m_block_size*nb_nodes*nb_eqs);
+    std::vector<Real> block_wave_speed(m_block_size*nb_nodes);
+    for (Uint block_begin=m_begin; block_begin<m_end; block_begin+=m_block_size)
+    {
+      const Uint block_end = std::min(block_begin+m_block_size, m_end);
+      m_computer.compute_term_block(block_begin, block_end, nb_nodes, nb_eqs, &block_term[0], &block_wave_speed[0]);
+
+      const Real* elem_term = &block_term[0];
+      const Real* elem_wave_speed = &block_wave_speed[0];
+      for (Uint e=block_begin; e<block_end; ++e)
+      {
+        mesh::Connectivity::ConstRow nodes = connectivity[e];
+        for (Uint s=0; s<nb_nodes; ++s)
+        {
+          const Uint p=nodes[s];
+          for (Uint eq=0; eq<nb_eqs; ++eq)
+          {
+            m_term[p][eq] += elem_term[eq];
+          }
+          m_wave_speed[p][0] = elem_wave_speed[s];
+          elem_term += nb_eqs;
+        }
+        elem_wave_speed += nb_nodes;
+      }
+    }
+  }
+
+  void operator()()
+  {
+    try
+    {
+      run();
+    }
+    catch(std::exception& e)
+    {
+      m_error = e.what();
+    }
+  }
+
+  TermComputer& m_computer;
+  const mesh::Space& m_space;
+  mesh::Field& m_term;
+  mesh::Field& m_wave_speed;
+  const Uint m_block_size;
+  const Uint m_begin;
+  const Uint m_end;
+  std::string& m_error;
+};
+
+} // detail
+
+/////////////////////////////////////////////////////////////////////////////////////
+
 TermComputer::TermComputer ( const std::string& name ) 
-  : common::Action(name) 
+  : common::Action(name),
+    m_block_size(32),
+    m_nb_threads(1)
 {
   options().add("field",m_term_field).link_to(&m_term_field)
     .description("Term that will be computed")
@@ -28,6 +113,13 @@ TermComputer::TermComputer ( const std::string& name )
   options().add("term_wave_speed_field",m_term_ws).link_to(&m_term_ws)
     .description("Term wave speed that will be computed")
     .mark_basic();
+  options().add("block_size",m_block_size).link_to(&m_block_size)
+    .pretty_name("Block Size")
+    .description("Number of elements that are computed before they are added to the term field");
+  options().add("nb_threads",m_nb_threads).link_to(&m_nb_threads)
+    .pretty_name("Number of Threads")
+    .description("Number of threads dividing the elements of each rank. Only used when the term field is discontinuous, "
+                 "so the threads never write to the same node, and the term is thread safe.");
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -45,26 +137,56 @@ void TermComputer::execute()
 void TermComputer::compute_term(mesh::Field& term, mesh::Field& wave_speed)
 {
   term = 0.;
+  const Uint block_size = std::max(1u, m_block_size);
   boost_foreach( const Handle<mesh::Entities const>& cells, term.entities_range() )
   {
     if (loop_cells(cells))
     {
       const mesh::Space& space = term.space(*cells);
       const Uint nb_elems = space.size();
-      const Uint nb_nodes_per_elem = space.shape_function().nb_nodes();
-      for (Uint e=0; e<nb_elems; ++e)
+
+      // Nodes are shared between elements in a continuous space, so the blocks must then be added one at a time
+      const Uint nb_threads = term.dict().discontinuous() && thread_safe() ? std::max(1u, std::min(m_nb_threads, nb_elems)) : 1u;
+      std::vector<std::string> errors(nb_threads);
+      if (nb_threads == 1)
       {
-        compute_term(e,m_tmp_term,m_tmp_ws);
-        for (Uint s=0; s<nb_nodes_per_elem; ++s)
-        {
-          const Uint p=space.connectivity()[e][s];
-          for (Uint eq=0; eq<m_tmp_term[s].size(); ++eq)
-          {
-            term[p][eq] += m_tmp_term[s][eq];
-          }
-          wave_speed[p][0] = m_tmp_ws[s]; 
-        }
+        // No threads, so errors can propagate with their own type
+        detail::TermBlockLoop(*this, space, term, wave_speed, block_size, 0, nb_elems, errors[0]).run();
+        continue;
+      }
+
+      // The calling thread must not throw before the others are joined, since they reference errors and the fields
+      boost::thread_group threads;
+      for (Uint i=1; i<nb_threads; ++i)
+        threads.create_thread(detail::TermBlockLoop(*this, space, term, wave_speed, block_size, (nb_elems*i)/nb_threads, (nb_elems*(i+1))/nb_threads, errors[i]));
+      detail::TermBlockLoop(*this, space, term, wave_speed, block_size, 0, nb_elems/nb_threads, errors[0])();
+      threads.join_all();
+
+      for (Uint i=0; i<nb_threads; ++i)
+      {
+        if (!errors[i].empty())
+          throw common::ParallelError(FromHere(), "Error in term computer thread " + common::to_str(i) + ": " + errors[i]);
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+void TermComputer::compute_term_block(const Uint begin, const Uint end, const Uint nb_nodes, const Uint nb_eqs, Real* term, Real* wave_speed)
+{
+  std::vector<RealVector> elem_term(nb_nodes, RealVector(nb_eqs));
+  std::vector<Real> elem_wave_speed(nb_nodes);
+  for (Uint e=begin; e<end; ++e)
+  {
+    compute_term(e,elem_term,elem_wave_speed);
+    for (Uint s=0; s<nb_nodes; ++s)
+    {
+      for (Uint eq=0; eq<nb_eqs; ++eq)
+      {
+        *term++ = elem_term[s][eq];
       }
+      *wave_speed++ = elem_wave_speed[s];
     }
   }
 }
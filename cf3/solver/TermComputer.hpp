@@ -8,6 +8,8 @@
 #define cf3_solver_TermComputer_hpp
 
 #include "common/Action.hpp"
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
 #include "math/MatrixTypes.hpp"
 #include "solver/LibSolver.hpp"
 
@@ -29,6 +31,9 @@ namespace solver {
 /////////////////////////////////////////////////////////////////////////////////////
 
 /// @brief Computes a term of a system of equations by looping over elements
+///
+/// Elements are computed in blocks of contiguous elements, and each block is added to the fields at once.
+/// When the term is defined in a discontinuous space and the term is thread safe, the blocks can be divided over several threads.
 /// @author Willem Deconinck
 class solver_API TermComputer : public common::Action
 {
@@ -55,13 +60,95 @@ public:
   /// @brief Compute the term for given element in given vectors
   virtual void compute_term(const Uint elem_idx, std::vector<RealVector>& term, std::vector<Real>& wave_speed) = 0;
 
+  /// @brief Compute the term for the elements in [begin, end) of the cells passed to loop_cells
+  ///
+  /// The buffers are stored element by element: term holds nb_nodes x nb_eqs values per element, row by row,
+  /// and wave_speed holds nb_nodes values per element.
+  /// The default implementation calls the element-wise compute_term.
+  virtual void compute_term_block(const Uint begin, const Uint end, const Uint nb_nodes, const Uint nb_eqs, Real* term, Real* wave_speed);
+
+  /// @brief True if compute_term_block may be called concurrently for different blocks
+  ///
+  /// The nb_threads option is ignored unless this returns true, so terms keeping state per element stay serial.
+  virtual bool thread_safe() const { return false; }
+
  private:
 
   Handle<mesh::Field> m_term_field;
   Handle<mesh::Field> m_term_ws;
-  
-  std::vector<RealVector> m_tmp_term;
-  std::vector<Real>       m_tmp_ws;
+
+  /// Number of elements in a block
+  Uint m_block_size;
+
+  /// Number of threads, only used for discontinuous spaces
+  Uint m_nb_threads;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief TermComputer for a fixed element type and number of equations
+///
+/// TERM derives from this class and implements, without virtual call,
+/// @code void compute_element(const Uint elem_idx, TermMap& term, WaveSpeedMap& wave_speed); @endcode
+/// The maps point directly into the block buffers, so no temporaries are allocated.
+/// TERM must still implement loop_cells, returning false for cells with another element type.
+template <typename TERM, typename ETYPE, Uint NEQS>
+class TermComputerT : public TermComputer
+{
+public:
+
+  enum { nb_nodes = ETYPE::nb_nodes };
+  enum { nb_eqs = NEQS };
+
+  /// Term in all nodes of an element, with one row per node
+  typedef Eigen::Matrix<Real, nb_nodes, nb_eqs, (nb_eqs == 1 && nb_nodes != 1) ? Eigen::ColMajor : Eigen::RowMajor> TermMatrix;
+  typedef Eigen::Matrix<Real, nb_nodes, 1> WaveSpeedVector;
+  typedef Eigen::Map<TermMatrix> TermMap;
+  typedef Eigen::Map<WaveSpeedVector> WaveSpeedMap;
+
+  /// @brief Constructor
+  TermComputerT ( const std::string& name ) : TermComputer(name) {}
+
+  /// Virtual destructor
+  virtual ~TermComputerT() {}
+
+  using TermComputer::compute_term;
+
+  /// @brief Compute the term for given element in given vectors
+  virtual void compute_term(const Uint elem_idx, std::vector<RealVector>& term, std::vector<Real>& wave_speed)
+  {
+    TermMatrix elem_term;
+    WaveSpeedVector elem_wave_speed;
+    TermMap term_map(elem_term.data());
+    WaveSpeedMap wave_speed_map(elem_wave_speed.data());
+    static_cast<TERM&>(*this).compute_element(elem_idx, term_map, wave_speed_map);
+
+    term.resize(nb_nodes);
+    wave_speed.resize(nb_nodes);
+    for (Uint node=0; node<nb_nodes; ++node)
+    {
+      term[node] = elem_term.row(node).transpose();
+      wave_speed[node] = elem_wave_speed[node];
+    }
+  }
+
+  /// @brief Compute the term for a block of elements, directly in the buffers
+  virtual void compute_term_block(const Uint begin, const Uint end, const Uint block_nb_nodes, const Uint block_nb_eqs, Real* term, Real* wave_speed)
+  {
+    if (block_nb_nodes != nb_nodes || block_nb_eqs != nb_eqs)
+      throw common::BadValue(FromHere(), "Term " + uri().path() + " needs elements with " + common::to_str(static_cast<Uint>(nb_nodes))
+                             + " nodes and " + common::to_str(static_cast<Uint>(nb_eqs)) + " equations");
+
+    TERM& derived = static_cast<TERM&>(*this);
+    for (Uint elem_idx=begin; elem_idx<end; ++elem_idx)
+    {
+      TermMap term_map(term);
+      WaveSpeedMap wave_speed_map(wave_speed);
+      derived.compute_element(elem_idx, term_map, wave_speed_map);
+      term += nb_nodes*nb_eqs;
+      wave_speed += nb_nodes;
+    }
+  }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
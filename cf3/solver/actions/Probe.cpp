@@ -8,6 +8,7 @@
 #include <boost/function.hpp>
 
 #include "common/Core.hpp"
+#include "common/EventHandler.hpp"
 #include "common/Builder.hpp"
 #include "common/PropertyList.hpp"
 #include "common/OptionList.hpp"
@@ -29,6 +30,7 @@
 #include "mesh/Dictionary.hpp"
 #include "mesh/Space.hpp"
 #include "mesh/PointInterpolator.hpp"
+#include "mesh/Tags.hpp"
 
 namespace cf3 {
 namespace solver {
@@ -42,7 +44,10 @@ common::ComponentBuilder < Probe, common::Action, solver::actions::LibActions >
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
-Probe::Probe( const std::string& name  ) : common::Action(name)
+Probe::Probe( const std::string& name  ) :
+  common::Action(name),
+  m_storage_computed(false),
+  m_found(false)
 {
   mark_basic(); // by default probes are visible
 
@@ -54,7 +59,8 @@ Probe::Probe( const std::string& name  ) : common::Action(name)
   options().add("coordinate",std::vector<Real>())
     .pretty_name("Coordinate")
     .description("Coordinate to interpolate fields to")
-    .mark_basic();
+    .mark_basic()
+    .attach_trigger( boost::bind( &Probe::reset_storage, this ) );
     
   options().add("dict",m_dict)
       .description("Dictionary that will be probed")
@@ -70,6 +76,8 @@ Probe::Probe( const std::string& name  ) : common::Action(name)
 
   m_point_interpolator = create_component<PointInterpolator>("point_interpolator");
   m_variables = create_component<math::VariablesDescriptor>("variables");
+
+  Core::instance().event_handler().connect_to_event(mesh::Tags::event_mesh_changed(), this, &Probe::on_mesh_changed_event);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -77,6 +85,21 @@ Probe::Probe( const std::string& name  ) : common::Action(name)
 void Probe::configure_point_interpolator()
 {
   m_point_interpolator->options().set("dict",m_dict);
+  reset_storage();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Probe::reset_storage()
+{
+  m_storage_computed = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Probe::on_mesh_changed_event(SignalArgs& args)
+{
+  reset_storage();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -91,13 +114,13 @@ void Probe::execute()
   RealVector coord(opt_coord.size());
   math::copy(opt_coord,coord);
 
-  // Find interpolation data for this coordinate
-  SpaceElem m_element;
-  std::vector<SpaceElem> m_stencil;
-  std::vector<Uint> m_points;
-  std::vector<Real> m_weights;
-
-  int found = m_point_interpolator->compute_storage(coord,m_element,m_stencil,m_points,m_weights);
+  // Find interpolation data for this coordinate, only if the coordinate, dictionary or mesh changed
+  if (!m_storage_computed)
+  {
+    m_found = m_point_interpolator->compute_storage(coord,m_element,m_stencil,m_points,m_weights);
+    m_storage_computed = true;
+  }
+  const bool found = m_found;
 
 //  std::cout << PE::Comm::instance().rank() << ":  found = " << found << std::endl;
 
@@ -237,7 +260,10 @@ void Probe::signature_create_post_processor(SignalArgs &args)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Probe::~Probe() {}
+Probe::~Probe()
+{
+  connection(mesh::Tags::event_mesh_changed())->disconnect();
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -11,6 +11,7 @@
 
 
 #include "common/Action.hpp"
+#include "mesh/Space.hpp"
 #include "solver/actions/LibActions.hpp"
 
 namespace cf3 {
@@ -74,12 +75,25 @@ private: // functions
   /// @brief Configure the point interpolator
   void configure_point_interpolator();
 
+  /// @brief Drop the interpolation storage, so it is computed again at the next execution
+  void reset_storage();
+
+  /// @brief Drop the interpolation storage when a mesh changes
+  void on_mesh_changed_event(common::SignalArgs& args);
+
 private: // data
 
   Handle<mesh::Dictionary>            m_dict;                ///< Dictionary to interpolate
   Handle<mesh::PointInterpolator>     m_point_interpolator;  ///< Interpolator for one point
   Handle< math::VariablesDescriptor > m_variables;           ///< Variable description
 
+  bool                      m_storage_computed;  ///< True if the storage below is valid for the configured coordinate
+  bool                      m_found;             ///< True if the coordinate was found on this rank
+  mesh::SpaceElem           m_element;           ///< Element containing the coordinate
+  std::vector<mesh::SpaceElem> m_stencil;        ///< Stencil used for the interpolation
+  std::vector<Uint>         m_points;            ///< Points of the dictionary used for the interpolation
+  std::vector<Real>         m_weights;           ///< Interpolation weights of m_points
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -74,7 +74,12 @@ void ProbePostProcFunction::update_function()
 
     boost::algorithm::replace_all(m_function_str,var_name,mod_var_name);
   }
-  function.parse(m_function_str, vars.str());
+
+  // The probe is executed every iteration, only parse again if the function or the variables changed
+  if (function.is_parsed() && function.function() == m_function_str && vars.str() == m_parsed_vars)
+    return;
+  m_parsed_vars = vars.str();
+  function.parse(m_function_str, m_parsed_vars);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -47,6 +47,9 @@ private:
   std::string m_var_str;
   std::string m_function_str;
 
+  /// Variables of the parsed function
+  std::string m_parsed_vars;
+
   std::vector<Real> m_params;
 };
 
@@ -92,25 +92,33 @@ struct MatrixAssignOpsCases
 };
 
 /// Translate tag to operator
-inline void do_assign_op_matrix(boost::proto::tag::assign, math::LSS::Matrix& lss_matrix, const math::LSS::BlockAccumulator& block_accumulator)
+template<typename BlockAccumulatorT, typename DataT>
+inline void do_assign_op_matrix(boost::proto::tag::assign, math::LSS::Matrix& lss_matrix, const BlockAccumulatorT& block_accumulator, const DataT&)
 {
   lss_matrix.set_values(block_accumulator);
 }
 
-/// Translate tag to operator
-inline void do_assign_op_matrix(boost::proto::tag::plus_assign, math::LSS::Matrix& lss_matrix, const math::LSS::BlockAccumulator& block_accumulator)
+/// Translate tag to operator, using the cached value positions if the matrix supports them
+template<typename BlockAccumulatorT, typename DataT>
+inline void do_assign_op_matrix(boost::proto::tag::plus_assign, math::LSS::Matrix& lss_matrix, const BlockAccumulatorT& block_accumulator, const DataT& data)
 {
-  lss_matrix.add_values(block_accumulator);
+  const int* positions = data.matrix_value_positions(lss_matrix);
+  if(is_null(positions))
+    lss_matrix.add_values(block_accumulator);
+  else
+    lss_matrix.add_values_at(block_accumulator, positions);
 }
 
 /// Translate tag to operator
-inline void do_assign_op_rhs(boost::proto::tag::assign, math::LSS::Vector& lss_rhs, const math::LSS::BlockAccumulator& block_accumulator)
+template<typename BlockAccumulatorT>
+inline void do_assign_op_rhs(boost::proto::tag::assign, math::LSS::Vector& lss_rhs, const BlockAccumulatorT& block_accumulator)
 {
   lss_rhs.set_rhs_values(block_accumulator);
 }
 
 /// Translate tag to operator
-inline void do_assign_op_rhs(boost::proto::tag::plus_assign, math::LSS::Vector& lss_rhs, const math::LSS::BlockAccumulator& block_accumulator)
+template<typename BlockAccumulatorT>
+inline void do_assign_op_rhs(boost::proto::tag::plus_assign, math::LSS::Vector& lss_rhs, const BlockAccumulatorT& block_accumulator)
 {
   lss_rhs.add_rhs_values(block_accumulator);
 }
@@ -141,7 +149,12 @@ struct BlockAssignmentOp<SystemMatrixTag, OpTagT>
     detail::assert_nb_nodes<DataT::nb_lss_nodes>();
     static const Uint nb_nodes = detail::SafeNbNodes<DataT::nb_lss_nodes>::value;
     static const Uint nb_dofs = mat_size / nb_nodes;
-    math::LSS::BlockAccumulator& block_accumulator = data.block_accumulator;
+    math::LSS::Matrix& lss_matrix = lss.matrix();
+    // Frozen matrices keep the values of a previous assembly
+    if(lss_matrix.is_frozen())
+      return;
+
+    typename DataT::BlockAccumulatorT& block_accumulator = data.block_accumulator;
     lss.convert_to_lss(data);
 
     for(Uint row = 0; row != mat_size; ++row)
@@ -154,7 +167,7 @@ struct BlockAssignmentOp<SystemMatrixTag, OpTagT>
         block_accumulator.mat(block_row, block_col) = rhs(row, col);
       }
     }
-    do_assign_op_matrix(OpTagT(), lss.matrix(), block_accumulator);
+    do_assign_op_matrix(OpTagT(), lss_matrix, block_accumulator, data);
   }
 };
 
@@ -169,7 +182,7 @@ struct BlockAssignmentOp<SystemRHSTag, OpTagT>
     detail::assert_nb_nodes<DataT::nb_lss_nodes>();
     static const Uint nb_nodes = detail::SafeNbNodes<DataT::nb_lss_nodes>::value;
     static const Uint nb_dofs = mat_size / nb_nodes;
-    math::LSS::BlockAccumulator& block_accumulator = data.block_accumulator;
+    typename DataT::BlockAccumulatorT& block_accumulator = data.block_accumulator;
     lss.convert_to_lss(data);
 
     for(Uint i = 0; i != mat_size; ++i)
@@ -7,7 +7,10 @@
 #ifndef cf3_solver_actions_Proto_DirichletBC_hpp
 #define cf3_solver_actions_Proto_DirichletBC_hpp
 
+#include <boost/mpl/bool.hpp>
+#include <boost/mpl/or.hpp>
 #include <boost/proto/core.hpp>
+#include <boost/proto/transform.hpp>
 
 #include "math/MatrixTypes.hpp"
 
@@ -140,6 +143,22 @@ struct DirichletBCGrammar :
 {
 };
 
+/// Evaluates to boost::mpl::true_ if the expression sets a Dirichlet condition. Symmetric Dirichlet conditions
+/// also modify the matrix columns and RHS entries of the neighbouring nodes, so such expressions can't be split over threads by node.
+struct ContainsDirichletBC :
+  boost::proto::or_
+  <
+    boost::proto::when< boost::proto::terminal< LSSWrapperImpl<DirichletBCTag> >, boost::mpl::true_() >,
+    boost::proto::when< boost::proto::terminal<boost::proto::_>, boost::mpl::false_() >,
+    boost::proto::when
+    <
+      boost::proto::nary_expr< boost::proto::_, boost::proto::vararg<boost::proto::_> >,
+      boost::proto::fold< boost::proto::_, boost::mpl::false_(), boost::mpl::or_<ContainsDirichletBC, boost::proto::_state>() >
+    >
+  >
+{
+};
+
 } // namespace Proto
 } // namespace actions
 } // namespace solver
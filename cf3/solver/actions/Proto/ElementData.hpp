@@ -41,6 +41,8 @@
 #include "ElementOperations.hpp"
 #include "ElementTransforms.hpp"
 #include "FieldSync.hpp"
+#include "GeometryCache.hpp"
+#include "MatrixPositions.hpp"
 #include "Terminals.hpp"
 
 namespace cf3 {
@@ -183,10 +185,23 @@ public:
 
   GeometricSupport(const mesh::Elements& elements) :
     m_coordinates(elements.geometry_fields().coordinates()),
-    m_connectivity_array(elements.geometry_space().connectivity().array())
+    m_connectivity_array(elements.geometry_space().connectivity().array()),
+    m_cache_elements(nullptr),
+    m_cache_data(nullptr),
+    m_cache_order(0),
+    m_cached_point(nullptr),
+    m_jacobian_computed(false)
   {
   }
 
+  /// Read the shape function gradients and integration weights at the quadrature points from the geometry cache of the elements
+  void enable_geometry_cache(mesh::Elements& elements)
+  {
+    m_cache_elements = &elements;
+    m_cache.reset();
+    m_cache_order = 0;
+  }
+
   /// Update nodes for the current element and set the connectivity for the passed block accumulator
   void set_element(const Uint element_idx)
   {
@@ -230,12 +245,14 @@ public:
   /// Precomputed jacobian
   const typename EtypeT::JacobianT& jacobian() const
   {
+    compute_cached_point_jacobian();
     return m_jacobian_matrix;
   }
 
   /// Precomputed jacobian inverse
   const typename EtypeT::JacobianT& jacobian_inverse() const
   {
+    compute_cached_point_jacobian();
     return m_jacobian_inverse;
   }
 
@@ -248,9 +265,30 @@ public:
   /// Precomputed jacobian determinant
   Real jacobian_determinant() const
   {
+    compute_cached_point_jacobian();
     return m_jacobian_determinant;
   }
 
+  /// Integration weight for the precomputed quadrature point with Gauss weight gauss_weight, i.e. the weight times the jacobian determinant
+  Real integration_weight(const Real gauss_weight) const
+  {
+    if(m_cached_point != nullptr)
+      return m_cached_point[m_cached_weight_offset];
+    return gauss_weight * m_jacobian_determinant;
+  }
+
+  /// True if the gradient of the shape functions at the current quadrature point comes from the geometry cache
+  bool has_cached_gradient() const
+  {
+    return m_cached_point != nullptr;
+  }
+
+  /// Gradient of the shape functions in physical coordinates at the current quadrature point, if has_cached_gradient()
+  Eigen::Map<const typename EtypeT::SF::GradientT> cached_gradient() const
+  {
+    return Eigen::Map<const typename EtypeT::SF::GradientT>(m_cached_point);
+  }
+
   const typename EtypeT::CoordsT& normal(const typename EtypeT::MappedCoordsT& mapped_coords) const
   {
     EtypeT::normal(mapped_coords, m_nodes, m_normal_vector);
@@ -271,9 +309,25 @@ public:
   /// Precompute jacobian for the given mapped coordinates
   void compute_jacobian(const typename EtypeT::MappedCoordsT& mapped_coords) const
   {
+    m_cached_point = nullptr;
     compute_jacobian_dispatch(boost::mpl::bool_<EtypeT::dimension == EtypeT::dimensionality>(), mapped_coords);
   }
 
+  /// Precompute the geometric data for quadrature point gauss_idx of the Gauss quadrature of order Order.
+  /// With the geometry cache enabled, the gradients and integration weight are read from the cache and the jacobian
+  /// is only computed if it is asked for.
+  template<Uint Order>
+  void compute_jacobian(const Uint gauss_idx) const
+  {
+    if(m_cache_elements == nullptr)
+    {
+      compute_jacobian(mesh::Integrators::GaussMappedCoords<Order, EtypeT::shape>::instance().coords.col(gauss_idx));
+      return;
+    }
+
+    read_cache_dispatch<Order>(boost::mpl::bool_<EtypeT::dimension == EtypeT::dimensionality>(), gauss_idx);
+  }
+
   /// Precompute the interpolated value (requires a computed EtypeT)
   void compute_coordinates() const
   {
@@ -305,6 +359,39 @@ private:
   {
   }
 
+  template<Uint Order>
+  void read_cache_dispatch(boost::mpl::false_, const Uint) const
+  {
+  }
+
+  template<Uint Order>
+  void read_cache_dispatch(boost::mpl::true_, const Uint gauss_idx) const
+  {
+    typedef GeometryCache<EtypeT, Order> CacheT;
+    if(m_cache_order != Order)
+    {
+      const boost::shared_ptr<CacheT const> cache = geometry_cache<EtypeT, Order>(*m_cache_elements);
+      m_cache = cache;
+      m_cache_data = cache.get();
+      m_cache_order = Order;
+      m_cached_weight_offset = CacheT::weight_offset;
+    }
+
+    m_cached_point = static_cast<const CacheT*>(m_cache_data)->point_data(m_element_idx, gauss_idx);
+    m_cached_mapped_coords = CacheT::GaussT::instance().coords.col(gauss_idx);
+    m_jacobian_computed = false;
+  }
+
+  /// Compute the jacobian at the current quadrature point if it was not computed when the gradients were read from the cache
+  void compute_cached_point_jacobian() const
+  {
+    if(m_cached_point == nullptr || m_jacobian_computed)
+      return;
+
+    compute_jacobian_dispatch(boost::mpl::bool_<EtypeT::dimension == EtypeT::dimensionality>(), m_cached_mapped_coords);
+    m_jacobian_computed = true;
+  }
+
   void compute_jacobian_dispatch(boost::mpl::true_, const typename EtypeT::MappedCoordsT& mapped_coords) const
   {
     EtypeT::compute_jacobian(mapped_coords, m_nodes, m_jacobian_matrix);
@@ -328,6 +415,20 @@ private:
   /// Index for the current element
   Uint m_element_idx;
 
+  /// Elements holding the geometry cache, or null if the cache is disabled
+  mesh::Elements* m_cache_elements;
+
+  /// Cache for the last used quadrature order
+  mutable boost::shared_ptr<void const> m_cache;
+  mutable const void* m_cache_data;
+  mutable Uint m_cache_order;
+  mutable Uint m_cached_weight_offset;
+
+  /// Cached data for the current quadrature point, or null if the data was computed
+  mutable const Real* m_cached_point;
+  mutable typename EtypeT::MappedCoordsT m_cached_mapped_coords;
+  mutable bool m_jacobian_computed;
+
   /// Temp storage for non-scalar results
 private:
   mutable typename EtypeT::SF::ValueT m_sf;
@@ -465,11 +566,18 @@ public:
     mesh::fill(m_element_values, m_field, m_connectivity_array[element_idx], offset);
   }
   
-  void update_block_connectivity(math::LSS::BlockAccumulator& block_accumulator)
+  template<typename BlockAccumulatorT>
+  void update_block_connectivity(BlockAccumulatorT& block_accumulator)
   {
     block_accumulator.neighbour_indices(m_connectivity_array[m_element_idx]);
   }
 
+  /// Connectivity that provides the block accumulator indices
+  const mesh::Connectivity::ArrayT& connectivity_array() const
+  {
+    return m_connectivity_array;
+  }
+
   /// Reference to the geometric support
   const SupportT& support() const
   {
@@ -576,6 +684,24 @@ private:
   void compute_values_dispatch(boost::mpl::true_, const MappedCoordsT& mapped_coords) const
   {
     compute_values_dispatch(boost::mpl::false_(), mapped_coords);
+    compute_gradient_dispatch(boost::mpl::bool_<boost::is_same<EtypeT, SupportEtypeT>::value>(), mapped_coords);
+  }
+
+  /// Gradient for a variable that uses the geometric shape function, which may come from the geometry cache
+  void compute_gradient_dispatch(boost::mpl::true_, const MappedCoordsT& mapped_coords) const
+  {
+    if(m_support.has_cached_gradient())
+    {
+      m_gradient = m_support.cached_gradient();
+      return;
+    }
+
+    compute_gradient_dispatch(boost::mpl::false_(), mapped_coords);
+  }
+
+  /// Gradient for any other variable
+  void compute_gradient_dispatch(boost::mpl::false_, const MappedCoordsT& mapped_coords) const
+  {
     EtypeT::SF::compute_gradient(mapped_coords, m_mapped_gradient_matrix);
     m_gradient.noalias() = m_support.jacobian_inverse() * m_mapped_gradient_matrix;
   }
@@ -916,11 +1042,26 @@ public:
   
   static const Uint nb_lss_nodes = detail::GetNbNodes<EquationDataT>::value;
 
+  /// Number of equations for each variable, when used in the LSS
+  typedef typename boost::mpl::transform
+  <
+    typename boost::mpl::copy<VariablesT, boost::mpl::back_inserter< boost::mpl::vector0<> > >::type,
+    FieldWidth<boost::mpl::_1, SupportEtypeT>
+  >::type NbEqsPerVarT;
+
+  /// Number of LSS equations for each node
+  static const Uint nb_lss_eqs = ElementMatrixSize<NbEqsPerVarT, EquationVariablesT>::type::value;
+
+  /// Type of the block accumulator, sized at compile time
+  typedef math::LSS::FixedBlockAccumulator<nb_lss_nodes, nb_lss_eqs> BlockAccumulatorT;
+
   ElementData(VariablesT& variables, mesh::Elements& elements) :
     m_variables(variables),
     m_elements(elements),
     m_support(elements),
-    m_equation_data(m_variables_data)
+    m_equation_data(m_variables_data),
+    m_positions_matrix(nullptr),
+    m_positions_cache(nullptr)
   {
     boost::mpl::for_each< boost::mpl::range_c<int, 0, NbVarsT::value> >(InitVariablesData(m_variables, m_elements, m_variables_data, m_support));
     for(Uint i = 0; i != CF3_PROTO_MAX_ELEMENT_MATRICES; ++i)
@@ -928,25 +1069,6 @@ public:
       m_element_matrices[i].setZero();
       m_element_vectors[i].setZero();
     }
-    
-    init_block_accumulator(typename boost::fusion::result_of::empty<EquationDataT>::type());
-  }
-  
-  // Init LSS block accumulator
-  void init_block_accumulator(boost::mpl::false_)
-  {
-    typedef typename boost::mpl::transform
-    <
-      typename boost::mpl::copy<VariablesT, boost::mpl::back_inserter< boost::mpl::vector0<> > >::type,
-      FieldWidth<boost::mpl::_1, SupportEtypeT>
-    >::type NbEqsPerVarT;
-    
-    block_accumulator.resize(nb_lss_nodes, ElementMatrixSize<NbEqsPerVarT, EquationVariablesT>::type::value);
-  }
-  
-  // No LSS, so nothing to be done
-  void init_block_accumulator(boost::mpl::true_)
-  {
   }
 
   ~ElementData()
@@ -987,6 +1109,25 @@ public:
     boost::mpl::for_each< boost::mpl::range_c<int, 0, NbVarsT::value> >(PrecomputeData<ExprT>(m_variables_data, mapped_coords));
   }
 
+  /// Precompute element matrices at quadrature point gauss_idx of the Gauss quadrature of order Order.
+  /// The jacobian is read from the geometry cache if it is enabled.
+  template<Uint Order, typename ExprT>
+  void precompute_element_matrices(const Uint gauss_idx, const ExprT& e)
+  {
+    const typename SupportEtypeT::MappedCoordsT mapped_coords = mesh::Integrators::GaussMappedCoords<Order, SupportEtypeT::shape>::instance().coords.col(gauss_idx);
+    m_support.compute_shape_functions(mapped_coords);
+    m_support.compute_coordinates();
+    m_support.template compute_jacobian<Order>(gauss_idx);
+    m_support.compute_normal(mapped_coords);
+    boost::mpl::for_each< boost::mpl::range_c<int, 0, NbVarsT::value> >(PrecomputeData<ExprT>(m_variables_data, mapped_coords));
+  }
+
+  /// Use the geometry cache of the elements for the jacobians in element quadratures
+  void enable_geometry_cache()
+  {
+    m_support.enable_geometry_cache(m_elements);
+  }
+
   /// Return the type of the data stored for variable I (I being an Integral Constant in the boost::mpl sense)
   template<typename I>
   struct DataType
@@ -1064,8 +1205,35 @@ public:
     return m_element_rhs;
   };
 
+  /// Positions of the block accumulator entries in the values of matrix, or null if the matrix doesn't cache them.
+  /// The positions for the current element are computed on first use, so the block accumulator indices must be converted to LSS indices.
+  const int* matrix_value_positions(math::LSS::Matrix& matrix) const
+  {
+    if(!matrix.caches_value_positions())
+      return nullptr;
+
+    if(&matrix != m_positions_matrix)
+    {
+      m_positions_matrix = &matrix;
+      m_positions_cache = matrix_positions_cache(matrix, boost::fusion::front(m_equation_data)->connectivity_array(), block_accumulator.mat.size());
+    }
+
+    if(is_null(m_positions_cache))
+      return nullptr;
+
+    int* positions = m_positions_cache + m_element_idx*block_accumulator.mat.size();
+    if(positions[0] == uncomputed_position && !matrix.value_positions(block_accumulator, positions))
+    {
+      // Not supported by the matrix, so don't try again for this matrix
+      m_positions_cache = nullptr;
+      return nullptr;
+    }
+
+    return positions;
+  }
+
   /// Stores a mutable block accululator, always up-to-date with index mapping and correct size
-  mutable math::LSS::BlockAccumulator block_accumulator;
+  mutable BlockAccumulatorT block_accumulator;
   mutable bool indices_converted; // Indicate if the indices in the block accumulator have been converted to LSS indices
 
 private:
@@ -1090,6 +1258,10 @@ private:
   /// Filtered view of the data associated with equation variables
   const EquationDataT m_equation_data;
 
+  /// Matrix for which the value positions were last requested, and the cache of positions for it
+  mutable math::LSS::Matrix* m_positions_matrix;
+  mutable int* m_positions_cache;
+
   ///////////// helper functions and structs /////////////
 
   /// Initializes the pointers in a VariablesDataT fusion sequence
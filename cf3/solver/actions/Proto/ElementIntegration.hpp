@@ -167,11 +167,11 @@ public:
     {
       typedef mesh::Integrators::GaussMappedCoords<order, ShapeFunctionT::shape> GaussT;
       ChildT e = boost::proto::child_c<1>(expr); // expression to integrate
-      data.precompute_element_matrices(GaussT::instance().coords.col(0), expr);
+      data.template precompute_element_matrices<order>(0, expr);
       expr.value = GaussT::instance().weights[0] * ElementMathImplicit()(e, state, data);
       for(Uint i = 1; i != GaussT::nb_points; ++i)
       {
-        data.precompute_element_matrices(GaussT::instance().coords.col(i), expr);
+        data.template precompute_element_matrices<order>(i, expr);
         expr.value += GaussT::instance().weights[i] * ElementMathImplicit()(e, state, data);
       }
       return expr.value;
@@ -197,7 +197,7 @@ struct ElementQuadratureEval :
         m_expr(expr),
         m_state(state),
         m_data(data),
-        m_weight(weight * data.support().jacobian_determinant())
+        m_weight(data.support().integration_weight(weight))
       {
       }
 
@@ -249,7 +249,7 @@ struct ElementQuadratureEval :
       for(Uint i = 0; i != GaussT::nb_points; ++i)
       {
         // Precompute the primitive element matrices (shape function values, gradients, ...) for the current Gauss point
-        data.precompute_element_matrices(GaussT::instance().coords.col(i), expr);
+        data.template precompute_element_matrices<IntegrationOrder<max_order>::value>(i, expr);
         boost::mpl::for_each< boost::mpl::range_c<int, 1, boost::proto::arity_of<ExprT>::value> >
         (
           evaluate_expr(expr, state, data, GaussT::instance().weights[i])
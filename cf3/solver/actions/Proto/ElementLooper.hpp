@@ -7,6 +7,12 @@
 #ifndef cf3_solver_actions_Proto_ElementLooper_hpp
 #define cf3_solver_actions_Proto_ElementLooper_hpp
 
+#include <algorithm>
+#include <limits>
+
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/shared_ptr.hpp>
+
 #include <boost/fusion/algorithm/iteration/for_each.hpp>
 #include <boost/fusion/adapted/mpl.hpp>
 #include <boost/fusion/mpl.hpp>
@@ -19,7 +25,9 @@
 #include "ElementData.hpp"
 #include "ElementExpressionWrapper.hpp"
 #include "ElementGrammar.hpp"
+#include "ThreadPool.hpp"
 
+#include "mesh/DataCache.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Space.hpp"
 #include "mesh/ElementTypePredicates.hpp"
@@ -60,7 +68,7 @@ struct CheckSameEtype
 template<typename ElementTypesT, typename ExprT, typename SupportETYPE, typename VariablesT, typename VariablesEtypesT, typename NbVarsT, typename VarIdxT>
 struct ExpressionRunner
 {
-  ExpressionRunner(VariablesT& vars, const ExprT& expr, mesh::Elements& elems) : variables(vars), expression(expr), elements(elems), m_nb_tests(0), m_found(false) {}
+  ExpressionRunner(VariablesT& vars, const ExprT& expr, mesh::Elements& elems, const Uint nb_threads = 1, const bool geometry_cache = false) : variables(vars), expression(expr), elements(elems), m_nb_threads(nb_threads), m_geometry_cache(geometry_cache), m_nb_tests(0), m_found(false) {}
 
   typedef typename boost::remove_reference<typename boost::fusion::result_of::at<VariablesT, VarIdxT>::type>::type VarT;
 
@@ -89,7 +97,7 @@ struct ExpressionRunner
       NewVariablesEtypesT,
       NbVarsT,
       NextIdxT
-    >(variables, expression, elements).run();
+    >(variables, expression, elements, m_nb_threads, m_geometry_cache).run();
   }
 
   // Chosen otherwise
@@ -141,12 +149,14 @@ struct ExpressionRunner
       NewVariablesEtypesT,
       NbVarsT,
       NextIdxT
-    >(variables, expression, elements).run();
+    >(variables, expression, elements, m_nb_threads, m_geometry_cache).run();
   }
 
   VariablesT& variables;
   const ExprT& expression;
   mesh::Elements& elements;
+  const Uint m_nb_threads;
+  const bool m_geometry_cache;
   // Number of times we tried a shape function
   mutable Uint m_nb_tests;
   mutable bool m_found;
@@ -154,15 +164,136 @@ struct ExpressionRunner
 
 
 
+namespace detail
+{
+  /// Elements grouped in colours, so elements of the same colour never share a node
+  struct ElementColouring
+  {
+    /// Element indices, sorted by colour and by index within a colour
+    std::vector<Uint> elements_by_colour;
+    /// Start of each colour in elements_by_colour, with one extra entry for the end
+    std::vector<Uint> colour_starts;
+  };
+
+  /// Colour the elements for threaded assembly, so elements of the same colour never share a node. Each element gets the
+  /// colour following the highest colour of its neighbours with a lower index, so of two elements sharing a node, the one
+  /// with the lowest index always comes first when looping over the colours in order. The contributions to each node are
+  /// then added in the same order as in the serial loop, making the result bit-identical to it for any number of threads.
+  /// The number of colours is the length of the longest chain of neighbouring elements with increasing indices, e.g.
+  /// nx + 2*(ny-1) for an nx by ny quad mesh numbered row by row, and nx + 2*(ny-1) + 4*(nz-1) for a hexahedral mesh numbered
+  /// in the same way.
+  /// @param connectivity Element to node connectivity
+  /// @param colouring Result of the colouring
+  inline void colour_elements(const mesh::Connectivity& connectivity, ElementColouring& colouring)
+  {
+    const Uint nb_elems = connectivity.size();
+    const Uint nb_elem_nodes = connectivity.row_size();
+
+    Uint nb_nodes = 0;
+    for(Uint elem = 0; elem != nb_elems; ++elem)
+      for(Uint i = 0; i != nb_elem_nodes; ++i)
+        nb_nodes = std::max(nb_nodes, connectivity[elem][i] + 1);
+
+    // Highest colour of the elements visited so far around each node. Elements are visited in index order, so for each
+    // element this gives the highest colour of the neighbours with a lower index.
+    const Uint no_colour = std::numeric_limits<Uint>::max();
+    std::vector<Uint> node_colours(nb_nodes, no_colour);
+    std::vector<Uint> elem_colours(nb_elems);
+    Uint nb_colours = 0;
+    for(Uint elem = 0; elem != nb_elems; ++elem)
+    {
+      const mesh::Connectivity::ConstRow row = connectivity[elem];
+      Uint colour = 0;
+      for(Uint i = 0; i != nb_elem_nodes; ++i)
+      {
+        if(node_colours[row[i]] != no_colour)
+          colour = std::max(colour, node_colours[row[i]] + 1);
+      }
+      for(Uint i = 0; i != nb_elem_nodes; ++i)
+        node_colours[row[i]] = colour;
+      elem_colours[elem] = colour;
+      nb_colours = std::max(nb_colours, colour + 1);
+    }
+
+    // Counting sort on the colour, keeping the element order within each colour
+    std::vector<Uint>& colour_starts = colouring.colour_starts;
+    colour_starts.assign(nb_colours + 1, 0);
+    for(Uint elem = 0; elem != nb_elems; ++elem)
+      ++colour_starts[elem_colours[elem] + 1];
+    for(Uint c = 0; c != nb_colours; ++c)
+      colour_starts[c + 1] += colour_starts[c];
+    std::vector<Uint> fill_position(colour_starts.begin(), colour_starts.end() - 1);
+    colouring.elements_by_colour.resize(nb_elems);
+    for(Uint elem = 0; elem != nb_elems; ++elem)
+      colouring.elements_by_colour[fill_position[elem_colours[elem]]++] = elem;
+  }
+
+  /// Colouring of the given elements, computed on first use and kept in the cache of the mesh until it changes
+  inline boost::shared_ptr<ElementColouring const> element_colouring(const mesh::Elements& elements)
+  {
+    mesh::DataCache& cache = common::find_parent_component<mesh::Mesh>(elements).cache();
+    const std::string key = "proto_element_colouring:" + elements.uri().path();
+    boost::shared_ptr<ElementColouring> colouring = cache.get<ElementColouring>(key);
+    if(!colouring)
+    {
+      colouring.reset(new ElementColouring());
+      colour_elements(elements.geometry_space().connectivity(), *colouring);
+      cache.set(key, colouring);
+    }
+    return colouring;
+  }
+}
+
 /// Helper struct to launch execution once all shape functions have been determined
 template<typename DataT>
 struct ElementLooperImpl
 {
-  template<typename ExprT>
-  void operator()(const ExprT& expr, DataT& data, const Uint nb_elems) const
+  /// @param nb_threads Number of threads to use. With more than one thread, the elements are coloured and the elements
+  /// of each colour are distributed over the threads. The expression must not modify any state shared between elements other
+  /// than the fields and the linear system (i.e. no values stored through lit() references).
+  /// @param geometry_cache Read the jacobians in element quadratures from the geometry cache of the elements (see geometry_cache)
+  ElementLooperImpl(const Uint nb_threads = 1, const bool geometry_cache = false) : m_nb_threads(nb_threads), m_geometry_cache(geometry_cache)
   {
-    const typename DataT::SupportShapeFunction::MappedCoordsT mapped_coords; // needed to deduce proper return type when wrapping
-    run(WrapExpression()(expr, mapped_coords, data), data, nb_elems);
+  }
+
+  template<typename ExprT, typename VariablesT>
+  void operator()(const ExprT& expr, VariablesT& variables, mesh::Elements& elements) const
+  {
+    const Uint nb_elems = elements.size();
+    if(m_nb_threads < 2 || nb_elems < 2)
+    {
+      DataT data(variables, elements);
+      if(m_geometry_cache)
+        data.enable_geometry_cache();
+      const typename DataT::SupportShapeFunction::MappedCoordsT mapped_coords; // needed to deduce proper return type when wrapping
+      run(WrapExpression()(expr, mapped_coords, data), data, nb_elems);
+      return;
+    }
+
+    const boost::shared_ptr<detail::ElementColouring const> colouring = detail::element_colouring(elements);
+
+    // Each thread gets its own data. The data is constructed here, since the constructor registers fields with the FieldSynchronizer
+    boost::ptr_vector<DataT> thread_data;
+    for(Uint i = 0; i != m_nb_threads; ++i)
+    {
+      thread_data.push_back(new DataT(variables, elements));
+      if(m_geometry_cache)
+        thread_data.back().enable_geometry_cache();
+    }
+
+    Barrier barrier(m_nb_threads);
+    std::vector<std::string> errors(m_nb_threads);
+    std::vector<ThreadPool::TaskT> tasks;
+    tasks.reserve(m_nb_threads);
+    for(Uint i = 0; i != m_nb_threads; ++i)
+      tasks.push_back(ThreadLoop<ExprT>(expr, thread_data[i], i, m_nb_threads, colouring->elements_by_colour, colouring->colour_starts, barrier, errors[i]));
+    ThreadPool::instance().run(tasks);
+
+    for(Uint i = 0; i != m_nb_threads; ++i)
+    {
+      if(!errors[i].empty())
+        throw common::ParallelError(FromHere(), "Error in element loop thread " + common::to_str(i) + " for " + elements.uri().path() + ": " + errors[i]);
+    }
   }
 
 private:
@@ -178,13 +309,80 @@ private:
       grammar(expr, elem, data);
     }
   }
+
+  /// Loop executed by each thread: for each colour, run the expression on the thread's share of the elements and wait for the others
+  template<typename ExprT>
+  struct ThreadLoop
+  {
+    ThreadLoop(const ExprT& expr, DataT& data, const Uint thread_idx, const Uint nb_threads, const std::vector<Uint>& elements_by_colour, const std::vector<Uint>& colour_starts, Barrier& barrier, std::string& error) :
+      m_expr(expr),
+      m_data(data),
+      m_thread_idx(thread_idx),
+      m_nb_threads(nb_threads),
+      m_elements_by_colour(elements_by_colour),
+      m_colour_starts(colour_starts),
+      m_barrier(barrier),
+      m_error(error)
+    {
+    }
+
+    void operator()()
+    {
+      const typename DataT::SupportShapeFunction::MappedCoordsT mapped_coords;
+      // The wrapped expression stores intermediate results, so each thread needs its own copy
+      run(WrapExpression()(m_expr, mapped_coords, m_data));
+    }
+
+    template<typename FilteredExprT>
+    void run(const FilteredExprT& expr)
+    {
+      ElementGrammar grammar;
+      const Uint nb_colours = m_colour_starts.size() - 1;
+      for(Uint c = 0; c != nb_colours; ++c)
+      {
+        // After an error, keep hitting the barrier so the other threads can finish
+        if(m_error.empty())
+        {
+          const Uint colour_size = m_colour_starts[c+1] - m_colour_starts[c];
+          const Uint begin = m_colour_starts[c] + (colour_size * m_thread_idx) / m_nb_threads;
+          const Uint end = m_colour_starts[c] + (colour_size * (m_thread_idx+1)) / m_nb_threads;
+          try
+          {
+            for(Uint i = begin; i != end; ++i)
+            {
+              const Uint elem = m_elements_by_colour[i];
+              m_data.set_element(elem);
+              grammar(expr, elem, m_data);
+            }
+          }
+          catch(std::exception& e)
+          {
+            m_error = e.what();
+          }
+        }
+        m_barrier.wait();
+      }
+    }
+
+    const ExprT& m_expr;
+    DataT& m_data;
+    const Uint m_thread_idx;
+    const Uint m_nb_threads;
+    const std::vector<Uint>& m_elements_by_colour;
+    const std::vector<Uint>& m_colour_starts;
+    Barrier& m_barrier;
+    std::string& m_error;
+  };
+
+  const Uint m_nb_threads;
+  const bool m_geometry_cache;
 };
 
 /// When we recursed to the last variable, actually run the expression
 template<typename ElementTypesT, typename ExprT, typename SupportETYPE, typename VariablesT, typename VariablesEtypesT, typename NbVarsT>
 struct ExpressionRunner<ElementTypesT, ExprT, SupportETYPE, VariablesT, VariablesEtypesT, NbVarsT, NbVarsT>
 {
-  ExpressionRunner(VariablesT& vars, const ExprT& expr, mesh::Elements& elems) : variables(vars), expression(expr), elements(elems) {}
+  ExpressionRunner(VariablesT& vars, const ExprT& expr, mesh::Elements& elems, const Uint nb_threads = 1, const bool geometry_cache = false) : variables(vars), expression(expr), elements(elems), m_nb_threads(nb_threads), m_geometry_cache(geometry_cache) {}
 
   typedef ElementData<VariablesT, VariablesEtypesT, SupportETYPE, typename EquationVariables<ExprT, NbVarsT>::type> DataT;
 
@@ -196,15 +394,15 @@ struct ExpressionRunner<ElementTypesT, ExprT, SupportETYPE, VariablesT, Variable
       INVALID_ELEMENT_EXPRESSION,
       (ElementGrammar));
 
-    DataT data(variables, elements);
-
-    ElementLooperImpl<DataT>()(expression, data, elements.size());
+    ElementLooperImpl<DataT>(m_nb_threads, m_geometry_cache)(expression, variables, elements);
   }
 
 private:
   VariablesT& variables;
   const ExprT& expression;
   mesh::Elements& elements;
+  const Uint m_nb_threads;
+  const bool m_geometry_cache;
 };
 
 /// mpl::for_each compatible functor to loop over elements, using the correct shape function for the geometry
@@ -215,10 +413,12 @@ struct ElementLooper
   // Type of a fusion vector that can contain a copy of each variable that is used in the expression
   typedef typename ExpressionProperties<ExprT>::VariablesT VariablesT;
 
-  ElementLooper(mesh::Elements& elements, const ExprT& expr, VariablesT& variables) :
+  ElementLooper(mesh::Elements& elements, const ExprT& expr, VariablesT& variables, const Uint nb_threads = 1, const bool geometry_cache = false) :
     m_elements(elements),
     m_expr(expr),
-    m_variables(variables)
+    m_variables(variables),
+    m_nb_threads(nb_threads),
+    m_geometry_cache(geometry_cache)
   {
   }
 
@@ -252,9 +452,7 @@ struct ElementLooper
     // Verify the types match, and throw an error if non-matching fields are found
     boost::fusion::for_each(m_variables, CheckSameEtype<ETYPE>(m_elements));
 
-    DataT data(m_variables, m_elements);
-
-    ElementLooperImpl<DataT>()(m_expr, data, m_elements.size());
+    ElementLooperImpl<DataT>(m_nb_threads, m_geometry_cache)(m_expr, m_variables, m_elements);
   }
 
   /// Static dispatch in case different ETYPE are possible
@@ -275,17 +473,21 @@ struct ElementLooper
       boost::mpl::vector0<>, // Start with an empty vector for the per-variable element types
       NbVarsT, // number of variables
       boost::mpl::int_<0> // Start index, as MPL integral constant
-    >(m_variables, m_expr, m_elements).run();
+    >(m_variables, m_expr, m_elements, m_nb_threads, m_geometry_cache).run();
   }
 
 private:
   mesh::Elements& m_elements;
   const ExprT& m_expr;
   VariablesT& m_variables;
+  const Uint m_nb_threads;
+  const bool m_geometry_cache;
 };
 
+/// Loop over all elements under root_region, evaluating expr
+/// @param nb_threads Number of threads to use for each Elements, see ElementLooperImpl for the requirements on expr
 template<typename ElementTypesT, typename ExprT>
-void for_each_element(mesh::Region& root_region, const ExprT& expr)
+void for_each_element(mesh::Region& root_region, const ExprT& expr, const Uint nb_threads = 1)
 {
   // Store the variables
   typedef typename ExpressionProperties<ExprT>::VariablesT VariablesT;
@@ -297,7 +499,7 @@ void for_each_element(mesh::Region& root_region, const ExprT& expr)
   BOOST_FOREACH(mesh::Elements& elements, common::find_components_recursively<mesh::Elements>(root_region))
   {
     // We skip order 0 functions in the top-call, because first the support shape function is determined, and order 0 is not allowed there
-    boost::mpl::for_each< boost::mpl::filter_view< ElementTypesT, mesh::IsMinimalOrder<1> > >( ElementLooper<ElementTypesT, ExprT>(elements, expr, vars) );
+    boost::mpl::for_each< boost::mpl::filter_view< ElementTypesT, mesh::IsMinimalOrder<1> > >( ElementLooper<ElementTypesT, ExprT>(elements, expr, vars, nb_threads) );
   }
 };
 
@@ -46,9 +46,37 @@ namespace Proto {
 class Expression
 {
 public:
+  Expression() : m_nb_threads(1), m_geometry_cache(false)
+  {
+  }
+
   /// Run the stored expression in a loop over the region
   virtual void loop(mesh::Region& region) = 0;
 
+  /// Set the number of threads used in loops over elements or nodes. The default of 1 runs the serial loop.
+  void set_nb_threads(const Uint nb_threads)
+  {
+    m_nb_threads = nb_threads;
+  }
+
+  /// Number of threads used in loops over elements or nodes
+  Uint nb_threads() const
+  {
+    return m_nb_threads;
+  }
+
+  /// Read the jacobians in element quadratures from a cache stored with the elements. Only valid if the mesh doesn't move.
+  void set_geometry_cache(const bool geometry_cache)
+  {
+    m_geometry_cache = geometry_cache;
+  }
+
+  /// True if element loops use the geometry cache
+  bool geometry_cache() const
+  {
+    return m_geometry_cache;
+  }
+
   /// Generate the required options for configurable items in the expression
   /// If an option already existed, only a link will be created
   /// @param options The optionlist that will hold the generated options
@@ -66,6 +94,10 @@ public:
   virtual void insert_field_info(std::map<std::string, std::string>& tags) const = 0;
 
   virtual ~Expression() {}
+
+protected:
+  Uint m_nb_threads;
+  bool m_geometry_cache;
 };
 
 /// Boilerplate implementation
@@ -255,7 +287,7 @@ public:
     // Traverse all Elements under the region and evaluate the expression
     BOOST_FOREACH(mesh::Elements& elements, common::find_components_recursively<mesh::Elements>(region) )
     {
-      boost::mpl::for_each<boost::mpl::filter_view< ElementTypes, mesh::IsMinimalOrder<1> > >( ElementLooper<ElementTypes, typename BaseT::CopiedExprT>(elements, BaseT::m_expr, BaseT::m_variables) );
+      boost::mpl::for_each<boost::mpl::filter_view< ElementTypes, mesh::IsMinimalOrder<1> > >( ElementLooper<ElementTypes, typename BaseT::CopiedExprT>(elements, BaseT::m_expr, BaseT::m_variables, BaseT::m_nb_threads, BaseT::m_geometry_cache) );
     }
   }
 };
@@ -279,7 +311,7 @@ public:
       INVALID_NODE_EXPRESSION,
       (NodeGrammar));
 
-    boost::mpl::for_each< DimsT >( NodeLooper<typename BaseT::CopiedExprT>(BaseT::m_expr, region, BaseT::m_variables) );
+    boost::mpl::for_each< DimsT >( NodeLooper<typename BaseT::CopiedExprT>(BaseT::m_expr, region, BaseT::m_variables, BaseT::m_nb_threads) );
   }
 };
 
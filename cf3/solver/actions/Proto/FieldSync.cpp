@@ -86,10 +86,13 @@ void FieldSynchronizer::synchronize()
   
   if(common::PE::Comm::instance().is_active())
   {
+    std::vector< Handle<mesh::Field> > fields;
+    fields.reserve(m_fields.size());
     for(FieldsT::iterator field_it = m_fields.begin(); field_it != m_fields.end(); ++field_it)
     {
-      field_it->second.first->synchronize();
+      fields.push_back(field_it->second.first);
     }
+    mesh::Field::synchronize_fields(fields);
   }
 
   m_fields.clear();
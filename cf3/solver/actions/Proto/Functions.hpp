@@ -7,7 +7,10 @@
 #ifndef cf3_solver_actions_Proto_Functions_hpp
 #define cf3_solver_actions_Proto_Functions_hpp
 
+#include <vector>
+
 #include <boost/proto/core.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "common/CF.hpp"
 #include "math/VectorialFunction.hpp"
@@ -50,10 +53,27 @@ pow(Arg const &arg)
 }
 
 
+/// Nodes for which a function is evaluated in one batch before a node loop
+struct BatchNodes
+{
+  /// Sorted node indices
+  std::vector<Uint> nodes;
+
+  /// For each node of the dictionary, its position in nodes, or math::Consts::uint_max() if it is not part of the batch
+  std::vector<Uint> slots;
+};
+
 /// Wrap the vectorial function, adding extra data that may be filled before expression evaluation
 struct ProtoEvaluatedFunction : math::VectorialFunction
 {
   mutable std::vector<Real> predefined_values;
+
+  /// Nodes for which batch_values holds the values, computed in one batch before a node loop.
+  /// When set, node loops take the value of these nodes from batch_values instead of evaluating the function.
+  boost::shared_ptr<BatchNodes const> batch_nodes;
+
+  /// Values of the functions in the nodes of batch_nodes, nbfuncs() values per node
+  std::vector<Real> batch_values;
 };
 
 
@@ -77,6 +97,13 @@ void evaluate_function(const ProtoEvaluatedFunction& func, const CoordsT& coords
   func.evaluate(func.predefined_values, result);
 }
 
+/// Evaluate the function in the current point of the loop. NodeData overloads this to use the precomputed node values.
+template<typename ResultT, typename DataT>
+void evaluate_function_data(const ProtoEvaluatedFunction& func, const DataT& data, ResultT& result)
+{
+  evaluate_function(func, data.coordinates(), result);
+}
+
 /// Primitive transform to evaluate a function with the function parser
 struct ParsedVectorFunctionTransform :
   boost::proto::transform< ParsedVectorFunctionTransform >
@@ -88,7 +115,7 @@ struct ParsedVectorFunctionTransform :
 
     result_type operator()(typename impl::expr_param expr, typename impl::state_param state, typename impl::data_param data) const
     {
-      evaluate_function(boost::proto::value(expr), data.coordinates(), expr.value);
+      evaluate_function_data(boost::proto::value(expr), data, expr.value);
       return expr.value;
     }
   };
@@ -105,7 +132,7 @@ boost::proto::transform< ParsedScalarFunctionTransform >
     Real operator()(typename impl::expr_param expr, typename impl::state_param state, typename impl::data_param data) const
     {
       std::vector<Real> result(1);
-      evaluate_function(boost::proto::value(expr), data.coordinates(), result);
+      evaluate_function_data(boost::proto::value(expr), data, result);
       return result.back();
     }
   };
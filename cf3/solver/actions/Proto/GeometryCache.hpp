@@ -0,0 +1,131 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_Proto_GeometryCache_hpp
+#define cf3_solver_actions_Proto_GeometryCache_hpp
+
+#include <vector>
+
+#include <boost/array.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "common/FindComponents.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Table.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/DataCache.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementData.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Integrators/Gauss.hpp"
+
+/// @file
+/// Storage of the geometric data at the quadrature points, for meshes that don't change
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+namespace Proto {
+
+/// Geometric data at the quadrature points of the Gauss quadrature of order Order, for all elements of volume element type EtypeT.
+/// For each element and quadrature point, this holds the gradient of the geometric shape functions in physical coordinates,
+/// followed by the integration weight, i.e. the jacobian determinant multiplied with the Gauss weight.
+template<typename EtypeT, Uint Order>
+class GeometryCache
+{
+public:
+  typedef mesh::Integrators::GaussMappedCoords<Order, EtypeT::shape> GaussT;
+
+  /// Gradient matrix of the shape functions
+  typedef typename EtypeT::SF::GradientT GradientT;
+
+  /// Number of entries in the gradient matrix
+  static const Uint gradient_size = GradientT::RowsAtCompileTime * GradientT::ColsAtCompileTime;
+
+  /// Number of entries for each quadrature point
+  static const Uint point_size = gradient_size + 1;
+
+  /// Offset of the integration weight in the data of a quadrature point
+  static const Uint weight_offset = gradient_size;
+
+  GeometryCache(const mesh::Elements& elements)
+  {
+    const Uint nb_elems = elements.size();
+    m_data.resize(nb_elems * GaussT::nb_points * point_size);
+
+    const common::Table<Real>& coordinates = elements.geometry_fields().coordinates();
+    const mesh::Connectivity& connectivity = elements.geometry_space().connectivity();
+    boost::array<Uint, EtypeT::nb_nodes> element_connectivity;
+    typename EtypeT::NodesT nodes;
+    typename EtypeT::JacobianT jacobian_matrix;
+    typename EtypeT::JacobianT jacobian_inverse;
+    GradientT mapped_gradient;
+    GradientT gradient;
+    Real jacobian_determinant;
+    bool is_invertible;
+    for(Uint elem = 0; elem != nb_elems; ++elem)
+    {
+      const mesh::Connectivity::ConstRow row = connectivity[elem];
+      std::copy(row.begin(), row.end(), element_connectivity.begin());
+      mesh::fill(nodes, coordinates, element_connectivity);
+      for(Uint i = 0; i != GaussT::nb_points; ++i)
+      {
+        // Same computations as GeometricSupport, EtypeTVariableData and ElementQuadratureEval, so the cached results are identical
+        const typename EtypeT::MappedCoordsT mapped_coords = GaussT::instance().coords.col(i);
+        EtypeT::compute_jacobian(mapped_coords, nodes, jacobian_matrix);
+        jacobian_matrix.computeInverseAndDetWithCheck(jacobian_inverse, jacobian_determinant, is_invertible);
+        cf3_assert(is_invertible);
+        EtypeT::SF::compute_gradient(mapped_coords, mapped_gradient);
+        gradient.noalias() = jacobian_inverse * mapped_gradient;
+
+        Real* data = &m_data[(elem*GaussT::nb_points + i)*point_size];
+        Eigen::Map<GradientT> gradient_data(data);
+        gradient_data = gradient;
+        data[weight_offset] = GaussT::instance().weights[i] * jacobian_determinant;
+      }
+    }
+  }
+
+  /// Data for quadrature point gauss_idx of element elem_idx
+  const Real* point_data(const Uint elem_idx, const Uint gauss_idx) const
+  {
+    return &m_data[(elem_idx*GaussT::nb_points + gauss_idx)*point_size];
+  }
+
+private:
+  std::vector<Real> m_data;
+};
+
+/// Get the geometry cache for the given elements and quadrature order, building it if it doesn't exist yet.
+/// The cache is kept in the DataCache of the mesh and dropped by Mesh::raise_mesh_changed, so it must only be used when
+/// the coordinates don't change without raising that event. Threads that miss the cache at the same time each build an identical copy.
+template<typename EtypeT, Uint Order>
+boost::shared_ptr< GeometryCache<EtypeT, Order> const > geometry_cache(const mesh::Elements& elements)
+{
+  typedef GeometryCache<EtypeT, Order> CacheT;
+
+  mesh::DataCache& data_cache = common::find_parent_component<mesh::Mesh>(elements).cache();
+  const std::string key = "proto_geometry_cache_" + common::to_str(Order) + ":" + elements.uri().path();
+  boost::shared_ptr<CacheT const> cache = data_cache.get<CacheT const>(key);
+  if(!cache)
+  {
+    cache.reset(new CacheT(elements));
+    data_cache.set(key, cache);
+  }
+
+  return cache;
+}
+
+} // namespace Proto
+} // namespace actions
+} // namespace solver
+} // namespace cf3
+
+#endif // cf3_solver_actions_Proto_GeometryCache_hpp
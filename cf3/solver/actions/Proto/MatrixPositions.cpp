@@ -0,0 +1,24 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "MatrixPositions.hpp"
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+namespace Proto {
+
+int* matrix_positions_cache(math::LSS::Matrix& matrix, const mesh::Connectivity::ArrayT& connectivity, const Uint block_size)
+{
+  const Uint cache_size = connectivity.size() * block_size;
+  std::vector<int>& cache = matrix.value_positions_storage(&connectivity, cache_size, uncomputed_position);
+  return cache.empty() ? nullptr : &cache[0];
+}
+
+} // namespace Proto
+} // namespace actions
+} // namespace solver
+} // namespace cf3
@@ -0,0 +1,36 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_Proto_MatrixPositions_hpp
+#define cf3_solver_actions_Proto_MatrixPositions_hpp
+
+#include "math/LSS/Matrix.hpp"
+
+#include "mesh/Connectivity.hpp"
+
+/// @file
+/// Storage of the positions of the element matrix entries in the values of an LSS matrix
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+namespace Proto {
+
+/// Marks the positions of an element that were not computed yet
+static const int uncomputed_position = -2;
+
+/// Get the cache of matrix value positions for the elements with the given connectivity, creating it if needed. The cache is kept
+/// by the matrix, keyed by the connectivity, so it is discarded together with the sparsity. It holds block_size positions for each
+/// element, as computed by math::LSS::Matrix::value_positions, and starts out filled with uncomputed_position.
+/// @param block_size Number of entries in the element matrix
+int* matrix_positions_cache(math::LSS::Matrix& matrix, const mesh::Connectivity::ArrayT& connectivity, const Uint block_size);
+
+} // namespace Proto
+} // namespace actions
+} // namespace solver
+} // namespace cf3
+
+#endif // cf3_solver_actions_Proto_MatrixPositions_hpp
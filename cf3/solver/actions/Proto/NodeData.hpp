@@ -16,6 +16,7 @@
 #include "common/PE/Comm.hpp"
 #include <common/Core.hpp>
 
+#include "math/Consts.hpp"
 #include "math/VariablesDescriptor.hpp"
 
 #include "mesh/Field.hpp"
@@ -27,6 +28,7 @@
 #include "mesh/Space.hpp"
 
 #include "FieldSync.hpp"
+#include "Functions.hpp"
 #include "Transforms.hpp"
 
 /// @file
@@ -395,6 +397,9 @@ private:
   /// Current coordinates
   mutable CoordsT m_position;
 
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
   ///////////// helper functions and structs /////////////
 private:
   /// Initializes the pointers in a VariablesDataT fusion sequence
@@ -467,6 +472,23 @@ private:
   };
 };
 
+/// Evaluate a function in the current node, taking the value from a batched evaluation if the node is part of it
+template<typename ResultT, typename VariablesT, typename NbDims>
+void evaluate_function_data(const ProtoEvaluatedFunction& func, const NodeData<VariablesT, NbDims>& data, ResultT& result)
+{
+  const Uint slot = func.batch_nodes ? func.batch_nodes->slots[data.node_idx] : math::Consts::uint_max();
+  if(slot == math::Consts::uint_max())
+  {
+    evaluate_function(func, data.coordinates(), result);
+    return;
+  }
+
+  const Uint nb_funcs = func.nbfuncs();
+  const Real* values = &func.batch_values[slot*nb_funcs];
+  for(Uint i = 0; i != nb_funcs; ++i)
+    result[i] = values[i];
+}
+
 } // namespace Proto
 } // namespace actions
 } // namespace solver
@@ -7,11 +7,15 @@
 #ifndef cf3_solver_actions_Proto_NodeLooper_hpp
 #define cf3_solver_actions_Proto_NodeLooper_hpp
 
+#include <boost/ptr_container/ptr_vector.hpp>
+
 #include "mesh/Functions.hpp"
 
+#include "DirichletBC.hpp"
 #include "FieldSync.hpp"
 #include "NodeData.hpp"
 #include "NodeGrammar.hpp"
+#include "ThreadPool.hpp"
 
 /// @file
 /// Loop over the nodes for a region
@@ -40,10 +44,16 @@ struct NodeLooperDim
 
   typedef NodeData<VariablesT, NbDimsT> DataT;
 
-  NodeLooperDim(const ExprT& expr, mesh::Region& region, VariablesT& variables) :
+  /// @param nb_threads Number of threads to use. With more than one thread, each thread gets a contiguous part of the nodes.
+  /// The expression must not modify any state shared between nodes other than the fields and the rows of a linear system
+  /// that belong to the node (i.e. no values stored through lit() references).
+  /// Expressions that set Dirichlet conditions run on a single thread, since the symmetric conditions also modify the
+  /// rows of neighbouring nodes.
+  NodeLooperDim(const ExprT& expr, mesh::Region& region, VariablesT& variables, const Uint nb_threads = 1) :
     m_expr(expr),
     m_region(region),
-    m_variables(variables)
+    m_variables(variables),
+    m_nb_threads(boost::result_of<ContainsDirichletBC(const ExprT&)>::type::value ? 1 : nb_threads)
   {
   }
 
@@ -137,35 +147,84 @@ struct NodeLooperDim
       dict = mesh.geometry_fields().handle<mesh::Dictionary>(); // fall back to the geometry if the dict is not found by tag
 
     const mesh::Field& coordinates = dict->coordinates();
-    DataT node_data(m_variables, m_region, coordinates, m_expr);
 
-    // Wrap things up so that we can store the intermediate product results
-    do_run(WrapExpression()(m_expr, 0, node_data), node_data, *dict);
+    // The list of used nodes is cached with the mesh, so it is only rebuilt after the mesh changed
+    const boost::shared_ptr< common::List<Uint> const > used_nodes = mesh::cached_used_nodes_list(m_region, *dict);
+    const common::List<Uint>& nodes = *used_nodes;
+    const Uint nb_nodes = nodes.size();
+
+    if(m_nb_threads < 2 || nb_nodes < m_nb_threads)
+    {
+      DataT node_data(m_variables, m_region, coordinates, m_expr);
+
+      // Wrap things up so that we can store the intermediate product results
+      do_run(WrapExpression()(m_expr, 0, node_data), node_data, nodes, 0, nb_nodes);
+      return;
+    }
+
+    // Each thread gets its own data. The data is constructed here, since the constructor registers fields with the FieldSynchronizer
+    boost::ptr_vector<DataT> thread_data;
+    for(Uint i = 0; i != m_nb_threads; ++i)
+      thread_data.push_back(new DataT(m_variables, m_region, coordinates, m_expr));
+
+    std::vector<std::string> errors(m_nb_threads);
+    std::vector<ThreadPool::TaskT> tasks;
+    for(Uint i = 0; i != m_nb_threads; ++i)
+      tasks.push_back(ThreadLoop(*this, thread_data[i], nodes, (nb_nodes * i) / m_nb_threads, (nb_nodes * (i+1)) / m_nb_threads, errors[i]));
+    ThreadPool::instance().run(tasks);
+
+    for(Uint i = 0; i != m_nb_threads; ++i)
+    {
+      if(!errors[i].empty())
+        throw common::ParallelError(FromHere(), "Error in node loop thread " + common::to_str(i) + " for " + m_region.uri().path() + ": " + errors[i]);
+    }
   }
 
 private:
   template<typename FilteredExprT>
-  void do_run(const FilteredExprT& expr, DataT& data, const mesh::Dictionary& dict) const
+  void do_run(const FilteredExprT& expr, DataT& data, const common::List<Uint>& nodes, const Uint begin, const Uint end) const
   {
     NodeGrammar grammar;
-
-    // Build a list of used entities
-    std::vector< Handle<mesh::Entities const> > used_entities;
-    BOOST_FOREACH(const mesh::Entities& entities, common::find_components_recursively<mesh::Entities>(m_region))
+    for(Uint i = begin; i != end; ++i)
     {
-      used_entities.push_back(entities.handle<mesh::Entities>());
+      data.set_node(nodes[i]);
+      grammar(expr, 0, data); // The "0" is the proto state, which is unused at the top-level expression
     }
+  }
 
-    boost::shared_ptr< common::List<Uint> > used_nodes_ptr = mesh::build_used_nodes_list(used_entities, dict, true);
+  /// Loop executed by each thread over its range of the used nodes
+  struct ThreadLoop
+  {
+    ThreadLoop(const NodeLooperDim& looper, DataT& data, const common::List<Uint>& nodes, const Uint begin, const Uint end, std::string& error) :
+      m_looper(looper),
+      m_data(data),
+      m_nodes(nodes),
+      m_begin(begin),
+      m_end(end),
+      m_error(error)
+    {
+    }
 
-    const common::List<Uint>& nodes = *used_nodes_ptr;
-    const Uint nb_nodes = nodes.size();
-    for(Uint i = 0; i != nb_nodes; ++i)
+    void operator()()
     {
-      data.set_node(nodes[i]);
-      grammar(expr, 0, data); // The "0" is the proto state, which is unused at the top-level expression
+      try
+      {
+        // The wrapped expression stores intermediate results, so each thread needs its own copy
+        m_looper.do_run(WrapExpression()(m_looper.m_expr, 0, m_data), m_data, m_nodes, m_begin, m_end);
+      }
+      catch(std::exception& e)
+      {
+        m_error = e.what();
+      }
     }
-  }
+
+    const NodeLooperDim& m_looper;
+    DataT& m_data;
+    const common::List<Uint>& m_nodes;
+    const Uint m_begin;
+    const Uint m_end;
+    std::string& m_error;
+  };
 
   struct FindDict
   {
@@ -197,6 +256,7 @@ private:
   const ExprT& m_expr;
   mesh::Region& m_region;
   VariablesT& m_variables;
+  const Uint m_nb_threads;
 };
 
 /// Loop over nodes, using static-sized vectors to store coordinates
@@ -206,10 +266,11 @@ struct NodeLooper
   /// Type of a fusion vector that can contain a copy of each variable that is used in the expression
   typedef typename ExpressionProperties<ExprT>::VariablesT VariablesT;
 
-  NodeLooper(const ExprT& expr, mesh::Region& region, VariablesT& variables) :
+  NodeLooper(const ExprT& expr, mesh::Region& region, VariablesT& variables, const Uint nb_threads = 1) :
     m_expr(expr),
     m_region(region),
-    m_variables(variables)
+    m_variables(variables),
+    m_nb_threads(nb_threads)
   {
   }
 
@@ -223,7 +284,7 @@ struct NodeLooper
       return;
 
     // Execute with known dimension
-    NodeLooperDim<ExprT, NbDimsT>(m_expr, m_region, m_variables)();
+    NodeLooperDim<ExprT, NbDimsT>(m_expr, m_region, m_variables, m_nb_threads)();
     
     FieldSynchronizer::instance().synchronize();
   }
@@ -233,10 +294,11 @@ private:
   const ExprT& m_expr;
   mesh::Region& m_region;
   VariablesT& m_variables;
+  const Uint m_nb_threads;
 };
 
 template<Uint dim, typename ExprT>
-void for_each_node(mesh::Region& root_region, const ExprT& expr)
+void for_each_node(mesh::Region& root_region, const ExprT& expr, const Uint nb_threads = 1)
 {
   // IF COMPILATION FAILS HERE: the espression passed is invalid
   BOOST_MPL_ASSERT_MSG(
@@ -250,18 +312,19 @@ void for_each_node(mesh::Region& root_region, const ExprT& expr)
   CopyNumberedVars<VariablesT> ctx(vars);
   boost::proto::eval(expr, ctx);
 
-  NodeLooper<ExprT>(expr, root_region, vars)(boost::mpl::int_<dim>());
+  NodeLooper<ExprT>(expr, root_region, vars, nb_threads)(boost::mpl::int_<dim>());
 }
 
 /// Visit all nodes used by root_region exactly once, executing expr
 /// @param variable_names Name of each of the variables, in case a linear system is solved
 /// @param variable_sizes Size (number of scalars) that makes up each variable in the linear system, if any
+/// @param nb_threads Number of threads sharing the nodes
 template<typename ExprT>
-void for_each_node(mesh::Region& root_region, const ExprT& expr)
+void for_each_node(mesh::Region& root_region, const ExprT& expr, const Uint nb_threads = 1)
 {
-  for_each_node<1>(root_region, expr);
-  for_each_node<2>(root_region, expr);
-  for_each_node<3>(root_region, expr);
+  for_each_node<1>(root_region, expr, nb_threads);
+  for_each_node<2>(root_region, expr, nb_threads);
+  for_each_node<3>(root_region, expr, nb_threads);
 }
 
 
@@ -11,6 +11,7 @@
 #include "common/Builder.hpp"
 #include "common/Log.hpp"
 #include "common/OptionComponent.hpp"
+#include "common/ScopedTimer.hpp"
 #include "common/URI.hpp"
 
 #include "mesh/Region.hpp"
@@ -37,7 +38,8 @@ struct ProtoAction::Implementation
 {
   Implementation(Component& comp, const Handle<PhysModel>& physical_model) :
     m_component(comp),
-    m_physical_model(physical_model)
+    m_physical_model(physical_model),
+    m_timing_region(timing_region(comp.name()))
   {
     m_component.options().option(Tags::physical_model()).attach_trigger(boost::bind(&Implementation::trigger_physical_model, this));
   }
@@ -64,6 +66,9 @@ struct ProtoAction::Implementation
 
   const Handle<PhysModel>& m_physical_model;
 
+  /// Timing region for the action, looked up when the action is set up since registration takes a lock
+  Uint m_timing_region;
+
   struct PhysicsConstantLink
   {
     PhysicsConstantLink(const Handle<PhysModel>& physical_model, const std::string& constant_name, Real& value, const std::string& parent_path) :
@@ -107,6 +112,15 @@ ProtoAction::ProtoAction(const std::string& name) :
   Action(name),
   m_implementation(new Implementation(*this, m_physical_model))
 {
+  options().add("nb_threads", 1u)
+    .pretty_name("Number of Threads")
+    .description("Number of threads used to loop over elements or nodes. Elements are coloured so the result is identical to the serial loop. Node loops that apply a Dirichlet condition always run serially, since the symmetric form also modifies the rows of the neighbouring nodes. Other node loops only write to the rows of their own node, so they can run threaded. Only use this for expressions that do not store values outside of fields and linear systems.")
+    .attach_trigger(boost::bind(&ProtoAction::trigger_nb_threads, this));
+
+  options().add("geometry_cache", false)
+    .pretty_name("Geometry Cache")
+    .description("Compute the shape function gradients and integration weights at the quadrature points only once and keep them with the mesh. The cache is rebuilt when the mesh_changed event is raised, so don't use this for moving meshes.")
+    .attach_trigger(boost::bind(&ProtoAction::trigger_geometry_cache, this));
 }
 
 ProtoAction::~ProtoAction()
@@ -118,6 +132,9 @@ void ProtoAction::execute()
   if(m_loop_regions.empty())
     CFwarn << "No regions to loop over for action " << uri().string() << CFendl;
 
+  // Timed per action name, so the assembly of each equation shows up separately
+  const ScopedTimer timer(m_implementation->m_timing_region);
+
   boost_foreach(const Handle< Region >& region, m_loop_regions)
   {
     if(is_null(m_implementation->m_expression))
@@ -130,8 +147,27 @@ void ProtoAction::execute()
 void ProtoAction::set_expression(const boost::shared_ptr< Expression >& expression)
 {
   m_implementation->m_expression = expression;
+  m_implementation->m_timing_region = timing_region(name());
   expression->add_options(options());
   m_implementation->trigger_physical_model();
+  trigger_nb_threads();
+  trigger_geometry_cache();
+}
+
+void ProtoAction::trigger_nb_threads()
+{
+  const Uint nb_threads = options().value<Uint>("nb_threads");
+  if(nb_threads == 0)
+    throw BadValue(FromHere(), "Number of threads for " + uri().path() + " must be at least 1");
+
+  if(is_not_null(m_implementation->m_expression))
+    m_implementation->m_expression->set_nb_threads(nb_threads);
+}
+
+void ProtoAction::trigger_geometry_cache()
+{
+  if(is_not_null(m_implementation->m_expression))
+    m_implementation->m_expression->set_geometry_cache(options().value<bool>("geometry_cache"));
 }
 
 bool ProtoAction::expression_is_set() const
@@ -48,6 +48,11 @@ public:
   void insert_field_info(std::map<std::string, std::string>& tags) const;
 
 private:
+  /// Pass the nb_threads option to the expression
+  void trigger_nb_threads();
+  /// Pass the geometry_cache option to the expression
+  void trigger_geometry_cache();
+
   class Implementation;
   boost::scoped_ptr<Implementation> m_implementation;
 };
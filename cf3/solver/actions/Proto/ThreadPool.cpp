@@ -0,0 +1,165 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <boost/bind.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "ThreadPool.hpp"
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+namespace Proto {
+
+class ThreadPool::Implementation
+{
+public:
+  Implementation() :
+    m_nb_workers(0),
+    m_tasks(0),
+    m_generation(0),
+    m_nb_busy(0),
+    m_stop(false)
+  {
+  }
+
+  ~Implementation()
+  {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      m_stop = true;
+    }
+    m_start_condition.notify_all();
+    m_threads.join_all();
+  }
+
+  void run(const std::vector<TaskT>& tasks)
+  {
+    boost::mutex::scoped_lock run_lock(m_run_mutex);
+
+    const Uint nb_workers = tasks.size() - 1;
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      // New workers wait for the next generation, which is the one started below
+      for(; m_nb_workers < nb_workers; ++m_nb_workers)
+        m_threads.create_thread(boost::bind(&Implementation::work, this, m_nb_workers, m_generation));
+      m_tasks = &tasks;
+      m_nb_busy = nb_workers;
+      ++m_generation;
+    }
+    m_start_condition.notify_all();
+
+    tasks.front()();
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    while(m_nb_busy != 0)
+      m_done_condition.wait(lock);
+    m_tasks = 0;
+  }
+
+private:
+  /// Main loop of worker idx, started in the given generation
+  void work(const Uint idx, Uint generation)
+  {
+    while(true)
+    {
+      const TaskT* task = 0;
+      {
+        boost::mutex::scoped_lock lock(m_mutex);
+        while(!m_stop && m_generation == generation)
+          m_start_condition.wait(lock);
+        if(m_stop)
+          return;
+        generation = m_generation;
+        if(idx + 1 < m_tasks->size())
+          task = &(*m_tasks)[idx + 1];
+      }
+
+      if(task == 0)
+        continue;
+
+      (*task)();
+
+      boost::mutex::scoped_lock lock(m_mutex);
+      if(--m_nb_busy == 0)
+        m_done_condition.notify_one();
+    }
+  }
+
+  /// Serializes the calls to run
+  boost::mutex m_run_mutex;
+
+  /// Protects the state below
+  boost::mutex m_mutex;
+  boost::condition_variable m_start_condition;
+  boost::condition_variable m_done_condition;
+
+  boost::thread_group m_threads;
+  Uint m_nb_workers;
+  /// Tasks of the current run
+  const std::vector<TaskT>* m_tasks;
+  /// Incremented for each run, so the workers know there is new work
+  Uint m_generation;
+  /// Number of workers that still have to finish their task in the current run
+  Uint m_nb_busy;
+  bool m_stop;
+};
+
+ThreadPool& ThreadPool::instance()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+ThreadPool::ThreadPool() :
+  m_implementation(new Implementation())
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+void ThreadPool::run(const std::vector<TaskT>& tasks)
+{
+  if(tasks.empty())
+    return;
+
+  m_implementation->run(tasks);
+}
+
+class Barrier::Implementation
+{
+public:
+  Implementation(const Uint nb_threads) :
+    m_barrier(nb_threads)
+  {
+  }
+
+  boost::barrier m_barrier;
+};
+
+Barrier::Barrier(const Uint nb_threads) :
+  m_implementation(new Implementation(nb_threads))
+{
+}
+
+Barrier::~Barrier()
+{
+}
+
+void Barrier::wait()
+{
+  m_implementation->m_barrier.wait();
+}
+
+} // namespace Proto
+} // namespace actions
+} // namespace solver
+} // namespace cf3
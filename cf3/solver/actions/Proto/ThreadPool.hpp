@@ -0,0 +1,70 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_Proto_ThreadPool_hpp
+#define cf3_solver_actions_Proto_ThreadPool_hpp
+
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "common/CF.hpp"
+
+#include "solver/actions/LibActions.hpp"
+
+/// @file
+/// Worker threads shared by the threaded Proto loops
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+namespace Proto {
+
+/// Worker threads that stay alive between loops, so threaded loops don't start and join new threads on every execution.
+/// Workers are started on first use, and more are added when a run needs them.
+/// The threading primitives are kept out of this header, since the Boost.Thread headers break the code that raises the MPL arity limits.
+class solver_actions_API ThreadPool
+{
+public:
+  typedef boost::function<void()> TaskT;
+
+  /// The pool shared by all loops
+  static ThreadPool& instance();
+
+  ~ThreadPool();
+
+  /// Run the tasks concurrently, the first on the calling thread and each of the others on its own worker, and return when
+  /// all of them are done. Tasks must not throw, and must not call run themselves. Concurrent calls are executed one after the other.
+  void run(const std::vector<TaskT>& tasks);
+
+private:
+  ThreadPool();
+
+  class Implementation;
+  boost::scoped_ptr<Implementation> m_implementation;
+};
+
+/// Barrier for the tasks of a ThreadPool run: wait returns once nb_threads threads have called it
+class solver_actions_API Barrier
+{
+public:
+  Barrier(const Uint nb_threads);
+  ~Barrier();
+
+  void wait();
+
+private:
+  class Implementation;
+  boost::scoped_ptr<Implementation> m_implementation;
+};
+
+} // namespace Proto
+} // namespace actions
+} // namespace solver
+} // namespace cf3
+
+#endif // cf3_solver_actions_Proto_ThreadPool_hpp
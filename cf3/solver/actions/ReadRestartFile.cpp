@@ -4,6 +4,9 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <map>
+
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
 
@@ -11,6 +14,9 @@
 #include "common/OptionList.hpp"
 #include "common/List.hpp"
 #include "common/BinaryDataReader.hpp"
+#include "common/Table.hpp"
+
+#include "common/PE/Comm.hpp"
 
 #include "common/XML/FileOperations.hpp"
 
@@ -25,6 +31,7 @@
 #include "solver/Time.hpp"
 
 #include "solver/actions/ReadRestartFile.hpp"
+#include "solver/actions/WriteRestartFile.hpp"
 
 /////////////////////////////////////////////////////////////////////////////////////
 
@@ -38,6 +45,180 @@ common::ComponentBuilder < ReadRestartFile, common::Action, LibActions > ReadRes
 
 ///////////////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+
+/// Send the data in send[i] to rank i, or copy it when running serially
+template<typename T>
+void exchange(const std::vector< std::vector<T> >& send, std::vector< std::vector<T> >& recv)
+{
+  common::PE::Comm& comm = common::PE::Comm::instance();
+  if(comm.is_active())
+    comm.all_to_all(send, recv);
+  else
+    recv = send;
+}
+
+/// The fields of one dictionary that are stored in a restart file
+struct DictionaryFields
+{
+  /// Index of the block with the row keys
+  Uint keys_index;
+  std::vector< Handle<mesh::Field> > fields;
+  /// Index of the block for each field
+  std::vector<Uint> field_indices;
+};
+
+/// Row key and the location of the row among the received data
+typedef std::pair< std::pair<Uint, Uint>, std::pair<Uint, Uint> > KeyLocationT;
+
+/// Read fields that may have been written using a different number of ranks. The rows from the file are read by
+/// spreading the file ranks over the current ranks, and then sent to an intermediate rank determined by their key.
+/// Each rank then requests the rows of its dictionary from the intermediate ranks.
+/// Returns the number of rows on this rank that were not found in the file
+Uint read_distributed(const common::URI& binary_file, const Uint nb_file_procs, const DictionaryFields& entry)
+{
+  common::PE::Comm& comm = common::PE::Comm::instance();
+  const Uint nb_procs = comm.is_active() ? comm.size() : 1;
+  const Uint rank = comm.is_active() ? comm.rank() : 0;
+  const Uint nb_fields = entry.fields.size();
+  const mesh::Dictionary& dict = entry.fields.front()->dict();
+
+  Uint row_width = 0;
+  BOOST_FOREACH(const Handle<mesh::Field>& field, entry.fields)
+  {
+    row_width += field->row_size();
+  }
+
+  // Read the data written by the file ranks rank, rank + nb_procs, ... and send each row to the rank handling its key
+  std::vector< std::vector<Uint> > send_keys(nb_procs);
+  std::vector< std::vector<Real> > send_values(nb_procs);
+  if(rank < nb_file_procs)
+  {
+    boost::shared_ptr<common::BinaryDataReader> data_reader = common::allocate_component<common::BinaryDataReader>("DataReader");
+    boost::shared_ptr< common::Table<Uint> > keys = common::allocate_component< common::Table<Uint> >("Keys");
+    boost::shared_ptr< common::Table<Real> > values = common::allocate_component< common::Table<Real> >("Values");
+    data_reader->options().set("rank", rank);
+    data_reader->options().set("file", binary_file);
+    std::vector<Real> rows;
+    for(Uint file_rank = rank; file_rank < nb_file_procs; file_rank += nb_procs)
+    {
+      if(file_rank != rank)
+        data_reader->options().set("rank", file_rank);
+
+      data_reader->read_table(*keys, entry.keys_index);
+      const Uint nb_rows = keys->size();
+      rows.resize(nb_rows*row_width);
+      Uint offset = 0;
+      for(Uint field_idx = 0; field_idx != nb_fields; ++field_idx)
+      {
+        const mesh::Field& field = *entry.fields[field_idx];
+        const Uint row_size = field.row_size();
+        data_reader->read_table(*values, entry.field_indices[field_idx]);
+        if(values->size() != nb_rows || values->row_size() != row_size)
+          throw common::FileFormatError(FromHere(), "Data for field " + field.uri().path() + " in " + binary_file.path() + " does not match the field size");
+        for(Uint i = 0; i != nb_rows; ++i)
+        {
+          for(Uint j = 0; j != row_size; ++j)
+            rows[i*row_width + offset + j] = (*values)[i][j];
+        }
+        offset += row_size;
+      }
+
+      for(Uint i = 0; i != nb_rows; ++i)
+      {
+        const Uint destination = (*keys)[i][0] % nb_procs;
+        send_keys[destination].push_back((*keys)[i][0]);
+        send_keys[destination].push_back((*keys)[i][1]);
+        send_values[destination].insert(send_values[destination].end(), rows.begin() + i*row_width, rows.begin() + (i+1)*row_width);
+      }
+    }
+  }
+
+  std::vector< std::vector<Uint> > file_keys;
+  std::vector< std::vector<Real> > file_values;
+  exchange(send_keys, file_keys);
+  exchange(send_values, file_values);
+  send_keys.clear();
+  send_values.clear();
+
+  // Sort the received rows by key, so they can be looked up
+  std::vector<KeyLocationT> lookup;
+  for(Uint proc = 0; proc != nb_procs; ++proc)
+  {
+    const Uint nb_rows = file_keys[proc].size() / 2;
+    for(Uint i = 0; i != nb_rows; ++i)
+      lookup.push_back(std::make_pair(std::make_pair(file_keys[proc][2*i], file_keys[proc][2*i+1]), std::make_pair(proc, i)));
+  }
+  std::sort(lookup.begin(), lookup.end());
+
+  // Request the rows of the local dictionary from the ranks handling their keys
+  std::vector<Uint> row_keys;
+  WriteRestartFile::row_keys(dict, row_keys);
+  const Uint nb_rows = dict.size();
+  std::vector< std::vector<Uint> > requests(nb_procs);
+  std::vector< std::vector<Uint> > requested_rows(nb_procs);
+  for(Uint i = 0; i != nb_rows; ++i)
+  {
+    const Uint destination = row_keys[2*i] % nb_procs;
+    requests[destination].push_back(row_keys[2*i]);
+    requests[destination].push_back(row_keys[2*i+1]);
+    requested_rows[destination].push_back(i);
+  }
+
+  std::vector< std::vector<Uint> > received_requests;
+  exchange(requests, received_requests);
+
+  // Answer the requests, leaving rows that are missing from the file at zero
+  std::vector< std::vector<Real> > replies(nb_procs);
+  Uint nb_missing = 0;
+  for(Uint proc = 0; proc != nb_procs; ++proc)
+  {
+    const Uint nb_requested = received_requests[proc].size() / 2;
+    replies[proc].reserve(nb_requested*row_width);
+    for(Uint i = 0; i != nb_requested; ++i)
+    {
+      const std::pair<Uint, Uint> key(received_requests[proc][2*i], received_requests[proc][2*i+1]);
+      const std::vector<KeyLocationT>::const_iterator found = std::lower_bound(lookup.begin(), lookup.end(), std::make_pair(key, std::make_pair(0u, 0u)));
+      if(found == lookup.end() || found->first != key)
+      {
+        ++nb_missing;
+        replies[proc].resize(replies[proc].size() + row_width, 0.);
+        continue;
+      }
+      const std::vector<Real>& source = file_values[found->second.first];
+      replies[proc].insert(replies[proc].end(), source.begin() + found->second.second*row_width, source.begin() + (found->second.second+1)*row_width);
+    }
+  }
+
+  std::vector< std::vector<Real> > received_replies;
+  exchange(replies, received_replies);
+
+  for(Uint proc = 0; proc != nb_procs; ++proc)
+  {
+    const std::vector<Uint>& rows = requested_rows[proc];
+    const std::vector<Real>& reply = received_replies[proc];
+    cf3_assert(reply.size() == rows.size()*row_width);
+    for(Uint i = 0; i != rows.size(); ++i)
+    {
+      Uint offset = i*row_width;
+      BOOST_FOREACH(const Handle<mesh::Field>& field, entry.fields)
+      {
+        const Uint row_size = field->row_size();
+        for(Uint j = 0; j != row_size; ++j)
+          (*field)[rows[i]][j] = reply[offset + j];
+        offset += row_size;
+      }
+    }
+  }
+
+  return nb_missing;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+
 ReadRestartFile::ReadRestartFile ( const std::string& name ) :
   common::Action(name)
 {  
@@ -88,27 +269,78 @@ void ReadRestartFile::execute()
     time->options().set("iteration", common::from_str<Uint>(restart_node.attribute_value("iteration")));
   }
 
-  if(common::from_str<Uint>(restart_node.attribute_value("version")) != 1)
+  const Uint version = common::from_str<Uint>(restart_node.attribute_value("version"));
+  if(version != 1 && version != 2)
     throw common::FileFormatError(FromHere(), "File  " + filepath.path() + " has unsupported version");
 
   common::PE::Comm& comm = common::PE::Comm::instance();
-  if(common::from_str<Uint>(restart_node.attribute_value("nb_procs")) != comm.size())
-    throw common::SetupError(FromHere(), "File  " + filepath.path() + " was made for " + restart_node.attribute_value("nb_procs") + " CPUs, but we are loading on " + common::to_str(comm.size()) + " CPUs");
+  const Uint nb_file_procs = common::from_str<Uint>(restart_node.attribute_value("nb_procs"));
+
+  // Version 1 files contain the complete field tables of each rank
+  if(version == 1)
+  {
+    if(nb_file_procs != comm.size())
+      throw common::SetupError(FromHere(), "File  " + filepath.path() + " was made for " + restart_node.attribute_value("nb_procs") + " CPUs, but we are loading on " + common::to_str(comm.size()) + " CPUs");
+
+    boost::shared_ptr<common::BinaryDataReader> data_reader = common::allocate_component<common::BinaryDataReader>("DataReader");
+    data_reader->options().set("file", common::URI(restart_node.attribute_value("binary_file")));
 
-  boost::shared_ptr<common::BinaryDataReader> data_reader = common::allocate_component<common::BinaryDataReader>("DataReader");
-  data_reader->options().set("file", common::URI(restart_node.attribute_value("binary_file")));
+    common::XML::XmlNode field_node = restart_node.content->first_node("field");
+    for(; field_node.is_valid(); field_node.content = field_node.content->next_sibling("field"))
+    {
+      data_reader->read_table(*find_field(*mesh, field_node.attribute_value("path")), common::from_str<Uint>(field_node.attribute_value("index")));
+    }
+    return;
+  }
+
+  // Version 2 files store the rows owned by each rank, identified by a key that is independent of the partitioning
+  std::map<std::string, detail::DictionaryFields> dictionaries;
+  std::vector<std::string> dictionary_order;
+  common::XML::XmlNode dict_node = restart_node.content->first_node("dictionary");
+  for(; dict_node.is_valid(); dict_node.content = dict_node.content->next_sibling("dictionary"))
+  {
+    const std::string path = dict_node.attribute_value("path");
+    dictionaries[path].keys_index = common::from_str<Uint>(dict_node.attribute_value("index"));
+    dictionary_order.push_back(path);
+  }
 
   common::XML::XmlNode field_node = restart_node.content->first_node("field");
   for(; field_node.is_valid(); field_node.content = field_node.content->next_sibling("field"))
   {
-    Handle<mesh::Field> field(mesh->access_component(common::URI(field_node.attribute_value("path"), common::URI::Scheme::CPATH)));
-    if(is_null(field))
-      throw common::SetupError(FromHere(), "Field " + field_node.attribute_value("path") + " was not found in mesh " + mesh->uri().path());
+    const std::string dict_path = field_node.attribute_value("dictionary");
+    if(!dictionaries.count(dict_path))
+      throw common::FileFormatError(FromHere(), "File  " + filepath.path() + " has no data for dictionary " + dict_path);
+    detail::DictionaryFields& entry = dictionaries[dict_path];
+    entry.fields.push_back(find_field(*mesh, field_node.attribute_value("path")));
+    entry.field_indices.push_back(common::from_str<Uint>(field_node.attribute_value("index")));
+  }
+
+  const common::URI binary_file(restart_node.attribute_value("binary_file"));
+  BOOST_FOREACH(const std::string& dict_path, dictionary_order)
+  {
+    const detail::DictionaryFields& entry = dictionaries[dict_path];
+    if(entry.fields.empty())
+      continue;
 
-    data_reader->read_table(*field, common::from_str<Uint>(field_node.attribute_value("index")));
+    Uint nb_missing = detail::read_distributed(binary_file, nb_file_procs, entry);
+    if(comm.is_active())
+    {
+      Uint nb_missing_local = nb_missing;
+      comm.all_reduce(common::PE::plus(), &nb_missing_local, 1, &nb_missing);
+    }
+    if(nb_missing != 0)
+      throw common::SetupError(FromHere(), "File  " + filepath.path() + " has no data for " + common::to_str(nb_missing) + " rows of dictionary " + dict_path);
   }
 }
 
+Handle<mesh::Field> ReadRestartFile::find_field(mesh::Mesh& mesh, const std::string& path)
+{
+  Handle<mesh::Field> field(mesh.access_component(common::URI(path, common::URI::Scheme::CPATH)));
+  if(is_null(field))
+    throw common::SetupError(FromHere(), "Field " + path + " was not found in mesh " + mesh.uri().path());
+  return field;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 } // actions
@@ -10,6 +10,8 @@
 #include "common/Action.hpp"
 #include "solver/actions/LibActions.hpp"
 
+namespace cf3 { namespace mesh { class Field; class Mesh; } }
+
 /////////////////////////////////////////////////////////////////////////////////////
 
 namespace cf3 {
@@ -19,6 +21,8 @@ namespace actions {
 ///////////////////////////////////////////////////////////////////////////////////////
 
 /// Read out a restartfile, designed to be loaded into an already-created mesh
+/// Files written by WriteRestartFile can be read using any number of ranks, the data is redistributed according to
+/// the global numbering. Files of the older format 1 can only be read using the same number of ranks.
 class solver_actions_API ReadRestartFile : public common::Action
 {
 public: // functions
@@ -34,6 +38,10 @@ public: // functions
 
   /// execute the action
   virtual void execute ();
+
+private:
+  /// Get the field with the given path, relative to the mesh
+  Handle<mesh::Field> find_field(mesh::Mesh& mesh, const std::string& path);
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
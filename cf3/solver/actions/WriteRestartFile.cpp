@@ -4,14 +4,20 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <map>
+
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
 
 #include "common/Builder.hpp"
+#include "common/Signal.hpp"
 #include "common/FindComponents.hpp"
 #include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
 #include "common/List.hpp"
+#include "common/Log.hpp"
 #include "common/BinaryDataWriter.hpp"
+#include "common/PE/Comm.hpp"
 #include "common/XML/FileOperations.hpp"
 
 #include "mesh/Dictionary.hpp"
@@ -20,6 +26,7 @@
 #include "mesh/Space.hpp"
 #include "mesh/ElementType.hpp"
 #include "mesh/Connectivity.hpp"
+#include "mesh/Entities.hpp"
 
 #include "solver/Tags.hpp"
 #include "solver/Time.hpp"
@@ -38,6 +45,15 @@ common::ComponentBuilder < WriteRestartFile, common::Action, LibActions > WriteR
 
 ///////////////////////////////////////////////////////////////////////////////////////
 
+struct WriteRestartFile::PendingOutput
+{
+  common::URI file;
+  boost::shared_ptr<common::BinaryDataWriter> data_writer;
+  boost::shared_ptr<common::XML::XmlDoc> xml_doc;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+
 WriteRestartFile::WriteRestartFile ( const std::string& name ) :
   common::Action(name)
 {
@@ -55,6 +71,62 @@ WriteRestartFile::WriteRestartFile ( const std::string& name ) :
     .pretty_name("Time")
     .description("Time component, used to extract timing and iteration information")
     .mark_basic();
+
+  options().add("asynchronous", false)
+    .pretty_name("Asynchronous")
+    .description("Return as soon as the field data is copied, compressing and writing it on a background thread");
+
+  options().add("shared_file", false)
+    .pretty_name("Shared File")
+    .description("Write the binary data of all ranks into a single file, instead of one file per rank");
+
+  options().add("max_pending_outputs", 2u)
+    .pretty_name("Max Pending Outputs")
+    .description("Maximum number of restart files that may be in the process of being written in asynchronous mode. Older files are completed first when this is exceeded.");
+
+  std::vector<boost::any> codecs;
+  codecs.push_back(std::string("zlib"));
+  codecs.push_back(std::string("zlib_fast"));
+  codecs.push_back(std::string("none"));
+  options().add("codec", std::string("zlib"))
+    .pretty_name("Codec")
+    .description("Compression used for the binary data: zlib, zlib_fast (fastest zlib level) or none")
+    .restricted_list() = codecs;
+
+  options().add("chunk_size", 1048576u)
+    .pretty_name("Chunk Size")
+    .description("Size in bytes of the independently compressed chunks of each binary data block. 0 compresses each block as a single stream.");
+
+  options().add("nb_threads", 1u)
+    .pretty_name("Number of Threads")
+    .description("Number of threads used to compress the chunks of a binary data block");
+
+  regist_signal( "wait_for_output" )
+    .connect( boost::bind( &WriteRestartFile::signal_wait_for_output, this, _1 ) )
+    .description("Wait until all pending asynchronous output is written")
+    .pretty_name("Wait For Output");
+}
+
+WriteRestartFile::~WriteRestartFile()
+{
+  if(m_pending_outputs.empty())
+    return;
+
+  // Completing the output is collective, so this only works if all ranks destroy the writer before MPI is finalized
+  if(common::PE::Comm::instance().is_finalized())
+  {
+    CFerror << "Restart output of " << uri().path() << " was not completed before MPI was finalized, call wait_for_output() before shutting down" << CFendl;
+    return;
+  }
+
+  try
+  {
+    wait_for_output();
+  }
+  catch(std::exception& e)
+  {
+    CFerror << e.what() << CFendl;
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -84,12 +156,26 @@ void WriteRestartFile::execute()
   
   const common::URI out_file_path = options().value<common::URI>("file");
   const common::URI binfile = out_file_path.base_path() / (out_file_path.base_name() + ".cfbinxml");
-  boost::shared_ptr<common::BinaryDataWriter> data_writer = common::allocate_component<common::BinaryDataWriter>("DataWriter");
-  data_writer->options().set("file", binfile);
-  
-  common::XML::XmlDoc xml_doc("1.0", "ISO-8859-1");
-  common::XML::XmlNode restart_node = xml_doc.add_node("restart");
-  restart_node.set_attribute("version", "1");
+  const bool asynchronous = options().value<bool>("asynchronous");
+
+  // Earlier output to the same file must be complete before a new writer opens it
+  while(has_pending_output(out_file_path))
+    finish_output();
+
+  boost::shared_ptr<PendingOutput> output(new PendingOutput());
+  output->file = out_file_path;
+  output->data_writer = common::allocate_component<common::BinaryDataWriter>("DataWriter");
+  output->data_writer->options().set("asynchronous", asynchronous);
+  output->data_writer->options().set("shared_file", options().value<bool>("shared_file"));
+  output->data_writer->options().set("file", binfile);
+  output->data_writer->options().set("codec", options().value<std::string>("codec"));
+  output->data_writer->options().set("chunk_size", options().value<Uint>("chunk_size"));
+  output->data_writer->options().set("nb_threads", options().value<Uint>("nb_threads"));
+  common::BinaryDataWriter& data_writer = *output->data_writer;
+
+  output->xml_doc.reset(new common::XML::XmlDoc("1.0", "ISO-8859-1"));
+  common::XML::XmlNode restart_node = output->xml_doc->add_node("restart");
+  restart_node.set_attribute("version", "2");
   restart_node.set_attribute("binary_file", binfile.path());
   restart_node.set_attribute("nb_procs", common::to_str(comm.size()));
   restart_node.set_attribute("current_time", common::to_str(time->current_time()));
@@ -97,19 +183,138 @@ void WriteRestartFile::execute()
   restart_node.set_attribute("iteration", common::to_str(time->iter()));
   
   const std::string base_path = mesh->uri().path() + "/";
+
+  // Write the keys of the rows owned by this rank, once for each dictionary
+  std::map< const mesh::Dictionary*, std::vector<Uint> > owned_rows;
+  BOOST_FOREACH(const Handle<mesh::Field>& field, fields)
+  {
+    const mesh::Dictionary& dict = field->dict();
+    if(owned_rows.count(&dict))
+      continue;
+
+    std::vector<Uint>& rows = owned_rows[&dict];
+    const Uint nb_rows = dict.size();
+    for(Uint i = 0; i != nb_rows; ++i)
+    {
+      if(!dict.is_ghost(i))
+        rows.push_back(i);
+    }
+
+    std::vector<Uint> keys;
+    row_keys(dict, keys);
+    boost::shared_ptr< common::Table<Uint> > owned_keys = common::allocate_component< common::Table<Uint> >(dict.name());
+    owned_keys->set_row_size(2);
+    owned_keys->resize(rows.size());
+    for(Uint i = 0; i != rows.size(); ++i)
+    {
+      (*owned_keys)[i][0] = keys[2*rows[i]];
+      (*owned_keys)[i][1] = keys[2*rows[i]+1];
+    }
+
+    common::XML::XmlNode dict_node = restart_node.add_node("dictionary");
+    std::string relative_path = dict.uri().path();
+    boost::replace_first(relative_path, base_path, "");
+    dict_node.set_attribute("path", relative_path);
+    dict_node.set_attribute("index", common::to_str(data_writer.append_data(*owned_keys)));
+  }
   
   BOOST_FOREACH(const Handle<mesh::Field>& field, fields)
   {
+    const std::vector<Uint>& rows = owned_rows[&field->dict()];
+    const Uint row_size = field->row_size();
+    boost::shared_ptr< common::Table<Real> > owned_values = common::allocate_component< common::Table<Real> >(field->name());
+    owned_values->set_row_size(row_size);
+    owned_values->resize(rows.size());
+    for(Uint i = 0; i != rows.size(); ++i)
+    {
+      for(Uint j = 0; j != row_size; ++j)
+        (*owned_values)[i][j] = (*field)[rows[i]][j];
+    }
+
     common::XML::XmlNode field_node = restart_node.add_node("field");
     std::string relative_path = field->uri().path();
     boost::replace_first(relative_path, base_path, "");
     cf3_assert(relative_path.size() == field->uri().path().size() - base_path.size());
+    std::string dict_path = field->dict().uri().path();
+    boost::replace_first(dict_path, base_path, "");
     field_node.set_attribute("path", relative_path);
-    field_node.set_attribute("index", common::to_str(data_writer->append_data(*field)));
+    field_node.set_attribute("dictionary", dict_path);
+    field_node.set_attribute("index", common::to_str(data_writer.append_data(*owned_values)));
+  }
+
+  // The restart file itself is only written once the data is complete
+  m_pending_outputs.push_back(output);
+  const Uint max_pending = asynchronous ? options().value<Uint>("max_pending_outputs") : 0;
+  while(m_pending_outputs.size() > max_pending)
+    finish_output();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+void WriteRestartFile::wait_for_output()
+{
+  while(!m_pending_outputs.empty())
+    finish_output();
+}
+
+void WriteRestartFile::signal_wait_for_output(common::SignalArgs& args)
+{
+  wait_for_output();
+}
+
+bool WriteRestartFile::has_pending_output(const common::URI& file) const
+{
+  BOOST_FOREACH(const boost::shared_ptr<PendingOutput>& output, m_pending_outputs)
+  {
+    if(output->file == file)
+      return true;
   }
+  return false;
+}
+
+void WriteRestartFile::finish_output()
+{
+  cf3_assert(!m_pending_outputs.empty());
+  boost::shared_ptr<PendingOutput> output = m_pending_outputs.front();
+  m_pending_outputs.pop_front();
 
+  common::PE::Comm& comm = common::PE::Comm::instance();
+  output->data_writer->close();
   if(comm.rank() == 0)
-    common::XML::to_file(xml_doc, out_file_path);
+    common::XML::to_file(*output->xml_doc, output->file);
+  comm.barrier();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+void WriteRestartFile::row_keys(const mesh::Dictionary& dictionary, std::vector<Uint>& keys)
+{
+  const Uint nb_rows = dictionary.size();
+  keys.assign(2*nb_rows, 0);
+  if(dictionary.continuous())
+  {
+    for(Uint i = 0; i != nb_rows; ++i)
+      keys[2*i] = dictionary.glb_idx()[i];
+    return;
+  }
+
+  // The global numbering of discontinuous dictionaries depends on the partitioning, so the elements are used instead
+  BOOST_FOREACH(const Handle<mesh::Space>& space, dictionary.spaces())
+  {
+    const mesh::Entities& entities = space->support();
+    const mesh::Connectivity& connectivity = space->connectivity();
+    const Uint nb_elems = connectivity.size();
+    for(Uint elem_idx = 0; elem_idx != nb_elems; ++elem_idx)
+    {
+      const mesh::Connectivity::ConstRow row = connectivity[elem_idx];
+      const Uint nb_elem_rows = row.size();
+      for(Uint i = 0; i != nb_elem_rows; ++i)
+      {
+        keys[2*row[i]] = entities.glb_idx()[elem_idx];
+        keys[2*row[i]+1] = i;
+      }
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -7,9 +7,13 @@
 #ifndef cf3_solver_actions_WriteRestartFile_hpp
 #define cf3_solver_actions_WriteRestartFile_hpp
 
+#include <deque>
+
 #include "common/Action.hpp"
 #include "solver/actions/LibActions.hpp"
 
+namespace cf3 { namespace mesh { class Dictionary; } }
+
 /////////////////////////////////////////////////////////////////////////////////////
 
 namespace cf3 {
@@ -19,6 +23,10 @@ namespace actions {
 ///////////////////////////////////////////////////////////////////////////////////////
 
 /// Write out a restartfile, designed to be loaded into an already-created mesh
+/// Only the rows owned by each rank are stored, together with a key that does not depend on the partitioning,
+/// so the file can be read back using any number of ranks.
+/// In asynchronous mode, execute() returns as soon as the data is copied, and compression and writing continue on a
+/// background thread. At most max_pending_outputs files are in flight, and wait_for_output() completes all of them.
 class solver_actions_API WriteRestartFile : public common::Action
 {
 public: // functions
@@ -26,14 +34,40 @@ public: // functions
   /// @param name of the component
   WriteRestartFile ( const std::string& name );
 
-  /// Virtual destructor
-  virtual ~WriteRestartFile() {}
+  /// Virtual destructor, completing any pending output. This is collective and needs MPI, so solvers using
+  /// asynchronous output should call wait_for_output() explicitly before shutting down.
+  virtual ~WriteRestartFile();
 
   /// Get the class name
   static std::string type_name () { return "WriteRestartFile"; }
 
   /// execute the action
   virtual void execute ();
+
+  /// Key identifying each row of the dictionary independently of the partitioning, stored as 2 values per row.
+  /// For continuous dictionaries this is the global index and 0, for discontinuous dictionaries the global
+  /// index of the element and the index of the row in the element.
+  static void row_keys(const mesh::Dictionary& dictionary, std::vector<Uint>& keys);
+
+  /// Block until all pending asynchronous output is written. Collective.
+  void wait_for_output();
+
+  /// @name SIGNALS
+  //@{
+  void signal_wait_for_output(common::SignalArgs& args);
+  //@}
+
+private:
+  /// Write data and XML description of a restart file that is still being written
+  struct PendingOutput;
+
+  /// True if an output to the given file is still pending
+  bool has_pending_output(const common::URI& file) const;
+
+  /// Complete the oldest pending output
+  void finish_output();
+
+  std::deque< boost::shared_ptr<PendingOutput> > m_pending_outputs;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////
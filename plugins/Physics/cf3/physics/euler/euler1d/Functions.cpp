@@ -194,6 +194,125 @@ void compute_hlle_flux( const Data& left, const Data& right, const ColVector_NDI
   }
   compute_convective_wave_speed(roe,normal,wave_speed);
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// @brief Convective flux of one lane of a state batch, returns the normal velocity
+inline Real compute_convective_flux( const StateBatch& s, const Uint f, const Real nx,
+                                     Real flux[NEQS] )
+{
+  const Real un = s.U[XX][f] * nx;
+  const Real rho_un = s.rho[f] * un;
+  flux[0] = rho_un;
+  flux[1] = rho_un * s.U[XX][f] + s.p[f] * nx;
+  flux[2] = rho_un * s.H[f];
+  return un;
+}
+
+} // namespace
+
+void compute_rusanov_flux( const FaceBatch& faces, FluxBatch& flux )
+{
+  const StateBatch& left  = faces.left;
+  const StateBatch& right = faces.right;
+  for (Uint f=0; f<BATCH_SIZE; ++f)
+  {
+    const Real nx = faces.normal[XX][f];
+    Real flux_left[NEQS], flux_right[NEQS];
+    const Real un_left  = compute_convective_flux(left,  f, nx, flux_left );
+    const Real un_right = compute_convective_flux(right, f, nx, flux_right);
+    const Real wave_speed = std::max(std::abs(un_left) +left.c[f] *std::abs(nx),
+                                     std::abs(un_right)+right.c[f]*std::abs(nx));
+    for (Uint eq=0; eq<NEQS; ++eq)
+      flux.flux[eq][f] = 0.5*(flux_left[eq]+flux_right[eq]) - 0.5*wave_speed*(right.cons[eq][f]-left.cons[eq][f]);
+    flux.wave_speed[f] = wave_speed;
+  }
+}
+
+void compute_roe_flux( const FaceBatch& faces, FluxBatch& flux )
+{
+  const StateBatch& left  = faces.left;
+  const StateBatch& right = faces.right;
+  for (Uint f=0; f<BATCH_SIZE; ++f)
+  {
+    if (left.rho[f]<0 || right.rho[f]<0)
+    {
+      throw common::BadValue(FromHere(), "negative density");
+    }
+  }
+  for (Uint f=0; f<BATCH_SIZE; ++f)
+  {
+    const Real nx = faces.normal[XX][f];
+
+    // Roe average
+    const Real sqrt_rhoL = std::sqrt(left.rho[f]);
+    const Real sqrt_rhoR = std::sqrt(right.rho[f]);
+    const Real inv_sum   = 1. / (sqrt_rhoL + sqrt_rhoR);
+    const Real gamma = 0.5*(left.gamma[f]+right.gamma[f]);
+    const Real rho   = sqrt_rhoL*sqrt_rhoR;
+    const Real u     = (sqrt_rhoL*left.U[XX][f] + sqrt_rhoR*right.U[XX][f]) * inv_sum;
+    const Real H     = (sqrt_rhoL*std::abs(left.H[f]) + sqrt_rhoR*std::abs(right.H[f])) * inv_sum;
+    const Real c2    = (gamma-1.)*(H-0.5*u*u);
+    const Real c     = std::sqrt(c2);
+    const Real un    = u*nx;
+    const Real cn    = c*nx;
+
+    // Wave strengths multiplied with the absolute wave speeds
+    const Real dp_c2 = (right.p[f] - left.p[f]) / c2;
+    const Real du_rho_c = (right.U[XX][f] - left.U[XX][f]) * rho / c;
+    const Real a0 = std::abs(un)    * (right.rho[f] - left.rho[f] - dp_c2);
+    const Real a1 = std::abs(un+cn) * 0.5*(dp_c2 + du_rho_c);
+    const Real a2 = std::abs(un-cn) * 0.5*(dp_c2 - du_rho_c);
+
+    // Central flux minus the upwind dissipation, summed over the columns of the right eigenvectors
+    Real flux_left[NEQS], flux_right[NEQS];
+    compute_convective_flux(left,  f, nx, flux_left );
+    compute_convective_flux(right, f, nx, flux_right);
+    flux.flux[0][f] = 0.5*(flux_left[0]+flux_right[0]) - 0.5*(a0 + a1 + a2);
+    flux.flux[1][f] = 0.5*(flux_left[1]+flux_right[1]) - 0.5*(a0*u + a1*(u+c) + a2*(u-c));
+    flux.flux[2][f] = 0.5*(flux_left[2]+flux_right[2]) - 0.5*(a0*0.5*u*u + a1*(H+c*u) + a2*(H-c*u));
+    flux.wave_speed[f] = std::abs(un)+c*std::abs(nx);
+  }
+}
+
+void compute_hlle_flux( const FaceBatch& faces, FluxBatch& flux )
+{
+  const StateBatch& left  = faces.left;
+  const StateBatch& right = faces.right;
+  for (Uint f=0; f<BATCH_SIZE; ++f)
+  {
+    const Real nx = faces.normal[XX][f];
+    const Real abs_nx = std::abs(nx);
+
+    // Roe average
+    const Real sqrt_rhoL = std::sqrt(std::abs(left.rho[f]));
+    const Real sqrt_rhoR = std::sqrt(std::abs(right.rho[f]));
+    const Real inv_sum   = 1. / (sqrt_rhoL + sqrt_rhoR);
+    const Real gamma = 0.5*(left.gamma[f]+right.gamma[f]);
+    const Real u     = (sqrt_rhoL*left.U[XX][f] + sqrt_rhoR*right.U[XX][f]) * inv_sum;
+    const Real H     = (sqrt_rhoL*std::abs(left.H[f]) + sqrt_rhoR*std::abs(right.H[f])) * inv_sum;
+    const Real c     = std::sqrt((gamma-1.)*(H-0.5*u*u));
+    const Real un    = u*nx;
+
+    Real flux_left[NEQS], flux_right[NEQS];
+    const Real un_left  = compute_convective_flux(left,  f, nx, flux_left );
+    const Real un_right = compute_convective_flux(right, f, nx, flux_right);
+    const Real wave_speed_left  = std::min(un_left  - left.c[f]*abs_nx,  un - c*abs_nx); // u - c
+    const Real wave_speed_right = std::max(un_right + right.c[f]*abs_nx, un + c*abs_nx); // u + c
+
+    // Clipping the wave speeds to zero selects the left or right flux for supersonic faces without branching
+    const Real s_left  = std::min(wave_speed_left,  0.);
+    const Real s_right = std::max(wave_speed_right, 0.);
+    const Real inv_ds  = 1. / (s_right - s_left);
+    for (Uint eq=0; eq<NEQS; ++eq)
+      flux.flux[eq][f] = ( s_right*flux_left[eq] - s_left*flux_right[eq]
+                         + s_left*s_right*(right.cons[eq][f]-left.cons[eq][f]) ) * inv_ds;
+    flux.wave_speed[f] = std::abs(un)+c*abs_nx;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 } // euler1D
@@ -54,6 +54,9 @@ struct Data
   void compute_from_primitive(const RowVector_NEQS& prim);
 };
 
+/// @brief Velocity component d, as read by the batched flux functions
+inline Real velocity_component(const Data& p, const Uint d) { return p.U[d]; }
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 } // euler2d
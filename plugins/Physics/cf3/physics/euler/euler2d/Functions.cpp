@@ -200,6 +200,129 @@ void compute_hlle_flux( const Data& left, const Data& right, const ColVector_NDI
   compute_convective_wave_speed(roe,normal,wave_speed);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// @brief Convective flux of one lane of a state batch, returns the normal velocity
+inline Real compute_convective_flux( const StateBatch& s, const Uint f, const Real nx, const Real ny,
+                                     Real flux[NEQS] )
+{
+  const Real un = s.U[XX][f]*nx + s.U[YY][f]*ny;
+  const Real rho_un = s.rho[f] * un;
+  flux[0] = rho_un;
+  flux[1] = rho_un * s.U[XX][f] + s.p[f] * nx;
+  flux[2] = rho_un * s.U[YY][f] + s.p[f] * ny;
+  flux[3] = rho_un * s.H[f];
+  return un;
+}
+
+} // namespace
+
+void compute_rusanov_flux( const FaceBatch& faces, FluxBatch& flux )
+{
+  const StateBatch& left  = faces.left;
+  const StateBatch& right = faces.right;
+  for (Uint f=0; f<BATCH_SIZE; ++f)
+  {
+    const Real nx = faces.normal[XX][f];
+    const Real ny = faces.normal[YY][f];
+    Real flux_left[NEQS], flux_right[NEQS];
+    const Real un_left  = compute_convective_flux(left,  f, nx, ny, flux_left );
+    const Real un_right = compute_convective_flux(right, f, nx, ny, flux_right);
+    const Real wave_speed = std::max(std::abs(un_left)+left.c[f], std::abs(un_right)+right.c[f]);
+    for (Uint eq=0; eq<NEQS; ++eq)
+      flux.flux[eq][f] = 0.5*(flux_left[eq]+flux_right[eq]) - 0.5*wave_speed*(right.cons[eq][f]-left.cons[eq][f]);
+    flux.wave_speed[f] = wave_speed;
+  }
+}
+
+void compute_roe_flux( const FaceBatch& faces, FluxBatch& flux )
+{
+  const StateBatch& left  = faces.left;
+  const StateBatch& right = faces.right;
+  for (Uint f=0; f<BATCH_SIZE; ++f)
+  {
+    const Real nx = faces.normal[XX][f];
+    const Real ny = faces.normal[YY][f];
+
+    // Roe average
+    const Real sqrt_rhoL = std::sqrt(left.rho[f]);
+    const Real sqrt_rhoR = std::sqrt(right.rho[f]);
+    const Real inv_sum   = 1. / (sqrt_rhoL + sqrt_rhoR);
+    const Real gamma = 0.5*(left.gamma[f]+right.gamma[f]);
+    const Real rho   = sqrt_rhoL*sqrt_rhoR;
+    const Real u     = (sqrt_rhoL*left.U[XX][f] + sqrt_rhoR*right.U[XX][f]) * inv_sum;
+    const Real v     = (sqrt_rhoL*left.U[YY][f] + sqrt_rhoR*right.U[YY][f]) * inv_sum;
+    const Real H     = (sqrt_rhoL*left.H[f] + sqrt_rhoR*right.H[f]) * inv_sum;
+    const Real U2    = u*u + v*v;
+    const Real c2    = (gamma-1.)*(H-0.5*U2);
+    const Real c     = std::sqrt(c2);
+    const Real un    = u*nx + v*ny;
+    const Real us    = u*ny - v*nx;
+
+    // Wave strengths multiplied with the absolute wave speeds
+    const Real du   = right.U[XX][f] - left.U[XX][f];
+    const Real dv   = right.U[YY][f] - left.U[YY][f];
+    const Real drho = right.rho[f] - left.rho[f];
+    const Real dp_c2 = (right.p[f] - left.p[f]) / c2;
+    const Real dun_rho_c = (du*nx + dv*ny) * rho / c;
+    const Real a0 = std::abs(un)   * (drho - dp_c2);
+    const Real a1 = std::abs(un)   * (du*ny - dv*nx) * rho;
+    const Real a2 = std::abs(un+c) * 0.5*(dp_c2 + dun_rho_c);
+    const Real a3 = std::abs(un-c) * 0.5*(dp_c2 - dun_rho_c);
+
+    // Central flux minus the upwind dissipation, summed over the columns of the right eigenvectors
+    Real flux_left[NEQS], flux_right[NEQS];
+    compute_convective_flux(left,  f, nx, ny, flux_left );
+    compute_convective_flux(right, f, nx, ny, flux_right);
+    flux.flux[0][f] = 0.5*(flux_left[0]+flux_right[0]) - 0.5*(a0 + a2 + a3);
+    flux.flux[1][f] = 0.5*(flux_left[1]+flux_right[1]) - 0.5*(a0*u + a1*ny + a2*(u+c*nx) + a3*(u-c*nx));
+    flux.flux[2][f] = 0.5*(flux_left[2]+flux_right[2]) - 0.5*(a0*v - a1*nx + a2*(v+c*ny) + a3*(v-c*ny));
+    flux.flux[3][f] = 0.5*(flux_left[3]+flux_right[3]) - 0.5*(a0*0.5*U2 + a1*us + a2*(H+c*un) + a3*(H-c*un));
+    flux.wave_speed[f] = std::abs(un)+c;
+  }
+}
+
+void compute_hlle_flux( const FaceBatch& faces, FluxBatch& flux )
+{
+  const StateBatch& left  = faces.left;
+  const StateBatch& right = faces.right;
+  for (Uint f=0; f<BATCH_SIZE; ++f)
+  {
+    const Real nx = faces.normal[XX][f];
+    const Real ny = faces.normal[YY][f];
+
+    // Roe average
+    const Real sqrt_rhoL = std::sqrt(left.rho[f]);
+    const Real sqrt_rhoR = std::sqrt(right.rho[f]);
+    const Real inv_sum   = 1. / (sqrt_rhoL + sqrt_rhoR);
+    const Real gamma = 0.5*(left.gamma[f]+right.gamma[f]);
+    const Real u     = (sqrt_rhoL*left.U[XX][f] + sqrt_rhoR*right.U[XX][f]) * inv_sum;
+    const Real v     = (sqrt_rhoL*left.U[YY][f] + sqrt_rhoR*right.U[YY][f]) * inv_sum;
+    const Real H     = (sqrt_rhoL*left.H[f] + sqrt_rhoR*right.H[f]) * inv_sum;
+    const Real c     = std::sqrt((gamma-1.)*(H-0.5*(u*u + v*v)));
+    const Real un    = u*nx + v*ny;
+
+    Real flux_left[NEQS], flux_right[NEQS];
+    const Real un_left  = compute_convective_flux(left,  f, nx, ny, flux_left );
+    const Real un_right = compute_convective_flux(right, f, nx, ny, flux_right);
+    const Real wave_speed_left  = std::min(un_left  - left.c[f],  un - c); // u - c
+    const Real wave_speed_right = std::max(un_right + right.c[f], un + c); // u + c
+
+    // Clipping the wave speeds to zero selects the left or right flux for supersonic faces without branching
+    const Real s_left  = std::min(wave_speed_left,  0.);
+    const Real s_right = std::max(wave_speed_right, 0.);
+    const Real inv_ds  = 1. / (s_right - s_left);
+    for (Uint eq=0; eq<NEQS; ++eq)
+      flux.flux[eq][f] = ( s_right*flux_left[eq] - s_left*flux_right[eq]
+                         + s_left*s_right*(right.cons[eq][f]-left.cons[eq][f]) ) * inv_ds;
+    flux.wave_speed[f] = std::abs(un)+c;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
 void compute_specific_entropy( const Data& p, Real& specific_entropy)
 {
   // Compute specific entropy from primitive variables
@@ -14,6 +14,7 @@
 #define cf3_physics_euler_euler2d_Functions_hpp
 
 #include "cf3/physics/euler/euler2d/Data.hpp"
+#include "cf3/physics/Batch.hpp"
 
 namespace cf3 {
 namespace physics {
@@ -22,6 +23,13 @@ namespace euler2d {
   
 //////////////////////////////////////////////////////////////////////////////////////////////
 
+using physics::BATCH_SIZE;
+
+/// @brief Batches of faces for the batched flux functions
+typedef physics::StateBatchT<Data,NDIM,NEQS> StateBatch;
+typedef physics::FaceBatchT<Data,NDIM,NEQS>  FaceBatch;
+typedef physics::FluxBatchT<NEQS>            FluxBatch;
+
 /// @brief Convective flux in conservative form
 void compute_convective_flux( const Data& p, const ColVector_NDIM& normal,
                               RowVector_NEQS& flux );
@@ -65,6 +73,15 @@ void compute_roe_flux( const Data& left, const Data& right, const ColVector_NDIM
 void compute_hlle_flux( const Data& left, const Data& right, const ColVector_NDIM& normal,
                         RowVector_NEQS& flux, Real& wave_speed );
 
+/// @brief Rusanov Approximate Riemann solver for a batch of faces
+void compute_rusanov_flux( const FaceBatch& faces, FluxBatch& flux );
+
+/// @brief Roe Approximate Riemann solver for a batch of faces
+void compute_roe_flux( const FaceBatch& faces, FluxBatch& flux );
+
+/// @brief HLLE Approximate Riemann solver for a batch of faces
+void compute_hlle_flux( const FaceBatch& faces, FluxBatch& flux );
+
 /// @brief Compute the specific entropy from the primitive variables
 void compute_specific_entropy( const Data& p, Real& specific_entropy );
 
@@ -32,6 +32,9 @@ struct Data : euler::euler1d::Data
   ColVector_NDIM grad_T;    ///< gradient of temperature
 };
 
+/// @brief Gradient of velocity component i, as read by the batched flux functions
+inline const ColVector_NDIM& velocity_gradient(const Data& p, const Uint i) { return p.grad_u; }
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 } // navierstokes1d
@@ -46,6 +46,25 @@ void compute_diffusive_wave_speed( const Data& p, const ColVector_NDIM& normal,
   wave_speed = std::max(p.mu/p.rho, p.kappa/(p.rho*p.Cp));
 }
 
+void compute_diffusive_flux( const FaceBatch& faces, FluxBatch& flux )
+{
+  for (Uint f=0; f<BATCH_SIZE; ++f)
+  {
+    const Real nx = faces.normal[XX][f];
+
+    // Viscous stress tensor
+    const Real tau_xx = faces.mu[f]*4./3.*faces.grad_U[XX][XX][f];
+
+    // Heat flux
+    const Real heat_flux = -faces.kappa[f]*(faces.grad_T[XX][f]*nx);
+
+    flux.flux[0][f] = 0.;
+    flux.flux[1][f] = tau_xx*nx;
+    flux.flux[2][f] = (tau_xx*faces.U[XX][f])*nx - heat_flux;
+    flux.wave_speed[f] = std::max(faces.mu[f]/faces.rho[f], faces.kappa[f]/(faces.rho[f]*faces.Cp[f]));
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 } // navierstokes1d
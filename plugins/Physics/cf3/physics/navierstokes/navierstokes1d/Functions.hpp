@@ -11,7 +11,9 @@
 #ifndef cf3_physics_navierstokes_navierstokes1d_Functions_hpp
 #define cf3_physics_navierstokes_navierstokes1d_Functions_hpp
 
+#include "cf3/physics/euler/euler1d/Functions.hpp"
 #include "cf3/physics/navierstokes/navierstokes1d/Data.hpp"
+#include "cf3/physics/Batch.hpp"
 
 namespace cf3 {
 namespace physics {
@@ -20,6 +22,13 @@ namespace navierstokes1d {
   
 //////////////////////////////////////////////////////////////////////////////////////////////
 
+using physics::BATCH_SIZE;
+
+/// @brief The convective flux is the one of the Euler equations
+typedef euler::euler1d::FaceBatch               ConvectiveFaceBatch;
+typedef physics::DiffusiveFaceBatchT<Data,NDIM> FaceBatch;
+typedef physics::FluxBatchT<NEQS>               FluxBatch;
+
 /// @brief Diffusive flux in conservative form
 void compute_diffusive_flux( const Data& p, const ColVector_NDIM& normal,
                              RowVector_NEQS& flux );
@@ -32,6 +41,9 @@ void compute_diffusive_flux( const Data& p, const ColVector_NDIM& normal,
 void compute_diffusive_wave_speed( const Data& p, const ColVector_NDIM& normal,
                                    Real& wave_speed );
 
+/// @brief Diffusive flux in conservative form, and maximum wave speed, for a batch of faces
+void compute_diffusive_flux( const FaceBatch& faces, FluxBatch& flux );
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 } // navierstokes1d
@@ -7,6 +7,7 @@
 #ifndef cf3_physics_navierstokes_navierstokes2d_Data_hpp
 #define cf3_physics_navierstokes_navierstokes2d_Data_hpp
 
+#include "math/Defs.hpp"
 #include "cf3/physics/navierstokes/navierstokes2d/Types.hpp"
 #include "cf3/physics/euler/euler2d/Data.hpp"
 
@@ -33,6 +34,9 @@ struct Data : euler::euler2d::Data
   ColVector_NDIM grad_T;    ///< gradient of temperature
 };
 
+/// @brief Gradient of velocity component i, as read by the batched flux functions
+inline const ColVector_NDIM& velocity_gradient(const Data& p, const Uint i) { return i == XX ? p.grad_u : p.grad_v; }
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 } // navierstokes2d
@@ -52,6 +52,34 @@ void compute_diffusive_wave_speed( const Data& p, const ColVector_NDIM& normal,
   wave_speed = std::max(p.mu/p.rho, p.kappa/(p.rho*p.Cp));
 }
 
+void compute_diffusive_flux( const FaceBatch& faces, FluxBatch& flux )
+{
+  for (Uint f=0; f<BATCH_SIZE; ++f)
+  {
+    const Real nx = faces.normal[XX][f];
+    const Real ny = faces.normal[YY][f];
+    const Real mu = faces.mu[f];
+
+    const Real two_third_divergence_U = 2./3.*(faces.grad_U[XX][XX][f] + faces.grad_U[YY][YY][f]);
+
+    // Viscous stress tensor
+    const Real tau_xx = mu*(2.*faces.grad_U[XX][XX][f] - two_third_divergence_U);
+    const Real tau_yy = mu*(2.*faces.grad_U[YY][YY][f] - two_third_divergence_U);
+    const Real tau_xy = mu*(faces.grad_U[XX][YY][f] + faces.grad_U[YY][XX][f]);
+
+    // Heat flux
+    const Real heat_flux = -faces.kappa[f]*(faces.grad_T[XX][f]*nx + faces.grad_T[YY][f]*ny);
+
+    const Real tau_nx = tau_xx*nx + tau_xy*ny;
+    const Real tau_ny = tau_xy*nx + tau_yy*ny;
+    flux.flux[0][f] = 0.;
+    flux.flux[1][f] = tau_nx;
+    flux.flux[2][f] = tau_ny;
+    flux.flux[3][f] = tau_nx*faces.U[XX][f] + tau_ny*faces.U[YY][f] - heat_flux;
+    flux.wave_speed[f] = std::max(mu/faces.rho[f], faces.kappa[f]/(faces.rho[f]*faces.Cp[f]));
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 } // navierstokes2d
@@ -13,6 +13,7 @@
 
 #include "cf3/physics/euler/euler2d/Functions.hpp"
 #include "cf3/physics/navierstokes/navierstokes2d/Data.hpp"
+#include "cf3/physics/Batch.hpp"
 
 namespace cf3 {
 namespace physics {
@@ -21,6 +22,13 @@ namespace navierstokes2d {
   
 //////////////////////////////////////////////////////////////////////////////////////////////
 
+using physics::BATCH_SIZE;
+
+/// @brief The convective flux is the one of the Euler equations
+typedef euler::euler2d::FaceBatch               ConvectiveFaceBatch;
+typedef physics::DiffusiveFaceBatchT<Data,NDIM> FaceBatch;
+typedef physics::FluxBatchT<NEQS>               FluxBatch;
+
 /// @brief Diffusive flux in conservative form
 void compute_diffusive_flux( const Data& p, const ColVector_NDIM& normal,
                              RowVector_NEQS& flux );
@@ -33,6 +41,9 @@ void compute_diffusive_flux( const Data& p, const ColVector_NDIM& normal,
 void compute_diffusive_wave_speed( const Data& p, const ColVector_NDIM& normal,
                                    Real& wave_speed );
 
+/// @brief Diffusive flux in conservative form, and maximum wave speed, for a batch of faces
+void compute_diffusive_flux( const FaceBatch& faces, FluxBatch& flux );
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 
 } // navierstokes2d
@@ -45,6 +45,39 @@ BOOST_AUTO_TEST_CASE( test_navierstokes2d )
     BOOST_CHECK(flux == check);
 }
 
+BOOST_AUTO_TEST_CASE( test_navierstokes2d_batch )
+{
+    Data p;
+
+    p.mu = 4.;
+    p.kappa = 0.5;
+    p.Cp = 2.;
+    p.rho = 1.;
+    p.U[0] = 2.;
+    p.U[1] = 2.;
+    p.grad_u << 3., 2.;
+    p.grad_v << 2., 3.;
+    p.grad_T << 3., 3.;
+
+    ColVector_NDIM normal;
+    normal << 1., 1.;
+    FaceBatch faces;
+    faces.set_face(3, p, normal);
+    FluxBatch batch;
+    compute_diffusive_flux(faces, batch);
+
+    RowVector_NEQS flux;
+    Real wave_speed;
+    batch.get(3, flux, wave_speed);
+    RowVector_NEQS check; check << 0, 24, 24, 99;
+    BOOST_CHECK(flux == check);
+    BOOST_CHECK_EQUAL(wave_speed, 4.);
+
+    // Lanes that are not set have no flux
+    batch.get(0, flux, wave_speed);
+    BOOST_CHECK(flux == RowVector_NEQS::Zero());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,199 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of the scalar and batched Riemann solvers of the Euler and Navier-Stokes equations"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "cf3/common/Timer.hpp"
+#include "cf3/physics/euler/euler1d/Functions.hpp"
+#include "cf3/physics/euler/euler2d/Functions.hpp"
+#include "cf3/physics/navierstokes/navierstokes2d/Functions.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::physics;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct RiemannBenchmarkFixture
+{
+  RiemannBenchmarkFixture()
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    // Number of faces and number of repetitions, can be passed as arguments
+    nb_faces = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 65536;
+    nb_repeats = argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 20;
+  }
+
+  void report(const std::string& name, const Real seconds)
+  {
+    const Real faces_per_second = static_cast<Real>(nb_faces*nb_repeats) / seconds;
+    std::cout << name << ": " << faces_per_second << " faces/s" << std::endl;
+    std::cout << "<DartMeasurement name=\"" << name << "\" type=\"numeric/double\">" << faces_per_second << "</DartMeasurement>" << std::endl;
+  }
+
+  /// Time the scalar and the batched version of a Riemann solver, and check they give the same result
+  template <typename DATA, typename COLVECTOR, typename ROWVECTOR, typename FACEBATCH, typename FLUXBATCH>
+  void benchmark( const std::string& name,
+                  const std::vector<DATA, Eigen::aligned_allocator<DATA> >& left,
+                  const std::vector<DATA, Eigen::aligned_allocator<DATA> >& right,
+                  const std::vector<COLVECTOR, Eigen::aligned_allocator<COLVECTOR> >& normal,
+                  const std::vector<FACEBATCH>& faces,
+                  void (*scalar_flux)(const DATA&, const DATA&, const COLVECTOR&, ROWVECTOR&, Real&),
+                  void (*batch_flux)(const FACEBATCH&, FLUXBATCH&),
+                  const Uint batch_size )
+  {
+    std::vector<ROWVECTOR, Eigen::aligned_allocator<ROWVECTOR> > flux(nb_faces);
+    std::vector<Real> wave_speed(nb_faces);
+    Timer scalar_timer;
+    for (Uint repeat=0; repeat<nb_repeats; ++repeat)
+    {
+      for (Uint f=0; f<nb_faces; ++f)
+        scalar_flux(left[f], right[f], normal[f], flux[f], wave_speed[f]);
+    }
+    report(name + " scalar", scalar_timer.elapsed());
+
+    std::vector<FLUXBATCH> batch_flux_result(faces.size());
+    Timer batch_timer;
+    for (Uint repeat=0; repeat<nb_repeats; ++repeat)
+    {
+      for (Uint b=0; b<faces.size(); ++b)
+        batch_flux(faces[b], batch_flux_result[b]);
+    }
+    report(name + " batched", batch_timer.elapsed());
+
+    ROWVECTOR face_flux;
+    Real face_wave_speed;
+    for (Uint f=0; f<nb_faces; ++f)
+    {
+      batch_flux_result[f/batch_size].get(f%batch_size, face_flux, face_wave_speed);
+      BOOST_CHECK_SMALL( (face_flux-flux[f]).cwiseAbs().maxCoeff(), 1e-8*(1.+flux[f].cwiseAbs().maxCoeff()) );
+    }
+  }
+
+  Uint nb_faces;
+  Uint nb_repeats;
+};
+
+BOOST_FIXTURE_TEST_SUITE( RiemannBenchmarkSuite, RiemannBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Euler1D )
+{
+  using namespace euler::euler1d;
+  nb_faces -= nb_faces % BATCH_SIZE;
+
+  std::vector<Data, Eigen::aligned_allocator<Data> > left(nb_faces), right(nb_faces);
+  std::vector<ColVector_NDIM, Eigen::aligned_allocator<ColVector_NDIM> > normal(nb_faces);
+  std::vector<FaceBatch> faces(nb_faces/BATCH_SIZE);
+  for (Uint f=0; f<nb_faces; ++f)
+  {
+    // Smooth flow with a varying velocity, containing subsonic and supersonic faces
+    const Real x = static_cast<Real>(f) / static_cast<Real>(nb_faces);
+    RowVector_NEQS prim_left, prim_right;
+    prim_left  << 1.+0.5*std::sin(20.*x), 600.*std::sin(7.*x), 1e5*(1.+0.3*std::cos(11.*x));
+    prim_right << 1.+0.5*std::sin(21.*x), 600.*std::sin(8.*x), 1e5*(1.+0.3*std::cos(12.*x));
+    left[f].gamma  = 1.4;  left[f].R  = 287.05;  left[f].compute_from_primitive(prim_left);
+    right[f].gamma = 1.4;  right[f].R = 287.05;  right[f].compute_from_primitive(prim_right);
+    normal[f] << (f%2 ? 1. : -1.);
+    faces[f/BATCH_SIZE].set_face(f%BATCH_SIZE, left[f], right[f], normal[f]);
+  }
+
+  benchmark("Euler1D Rusanov", left, right, normal, faces, &compute_rusanov_flux, &compute_rusanov_flux, BATCH_SIZE);
+  benchmark("Euler1D Roe",     left, right, normal, faces, &compute_roe_flux,     &compute_roe_flux,     BATCH_SIZE);
+  benchmark("Euler1D HLLE",    left, right, normal, faces, &compute_hlle_flux,    &compute_hlle_flux,    BATCH_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE( Euler2D )
+{
+  using namespace euler::euler2d;
+  nb_faces -= nb_faces % BATCH_SIZE;
+
+  std::vector<Data, Eigen::aligned_allocator<Data> > left(nb_faces), right(nb_faces);
+  std::vector<ColVector_NDIM, Eigen::aligned_allocator<ColVector_NDIM> > normal(nb_faces);
+  std::vector<FaceBatch> faces(nb_faces/BATCH_SIZE);
+  for (Uint f=0; f<nb_faces; ++f)
+  {
+    const Real x = static_cast<Real>(f) / static_cast<Real>(nb_faces);
+    RowVector_NEQS prim_left, prim_right;
+    prim_left  << 1.+0.5*std::sin(20.*x), 600.*std::sin(7.*x), 300.*std::cos(5.*x), 1e5*(1.+0.3*std::cos(11.*x));
+    prim_right << 1.+0.5*std::sin(21.*x), 600.*std::sin(8.*x), 300.*std::cos(6.*x), 1e5*(1.+0.3*std::cos(12.*x));
+    left[f].gamma  = 1.4;  left[f].R  = 287.05;  left[f].compute_from_primitive(prim_left);
+    right[f].gamma = 1.4;  right[f].R = 287.05;  right[f].compute_from_primitive(prim_right);
+    normal[f] << std::cos(0.7*f), std::sin(0.7*f);
+    faces[f/BATCH_SIZE].set_face(f%BATCH_SIZE, left[f], right[f], normal[f]);
+  }
+
+  benchmark("Euler2D Rusanov", left, right, normal, faces, &compute_rusanov_flux, &compute_rusanov_flux, BATCH_SIZE);
+  benchmark("Euler2D Roe",     left, right, normal, faces, &compute_roe_flux,     &compute_roe_flux,     BATCH_SIZE);
+  benchmark("Euler2D HLLE",    left, right, normal, faces, &compute_hlle_flux,    &compute_hlle_flux,    BATCH_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE( NavierStokes2D )
+{
+  using namespace navierstokes::navierstokes2d;
+  nb_faces -= nb_faces % BATCH_SIZE;
+
+  std::vector<Data, Eigen::aligned_allocator<Data> > state(nb_faces);
+  std::vector<ColVector_NDIM, Eigen::aligned_allocator<ColVector_NDIM> > normal(nb_faces);
+  std::vector<FaceBatch> faces(nb_faces/BATCH_SIZE);
+  for (Uint f=0; f<nb_faces; ++f)
+  {
+    const Real x = static_cast<Real>(f) / static_cast<Real>(nb_faces);
+    Data& p = state[f];
+    p.mu = 1.8e-5;  p.kappa = 2.6e-2;  p.Cp = 1005.;
+    p.rho = 1.+0.5*std::sin(20.*x);
+    p.U << 100.*std::sin(7.*x), 50.*std::cos(5.*x);
+    p.grad_u << std::sin(3.*x), std::cos(4.*x);
+    p.grad_v << std::cos(2.*x), std::sin(5.*x);
+    p.grad_T << 10.*std::sin(6.*x), 10.*std::cos(6.*x);
+    normal[f] << std::cos(0.7*f), std::sin(0.7*f);
+    faces[f/BATCH_SIZE].set_face(f%BATCH_SIZE, p, normal[f]);
+  }
+
+  // The diffusive flux is evaluated in a single state on the face
+  std::vector<FluxBatch> batch_flux(faces.size());
+  std::vector<RowVector_NEQS, Eigen::aligned_allocator<RowVector_NEQS> > flux(nb_faces);
+  std::vector<Real> wave_speed(nb_faces);
+  Timer scalar_timer;
+  for (Uint repeat=0; repeat<nb_repeats; ++repeat)
+  {
+    for (Uint f=0; f<nb_faces; ++f)
+      compute_diffusive_flux(state[f], normal[f], flux[f], wave_speed[f]);
+  }
+  report("NavierStokes2D diffusive scalar", scalar_timer.elapsed());
+
+  Timer batch_timer;
+  for (Uint repeat=0; repeat<nb_repeats; ++repeat)
+  {
+    for (Uint b=0; b<faces.size(); ++b)
+      compute_diffusive_flux(faces[b], batch_flux[b]);
+  }
+  report("NavierStokes2D diffusive batched", batch_timer.elapsed());
+
+  RowVector_NEQS face_flux;
+  Real face_wave_speed;
+  for (Uint f=0; f<nb_faces; ++f)
+  {
+    batch_flux[f/BATCH_SIZE].get(f%BATCH_SIZE, face_flux, face_wave_speed);
+    BOOST_CHECK_SMALL( (face_flux-flux[f]).cwiseAbs().maxCoeff(), 1e-8*(1.+flux[f].cwiseAbs().maxCoeff()) );
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
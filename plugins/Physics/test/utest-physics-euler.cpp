@@ -243,6 +243,123 @@ BOOST_AUTO_TEST_CASE( Test_Euler2D_SymmetryBCs )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Check that a flux computed for a batch of faces equals the flux computed face by face
+template <typename RowVector>
+void check_batch_flux( const RowVector& flux, const Real wave_speed,
+                       const RowVector& batch_flux, const Real batch_wave_speed )
+{
+  for (Uint eq=0; eq<(Uint)flux.size(); ++eq)
+    BOOST_CHECK_SMALL( batch_flux[eq]-flux[eq], 1e-10*(1.+flux.cwiseAbs().maxCoeff()) );
+  BOOST_CHECK_CLOSE( batch_wave_speed, wave_speed, 1e-10 );
+}
+
+BOOST_AUTO_TEST_CASE( Test_Euler1D_batch )
+{
+  // Subsonic and supersonic faces in both directions
+  const Real states[euler1d::BATCH_SIZE][2][3] = {
+    { {4.696,    0., 404400.}, {1.408,    0., 101100.} },
+    { {1.408,    0., 101100.}, {4.696,    0., 404400.} },
+    { {1.225,  900., 101300.}, {1.1,    800., 90000. } },
+    { {1.225, -900., 101300.}, {1.1,   -800., 90000. } },
+    { {1.225,   30., 101300.}, {1.3,     10., 101000.} },
+    { {0.5,    100., 50000. }, {2.,    -100., 200000.} },
+    { {1.,     400., 100000.}, {1.,     300., 100000.} },
+    { {1.225,    0., 101300.}, {1.225,    0., 101300.} } };
+
+  euler1d::Data left[euler1d::BATCH_SIZE], right[euler1d::BATCH_SIZE];
+  euler1d::ColVector_NDIM normal[euler1d::BATCH_SIZE];
+  euler1d::FaceBatch faces;
+  for (Uint f=0; f<euler1d::BATCH_SIZE; ++f)
+  {
+    euler1d::RowVector_NEQS prim_left, prim_right;
+    prim_left  << states[f][0][0], states[f][0][1], states[f][0][2];
+    prim_right << states[f][1][0], states[f][1][1], states[f][1][2];
+    left[f].gamma=1.4;   left[f].R=287.05;   left[f].compute_from_primitive(prim_left);
+    right[f].gamma=1.4;  right[f].R=287.05;  right[f].compute_from_primitive(prim_right);
+    normal[f] << (f%3 == 2 ? -1. : 1.);
+    faces.set_face(f, left[f], right[f], normal[f]);
+  }
+
+  euler1d::FluxBatch rusanov, roe, hlle;
+  compute_rusanov_flux( faces, rusanov );
+  compute_roe_flux( faces, roe );
+  compute_hlle_flux( faces, hlle );
+
+  euler1d::RowVector_NEQS flux, batch_flux;
+  Real wave_speed, batch_wave_speed;
+  for (Uint f=0; f<euler1d::BATCH_SIZE; ++f)
+  {
+    compute_rusanov_flux( left[f], right[f], normal[f], flux, wave_speed );
+    rusanov.get( f, batch_flux, batch_wave_speed );
+    check_batch_flux( flux, wave_speed, batch_flux, batch_wave_speed );
+
+    compute_roe_flux( left[f], right[f], normal[f], flux, wave_speed );
+    roe.get( f, batch_flux, batch_wave_speed );
+    check_batch_flux( flux, wave_speed, batch_flux, batch_wave_speed );
+
+    compute_hlle_flux( left[f], right[f], normal[f], flux, wave_speed );
+    hlle.get( f, batch_flux, batch_wave_speed );
+    check_batch_flux( flux, wave_speed, batch_flux, batch_wave_speed );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Test_Euler2D_batch )
+{
+  // Subsonic and supersonic faces in several directions
+  const Real states[euler2d::BATCH_SIZE][2][4] = {
+    { {4.696,    0.,    0., 404400.}, {1.408,    0.,    0., 101100.} },
+    { {1.408,   50.,   20., 101100.}, {1.408,  -50.,   20., 101100.} },
+    { {1.225,  900.,  100., 101300.}, {1.1,    800.,  150., 90000. } },
+    { {1.225, -900., -100., 101300.}, {1.1,   -800., -150., 90000. } },
+    { {1.225,   30.,   30., 101300.}, {1.3,     10.,  -10., 101000.} },
+    { {0.5,    100.,  700., 50000. }, {2.,    -100.,  600., 200000.} },
+    { {1.,     400.,  300., 100000.}, {1.,     300.,  400., 100000.} } };
+
+  euler2d::Data left[euler2d::BATCH_SIZE], right[euler2d::BATCH_SIZE];
+  euler2d::ColVector_NDIM normal[euler2d::BATCH_SIZE];
+  euler2d::FaceBatch faces;
+  // The last lane is left at its initial state
+  const Uint nb_faces = euler2d::BATCH_SIZE-1;
+  for (Uint f=0; f<nb_faces; ++f)
+  {
+    euler2d::RowVector_NEQS prim_left, prim_right;
+    prim_left  << states[f][0][0], states[f][0][1], states[f][0][2], states[f][0][3];
+    prim_right << states[f][1][0], states[f][1][1], states[f][1][2], states[f][1][3];
+    left[f].gamma=1.4;   left[f].R=287.05;   left[f].compute_from_primitive(prim_left);
+    right[f].gamma=1.4;  right[f].R=287.05;  right[f].compute_from_primitive(prim_right);
+    normal[f] << std::cos(0.9*f), std::sin(0.9*f);
+    faces.set_face(f, left[f], right[f], normal[f]);
+  }
+
+  euler2d::FluxBatch rusanov, roe, hlle;
+  compute_rusanov_flux( faces, rusanov );
+  compute_roe_flux( faces, roe );
+  compute_hlle_flux( faces, hlle );
+
+  euler2d::RowVector_NEQS flux, batch_flux;
+  Real wave_speed, batch_wave_speed;
+  for (Uint f=0; f<nb_faces; ++f)
+  {
+    compute_rusanov_flux( left[f], right[f], normal[f], flux, wave_speed );
+    rusanov.get( f, batch_flux, batch_wave_speed );
+    check_batch_flux( flux, wave_speed, batch_flux, batch_wave_speed );
+
+    compute_roe_flux( left[f], right[f], normal[f], flux, wave_speed );
+    roe.get( f, batch_flux, batch_wave_speed );
+    check_batch_flux( flux, wave_speed, batch_flux, batch_wave_speed );
+
+    compute_hlle_flux( left[f], right[f], normal[f], flux, wave_speed );
+    hlle.get( f, batch_flux, batch_wave_speed );
+    check_batch_flux( flux, wave_speed, batch_flux, batch_wave_speed );
+  }
+
+  // A gas at rest has no mass flux
+  roe.get( nb_faces, batch_flux, batch_wave_speed );
+  BOOST_CHECK_EQUAL( batch_flux[0], 0. );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
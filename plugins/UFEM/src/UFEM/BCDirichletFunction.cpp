@@ -101,7 +101,7 @@ void BCDirichletFunction::execute()
     }
   }
   
-  cf3::solver::actions::Proto::ProtoAction::execute();
+  execute_batched(options().value<std::string>("field_tag"));
 }
 
 } // namespace UFEM
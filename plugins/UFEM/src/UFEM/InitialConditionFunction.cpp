@@ -100,6 +100,11 @@ void InitialConditionFunction::trigger()
   }
 }
 
+void InitialConditionFunction::execute()
+{
+  execute_batched(options().value<std::string>("field_tag"));
+}
+
 
 
 } // UFEM
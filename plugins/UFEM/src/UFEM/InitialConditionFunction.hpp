@@ -31,6 +31,9 @@ public: // functions
   /// Get the class name
   static std::string type_name () { return "InitialConditionFunction"; }
 
+  /// Set the variable, evaluating the function in all nodes at once
+  virtual void execute();
+
 private:
   /// Triggered when the tag or variable is changed
   void trigger();
@@ -102,6 +102,18 @@ LSSAction::LSSAction(const std::string& name) :
     .pretty_name("Blocked System")
     .description("Store the linear system internally as a set of blocks grouped per variable, rather than keeping the variables per node");
 
+  options().add("sparsity_threads", 1u)
+    .pretty_name("Sparsity Threads")
+    .description("Number of threads used to build the sparsity pattern of the LSS");
+
+  options().add("freeze_matrix", false)
+    .pretty_name("Freeze Matrix")
+    .description("Keep the system matrix and preconditioner of the first execution, skipping matrix assembly afterwards. Only valid if the matrix does not depend on the solution or the time step");
+
+  options().add("cache_matrix_positions", false)
+    .pretty_name("Cache Matrix Positions")
+    .description("Store the position of each element matrix entry in the system matrix at the first assembly, so later assemblies can skip the index lookups. This uses extra memory and is only supported by TrilinosCrsMatrix");
+
   options().add("matrix_builder", "cf3.math.LSS.TrilinosFEVbrMatrix")
     .pretty_name("Matrix Builder")
     .description("Builder to use when creating the LSS")
@@ -131,7 +143,23 @@ void LSSAction::execute()
 
   CFdebug << "Running with LSS " << options().option("lss").value_str() << CFendl;
 
+  const Handle<LSS::Matrix> matrix = m_implementation->m_lss->matrix();
+  const bool freeze_matrix = options().value<bool>("freeze_matrix");
+  if(is_not_null(matrix))
+  {
+    matrix->cache_value_positions(options().value<bool>("cache_matrix_positions"));
+    if(!freeze_matrix)
+      matrix->freeze(false);
+  }
+
   solver::ActionDirector::execute();
+
+  // Keep the matrix assembled during this first execution
+  if(freeze_matrix && is_not_null(matrix) && !matrix->is_frozen())
+  {
+    CFdebug << "Freezing matrix " << matrix->uri().path() << CFendl;
+    matrix->freeze(true);
+  }
 }
 
 LSS::System& LSSAction::create_lss()
@@ -214,7 +242,7 @@ void LSSAction::on_regions_set()
     Handle< List<int> > used_node_map = m_implementation->m_lss->create_component< List<int> >("used_node_map");
 
     std::vector<Uint> node_connectivity, starting_indices;
-    boost::shared_ptr< List<Uint> > used_nodes = build_sparsity(m_loop_regions, *m_dictionary, node_connectivity, starting_indices, *gids, *ranks, *used_node_map);
+    boost::shared_ptr< List<Uint> > used_nodes = build_sparsity(m_loop_regions, *m_dictionary, node_connectivity, starting_indices, *gids, *ranks, *used_node_map, options().value<Uint>("sparsity_threads"));
     if(is_not_null(get_child(used_nodes->name())))
       remove_component(used_nodes->name());
     add_component(used_nodes);
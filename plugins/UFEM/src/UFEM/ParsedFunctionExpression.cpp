@@ -4,12 +4,23 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <iterator>
+
 #include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
 #include "common/Option.hpp"
 #include "common/OptionList.hpp"
 #include "common/Signal.hpp"
 #include "common/FindComponents.hpp"
 
+#include "math/Consts.hpp"
+
+#include "mesh/DataCache.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Functions.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Region.hpp"
 
@@ -106,6 +117,94 @@ void ParsedFunctionExpression::trigger_time()
   m_function.predefined_values.back() = m_time->options().value<Real>("current_time");
 }
 
+namespace detail
+{
+
+/// Union of the sorted used node lists of the regions, so nodes shared between regions are evaluated once.
+/// It is kept in the cache of the mesh, so it is only built again after the mesh changes.
+boost::shared_ptr<solver::actions::Proto::BatchNodes const> batch_nodes(const mesh::Mesh& mesh, const std::vector< Handle<mesh::Region> >& regions, const mesh::Dictionary& dict)
+{
+  std::string key = "parsed_function_batch_nodes:" + dict.uri().path();
+  BOOST_FOREACH(const Handle<mesh::Region>& region, regions)
+    key += ":" + region->uri().path();
+
+  boost::shared_ptr<solver::actions::Proto::BatchNodes const> cached = mesh.cache().get<solver::actions::Proto::BatchNodes const>(key);
+  if(cached)
+    return cached;
+
+  boost::shared_ptr<solver::actions::Proto::BatchNodes> result(new solver::actions::Proto::BatchNodes());
+  std::vector<Uint>& nodes = result->nodes;
+  std::vector<Uint> merged_nodes;
+  BOOST_FOREACH(const Handle<mesh::Region>& region, regions)
+  {
+    const boost::shared_ptr< List<Uint> const > used_nodes_list = mesh::cached_used_nodes_list(*region, dict);
+    const List<Uint>::ListT& used_nodes = used_nodes_list->array();
+    merged_nodes.clear();
+    std::set_union(nodes.begin(), nodes.end(), used_nodes.begin(), used_nodes.end(), std::back_inserter(merged_nodes));
+    nodes.swap(merged_nodes);
+  }
+
+  // Dense map from the dictionary nodes to their position in the batch, so node loops need no search
+  result->slots.assign(dict.size(), math::Consts::uint_max());
+  const Uint nb_nodes = nodes.size();
+  for(Uint i = 0; i != nb_nodes; ++i)
+    result->slots[nodes[i]] = i;
+
+  mesh.cache().set(key, result);
+  return result;
+}
+
+} // detail
+
+void ParsedFunctionExpression::execute_batched(const std::string& field_tag)
+{
+  if(m_loop_regions.empty() || !m_function.is_parsed())
+  {
+    ProtoAction::execute();
+    return;
+  }
+
+  // Same dictionary as used by the node loop
+  mesh::Mesh& mesh = find_parent_component<mesh::Mesh>(*regions().front());
+  Handle<mesh::Dictionary> dict = find_component_ptr_with_tag<mesh::Dictionary>(mesh, field_tag);
+  if(is_null(dict))
+    dict = mesh.geometry_fields().handle<mesh::Dictionary>();
+
+  const mesh::Field& coordinates = dict->coordinates();
+  const Uint nb_vars = m_function.predefined_values.size();
+  const Uint dim = nb_vars - 1;
+  const Uint nb_funcs = m_function.nbfuncs();
+
+  m_function.batch_nodes = detail::batch_nodes(mesh, m_loop_regions, *dict);
+  const std::vector<Uint>& nodes = m_function.batch_nodes->nodes;
+
+  // The buffer keeps its memory between executions
+  const Uint nb_nodes = nodes.size();
+  m_batch_variables.resize(nb_nodes*nb_vars);
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    for(Uint j = 0; j != dim; ++j)
+      m_batch_variables[i*nb_vars + j] = coordinates[nodes[i]][j];
+    m_batch_variables[i*nb_vars + dim] = m_function.predefined_values.back();
+  }
+
+  m_function.batch_values.resize(nb_nodes*nb_funcs);
+  if(nb_nodes != 0)
+    m_function.evaluate_batch(&m_batch_variables[0], nb_nodes, &m_function.batch_values[0]);
+
+  // The values are only valid for this loop, other uses of the function evaluate it again
+  try
+  {
+    ProtoAction::execute();
+  }
+  catch(...)
+  {
+    m_function.batch_nodes.reset();
+    throw;
+  }
+  m_function.batch_nodes.reset();
+}
+
 const solver::actions::Proto::ScalarFunction& ParsedFunctionExpression::scalar_function()
 {
   if(options().option("value").value< std::vector<std::string> >().size() > 1)
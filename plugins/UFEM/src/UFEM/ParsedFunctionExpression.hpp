@@ -39,6 +39,11 @@ public:
   /// Get the stored function as a scalar. This requires that the values option has exactly one element
   const solver::actions::Proto::ScalarFunction& scalar_function();
 
+protected:
+  /// Execute a node expression, evaluating the function in all nodes of the loop regions at once beforehand
+  /// @param field_tag Tag of the dictionary the expression loops over, the geometry dictionary is used if no dictionary has this tag
+  void execute_batched(const std::string& field_tag);
+
 private:
   void trigger_value();
   void trigger_time_component();
@@ -48,6 +53,9 @@ private:
   // Can also represent a vector function
   solver::actions::Proto::VectorFunction m_function;
 
+  /// Scratch buffer for execute_batched, kept to avoid reallocating it at each execution
+  std::vector<Real> m_batch_variables;
+
   Handle<solver::Time> m_time;
 };
 
@@ -573,6 +573,12 @@ void Solver::execute()
     CFinfo << "Running the solver over a mesh with " << mesh().geometry_fields().size() << " nodes." << CFendl;
   }
   solver::SimpleSolver::execute();
+
+  // Complete asynchronous restart output while all ranks are still running
+  BOOST_FOREACH(solver::actions::WriteRestartFile& writer, common::find_components_recursively<solver::actions::WriteRestartFile>(*this))
+  {
+    writer.wait_for_output();
+  }
 }
 
 
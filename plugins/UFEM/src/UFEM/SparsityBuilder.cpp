@@ -4,7 +4,9 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
-#include <set>
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
 
 #include "common/FindComponents.hpp"
 #include "common/List.hpp"
@@ -28,7 +30,98 @@ using namespace mesh;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region> >& regions, const Dictionary& dictionary, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices, List<Uint>& gids, List<Uint>& ranks, List<int>& used_node_map)
+namespace detail
+{
+
+/// Builds the rows of the sparsity for the used nodes in [begin, end) from the elements around each node, given as
+/// (connectivity, element) pairs in node_elems. For each column, a marker holds the last row it was added to, so duplicate
+/// entries are skipped instead of stored and sorted out. Without entries, only row_sizes is filled. With entries, each
+/// row is written at its start index and sorted. Different ranges can be built concurrently.
+struct SparsityRowBuilder
+{
+  SparsityRowBuilder(const std::vector<const Connectivity*>& connectivities, const std::vector<Uint>& node_elems_starts, const std::vector< std::pair<Uint, Uint> >& node_elems, const List<int>& used_node_map, std::vector<Uint>& row_sizes, const std::vector<Uint>& start_indices, std::vector<Uint>* entries, const Uint begin, const Uint end) :
+    m_connectivities(connectivities),
+    m_node_elems_starts(node_elems_starts),
+    m_node_elems(node_elems),
+    m_used_node_map(used_node_map),
+    m_row_sizes(row_sizes),
+    m_start_indices(start_indices),
+    m_entries(entries),
+    m_begin(begin),
+    m_end(end)
+  {
+  }
+
+  void operator()()
+  {
+    const Uint nb_rows = m_row_sizes.size();
+    std::vector<Uint> last_row(nb_rows, nb_rows);
+    for(Uint i = m_begin; i != m_end; ++i)
+    {
+      Uint row_size = 0;
+      for(Uint j = m_node_elems_starts[i]; j != m_node_elems_starts[i+1]; ++j)
+      {
+        const std::pair<Uint, Uint>& node_elem = m_node_elems[j];
+        BOOST_FOREACH(const Uint node_b, (*m_connectivities[node_elem.first])[node_elem.second])
+        {
+          const Uint column = m_used_node_map[node_b];
+          if(last_row[column] == i)
+            continue;
+          last_row[column] = i;
+          if(m_entries != nullptr)
+            (*m_entries)[m_start_indices[i] + row_size] = column;
+          ++row_size;
+        }
+      }
+
+      if(m_entries == nullptr)
+      {
+        m_row_sizes[i] = row_size;
+      }
+      else
+      {
+        const std::vector<Uint>::iterator row_begin = m_entries->begin() + m_start_indices[i];
+        std::sort(row_begin, row_begin + row_size);
+      }
+    }
+  }
+
+  const std::vector<const Connectivity*>& m_connectivities;
+  const std::vector<Uint>& m_node_elems_starts;
+  const std::vector< std::pair<Uint, Uint> >& m_node_elems;
+  const List<int>& m_used_node_map;
+  std::vector<Uint>& m_row_sizes;
+  const std::vector<Uint>& m_start_indices;
+  std::vector<Uint>* m_entries;
+  const Uint m_begin;
+  const Uint m_end;
+};
+
+/// Run SparsityRowBuilder over all rows, splitting them over nb_threads threads
+void build_sparsity_rows(const std::vector<const Connectivity*>& connectivities, const std::vector<Uint>& node_elems_starts, const std::vector< std::pair<Uint, Uint> >& node_elems, const List<int>& used_node_map, std::vector<Uint>& row_sizes, const std::vector<Uint>& start_indices, std::vector<Uint>* entries, const Uint nb_threads)
+{
+  const Uint nb_rows = row_sizes.size();
+  boost::thread_group threads;
+  for(Uint i = 1; i < nb_threads; ++i)
+    threads.create_thread(SparsityRowBuilder(connectivities, node_elems_starts, node_elems, used_node_map, row_sizes, start_indices, entries, (nb_rows * i) / nb_threads, (nb_rows * (i+1)) / nb_threads));
+  SparsityRowBuilder(connectivities, node_elems_starts, node_elems, used_node_map, row_sizes, start_indices, entries, 0, nb_rows / nb_threads)();
+  threads.join_all();
+}
+
+/// Ordering on the first element of a pair only, for lookups in a sorted GID to LID map
+struct CompareFirst
+{
+  bool operator()(const std::pair<Uint, Uint>& a, const std::pair<Uint, Uint>& b) const
+  {
+    return a.first < b.first;
+  }
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region> >& regions, const Dictionary& dictionary, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices, List<Uint>& gids, List<Uint>& ranks, List<int>& used_node_map, const Uint nb_threads)
 {
   // Get some data from the dictionary
   const Uint nb_global_nodes = dictionary.size();
@@ -129,17 +222,23 @@ boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region>
     std::vector<int> recv_map; recv_map.reserve(recv_size);
     std::vector<int> send_map; send_map.reserve(send_size);
     
-    std::map<Uint, Uint> gids_reverse_map;
+    // Sorted (GID, LID) pairs, to look up the local index of the requested GIDs
+    std::vector< std::pair<Uint, Uint> > gids_reverse_map(nb_global_nodes);
     for(Uint i = 0; i != nb_global_nodes; ++i)
-      gids_reverse_map[dict_gid[i]] = i;
+      gids_reverse_map[i] = std::make_pair(dict_gid[i], i);
+    std::sort(gids_reverse_map.begin(), gids_reverse_map.end());
 
     for(Uint i = 0; i != nb_procs; ++i)
     {
       recv_map.insert(recv_map.end(), lids_to_receive[i].begin(), lids_to_receive[i].end());
-      const std::vector<Uint> send_gids_i = gids_to_send[i];
+      const std::vector<Uint>& send_gids_i = gids_to_send[i];
       const Uint len_send_gids_i = send_gids_i.size();
       for(Uint j = 0; j != len_send_gids_i; ++j)
-        send_map.push_back(gids_reverse_map[send_gids_i[j]]);
+      {
+        const std::vector< std::pair<Uint, Uint> >::const_iterator found = std::lower_bound(gids_reverse_map.begin(), gids_reverse_map.end(), std::make_pair(send_gids_i[j], Uint(0)), detail::CompareFirst());
+        cf3_assert(found != gids_reverse_map.end() && found->first == send_gids_i[j]);
+        send_map.push_back(found->second);
+      }
     }
     
     // Update the GIDs for the ghosts
@@ -154,39 +253,51 @@ boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region>
     }
   }
 
-  std::vector< std::set<Uint> > connectivity_sets(nb_used_nodes);
-  start_indices.assign(nb_used_nodes+1, 0);
-
-  // Determine the number of connected nodes for each element
+  // Count the elements around each node
+  std::vector<const Connectivity*> connectivities; connectivities.reserve(used_entities.size());
+  std::vector<Uint> node_elems_starts(nb_used_nodes+1, 0);
   BOOST_FOREACH(const Handle<Entities const>& elements, used_entities)
   {
     const Connectivity& connectivity = elements->space(dictionary).connectivity();
+    connectivities.push_back(&connectivity);
     const Uint nb_elems = connectivity.size();
-    const Uint nb_elem_nodes = connectivity.row_size();
     for(Uint elem = 0; elem != nb_elems; ++elem)
     {
-      BOOST_FOREACH(const Uint node_a, connectivity[elem])
+      BOOST_FOREACH(const Uint node, connectivity[elem])
       {
-        BOOST_FOREACH(const Uint node_b, connectivity[elem])
-        {
-          connectivity_sets[used_node_map[node_a]].insert(used_node_map[node_b]);
-        }
+        ++node_elems_starts[used_node_map[node]+1];
       }
     }
   }
+  for(Uint i = 0; i != nb_used_nodes; ++i)
+    node_elems_starts[i+1] += node_elems_starts[i];
 
-  // Sum the number of connected nodes to get the real start indices
-  const Uint start_indices_end = start_indices.size();
-  for(Uint i = 1; i != start_indices_end; ++i)
+  // Node to element connectivity of the used nodes, as (connectivity index, element) pairs
+  std::vector< std::pair<Uint, Uint> > node_elems(node_elems_starts.back());
+  std::vector<Uint> node_elems_fill(node_elems_starts.begin(), node_elems_starts.end() - 1);
+  for(Uint conn_idx = 0; conn_idx != connectivities.size(); ++conn_idx)
   {
-    start_indices[i] = connectivity_sets[i-1].size() + start_indices[i-1];
+    const Connectivity& connectivity = *connectivities[conn_idx];
+    const Uint nb_elems = connectivity.size();
+    for(Uint elem = 0; elem != nb_elems; ++elem)
+    {
+      BOOST_FOREACH(const Uint node, connectivity[elem])
+      {
+        node_elems[node_elems_fill[used_node_map[node]]++] = std::make_pair(conn_idx, elem);
+      }
+    }
   }
 
-  node_connectivity.reserve(start_indices.back());
-  for(Uint node = 0; node != nb_used_nodes; ++node)
-  {
-    node_connectivity.insert(node_connectivity.begin() + start_indices[node], connectivity_sets[node].begin(), connectivity_sets[node].end());
-  }
+  // Count the unique entries of each row, then fill the rows at their final position, splitting the rows over the threads
+  const Uint nb_fill_threads = std::max(Uint(1), std::min(nb_threads, nb_used_nodes));
+  std::vector<Uint> row_sizes(nb_used_nodes);
+  start_indices.assign(nb_used_nodes+1, 0);
+  detail::build_sparsity_rows(connectivities, node_elems_starts, node_elems, used_node_map, row_sizes, start_indices, nullptr, nb_fill_threads);
+  for(Uint i = 0; i != nb_used_nodes; ++i)
+    start_indices[i+1] = start_indices[i] + row_sizes[i];
+
+  node_connectivity.resize(start_indices.back());
+  detail::build_sparsity_rows(connectivities, node_elems_starts, node_elems, used_node_map, row_sizes, start_indices, &node_connectivity, nb_fill_threads);
 
   return used_nodes_ptr;
 }
@@ -63,7 +63,7 @@ struct ScalarLSSVector
   {
     index_converter(data);
     acc.resize(DataT::SupportShapeFunction::nb_nodes, 1);
-    acc.indices = data.block_accumulator.indices;
+    acc.indices.assign(data.block_accumulator.indices.begin(), data.block_accumulator.indices.end());
     vector->get_sol_values(acc);
     result = acc.sol;
     return result;
@@ -99,7 +99,7 @@ struct VectorLSSVector
   {
     index_converter(data);
     acc.resize(DataT::SupportShapeFunction::nb_nodes, DataT::dimension);
-    acc.indices = data.block_accumulator.indices;
+    acc.indices.assign(data.block_accumulator.indices.begin(), data.block_accumulator.indices.end());
     vector->get_sol_values(acc);
     // We need to renumber to the blocked structure used in the element matrices
     for(Uint i = 0; i != DataT::SupportShapeFunction::nb_nodes; ++i)
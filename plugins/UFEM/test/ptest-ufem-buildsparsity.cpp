@@ -0,0 +1,143 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark for the UFEM sparsity builder"
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/List.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/Timer.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Domain.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/BlockMesh/BlockData.hpp"
+
+#include "solver/Model.hpp"
+
+#include "Tools/MeshGeneration/MeshGeneration.hpp"
+
+#include "UFEM/SparsityBuilder.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver;
+
+/// Peak resident memory of the process in kB, as reported by Linux. Falls back to the current allocated memory elsewhere.
+Real peak_memory_kb()
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while(std::getline(status, line))
+  {
+    if(line.compare(0, 6, "VmHWM:") == 0)
+    {
+      std::istringstream line_stream(line.substr(6));
+      Real result;
+      line_stream >> result;
+      return result;
+    }
+  }
+  return OSystem::instance().layer()->memory_usage() / 1024.;
+}
+
+struct BuildSparsityBenchmarkFixture
+{
+  BuildSparsityBenchmarkFixture() :
+    root( Core::instance().root() )
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    // Number of segments in each direction, can be passed as first argument
+    nb_segments = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 40;
+    // Number of threads for the threaded run, can be passed as second argument
+    nb_threads = argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 4;
+  }
+
+  Component& root;
+  Uint nb_segments;
+  Uint nb_threads;
+
+  static Handle<Mesh> mesh;
+  static std::vector<Uint> serial_connectivity;
+  static std::vector<Uint> serial_start_indices;
+
+  /// Run the sparsity builder on the mesh, printing the timing and memory use
+  void run(const Uint threads, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices)
+  {
+    Handle< List<Uint> > gids = root.create_component< List<Uint> >("GIDs");
+    Handle< List<Uint> > ranks = root.create_component< List<Uint> >("Ranks");
+    Handle< List<int> > used_node_map = root.create_component< List<int> >("used_node_map");
+
+    Timer timer;
+    UFEM::build_sparsity(std::vector< Handle<Region> >(1, mesh->topology().handle<Region>()), mesh->geometry_fields(), node_connectivity, start_indices, *gids, *ranks, *used_node_map, threads);
+    const Real elapsed = timer.elapsed();
+
+    std::cout << "build_sparsity with " << threads << " thread(s) for " << start_indices.size()-1 << " nodes and " << node_connectivity.size() << " nonzeros: "
+              << elapsed << " s, peak memory " << peak_memory_kb() / 1024. << " MB" << std::endl;
+    std::cout << "<DartMeasurement name=\"build_sparsity " << threads << " threads time\" type=\"numeric/double\">" << elapsed << "</DartMeasurement>" << std::endl;
+
+    root.remove_component(*gids);
+    root.remove_component(*ranks);
+    root.remove_component(*used_node_map);
+  }
+};
+
+Handle<Mesh> BuildSparsityBenchmarkFixture::mesh;
+std::vector<Uint> BuildSparsityBenchmarkFixture::serial_connectivity;
+std::vector<Uint> BuildSparsityBenchmarkFixture::serial_start_indices;
+
+BOOST_FIXTURE_TEST_SUITE( BuildSparsityBenchmarkSuite, BuildSparsityBenchmarkFixture )
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  common::PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( CreateMesh )
+{
+  Model& model = *root.create_component<Model>("Model");
+  Domain& domain = model.create_domain("Domain");
+  mesh = domain.create_component<Mesh>("Mesh");
+  BlockMesh::BlockArrays& blocks = *domain.create_component<BlockMesh::BlockArrays>("blocks");
+  Tools::MeshGeneration::create_channel_3d(blocks, 10., 0.5, 5., nb_segments, nb_segments/2, nb_segments, 1.);
+  blocks.create_mesh(*mesh);
+
+  std::cout << "Mesh with " << mesh->geometry_fields().size() << " nodes, peak memory " << peak_memory_kb() / 1024. << " MB" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE( SerialBuild )
+{
+  run(1, serial_connectivity, serial_start_indices);
+}
+
+BOOST_AUTO_TEST_CASE( ThreadedBuild )
+{
+  std::vector<Uint> node_connectivity, start_indices;
+  run(nb_threads, node_connectivity, start_indices);
+
+  BOOST_CHECK(node_connectivity == serial_connectivity);
+  BOOST_CHECK(start_indices == serial_start_indices);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,113 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of global to local lookups with Map and HashMap"
+
+#include <algorithm>
+
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/CF.hpp"
+#include "common/HashMap.hpp"
+#include "common/Map.hpp"
+#include "common/Timer.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct HashMapBenchmarkFixture
+{
+  HashMapBenchmarkFixture()
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    // Number of keys and number of lookups, can be passed as arguments
+    nb_keys = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 1000000;
+    nb_lookups = argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 10000000;
+
+    // Global indices of a partition: shuffled and sparse, like after repartitioning
+    glb_indices.resize(nb_keys);
+    for(Uint i = 0; i != nb_keys; ++i)
+      glb_indices[i] = 3*static_cast<boost::uint64_t>(i) + 7;
+    std::random_shuffle(glb_indices.begin(), glb_indices.end());
+
+    // Lookups in random order
+    lookups.resize(nb_lookups);
+    boost::uint64_t state = 12345;
+    for(Uint i = 0; i != nb_lookups; ++i)
+    {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      lookups[i] = glb_indices[(state >> 33) % nb_keys];
+    }
+  }
+
+  static void report(const std::string& name, const Real elapsed)
+  {
+    std::cout << name << ": " << elapsed << " s" << std::endl;
+    std::cout << "<DartMeasurement name=\"" << name << "\" type=\"numeric/double\">" << elapsed << "</DartMeasurement>" << std::endl;
+  }
+
+  /// Build the map from glb_indices, with local index as value
+  template<typename MapT>
+  void build(MapT& map, const std::string& name)
+  {
+    Timer timer;
+    map.reserve(nb_keys);
+    for(Uint i = 0; i != nb_keys; ++i)
+      map.push_back(glb_indices[i], i);
+    report(name + " build", timer.elapsed());
+  }
+
+  /// Look up all keys, return a checksum of the local indices
+  template<typename MapT>
+  Uint lookup(const MapT& map, const std::string& name)
+  {
+    Timer timer;
+    Uint checksum = 0;
+    for(Uint i = 0; i != nb_lookups; ++i)
+      checksum += map[lookups[i]];
+    const Real elapsed = timer.elapsed();
+    report(name + " lookup", elapsed);
+    std::cout << name << " throughput: " << static_cast<Real>(nb_lookups) / elapsed / 1e6 << " Mlookups/s" << std::endl;
+    return checksum;
+  }
+
+  Uint nb_keys;
+  Uint nb_lookups;
+  std::vector<boost::uint64_t> glb_indices;
+  std::vector<boost::uint64_t> lookups;
+};
+
+BOOST_FIXTURE_TEST_SUITE( HashMapBenchmarkSuite, HashMapBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Lookups )
+{
+  boost::shared_ptr< Map<boost::uint64_t,Uint> > sorted_map = allocate_component< Map<boost::uint64_t,Uint> >("sorted_map");
+  build(*sorted_map, "Map");
+  Timer timer;
+  sorted_map->sort_keys();
+  report("Map sort", timer.elapsed());
+
+  boost::shared_ptr< HashMap<boost::uint64_t,Uint> > hash_map = allocate_component< HashMap<boost::uint64_t,Uint> >("hash_map");
+  build(*hash_map, "HashMap");
+
+  const Uint sorted_checksum = lookup(static_cast<const Map<boost::uint64_t,Uint>&>(*sorted_map), "Map");
+  const Uint hash_checksum = lookup(static_cast<const HashMap<boost::uint64_t,Uint>&>(*hash_map), "HashMap");
+  BOOST_CHECK_EQUAL(sorted_checksum, hash_checksum);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
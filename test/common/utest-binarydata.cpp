@@ -17,6 +17,7 @@
 
 #include "common/BinaryDataReader.hpp"
 #include "common/BinaryDataWriter.hpp"
+#include "common/BoostFilesystem.hpp"
 #include "common/Core.hpp"
 #include "common/List.hpp"
 #include "common/OptionList.hpp"
@@ -173,6 +174,127 @@ BOOST_AUTO_TEST_CASE( ReadBinaryData )
   BOOST_CHECK_EQUAL(empty_real_table.row_size(), 8);
 }
 
+BOOST_AUTO_TEST_CASE( AsynchronousBinaryData )
+{
+  Handle<common::Component> write_group = common::Core::instance().root().get_child("WriteGroup");
+  common::Table<Real>& real_table = *Handle< common::Table<Real> >(write_group->get_child("RealTable"));
+  common::List<Uint>& int_list = *Handle< common::List<Uint> >(write_group->get_child("IntList"));
+  const common::Table<Real>::ArrayT real_table_copy = real_table.array();
+
+  common::BinaryDataWriter& writer = *write_group->create_component<common::BinaryDataWriter>("AsyncWriter");
+  writer.options().set("asynchronous", true);
+  writer.options().set("file", common::URI("binary_data_async.cfbinxml"));
+
+  BOOST_CHECK_EQUAL(writer.append_data(real_table), 0);
+  BOOST_CHECK_EQUAL(writer.append_data(int_list), 1);
+
+  // The data was staged, so changing it must not affect the output
+  fill_table(real_table);
+
+  writer.close();
+
+  common::Component& read_group = *common::Core::instance().root().create_component("AsyncReadGroup", "cf3.common.Group");
+  common::BinaryDataReader& reader = *read_group.create_component<common::BinaryDataReader>("Reader");
+  reader.options().set("file", common::URI("binary_data_async.cfbinxml"));
+
+  common::Table<Real>& read_real_table = *read_group.create_component< common::Table<Real> >("RealTable");
+  common::List<Uint>& read_int_list = *read_group.create_component< common::List<Uint> >("IntList");
+  reader.read_table(read_real_table, 0);
+  reader.read_list(read_int_list, 1);
+
+  BOOST_CHECK(read_real_table.array() == real_table_copy);
+  BOOST_CHECK(read_int_list.array() == int_list.array());
+}
+
+BOOST_AUTO_TEST_CASE( SharedFileBinaryData )
+{
+  Handle<common::Component> write_group = common::Core::instance().root().get_child("WriteGroup");
+  common::Table<Uint>& int_table = *Handle< common::Table<Uint> >(write_group->get_child("IntTable"));
+  common::List<Real>& real_list = *Handle< common::List<Real> >(write_group->get_child("RealList"));
+  common::List<Real>& empty_real_list = *Handle< common::List<Real> >(write_group->get_child("EmptyRealList"));
+
+  common::BinaryDataWriter& writer = *write_group->create_component<common::BinaryDataWriter>("SharedWriter");
+  writer.options().set("shared_file", true);
+  writer.options().set("file", common::URI("binary_data_shared.cfbinxml"));
+  writer.append_data(int_table);
+  writer.append_data(empty_real_list);
+  writer.append_data(real_list);
+  writer.close();
+
+  // One binary file for all ranks
+  BOOST_CHECK(boost::filesystem::exists("binary_data_shared.cfbin"));
+  BOOST_CHECK(!boost::filesystem::exists("binary_data_shared_P0.cfbin"));
+
+  common::Component& read_group = *common::Core::instance().root().create_component("SharedReadGroup", "cf3.common.Group");
+  common::BinaryDataReader& reader = *read_group.create_component<common::BinaryDataReader>("Reader");
+  reader.options().set("file", common::URI("binary_data_shared.cfbinxml"));
+
+  common::Table<Uint>& read_int_table = *read_group.create_component< common::Table<Uint> >("IntTable");
+  common::List<Real>& read_empty_list = *read_group.create_component< common::List<Real> >("EmptyRealList");
+  common::List<Real>& read_real_list = *read_group.create_component< common::List<Real> >("RealList");
+  reader.read_table(read_int_table, 0);
+  reader.read_list(read_empty_list, 1);
+  reader.read_list(read_real_list, 2);
+
+  BOOST_CHECK(read_int_table.array() == int_table.array());
+  BOOST_CHECK_EQUAL(read_empty_list.size(), 0);
+  BOOST_CHECK(read_real_list.array() == real_list.array());
+
+  // Data of the other ranks is read from the same file
+  const Uint nb_procs = common::PE::Comm::instance().size();
+  for(Uint i = 0; i != nb_procs; ++i)
+  {
+    reader.options().set("rank", i);
+    reader.read_list(read_real_list, 2);
+    BOOST_CHECK_EQUAL(read_real_list.size(), 40000+4000*i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( ChunkedBinaryData )
+{
+  Handle<common::Component> write_group = common::Core::instance().root().get_child("WriteGroup");
+  const common::Table<Real>& real_table = *Handle< common::Table<Real> >(write_group->get_child("RealTable"));
+  common::Component& read_group = *common::Core::instance().root().create_component("ChunkedReadGroup", "cf3.common.Group");
+  common::Table<Real>& read_real_table = *read_group.create_component< common::Table<Real> >("RealTable");
+
+  const Uint first_row = 1234;
+  const Uint nb_rows = 5000;
+
+  const char* codecs[] = {"zlib", "zlib_fast", "none"};
+  const Uint chunk_sizes[] = {0, 4096, 1000};
+  for(Uint i = 0; i != 3; ++i)
+  {
+    for(Uint j = 0; j != 3; ++j)
+    {
+      const std::string file = std::string("binary_data_chunked_") + codecs[i] + "_" + common::to_str(chunk_sizes[j]) + ".cfbinxml";
+      boost::shared_ptr<common::BinaryDataWriter> writer = common::allocate_component<common::BinaryDataWriter>("ChunkedWriter");
+      writer->options().set("codec", std::string(codecs[i]));
+      writer->options().set("chunk_size", chunk_sizes[j]);
+      writer->options().set("nb_threads", 3u);
+      writer->options().set("file", common::URI(file));
+      writer->append_data(real_table);
+      writer->close();
+
+      boost::shared_ptr<common::BinaryDataReader> reader = common::allocate_component<common::BinaryDataReader>("ChunkedReader");
+      reader->options().set("file", common::URI(file));
+      reader->read_table(read_real_table, 0);
+      BOOST_CHECK(read_real_table.array() == real_table.array());
+
+      // Partial read, starting and ending in the middle of a chunk
+      reader->read_table_rows(read_real_table, 0, first_row, nb_rows);
+      BOOST_CHECK_EQUAL(read_real_table.size(), nb_rows);
+      BOOST_CHECK_EQUAL(read_real_table.row_size(), real_table.row_size());
+      bool rows_equal = true;
+      for(Uint row = 0; row != nb_rows; ++row)
+      {
+        for(Uint col = 0; col != real_table_cols; ++col)
+          rows_equal = rows_equal && read_real_table[row][col] == real_table[first_row + row][col];
+      }
+      BOOST_CHECK(rows_equal);
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_SUITE_END()
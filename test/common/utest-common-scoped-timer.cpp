@@ -0,0 +1,187 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::common::ScopedTimer"
+
+#include <sstream>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/BoostFilesystem.hpp"
+#include "common/ScopedTimer.hpp"
+#include "common/StringConversion.hpp"
+#include "common/URI.hpp"
+
+#include "common/PE/Comm.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Times a number of calls in a separate thread
+struct TimedWork
+{
+  void operator()()
+  {
+    for(Uint i = 0; i != 10; ++i)
+    {
+      CF3_SCOPED_TIMER("thread_work");
+    }
+  }
+};
+
+/// Count the occurrences of pattern in str
+Uint count_occurrences(const std::string& str, const std::string& pattern)
+{
+  Uint result = 0;
+  for(std::string::size_type pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1))
+    ++result;
+  return result;
+}
+
+/// Print the regions and return the output on rank 0
+std::string print_regions()
+{
+  std::ostringstream out;
+  print_timing_regions(out);
+  if(PE::Comm::instance().rank() == 0)
+    std::cout << out.str();
+  return out.str();
+}
+
+BOOST_AUTO_TEST_SUITE( ScopedTimerSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+BOOST_AUTO_TEST_CASE( NestedRegions )
+{
+  reset_timing_regions();
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint nb_procs = PE::Comm::instance().size();
+
+  for(Uint i = 0; i != 3; ++i)
+  {
+    CF3_SCOPED_TIMER("outer");
+    for(Uint j = 0; j != 2; ++j)
+    {
+      CF3_SCOPED_TIMER("inner");
+    }
+  }
+
+  // A different number of calls on each rank
+  for(Uint i = 0; i <= rank; ++i)
+  {
+    CF3_SCOPED_TIMER("imbalanced");
+  }
+
+  const std::string output = print_regions();
+  if(rank == 0)
+  {
+    BOOST_CHECK(boost::algorithm::contains(output, "\nouter: count: [3, 3]"));
+    BOOST_CHECK(boost::algorithm::contains(output, "\n  inner: count: [6, 6]"));
+    BOOST_CHECK(boost::algorithm::contains(output, "\nimbalanced: count: [1, " + to_str(nb_procs) + "]"));
+  }
+  else
+  {
+    BOOST_CHECK(output.empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Threads )
+{
+  reset_timing_regions();
+
+  boost::thread_group threads;
+  for(Uint i = 0; i != 4; ++i)
+    threads.create_thread(TimedWork());
+  threads.join_all();
+
+  const std::string output = print_regions();
+  if(PE::Comm::instance().rank() == 0)
+  {
+    BOOST_CHECK(boost::algorithm::contains(output, "\nthread_work: count: [40, 40]"));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Trace )
+{
+  reset_timing_regions();
+  enable_timing_trace(true);
+  set_timing_trace_capacity(4);
+  for(Uint i = 0; i != 10; ++i)
+  {
+    CF3_SCOPED_TIMER("traced");
+  }
+  enable_timing_trace(false);
+
+  write_timing_trace(URI("scoped-timer-trace"));
+
+  const boost::filesystem::path trace_path("scoped-timer-trace_P" + to_str(PE::Comm::instance().rank()) + ".json");
+  BOOST_CHECK(boost::filesystem::exists(trace_path));
+  boost::filesystem::fstream trace_file(trace_path, std::ios_base::in);
+  std::stringstream contents;
+  contents << trace_file.rdbuf();
+
+  // Only the last calls that fit in the buffer are kept
+  BOOST_CHECK(boost::algorithm::starts_with(contents.str(), "{\"traceEvents\":["));
+  BOOST_CHECK_EQUAL(count_occurrences(contents.str(), "\"name\":\"traced\""), 4);
+  BOOST_CHECK_EQUAL(count_occurrences(contents.str(), "\"pid\":" + to_str(PE::Comm::instance().rank())), 5);
+}
+
+BOOST_AUTO_TEST_CASE( SequentialThreads )
+{
+  reset_timing_regions();
+  enable_timing_trace(true);
+  set_timing_trace_capacity(4);
+
+  // Each thread takes over the slot of the previous one, so all calls end up in a single trace buffer
+  for(Uint i = 0; i != 10; ++i)
+  {
+    boost::thread thread((TimedWork()));
+    thread.join();
+  }
+  enable_timing_trace(false);
+
+  const std::string output = print_regions();
+  if(PE::Comm::instance().rank() == 0)
+  {
+    BOOST_CHECK(boost::algorithm::contains(output, "\nthread_work: count: [100, 100]"));
+  }
+
+  write_timing_trace(URI("scoped-timer-sequential"));
+  const boost::filesystem::path trace_path("scoped-timer-sequential_P" + to_str(PE::Comm::instance().rank()) + ".json");
+  boost::filesystem::fstream trace_file(trace_path, std::ios_base::in);
+  std::stringstream contents;
+  contents << trace_file.rdbuf();
+  BOOST_CHECK_EQUAL(count_occurrences(contents.str(), "\"name\":\"thread_work\""), 4);
+}
+
+BOOST_AUTO_TEST_CASE( ResetWhileActive )
+{
+  CF3_SCOPED_TIMER("active");
+  BOOST_CHECK_THROW(reset_timing_regions(), SetupError);
+}
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,146 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for HashMap component"
+
+#include <map>
+
+#include <boost/cstdint.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/CF.hpp"
+#include "common/HashMap.hpp"
+#include "common/Foreach.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::common;
+
+BOOST_AUTO_TEST_SUITE( HashMapTests )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE ( test_HashMap )
+{
+  boost::shared_ptr< HashMap<int,Uint> > map_ptr ( allocate_component< HashMap<int,Uint> > ("map"));
+  HashMap<int,Uint>& map = *map_ptr;
+
+  BOOST_CHECK_EQUAL(map.type_name() , "HashMap<integer,unsigned>");
+
+  BOOST_CHECK(map.find(1) == map.end());
+  BOOST_CHECK(!map.exists(1));
+
+  BOOST_CHECK_EQUAL(map.push_back(1, 10u), 0u);
+  BOOST_CHECK_EQUAL(map.push_back(-2, 20u), 1u);
+  BOOST_CHECK_EQUAL(map.size() , 2u);
+  BOOST_CHECK_EQUAL(map[1] , 10u);
+  BOOST_CHECK_EQUAL(map[-2] , 20u);
+
+  map[3] = 30;
+  BOOST_CHECK_EQUAL(map.size() , 3u);
+  BOOST_CHECK_EQUAL(map.find(3)->second, 30u);
+
+  std::pair<HashMap<int,Uint>::iterator,bool> ret = map.insert(std::make_pair(4,40u));
+  BOOST_CHECK_EQUAL(ret.second, true);
+  BOOST_CHECK_EQUAL(ret.first->second, 40u);
+
+  // try to insert one that is already there
+  ret = map.insert(std::make_pair(4,1000u));
+  BOOST_CHECK_EQUAL(ret.second, false);
+  BOOST_CHECK_EQUAL(ret.first->second, 40u);
+
+  // Pairs are visited in insertion order
+  std::vector<int> keys;
+  foreach_container((const int key)(const Uint data),map)
+  {
+    BOOST_CHECK_EQUAL( map[key] , data );
+    keys.push_back(key);
+  }
+  BOOST_CHECK_EQUAL(keys.size(), 4u);
+  BOOST_CHECK_EQUAL(keys[0], 1);
+  BOOST_CHECK_EQUAL(keys[1], -2);
+  BOOST_CHECK_EQUAL(keys[2], 3);
+  BOOST_CHECK_EQUAL(keys[3], 4);
+
+  // The last pair takes the place of the erased one
+  BOOST_CHECK(map.erase(1));
+  BOOST_CHECK(!map.erase(1));
+  BOOST_CHECK(!map.exists(1));
+  BOOST_CHECK_EQUAL(map.size(), 3u);
+  BOOST_CHECK_EQUAL(map.begin()->first, 4);
+  BOOST_CHECK_EQUAL(map[4], 40u);
+
+  const HashMap<int,Uint>& const_map = map;
+  BOOST_CHECK(const_map.find(-2) != const_map.end());
+  BOOST_CHECK_EQUAL(const_map[3], 30u);
+
+  map.clear();
+  BOOST_CHECK_EQUAL(map.size(), 0u);
+  BOOST_CHECK(!map.exists(3));
+}
+
+BOOST_AUTO_TEST_CASE ( test_HashMap_growth )
+{
+  boost::shared_ptr< HashMap<boost::uint64_t,Uint> > map_ptr ( allocate_component< HashMap<boost::uint64_t,Uint> > ("map"));
+  HashMap<boost::uint64_t,Uint>& map = *map_ptr;
+
+  // Strided keys, without reserving, so the table is rehashed several times
+  const Uint nb_keys = 10000;
+  for(Uint i = 0; i != nb_keys; ++i)
+    map.push_back(1024*static_cast<boost::uint64_t>(i), i);
+  BOOST_CHECK_EQUAL(map.size(), nb_keys);
+  BOOST_CHECK(map.capacity() >= nb_keys);
+
+  bool all_found = true;
+  for(Uint i = 0; i != nb_keys; ++i)
+    all_found = all_found && map.exists(1024*static_cast<boost::uint64_t>(i)) && map[1024*static_cast<boost::uint64_t>(i)] == i;
+  BOOST_CHECK(all_found);
+  BOOST_CHECK(!map.exists(1));
+
+  map.reserve(4*nb_keys);
+  BOOST_CHECK(map.capacity() >= 4*nb_keys);
+  BOOST_CHECK_EQUAL(map[1024*static_cast<boost::uint64_t>(nb_keys-1)], nb_keys-1);
+}
+
+BOOST_AUTO_TEST_CASE ( test_HashMap_erase )
+{
+  boost::shared_ptr< HashMap<Uint,Uint> > map_ptr ( allocate_component< HashMap<Uint,Uint> > ("map"));
+  HashMap<Uint,Uint>& map = *map_ptr;
+  std::map<Uint,Uint> reference;
+
+  // Erase every third key while inserting, and compare with std::map
+  for(Uint i = 0; i != 5000; ++i)
+  {
+    map[i] = 2*i;
+    reference[i] = 2*i;
+    if(i % 3 == 2)
+    {
+      BOOST_CHECK(map.erase(i-1));
+      reference.erase(i-1);
+    }
+  }
+
+  BOOST_CHECK_EQUAL(map.size(), reference.size());
+  bool all_equal = true;
+  for(Uint i = 0; i != 5000; ++i)
+  {
+    const std::map<Uint,Uint>::const_iterator ref_itr = reference.find(i);
+    const HashMap<Uint,Uint>::const_iterator itr = map.find(i);
+    if(ref_itr == reference.end())
+      all_equal = all_equal && itr == map.end();
+    else
+      all_equal = all_equal && itr != map.end() && itr->second == ref_itr->second;
+  }
+  BOOST_CHECK(all_equal);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -212,6 +212,117 @@ BOOST_AUTO_TEST_CASE( commpattern_mainstream )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( commpattern_split_synchronization )
+{
+  // general constants in this routine
+  const int nproc=PE::Comm::instance().size();
+  const int irank=PE::Comm::instance().rank();
+
+  // commpattern
+  boost::shared_ptr<CommPattern> pecp_ptr = allocate_component<CommPattern>("CommPattern");
+  CommPattern& pecp = *pecp_ptr;
+
+  // setup gid & rank
+  std::vector<Uint> gid;
+  std::vector<Uint> rank;
+  setupGidAndRank(gid,rank);
+  pecp.insert("gid",gid,1,false);
+
+  std::vector<int> v1;
+  for(int i=0;i<6*nproc;i++) v1.push_back(-((irank+1)*1000+i+1));
+  pecp.insert("v1",v1,1,true);
+
+  pecp.setup(Handle<CommWrapper>(pecp.get_child("gid")),rank);
+
+  // every other rank is a neighbour in this pattern
+  BOOST_CHECK_EQUAL( pecp.send_neighbours().size() , (Uint)(nproc-1) );
+  BOOST_CHECK_EQUAL( pecp.recv_neighbours().size() , (Uint)(nproc-1) );
+
+  // repeated exchanges reuse the same persistent requests
+  for (int iter=0; iter<3; iter++)
+  {
+    pecp.start_synchronize("v1");
+    pecp.finish_synchronize("v1");
+
+    Uint idx=0;
+    Uint i;
+    for (i=0; i<  nproc; i++, idx++ ) BOOST_CHECK_EQUAL( v1[i], (int)(-((((i-0*nproc)/1)+1)*1000+idx+1)) );
+    for (   ; i<3*nproc; i++, idx++ ) BOOST_CHECK_EQUAL( v1[i], (int)(-((((i-1*nproc)/2)+1)*1000+idx+1)) );
+    for (   ; i<6*nproc; i++, idx++ ) BOOST_CHECK_EQUAL( v1[i], (int)(-((((i-3*nproc)/3)+1)*1000+idx+1)) );
+  }
+
+  BOOST_CHECK_THROW( pecp.finish_synchronize("v1"), ShouldNotBeHere );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( commpattern_group_synchronization )
+{
+  // general constants in this routine
+  const int nproc=PE::Comm::instance().size();
+  const int irank=PE::Comm::instance().rank();
+
+  // commpattern
+  boost::shared_ptr<CommPattern> pecp_ptr = allocate_component<CommPattern>("CommPattern");
+  CommPattern& pecp = *pecp_ptr;
+
+  // setup gid & rank
+  std::vector<Uint> gid;
+  std::vector<Uint> rank;
+  setupGidAndRank(gid,rank);
+  pecp.insert("gid",gid,1,false);
+
+  // arrays of mixed types and strides, each synchronized once in a group and once by itself
+  std::vector<int> i1, i1_ref;
+  for(int i=0;i<6*nproc;i++) i1.push_back(-((irank+1)*1000+i+1));
+  std::vector<double> d2, d2_ref;
+  for(int i=0;i<12*nproc;i++) d2.push_back((double)((irank+1)*1000+i+1)+0.5);
+  std::vector<float> f3, f3_ref;
+  for(int i=0;i<18*nproc;i++) f3.push_back((float)((irank+1)*100+i+1)+0.25f);
+  boost::multi_array<Uint,2> u4(boost::extents[6*nproc][4]), u4_ref;
+  for(int i=0;i<6*nproc;i++)
+    for(int j=0;j<4;j++)
+      u4[i][j]=(irank+1)*10000+4*i+j;
+  i1_ref=i1; d2_ref=d2; f3_ref=f3;
+  u4_ref.resize(boost::extents[6*nproc][4]);
+  u4_ref=u4;
+
+  pecp.insert("i1",i1,1,true);
+  pecp.insert("d2",d2,2,true);
+  pecp.insert("f3",f3,3,true);
+  pecp.insert("u4",u4,true);
+  pecp.insert("i1_ref",i1_ref,1,true);
+  pecp.insert("d2_ref",d2_ref,2,true);
+  pecp.insert("f3_ref",f3_ref,3,true);
+  pecp.insert("u4_ref",u4_ref,true);
+
+  pecp.setup(Handle<CommWrapper>(pecp.get_child("gid")),rank);
+
+  std::vector<std::string> group;
+  group.push_back("i1");
+  group.push_back("d2");
+  group.push_back("f3");
+  group.push_back("u4");
+  pecp.synchronize_group(group);
+
+  pecp.synchronize("i1_ref");
+  pecp.synchronize("d2_ref");
+  pecp.synchronize("f3_ref");
+  pecp.synchronize("u4_ref");
+
+  // the ghosts received from the other ranks must match the separate synchronization
+  for(int i=0;i<6*nproc;i++)
+  {
+    BOOST_CHECK_EQUAL( i1[i], i1_ref[i] );
+    for(int j=0;j<2;j++) BOOST_CHECK_EQUAL( d2[2*i+j], d2_ref[2*i+j] );
+    for(int j=0;j<3;j++) BOOST_CHECK_EQUAL( f3[3*i+j], f3_ref[3*i+j] );
+    for(int j=0;j<4;j++) BOOST_CHECK_EQUAL( u4[i][j], u4_ref[i][j] );
+    if (rank[i]!=irank) BOOST_CHECK_EQUAL( i1[i]/1000, -(int)(rank[i]+1) );
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( commpattern_external_synchronization )
 {
 /*
@@ -0,0 +1,106 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of the point by point and batched evaluation of parsed functions"
+
+#include <iostream>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Timer.hpp"
+#include "math/VectorialFunction.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::math;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct FunctionBatchFixture
+{
+  FunctionBatchFixture()
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    // Number of points and number of repetitions, can be passed as arguments
+    nb_points = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 100000;
+    nb_repeats = argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 10;
+  }
+
+  void report(const std::string& name, const Real seconds)
+  {
+    const Real points_per_second = static_cast<Real>(nb_points*nb_repeats) / seconds;
+    std::cout << name << ": " << points_per_second << " points/s" << std::endl;
+    std::cout << "<DartMeasurement name=\"" << name << "\" type=\"numeric/double\">" << points_per_second << "</DartMeasurement>" << std::endl;
+  }
+
+  /// Time the evaluation of the function in all points, one by one and batched
+  void benchmark(const std::string& name, const std::string& functions)
+  {
+    VectorialFunction function(functions, "x,y,z,t");
+    const Uint nb_funcs = function.nbfuncs();
+
+    // Coordinates of a 3D point cloud and the time
+    std::vector<Real> vars(4*nb_points);
+    for(Uint i = 0; i != nb_points; ++i)
+    {
+      vars[4*i]   = static_cast<Real>(i % 101) / 100.;
+      vars[4*i+1] = static_cast<Real>(i % 89) / 88.;
+      vars[4*i+2] = static_cast<Real>(i % 53) / 52.;
+      vars[4*i+3] = 0.25;
+    }
+
+    std::vector<Real> scalar_result(nb_funcs*nb_points);
+    std::vector<Real> pt(4);
+    Timer scalar_timer;
+    for(Uint repeat = 0; repeat != nb_repeats; ++repeat)
+    {
+      for(Uint i = 0; i != nb_points; ++i)
+      {
+        std::copy(&vars[4*i], &vars[4*i] + 4, pt.begin());
+        const RealVector& result = function(pt);
+        for(Uint f = 0; f != nb_funcs; ++f)
+          scalar_result[nb_funcs*i+f] = result[f];
+      }
+    }
+    report(name + " pointwise", scalar_timer.elapsed());
+
+    std::vector<Real> batch_result(nb_funcs*nb_points);
+    Timer batch_timer;
+    for(Uint repeat = 0; repeat != nb_repeats; ++repeat)
+      function.evaluate_batch(&vars[0], nb_points, &batch_result[0]);
+    report(name + " batched", batch_timer.elapsed());
+
+    BOOST_CHECK(batch_result == scalar_result);
+  }
+
+  Uint nb_points;
+  Uint nb_repeats;
+};
+
+BOOST_FIXTURE_TEST_SUITE( FunctionBatchSuite, FunctionBatchFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Polynomial )
+{
+  benchmark("Polynomial", "[1 + x + 2*y*y - x*y*z + 0.5*t]");
+}
+
+BOOST_AUTO_TEST_CASE( TimeDependentVelocity )
+{
+  // Time dependent Dirichlet condition for a 3D velocity field
+  benchmark("TimeDependentVelocity", "[sin(pi*x)*cos(pi*y)*exp(-t)][-cos(pi*x)*sin(pi*y)*exp(-t)][4*z*(1-z)*(1+0.1*sin(2*pi*t))]");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,249 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of the linear system backends on an implicit heat conduction problem"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/Timer.hpp"
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+
+#include "math/Consts.hpp"
+#include "math/LSS/System.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Process local index of the grid nodes of a strip of rows: the owned nodes come first, followed by the ghost rows below and above
+struct StripNumbering
+{
+  StripNumbering(const Uint n, const Uint row_begin, const Uint row_end) :
+    n(n),
+    row_begin(row_begin),
+    row_end(row_end),
+    lower_ghosts((row_end-row_begin)*n),
+    upper_ghosts(row_begin != 0 ? lower_ghosts + n : lower_ghosts)
+  {
+  }
+
+  Uint operator()(const Uint i, const Uint j) const
+  {
+    if(j < row_begin)
+      return lower_ghosts + i;
+    if(j >= row_end)
+      return upper_ghosts + i;
+    return (j-row_begin)*n + i;
+  }
+
+  const Uint n, row_begin, row_end, lower_ghosts, upper_ghosts;
+};
+
+/// Backward Euler time stepping of the heat equation on the unit square, discretized with the 5-point stencil.
+/// The grid is split in strips of rows, one per rank.
+struct HeatFixture
+{
+  HeatFixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+    if(m_argc < 3)
+      throw common::ParsingFailed(FromHere(), "Expected arguments: matrix builder, solution strategy and optionally the number of nodes in each direction and the number of time steps");
+    matrix_builder = m_argv[1];
+    solution_strategy = m_argv[2];
+    nb_nodes = m_argc > 3 ? boost::lexical_cast<Uint>(m_argv[3]) : 200;
+    nb_steps = m_argc > 4 ? boost::lexical_cast<Uint>(m_argv[4]) : 10;
+  }
+
+  void report(const std::string& name, const Real value)
+  {
+    if(common::PE::Comm::instance().rank() == 0)
+    {
+      std::cout << name << ": " << value << std::endl;
+      std::cout << "<DartMeasurement name=\"" << name << "\" type=\"numeric/double\">" << value << "</DartMeasurement>" << std::endl;
+    }
+  }
+
+  int m_argc;
+  char** m_argv;
+  std::string matrix_builder;
+  std::string solution_strategy;
+  Uint nb_nodes;
+  Uint nb_steps;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( HeatSuite, HeatFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init_mpi )
+{
+  common::PE::Comm::instance().init(m_argc,m_argv);
+  common::Core::instance().environment().options().set("log_level", 1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( heat )
+{
+  const Uint irank = common::PE::Comm::instance().rank();
+  const Uint nproc = common::PE::Comm::instance().size();
+  const Uint n = nb_nodes;
+
+  // Rows of the grid owned by this rank, and the ghost rows on either side
+  const Uint row_begin = (n*irank)/nproc;
+  const Uint row_end = (n*(irank+1))/nproc;
+  const Uint nb_owned = (row_end - row_begin)*n;
+
+  std::vector<Uint> gids, ranks;
+  for(Uint j = row_begin; j != row_end; ++j)
+  {
+    for(Uint i = 0; i != n; ++i)
+    {
+      gids.push_back(j*n + i);
+      ranks.push_back(irank);
+    }
+  }
+  if(row_begin != 0)
+  {
+    for(Uint i = 0; i != n; ++i)
+    {
+      gids.push_back((row_begin-1)*n + i);
+      ranks.push_back(irank-1);
+    }
+  }
+  if(row_end != n)
+  {
+    for(Uint i = 0; i != n; ++i)
+    {
+      gids.push_back(row_end*n + i);
+      ranks.push_back(irank+1);
+    }
+  }
+  const Uint nb_local = gids.size();
+
+  const StripNumbering numbering(n, row_begin, row_end);
+
+  std::vector<Uint> node_connectivity, starting_indices;
+  starting_indices.push_back(0);
+  for(Uint j = row_begin; j != row_end; ++j)
+  {
+    for(Uint i = 0; i != n; ++i)
+    {
+      if(j != 0) node_connectivity.push_back(numbering(i, j-1));
+      if(i != 0) node_connectivity.push_back(numbering(i-1, j));
+      node_connectivity.push_back(numbering(i, j));
+      if(i != n-1) node_connectivity.push_back(numbering(i+1, j));
+      if(j != n-1) node_connectivity.push_back(numbering(i, j+1));
+      starting_indices.push_back(node_connectivity.size());
+    }
+  }
+  for(Uint ghost = nb_owned; ghost != nb_local; ++ghost)
+  {
+    node_connectivity.push_back(ghost);
+    starting_indices.push_back(node_connectivity.size());
+  }
+
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  cp.insert("gid", gids, 1, false);
+  cp.setup(Handle<common::PE::CommWrapper>(cp.get_child("gid")), ranks);
+
+  boost::shared_ptr<LSS::System> sys = common::allocate_component<LSS::System>("sys");
+  sys->options().option("matrix_builder").change_value(matrix_builder);
+  sys->options().option("solution_strategy").change_value(solution_strategy);
+
+  common::Timer timer;
+  sys->create(cp, 1, node_connectivity, starting_indices);
+  report("Create", timer.elapsed());
+
+  const Real h = 1. / static_cast<Real>(n-1);
+  const Real dt = 0.25*h;
+  const Real diagonal = 1./dt + 4./(h*h);
+  const Real offdiagonal = -1./(h*h);
+
+  // Initial condition, which decays without changing shape
+  std::vector<Real> temperature(nb_owned);
+  for(Uint j = row_begin; j != row_end; ++j)
+    for(Uint i = 0; i != n; ++i)
+      temperature[(j-row_begin)*n + i] = std::sin(math::Consts::pi()*i*h) * std::sin(math::Consts::pi()*j*h);
+
+  Real assembly_time = 0.;
+  Real solve_time = 0.;
+  for(Uint step = 0; step != nb_steps; ++step)
+  {
+    timer.restart();
+    sys->reset();
+    for(Uint row = 0; row != nb_owned; ++row)
+    {
+      for(Uint k = starting_indices[row]; k != starting_indices[row+1]; ++k)
+        sys->matrix()->add_value(node_connectivity[k], row, node_connectivity[k] == row ? diagonal : offdiagonal);
+      sys->rhs()->set_value(row, temperature[row] / dt);
+    }
+    for(Uint j = row_begin; j != row_end; ++j)
+    {
+      for(Uint i = 0; i != n; ++i)
+      {
+        if(i == 0 || j == 0 || i == n-1 || j == n-1)
+          sys->dirichlet(numbering(i, j), 0, 0.);
+      }
+    }
+    assembly_time += timer.elapsed();
+
+    timer.restart();
+    sys->solve();
+    solve_time += timer.elapsed();
+
+    for(Uint row = 0; row != nb_owned; ++row)
+      sys->solution()->get_value(row, temperature[row]);
+  }
+
+  report("Assembly", assembly_time);
+  report("Solve", solve_time);
+  report("SolvePerStep", solve_time / static_cast<Real>(nb_steps));
+
+  // Each step of the discrete problem damps the initial mode by the same factor
+  const Real eigenvalue = 4./(h*h) * (1. - std::cos(math::Consts::pi()*h));
+  const Real decay = std::pow(1. / (1. + dt*eigenvalue), static_cast<Real>(nb_steps));
+  for(Uint j = row_begin; j != row_end; ++j)
+  {
+    for(Uint i = 0; i != n; ++i)
+    {
+      const Real expected = decay * std::sin(math::Consts::pi()*i*h) * std::sin(math::Consts::pi()*j*h);
+      BOOST_CHECK_SMALL(temperature[(j-row_begin)*n + i] - expected, 1e-4);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize_mpi )
+{
+  common::PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
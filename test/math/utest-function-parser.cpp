@@ -11,6 +11,8 @@
 
 #include <boost/assign/list_of.hpp>
 
+#include "math/AnalyticalFunction.hpp"
+#include "math/BatchFunctionParser.hpp"
 #include "math/VectorialFunction.hpp"
 
 using namespace std;
@@ -26,6 +28,49 @@ struct FunctionParser_Fixture
   FunctionParser_Fixture() {}
 
   ~FunctionParser_Fixture() {}
+
+  /// Points x,y,t covering the domain [-2,2]x[-2,2], including the origin and the unit circle
+  static std::vector<Real> points(const Uint nb_points)
+  {
+    std::vector<Real> result(3*nb_points);
+    for(Uint i = 0; i != nb_points; ++i)
+    {
+      result[3*i]   = -2. + 4.*static_cast<Real>(i % 17) / 16.;
+      result[3*i+1] = -2. + 4.*static_cast<Real>(i % 13) / 12.;
+      result[3*i+2] = 0.1*static_cast<Real>(i);
+    }
+    return result;
+  }
+
+  /// Check that the batch evaluation gives the same result as Eval in every point
+  static void check_batch(const std::string& function)
+  {
+    BOOST_TEST_CHECKPOINT(function);
+    BatchFunctionParser parser;
+    BOOST_REQUIRE_EQUAL(parser.Parse(function, "x,y,t"), -1);
+
+    // not a multiple of the block size, to have a partial last block
+    const Uint nb_points = 3*BatchFunctionParser::BLOCK_SIZE + 5;
+    const std::vector<Real> vars = points(nb_points);
+    std::vector<Real> batch_result(2*nb_points, -1.);
+    parser.eval_batch(&vars[0], nb_points, &batch_result[0], 2);
+
+    int first_error = 0;
+    for(Uint i = 0; i != nb_points; ++i)
+    {
+      const Real scalar_result = parser.Eval(&vars[3*i]);
+      if(first_error == 0)
+        first_error = parser.EvalError();
+      // negative numbers to a fractional power give NaN in both cases
+      if(scalar_result != scalar_result)
+        BOOST_CHECK(batch_result[2*i] != batch_result[2*i]);
+      else
+        BOOST_CHECK_EQUAL(batch_result[2*i], scalar_result);
+      BOOST_CHECK_EQUAL(batch_result[2*i+1], -1.);
+    }
+    parser.eval_batch(&vars[0], nb_points, &batch_result[0], 2);
+    BOOST_CHECK_EQUAL(parser.EvalError(), first_error);
+  }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -82,6 +127,48 @@ BOOST_AUTO_TEST_CASE( function_2 )
 }
 
 
+BOOST_AUTO_TEST_CASE( batch_evaluation )
+{
+  // straight-line functions, evaluated for a whole block at once
+  check_batch("x*y + 3*t - 1");
+  check_batch("sin(x)*cos(y) + exp(-t) + atan2(y,x) + hypot(x,y)");
+  check_batch("sqrt(x*x + y*y)^1.5 + abs(x) - min(x,y) + max(x,t)");
+  check_batch("floor(x) + ceil(y) + int(x*y) + trunc(t) + x%1.5");
+  check_batch("(x<y) + (x>=y)*2 + (x=y)*4 + (x!=t) + (x<0 & y>0) + (x>1 | y<-1) + !x");
+  check_batch("cosh(x) + sinh(y) + tanh(t) + asinh(x) + cbrt(y) + exp2(x) + sin(x)^2 + cos(x)^2");
+  // functions where some points fail
+  check_batch("1/x + y/(x*y)");
+  check_batch("sqrt(x) + log(y) + log10(x+1) + log2(y*y)");
+  check_batch("acos(x) + asin(y) + acosh(y) + atanh(x/2)");
+  check_batch("x^y + x^(-1) + y^0.5");
+  check_batch("cot(x) + csc(y) + sec(x) + 1/sqrt(y)");
+  // conditions, evaluated point by point
+  check_batch("if(x<0, -x, sqrt(x)) + if(y>t, 1, 2)");
+}
+
+BOOST_AUTO_TEST_CASE( batch_functions )
+{
+  const Uint nb_points = 100;
+  const std::vector<Real> vars = points(nb_points);
+
+  VectorialFunction vectorial("[x+y][x*t][sin(y)]","x,y,t");
+  std::vector<Real> vectorial_result(3*nb_points);
+  vectorial.evaluate_batch(&vars[0], nb_points, &vectorial_result[0]);
+
+  AnalyticalFunction analytical("x*y-t", "x,y,t");
+  std::vector<Real> analytical_result(nb_points);
+  analytical.evaluate_batch(&vars[0], nb_points, &analytical_result[0]);
+
+  for(Uint i = 0; i != nb_points; ++i)
+  {
+    const std::vector<Real> pt(vars.begin()+3*i, vars.begin()+3*i+3);
+    RealVector r = vectorial(pt);
+    BOOST_CHECK_EQUAL(vectorial_result[3*i], r[0]);
+    BOOST_CHECK_EQUAL(vectorial_result[3*i+1], r[1]);
+    BOOST_CHECK_EQUAL(vectorial_result[3*i+2], r[2]);
+    BOOST_CHECK_EQUAL(analytical_result[i], analytical(pt));
+  }
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -1131,6 +1131,160 @@ BOOST_AUTO_TEST_CASE( solve_system_laplacian )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( value_positions_and_freeze )
+{
+  // build a commpattern and the system
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  sys->options().option("matrix_builder").change_value(matrix_builder);
+  build_system(*sys,cp);
+  Handle<LSS::Matrix> mat=sys->matrix();
+
+  std::vector<Uint> cols, rows;
+  std::vector<Real> vals, ref_vals;
+
+  LSS::BlockAccumulator ba;
+  ba.resize(3,neq);
+  for (int i=0; i<ba.mat.size(); i++) ba.mat.data()[i]=i+1.;
+  if (irank==0)
+  {
+    ba.indices[0]=1;
+    ba.indices[1]=3;
+    ba.indices[2]=5;
+  } else {
+    ba.indices[0]=5;
+    ba.indices[1]=2;
+    ba.indices[2]=8;
+  }
+
+  // reference, using the index lookups
+  mat->reset();
+  mat->add_values(ba);
+  mat->add_values(ba);
+  mat->debug_data(rows,cols,ref_vals);
+
+  // same result when adding at the precomputed positions
+  mat->reset();
+  std::vector<int> positions(ba.mat.size());
+  const bool has_positions = mat->value_positions(ba,&positions[0]);
+  if (matrix_builder == "cf3.math.LSS.TrilinosCrsMatrix")
+    BOOST_CHECK(has_positions);
+  if (has_positions)
+  {
+    mat->add_values_at(ba,&positions[0]);
+    mat->add_values_at(ba,&positions[0]);
+  } else {
+    mat->add_values(ba);
+    mat->add_values(ba);
+  }
+  mat->debug_data(rows,cols,vals);
+  BOOST_CHECK(vals == ref_vals);
+
+  // a frozen matrix is left untouched by the system
+  mat->freeze(true);
+  BOOST_CHECK(mat->is_frozen());
+  sys->reset(1.);
+  sys->add_values(ba);
+  sys->dirichlet(ba.indices[1],0,2.);
+  mat->debug_data(rows,cols,vals);
+  BOOST_CHECK(vals == ref_vals);
+  sys->rhs()->debug_data(vals);
+  BOOST_CHECK_EQUAL(vals[ba.indices[1]*neq],2.);
+  mat->freeze(false);
+  sys->reset(1.);
+  mat->debug_data(rows,cols,vals);
+  BOOST_FOREACH(Real v, vals) BOOST_CHECK_EQUAL(v,1.);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( fixed_block_accumulator )
+{
+  // build a commpattern and the system
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  sys->options().option("matrix_builder").change_value(matrix_builder);
+  build_system(*sys,cp);
+  Handle<LSS::Matrix> mat=sys->matrix();
+  Handle<LSS::Vector> rhs=sys->rhs();
+
+  std::vector<Uint> cols, rows;
+  std::vector<Real> vals, ref_vals;
+
+  // the fixture uses two equations
+  BOOST_CHECK_EQUAL(neq,2);
+  LSS::FixedBlockAccumulator<3,2> fixed_ba;
+  BOOST_CHECK_EQUAL(fixed_ba.size(),6);
+  BOOST_CHECK_EQUAL(fixed_ba.block_size(),3);
+  for (int i=0; i<fixed_ba.mat.size(); i++) fixed_ba.mat.data()[i]=i+1.;
+  for (int i=0; i<fixed_ba.rhs.size(); i++) fixed_ba.rhs[i]=i+1.;
+  std::vector<Uint> indices(3);
+  if (irank==0)
+  {
+    indices[0]=1;
+    indices[1]=3;
+    indices[2]=5;
+  } else {
+    indices[0]=5;
+    indices[1]=2;
+    indices[2]=8;
+  }
+  fixed_ba.neighbour_indices(indices);
+
+  LSS::BlockAccumulator ba;
+  fixed_ba.copy_to(ba);
+  BOOST_CHECK_EQUAL(ba.size(),6);
+  BOOST_CHECK(ba.indices == indices);
+  BOOST_CHECK(ba.mat == fixed_ba.mat);
+
+  // reference, using the dynamic block accumulator
+  sys->reset();
+  mat->add_values(ba);
+  rhs->add_rhs_values(ba);
+  mat->debug_data(rows,cols,ref_vals);
+  std::vector<Real> ref_rhs;
+  rhs->debug_data(ref_rhs);
+
+  // same result with the fixed size version
+  sys->reset();
+  mat->add_values(fixed_ba);
+  rhs->add_rhs_values(fixed_ba);
+  mat->debug_data(rows,cols,vals);
+  BOOST_CHECK(vals == ref_vals);
+  rhs->debug_data(vals);
+  BOOST_CHECK(vals == ref_rhs);
+
+  // set_values and set_rhs_values, reference first
+  sys->reset(1.);
+  mat->set_values(ba);
+  rhs->set_rhs_values(ba);
+  mat->debug_data(rows,cols,ref_vals);
+  rhs->debug_data(ref_rhs);
+
+  sys->reset(1.);
+  mat->set_values(fixed_ba);
+  rhs->set_rhs_values(fixed_ba);
+  mat->debug_data(rows,cols,vals);
+  BOOST_CHECK(vals == ref_vals);
+  rhs->debug_data(vals);
+  BOOST_CHECK(vals == ref_rhs);
+
+  // get_sol_values reads the same entries for both accumulators
+  Handle<LSS::Vector> sol=sys->solution();
+  sol->set_rhs_values(ba);
+  ba.sol.setZero();
+  fixed_ba.sol.setZero();
+  sol->get_sol_values(ba);
+  sol->get_sol_values(fixed_ba);
+  for (int i=0; i<fixed_ba.sol.size(); i++) BOOST_CHECK_EQUAL(fixed_ba.sol[i],ba.sol[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( finalize_mpi )
 {
   CFinfo.setFilterRankZero(true);
@@ -78,6 +78,9 @@ BOOST_AUTO_TEST_CASE( system_solve )
   boost::shared_ptr<LSS::System> sys_ptr = common::allocate_component<LSS::System>("system");
   LSS::System& sys = *sys_ptr;
   sys.options().option("matrix_builder").change_value(boost::lexical_cast<std::string>(m_argv[1]));
+  // optional second argument: builder name for the solution strategy
+  if(m_argc > 2)
+    sys.options().option("solution_strategy").change_value(boost::lexical_cast<std::string>(m_argv[2]));
   sys.create(cp,m.nbeqs,m.column_indices,m.rowstart_positions);
   sys.reset();
 
@@ -0,0 +1,414 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+//
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the native matrix, vector and solvers of cf3::math::LSS"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+#include <boost/assign/std/vector.hpp>
+#include <boost/foreach.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+
+#include "math/LSS/System.hpp"
+#include "math/LSS/SolutionStrategy.hpp"
+#include "math/LSS/Native/NativeCrsMatrix.hpp"
+#include "math/LSS/Native/NativeVector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace boost::assign;
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct LSSNativeFixture
+{
+  /// common setup for each test case
+  LSSNativeFixture() :
+    irank(0),
+    nproc(1),
+    nb_global_nodes(40)
+  {
+    if (common::PE::Comm::instance().is_initialized())
+    {
+      nproc=common::PE::Comm::instance().size();
+      irank=common::PE::Comm::instance().rank();
+      BOOST_CHECK_EQUAL(nproc,2);
+    }
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Build a system for the 1D laplacian tridiag(-1, 2, -1), split in two halves. Each rank has one ghost,
+  /// which is stored after the owned nodes.
+  void build_laplacian(LSS::System& sys, common::PE::CommPattern& cp)
+  {
+    const Uint nb_owned = nb_global_nodes/2;
+    gid.clear();
+    rank_updatable.clear();
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      gid.push_back(irank*nb_owned + i);
+      rank_updatable.push_back(irank);
+    }
+    gid.push_back(irank == 0 ? nb_owned : nb_owned-1);
+    rank_updatable.push_back(1-irank);
+    cp.insert("gid",gid,1,false);
+    cp.setup(Handle<common::PE::CommWrapper>(cp.get_child("gid")),rank_updatable);
+
+    const Uint ghost = nb_owned;
+    std::vector<Uint> node_connectivity, starting_indices;
+    starting_indices.push_back(0);
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      const Uint left = i == 0 ? (irank == 1 ? ghost : i) : i-1;
+      const Uint right = i == nb_owned-1 ? (irank == 0 ? ghost : i) : i+1;
+      if(left != i)
+        node_connectivity.push_back(left);
+      node_connectivity.push_back(i);
+      if(right != i)
+        node_connectivity.push_back(right);
+      starting_indices.push_back(node_connectivity.size());
+    }
+    node_connectivity.push_back(ghost);
+    starting_indices.push_back(node_connectivity.size());
+
+    sys.options().option("matrix_builder").change_value(std::string("cf3.math.LSS.NativeCrsMatrix"));
+    sys.options().option("solution_strategy").change_value(std::string("cf3.math.LSS.NativeStrategy"));
+    sys.create(cp,1,node_connectivity,starting_indices);
+    sys.reset();
+
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      for(Uint j = starting_indices[i]; j != starting_indices[i+1]; ++j)
+        sys.matrix()->set_value(node_connectivity[j], i, node_connectivity[j] == i ? 2. : -1.);
+    }
+  }
+
+  /// Value of the exact solution at the given global node
+  Real exact(const Uint global_node) const
+  {
+    return 1. + 0.5*global_node - 0.01*global_node*global_node;
+  }
+
+  /// Laplacian of the exact solution, i.e. the RHS of the test system, at the given global node
+  Real laplacian(const Uint global_node) const
+  {
+    Real result = 2.*exact(global_node);
+    if(global_node != 0)
+      result -= exact(global_node-1);
+    if(global_node != nb_global_nodes-1)
+      result -= exact(global_node+1);
+    return result;
+  }
+
+  int irank;
+  int nproc;
+  int m_argc;
+  char** m_argv;
+
+  const Uint nb_global_nodes;
+  std::vector<Uint> gid;
+  std::vector<Uint> rank_updatable;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( LSSNativeSuite, LSSNativeFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init_mpi )
+{
+  common::PE::Comm::instance().init(m_argc,m_argv);
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().is_active(),true);
+  common::Core::instance().environment().options().set("exception_backtrace", false);
+  common::Core::instance().environment().options().set("exception_outputs", false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( atomic_access )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  build_laplacian(*sys, cp);
+
+  Handle<LSS::Matrix> mat = sys->matrix();
+  BOOST_CHECK_EQUAL(mat->solvertype(), std::string("Native"));
+  BOOST_CHECK_EQUAL(sys->solution()->derived_type_name(), std::string("cf3.math.LSS.NativeVector"));
+  BOOST_CHECK_EQUAL(mat->blockrow_size(), nb_global_nodes/2);
+  BOOST_CHECK_EQUAL(mat->blockcol_size(), nb_global_nodes/2+1);
+
+  const Uint ghost = nb_global_nodes/2;
+  const Uint boundary = irank == 0 ? ghost-1 : 0;
+
+  // Entries in the sparsity pattern
+  Real value;
+  mat->get_value(boundary, boundary, value);
+  BOOST_CHECK_EQUAL(value, 2.);
+  mat->get_value(ghost, boundary, value);
+  BOOST_CHECK_EQUAL(value, -1.);
+  mat->add_value(ghost, boundary, 0.5);
+  mat->get_value(ghost, boundary, value);
+  BOOST_CHECK_EQUAL(value, -0.5);
+
+  // Ghost rows and entries outside the pattern are not accessible
+  BOOST_CHECK_THROW(mat->get_value(ghost, ghost, value), common::BadValue);
+  BOOST_CHECK_THROW(mat->set_value(irank == 0 ? boundary-5 : boundary+5, boundary, 1.), common::BadValue);
+
+  // Block access, with the ghost row being ignored
+  LSS::BlockAccumulator ba;
+  ba.resize(2,1);
+  ba.indices[0] = boundary;
+  ba.indices[1] = ghost;
+  ba.mat << 1., 2.,
+            3., 4.;
+  mat->set_values(ba);
+  mat->add_values(ba);
+  ba.reset(-1.);
+  mat->get_values(ba);
+  BOOST_CHECK_EQUAL(ba.mat(0,0), 2.);
+  BOOST_CHECK_EQUAL(ba.mat(0,1), 4.);
+  BOOST_CHECK_EQUAL(ba.mat(1,0), 0.);
+  BOOST_CHECK_EQUAL(ba.mat(1,1), 0.);
+
+  // Diagonal
+  std::vector<Real> diag(ghost+1, 3.);
+  mat->set_diagonal(diag);
+  mat->add_diagonal(diag);
+  mat->get_diagonal(diag);
+  BOOST_CHECK_EQUAL(diag.size(), ghost+1);
+  for(Uint i = 0; i != ghost; ++i)
+    BOOST_CHECK_EQUAL(diag[i], 6.);
+  BOOST_CHECK_EQUAL(diag[ghost], 0.);
+
+  // Dirichlet row
+  mat->set_row(boundary, 0, 1., 0.);
+  mat->get_value(boundary, boundary, value);
+  BOOST_CHECK_EQUAL(value, 1.);
+  mat->get_value(ghost, boundary, value);
+  BOOST_CHECK_EQUAL(value, 0.);
+
+  // Debug data has one entry per stored value, in process local numbering
+  std::vector<Uint> rows, cols;
+  std::vector<Real> vals;
+  mat->debug_data(rows, cols, vals);
+  BOOST_CHECK_EQUAL(vals.size(), 3*ghost - 1);
+  for(Uint i = 0; i != rows.size(); ++i)
+    BOOST_CHECK(rows[i] < ghost);
+
+  // Vector access and synchronization
+  Handle<LSS::Vector> sol = sys->solution();
+  for(Uint i = 0; i != ghost; ++i)
+    sol->set_value(i, gid[i]);
+  sol->set_value(ghost, -1.);
+  sol->sync();
+  sol->get_value(ghost, value);
+  BOOST_CHECK_EQUAL(value, static_cast<Real>(gid[ghost]));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( symmetric_dirichlet )
+{
+  // Same system and expectations as utest-lss-symmetric-dirichlet
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  if (irank==0)
+  {
+    gid += 0,1,2;
+    rank_updatable += 0,0,1;
+  } else {
+    gid += 1,2,3;
+    rank_updatable += 0,1,1;
+  }
+  cp.insert("gid",gid,1,false);
+  cp.setup(Handle<common::PE::CommWrapper>(cp.get_child("gid")),rank_updatable);
+
+  std::vector<Uint> node_connectivity, starting_indices;
+  node_connectivity += 0,1,0,1,2,1,2;
+  starting_indices += 0,2,5,7;
+
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  sys->options().option("matrix_builder").change_value(std::string("cf3.math.LSS.NativeCrsMatrix"));
+  sys->options().option("solution_strategy").change_value(std::string("cf3.math.LSS.NativeStrategy"));
+  sys->create(cp,1,node_connectivity,starting_indices);
+  sys->reset();
+
+  sys->matrix()->set_row(0, 0, 2, 1);
+  sys->matrix()->set_row(1, 0, 2, 1);
+  sys->matrix()->set_row(2, 0, 2, 1);
+
+  if(irank == 0)
+    sys->matrix()->symmetric_dirichlet(1, 0, 10., *sys->rhs());
+  else
+    sys->matrix()->symmetric_dirichlet(0, 0, 10., *sys->rhs());
+
+  Real val;
+  if(irank == 0)
+  {
+    sys->matrix()->get_value(0, 0, val);
+    BOOST_CHECK_EQUAL(val, 2.);
+    sys->matrix()->get_value(1, 0, val);
+    BOOST_CHECK_EQUAL(val, 0.);
+    sys->matrix()->get_value(0, 1, val);
+    BOOST_CHECK_EQUAL(val, 0.);
+    sys->matrix()->get_value(1, 1, val);
+    BOOST_CHECK_EQUAL(val, 1.);
+    sys->matrix()->get_value(2, 1, val);
+    BOOST_CHECK_EQUAL(val, 0.);
+
+    sys->rhs()->get_value(0, val);
+    BOOST_CHECK_EQUAL(val, -10.);
+    sys->rhs()->get_value(1, val);
+    BOOST_CHECK_EQUAL(val, 10.);
+  }
+  else
+  {
+    sys->matrix()->get_value(0, 1, val);
+    BOOST_CHECK_EQUAL(val, 0.);
+    sys->matrix()->get_value(1, 1, val);
+    BOOST_CHECK_EQUAL(val, 2.);
+    sys->matrix()->get_value(2, 1, val);
+    BOOST_CHECK_EQUAL(val, 1.);
+    sys->matrix()->get_value(1, 2, val);
+    BOOST_CHECK_EQUAL(val, 1.);
+    sys->matrix()->get_value(2, 2, val);
+    BOOST_CHECK_EQUAL(val, 2.);
+
+    sys->rhs()->get_value(0, val);
+    BOOST_CHECK_EQUAL(val, 10.);
+    sys->rhs()->get_value(1, val);
+    BOOST_CHECK_EQUAL(val, -10.);
+    sys->rhs()->get_value(2, val);
+    BOOST_CHECK_EQUAL(val, 0.);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( apply )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  build_laplacian(*sys, cp);
+
+  const Uint nb_owned = nb_global_nodes/2;
+  Handle<LSS::Vector> x = sys->solution();
+  Handle<LSS::Vector> y = sys->rhs();
+
+  // Only the owned values are set, the ghost is updated by apply
+  for(Uint i = 0; i != nb_owned; ++i)
+  {
+    x->set_value(i, exact(gid[i]));
+    y->set_value(i, 1.);
+  }
+
+  // The test matrix is small, so allow threads for any number of entries
+  sys->matrix()->options().set("min_thread_entries", 1u);
+  for(Uint nb_threads = 1; nb_threads != 4; ++nb_threads)
+  {
+    sys->matrix()->options().set("nb_threads", nb_threads);
+
+    // y = A*x
+    sys->matrix()->apply(y, x);
+    Real value;
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      y->get_value(i, value);
+      BOOST_CHECK_CLOSE(value, laplacian(gid[i]), 1e-10);
+    }
+
+    // y = 2*A*x - 3*y = -A*x
+    sys->matrix()->apply(y, x, 2., -3.);
+    for(Uint i = 0; i != nb_owned; ++i)
+    {
+      y->get_value(i, value);
+      BOOST_CHECK_CLOSE(value, -laplacian(gid[i]), 1e-10);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( solve )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  build_laplacian(*sys, cp);
+
+  const Uint nb_owned = nb_global_nodes/2;
+  for(Uint i = 0; i != nb_owned; ++i)
+    sys->rhs()->set_value(i, laplacian(gid[i]));
+
+  Handle<LSS::SolutionStrategy> strategy = sys->solution_strategy();
+  strategy->options().set("tolerance", 1e-10);
+
+  std::vector<std::string> solvers, preconditioners;
+  solvers += "CG", "BiCGStab", "GMRES";
+  preconditioners += "None", "Jacobi", "ILU0";
+  BOOST_FOREACH(const std::string& solver, solvers)
+  {
+    BOOST_FOREACH(const std::string& preconditioner, preconditioners)
+    {
+      strategy->options().set("solver", solver);
+      strategy->options().set("preconditioner", preconditioner);
+      sys->solution()->reset();
+      sys->solve();
+
+      BOOST_CHECK(strategy->properties().value<Uint>("iterations") > 0);
+      BOOST_CHECK(strategy->properties().value<Real>("relative_residual") < 1e-10);
+
+      // Owned values and the ghost are up to date
+      Real value;
+      for(Uint i = 0; i != nb_owned+1; ++i)
+      {
+        sys->solution()->get_value(i, value);
+        BOOST_CHECK_CLOSE(value, exact(gid[i]), 1e-6);
+      }
+    }
+  }
+
+  // Convergence across a restart
+  strategy->options().set("solver", std::string("GMRES"));
+  strategy->options().set("preconditioner", std::string("ILU0"));
+  strategy->options().set("gmres_restart", 2u);
+  sys->solution()->reset();
+  sys->solve();
+  BOOST_CHECK(strategy->properties().value<Uint>("iterations") > 2);
+  BOOST_CHECK(strategy->properties().value<Real>("relative_residual") < 1e-10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize_mpi )
+{
+  common::PE::Comm::instance().finalize();
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().is_active(),false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,67 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::math::radix_sort"
+
+#include <algorithm>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "math/RadixSort.hpp"
+
+using namespace cf3;
+using namespace cf3::math;
+
+BOOST_AUTO_TEST_SUITE( math_radix_sort_test_suite )
+
+BOOST_AUTO_TEST_CASE( empty )
+{
+  std::vector<boost::uint64_t> keys;
+  std::vector<Uint> permutation(3);
+  radix_sort(keys, permutation);
+  BOOST_CHECK(permutation.empty());
+}
+
+BOOST_AUTO_TEST_CASE( random_keys )
+{
+  // Keys spanning all 64 bits, with many duplicates in the low bits
+  boost::mt19937 generator(1);
+  boost::variate_generator< boost::mt19937&, boost::uniform_int<boost::uint64_t> > random(generator, boost::uniform_int<boost::uint64_t>(0, 1000));
+  std::vector<boost::uint64_t> keys(10000);
+  for(Uint i = 0; i != keys.size(); ++i)
+    keys[i] = (random() << 54) | (random() % 7);
+
+  std::vector<Uint> permutation;
+  radix_sort(keys, permutation);
+  BOOST_REQUIRE_EQUAL(permutation.size(), keys.size());
+
+  std::vector<bool> found(keys.size(), false);
+  found[permutation[0]] = true;
+  for(Uint i = 1; i != permutation.size(); ++i)
+  {
+    BOOST_CHECK(keys[permutation[i-1]] <= keys[permutation[i]]);
+    // Equal keys keep their order
+    if(keys[permutation[i-1]] == keys[permutation[i]])
+      BOOST_CHECK(permutation[i-1] < permutation[i]);
+    found[permutation[i]] = true;
+  }
+  BOOST_CHECK(std::find(found.begin(), found.end(), false) == found.end());
+}
+
+BOOST_AUTO_TEST_CASE( equal_keys )
+{
+  std::vector<boost::uint64_t> keys(5, 42);
+  std::vector<Uint> permutation;
+  radix_sort(keys, permutation);
+  for(Uint i = 0; i != keys.size(); ++i)
+    BOOST_CHECK_EQUAL(permutation[i], i);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
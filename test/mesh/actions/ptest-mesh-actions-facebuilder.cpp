@@ -0,0 +1,134 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of mesh::actions::BuildFaces on a hexahedral mesh"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/Timer.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Entities.hpp"
+#include "mesh/FaceCellConnectivity.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+#include "mesh/Tags.hpp"
+#include "mesh/actions/BuildFaces.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::mesh::actions;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct FaceBuilderBenchmarkFixture
+{
+  FaceBuilderBenchmarkFixture() :
+    root( Core::instance().root() )
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    // Number of cells in each direction, can be passed as first argument
+    nb_cells = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 30;
+  }
+
+  /// Generate a box of nb_cells^3 hexahedra and build its faces with the given number of threads
+  Mesh& build_faces(const std::string& name, const Uint nb_threads)
+  {
+    Mesh& mesh = *root.create_component<Mesh>(name);
+    Handle<SimpleMeshGenerator> generator = root.create_component<SimpleMeshGenerator>("generator_" + name);
+    generator->options().set("nb_cells", std::vector<Uint>(3, nb_cells));
+    generator->options().set("lengths", std::vector<Real>(3, 1.));
+    generator->options().set("mesh", mesh.uri());
+    generator->execute();
+
+    Handle<BuildFaces> facebuilder = root.create_component<BuildFaces>("facebuilder_" + name);
+    facebuilder->options().set("nb_threads", nb_threads);
+
+    Timer timer;
+    facebuilder->transform(mesh);
+    const Real elapsed = timer.elapsed();
+    std::cout << "BuildFaces with " << nb_threads << " threads: " << elapsed << " s for " << nb_cells*nb_cells*nb_cells << " cells" << std::endl;
+    std::cout << "<DartMeasurement name=\"BuildFaces " << nb_threads << " threads\" type=\"numeric/double\">" << elapsed << "</DartMeasurement>" << std::endl;
+
+    return mesh;
+  }
+
+  /// Total number of faces with the given tag
+  Uint count_faces(Mesh& mesh, const std::string& tag)
+  {
+    Uint result = 0;
+    boost_foreach(const Entities& faces, find_components_recursively_with_tag<Entities>(mesh.topology(), tag))
+      result += faces.size();
+    return result;
+  }
+
+  /// Check the number of faces in a box of nb_cells^3 hexahedra
+  void check_counts(Mesh& mesh)
+  {
+    BOOST_CHECK_EQUAL(count_faces(mesh, mesh::Tags::inner_faces()), 3*nb_cells*nb_cells*(nb_cells-1));
+    BOOST_CHECK_EQUAL(count_faces(mesh, mesh::Tags::bdry_faces()), 6*nb_cells*nb_cells);
+  }
+
+  Component& root;
+  Uint nb_cells;
+};
+
+BOOST_FIXTURE_TEST_SUITE( FaceBuilderBenchmarkSuite, FaceBuilderBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK_EQUAL(PE::Comm::instance().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( Threads )
+{
+  Mesh& serial_mesh = build_faces("serial", 1);
+  check_counts(serial_mesh);
+
+  Mesh& threaded_mesh = build_faces("threaded", 2);
+  check_counts(threaded_mesh);
+
+  // The face numbering must not depend on the number of threads
+  std::vector< Handle<FaceCellConnectivity> > serial_f2c, threaded_f2c;
+  boost_foreach(FaceCellConnectivity& f2c, find_components_recursively<FaceCellConnectivity>(serial_mesh.topology()))
+    serial_f2c.push_back(f2c.handle<FaceCellConnectivity>());
+  boost_foreach(FaceCellConnectivity& f2c, find_components_recursively<FaceCellConnectivity>(threaded_mesh.topology()))
+    threaded_f2c.push_back(f2c.handle<FaceCellConnectivity>());
+  BOOST_REQUIRE_EQUAL(serial_f2c.size(), threaded_f2c.size());
+  for(Uint i = 0; i != serial_f2c.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(serial_f2c[i]->size(), threaded_f2c[i]->size());
+    for(Uint face = 0; face != serial_f2c[i]->size(); ++face)
+    {
+      BOOST_CHECK(serial_f2c[i]->face_number()[face] == threaded_f2c[i]->face_number()[face]);
+      BOOST_CHECK(serial_f2c[i]->is_bdry_face()[face] == threaded_f2c[i]->is_bdry_face()[face]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,230 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of mesh::actions::LocalRenumbering on a scrambled hexahedral mesh"
+
+#include <algorithm>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/CompressedTable.hpp"
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/OptionList.hpp"
+#include "common/Timer.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/actions/LocalRenumbering.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::mesh::actions;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct LocalRenumberingBenchmarkFixture
+{
+  LocalRenumberingBenchmarkFixture() :
+    root( Core::instance().root() )
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    // Number of cells in each direction and number of repetitions, can be passed as arguments
+    nb_cells = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 40;
+    nb_repeats = argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 20;
+  }
+
+  void report(const std::string& name, const Real value)
+  {
+    std::cout << name << ": " << value << std::endl;
+    std::cout << "<DartMeasurement name=\"" << name << "\" type=\"numeric/double\">" << value << "</DartMeasurement>" << std::endl;
+  }
+
+  /// Element loop that gathers the nodal values and coordinates of each cell and scatters a result back to the nodes,
+  /// as a finite element assembly does. Returns the sum of the result.
+  Real assembly(Mesh& mesh, const std::string& label)
+  {
+    Dictionary& geometry = mesh.geometry_fields();
+    const Field& coords = geometry.coordinates();
+    const Field& u = *Handle<Field>(geometry.get_child("u"));
+    Field& residual = *Handle<Field>(geometry.get_child("residual"));
+
+    Timer timer;
+    for(Uint repeat = 0; repeat != nb_repeats; ++repeat)
+    {
+      for(Uint i = 0; i != residual.size(); ++i)
+        residual[i][0] = 0.;
+      boost_foreach(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+      {
+        const Connectivity& connectivity = elements.geometry_space().connectivity();
+        const Uint nb_elems = connectivity.size();
+        const Uint nb_elem_nodes = connectivity.row_size();
+        for(Uint elem = 0; elem != nb_elems; ++elem)
+        {
+          const Connectivity::ConstRow nodes = connectivity[elem];
+          Real mean = 0.;
+          Real weight = 0.;
+          for(Uint i = 0; i != nb_elem_nodes; ++i)
+          {
+            mean += u[nodes[i]][0];
+            weight += coords[nodes[i]][0] + coords[nodes[i]][1] + coords[nodes[i]][2];
+          }
+          mean /= static_cast<Real>(nb_elem_nodes);
+          for(Uint i = 0; i != nb_elem_nodes; ++i)
+            residual[nodes[i]][0] += weight * (u[nodes[i]][0] - mean);
+        }
+      }
+    }
+    report("Assembly " + label, timer.elapsed());
+
+    Real sum = 0.;
+    for(Uint i = 0; i != residual.size(); ++i)
+      sum += residual[i][0];
+    return sum;
+  }
+
+  /// Product with the graph Laplacian of the nodes, stored in CRS format. Returns the sum of the result.
+  Real spmv(Mesh& mesh, const std::string& label)
+  {
+    const Dictionary& geometry = mesh.geometry_fields();
+    const Uint nb_nodes = geometry.size();
+    const CompressedTable<SpaceElem>& node_elements = geometry.connectivity();
+
+    std::vector<Uint> row_offsets(1, 0u);
+    std::vector<Uint> columns;
+    std::vector<Real> values;
+    std::vector<Uint> marker(nb_nodes, 0u);
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      marker[i] = i+1;
+      const Uint diagonal = columns.size();
+      columns.push_back(i);
+      values.push_back(0.);
+      boost_foreach(const SpaceElem& elem, node_elements[i])
+      {
+        boost_foreach(const Uint j, elem.comp->connectivity()[elem.idx])
+        {
+          if(marker[j] != i+1)
+          {
+            marker[j] = i+1;
+            columns.push_back(j);
+            values.push_back(-1.);
+          }
+        }
+      }
+      values[diagonal] = static_cast<Real>(columns.size() - diagonal);
+      row_offsets.push_back(columns.size());
+    }
+
+    const Field& u = *Handle<Field const>(geometry.get_child("u"));
+    std::vector<Real> x(nb_nodes), y(nb_nodes);
+    for(Uint i = 0; i != nb_nodes; ++i)
+      x[i] = u[i][0];
+
+    Timer timer;
+    for(Uint repeat = 0; repeat != nb_repeats; ++repeat)
+    {
+      for(Uint i = 0; i != nb_nodes; ++i)
+      {
+        Real result = 0.;
+        for(Uint k = row_offsets[i]; k != row_offsets[i+1]; ++k)
+          result += values[k] * x[columns[k]];
+        y[i] = result;
+      }
+    }
+    report("SpMV " + label, timer.elapsed());
+
+    Real sum = 0.;
+    for(Uint i = 0; i != nb_nodes; ++i)
+      sum += y[i];
+    return sum;
+  }
+
+  /// Random permutation of the given size
+  static std::vector<Uint> random_permutation(const Uint size)
+  {
+    std::vector<Uint> result(size);
+    for(Uint i = 0; i != size; ++i)
+      result[i] = i;
+    std::random_shuffle(result.begin(), result.end());
+    return result;
+  }
+
+  Component& root;
+  Uint nb_cells;
+  Uint nb_repeats;
+};
+
+BOOST_FIXTURE_TEST_SUITE( LocalRenumberingBenchmarkSuite, LocalRenumberingBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK_EQUAL(PE::Comm::instance().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( ScrambledAndRenumbered )
+{
+  Mesh& mesh = *root.create_component<Mesh>("mesh");
+  Handle<SimpleMeshGenerator> generator = root.create_component<SimpleMeshGenerator>("generator");
+  generator->options().set("nb_cells", std::vector<Uint>(3, nb_cells));
+  generator->options().set("lengths", std::vector<Real>(3, 1.));
+  generator->options().set("mesh", mesh.uri());
+  generator->execute();
+
+  Dictionary& geometry = mesh.geometry_fields();
+  Field& u = geometry.create_field("u");
+  geometry.create_field("residual");
+  for(Uint i = 0; i != geometry.size(); ++i)
+    u[i][0] = geometry.coordinates()[i][0] * geometry.coordinates()[i][1] + geometry.coordinates()[i][2];
+
+  // Random local order, standing in for the order left by a reader or a repartitioning
+  boost_foreach(Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+    LocalRenumbering::renumber_elements(elements, random_permutation(elements.size()));
+  LocalRenumbering::renumber_nodes(geometry, random_permutation(geometry.size()));
+  mesh.raise_mesh_changed();
+
+  const Real scrambled_assembly = assembly(mesh, "scrambled");
+  const Real scrambled_spmv = spmv(mesh, "scrambled");
+
+  Handle<LocalRenumbering> renumbering = root.create_component<LocalRenumbering>("renumbering");
+  Timer timer;
+  renumbering->transform(mesh);
+  report("LocalRenumbering", timer.elapsed());
+
+  const Real renumbered_assembly = assembly(mesh, "renumbered");
+  const Real renumbered_spmv = spmv(mesh, "renumbered");
+
+  // The results only differ by the order of summation
+  BOOST_CHECK_CLOSE(renumbered_assembly + 1., scrambled_assembly + 1., 1e-6);
+  BOOST_CHECK_CLOSE(renumbered_spmv + 1., scrambled_spmv + 1., 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,135 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Tests mesh::actions::GlobalNumbering"
+
+#include <map>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/Table.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/actions/GlobalNumbering.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::mesh::actions;
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( TestGlobalNumbering_TestSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+BOOST_AUTO_TEST_CASE( GhostNodes )
+{
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint nb_procs = PE::Comm::instance().size();
+
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("mesh");
+  Handle<SimpleMeshGenerator> generator = Core::instance().root().create_component<SimpleMeshGenerator>("generator");
+  generator->options().set("nb_cells", std::vector<Uint>(2, 12));
+  generator->options().set("lengths", std::vector<Real>(2, 1.));
+  generator->options().set("mesh", mesh->uri());
+  generator->execute();
+
+  boost::shared_ptr<GlobalNumbering> numbering = allocate_component<GlobalNumbering>("numbering");
+  numbering->set_mesh(mesh);
+  numbering->execute();
+
+  Dictionary& nodes = mesh->geometry_fields();
+  const common::Table<Real>& coords = nodes.coordinates();
+
+  // Owned nodes and elements are numbered contiguously, starting after the previous ranks
+  Uint nb_owned = 0;
+  for(Uint i = 0; i != nodes.size(); ++i)
+  {
+    if(!nodes.is_ghost(i))
+      ++nb_owned;
+  }
+  boost_foreach(const Entities& elements, find_components_recursively<Entities>(*mesh))
+  {
+    for(Uint e = 0; e != elements.size(); ++e)
+    {
+      if(!elements.is_ghost(e))
+        ++nb_owned;
+    }
+  }
+  std::vector<Uint> nb_owned_per_proc;
+  PE::Comm::instance().all_gather(nb_owned, nb_owned_per_proc);
+  Uint start = 0;
+  for(Uint p = 0; p != rank; ++p)
+    start += nb_owned_per_proc[p];
+
+  std::vector<Uint> owned_ids;
+  std::vector<Real> owned_coords;
+  Uint next_id = start;
+  for(Uint i = 0; i != nodes.size(); ++i)
+  {
+    if(nodes.is_ghost(i))
+      continue;
+    BOOST_CHECK_EQUAL(nodes.glb_idx()[i], next_id++);
+    owned_ids.push_back(nodes.glb_idx()[i]);
+    owned_coords.push_back(coords[i][XX]);
+    owned_coords.push_back(coords[i][YY]);
+  }
+
+  // Ghost nodes must get the global index and rank of the owned node at the same position
+  std::vector< std::vector<Uint> > all_ids;
+  std::vector< std::vector<Real> > all_coords;
+  PE::Comm::instance().all_gather(owned_ids, all_ids);
+  PE::Comm::instance().all_gather(owned_coords, all_coords);
+  std::map<Uint, std::pair<Uint, Uint> > owner_of;
+  for(Uint p = 0; p != nb_procs; ++p)
+  {
+    for(Uint i = 0; i != all_ids[p].size(); ++i)
+      owner_of[all_ids[p][i]] = std::make_pair(p, i);
+  }
+
+  Uint nb_ghosts = 0;
+  for(Uint i = 0; i != nodes.size(); ++i)
+  {
+    if(!nodes.is_ghost(i))
+      continue;
+    ++nb_ghosts;
+    const std::map<Uint, std::pair<Uint, Uint> >::const_iterator owner = owner_of.find(nodes.glb_idx()[i]);
+    BOOST_REQUIRE(owner != owner_of.end());
+    BOOST_CHECK_EQUAL(nodes.rank()[i], owner->second.first);
+    BOOST_CHECK_CLOSE(coords[i][XX], all_coords[owner->second.first][2*owner->second.second], 1e-8);
+    BOOST_CHECK_CLOSE(coords[i][YY], all_coords[owner->second.first][2*owner->second.second+1], 1e-8);
+  }
+  if(nb_procs > 1)
+    BOOST_CHECK(nb_ghosts > 0);
+}
+
+BOOST_AUTO_TEST_CASE( Terminate )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,80 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Tests mesh::actions::InitFieldFunction"
+
+#include <boost/assign/list_of.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+#include "mesh/actions/InitFieldFunction.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::mesh::actions;
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( InitFieldFunctionSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+BOOST_AUTO_TEST_CASE( InitField )
+{
+  // More nodes than points evaluated together, with a partial last block
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("mesh");
+  Handle<SimpleMeshGenerator> generator = Core::instance().root().create_component<SimpleMeshGenerator>("generator");
+  generator->options().set("nb_cells", std::vector<Uint>(2, 40u));
+  generator->options().set("lengths", std::vector<Real>(2, 1.));
+  generator->options().set("mesh", mesh.uri());
+  generator->execute();
+
+  Dictionary& geometry = mesh.geometry_fields();
+  Field& field = geometry.create_field("field", 2u);
+  Field& scalar = geometry.create_field("scalar");
+  for(Uint node = 0; node != geometry.size(); ++node)
+    scalar[node][0] = 3.*geometry.coordinates()[node][0];
+
+  Handle<InitFieldFunction> init_field = Core::instance().root().create_component<InitFieldFunction>("init_field");
+  init_field->options().set("field", field.handle<Field>());
+  init_field->options().set("time", 0.5);
+  const std::vector<std::string> functions = boost::assign::list_of("x+2*y+t")("if(x<0.5, scalar, 1/x)");
+  init_field->options().set("functions", functions);
+  init_field->execute();
+
+  for(Uint node = 0; node != geometry.size(); ++node)
+  {
+    const Real x = geometry.coordinates()[node][0];
+    const Real y = geometry.coordinates()[node][1];
+    BOOST_CHECK_CLOSE(field[node][0], x + 2.*y + 0.5, 1e-12);
+    BOOST_CHECK_CLOSE(field[node][1], x < 0.5 ? 3.*x : 1./x, 1e-12);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
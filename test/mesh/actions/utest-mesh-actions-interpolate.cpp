@@ -14,6 +14,7 @@
 #include "common/Core.hpp"
 #include "common/PE/debug.hpp"
 #include "common/PE/Comm.hpp"
+#include "common/Table.hpp"
 
 #include "mesh/actions/Interpolate.hpp"
 
@@ -21,6 +22,7 @@
 #include "mesh/Mesh.hpp"
 #include "mesh/Region.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
 #include "mesh/SimpleMeshGenerator.hpp"
 
 using namespace cf3;
@@ -117,6 +119,58 @@ BOOST_AUTO_TEST_CASE( build )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( bounding_box_search )
+{
+  // Target mesh with a different resolution, so its partitions don't match the source partitions
+  Handle<MeshGenerator> mesh_generator(Core::instance().root().get_child("mesh_generator"));
+  mesh_generator->options().set("mesh",Core::instance().root().uri()/"coarse_rect");
+  mesh_generator->options().set("lengths",std::vector<Real>(2,10.));
+  std::vector<Real> offsets(2);
+  offsets[XX] = 0.;
+  offsets[YY] = -0.5;
+  mesh_generator->options().set("offsets",offsets);
+  std::vector<Uint> nb_cells(2);
+  nb_cells[XX] = 7u;
+  nb_cells[YY] = 3u;
+  mesh_generator->options().set("nb_cells",nb_cells);
+  Mesh& coarse_rect = mesh_generator->generate();
+
+  const Field& source = *Handle<Field>(Core::instance().root().get_child("rect")->get_child("geometry")->get_child("solution"));
+  Field& target = coarse_rect.geometry_fields().create_field("solution");
+
+  Interpolate& interpolator = *Core::instance().root().create_component<Interpolate>("bounding_box_interpolator");
+  interpolator.options().set("source",source.handle<Field const>());
+  interpolator.options().set("target",target.handle<Field>());
+
+  // Both search modes must give the same, exact result for a linear field
+  for(Uint mode=0; mode<2; ++mode)
+  {
+    interpolator.options().set("bounding_box_search",mode == 1);
+    for(Uint i=0; i<target.size();++i)
+      target[i][0] = 0.;
+    interpolator.execute();
+    for(Uint i=0; i<target.size();++i)
+      BOOST_CHECK_SMALL(target[i][0] - target.coordinates()[i][XX], 1e-10);
+  }
+
+  // A point outside the source domain must be set to zero in both modes
+  Handle< Table<Real> > coordinates = Core::instance().root().create_component< Table<Real> >("outside_coordinates");
+  Handle< Table<Real> > values = Core::instance().root().create_component< Table<Real> >("outside_values");
+  coordinates->set_row_size(2);
+  coordinates->resize(2);
+  (*coordinates)[0][XX] = 5.;  (*coordinates)[0][YY] = 0.;
+  (*coordinates)[1][XX] = 15.; (*coordinates)[1][YY] = 3.;
+  for(Uint mode=0; mode<2; ++mode)
+  {
+    interpolator.options().set("bounding_box_search",mode == 1);
+    interpolator.interpolate(source, *coordinates, *values);
+    BOOST_CHECK_SMALL((*values)[0][0] - 5., 1e-10);
+    BOOST_CHECK_EQUAL((*values)[1][0], 0.);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( Terminate )
 {
   PE::Comm::instance().finalize();
@@ -0,0 +1,264 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Tests mesh::actions::LocalRenumbering"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/actions/LocalRenumbering.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::mesh::actions;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct LocalRenumberingFixture
+{
+  /// True if the space is defined on cells
+  static bool is_volume(const Space& space)
+  {
+    return space.support().element_type().dimensionality() == space.support().element_type().dimension();
+  }
+
+  /// Largest difference between the indices of two nodes of the same cell
+  static Uint bandwidth(const Mesh& mesh)
+  {
+    Uint result = 0;
+    boost_foreach(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+    {
+      const Connectivity& connectivity = elements.geometry_space().connectivity();
+      for(Uint elem = 0; elem != connectivity.size(); ++elem)
+      {
+        const Connectivity::ConstRow row = connectivity[elem];
+        const Uint min_node = *std::min_element(row.begin(), row.end());
+        const Uint max_node = *std::max_element(row.begin(), row.end());
+        result = std::max(result, max_node - min_node);
+      }
+    }
+    return result;
+  }
+
+  /// Global node indices of each cell, by global cell index
+  static std::map< Uint, std::vector<Uint> > cell_nodes(const Mesh& mesh)
+  {
+    std::map< Uint, std::vector<Uint> > result;
+    const List<Uint>& node_glb_idx = mesh.geometry_fields().glb_idx();
+    boost_foreach(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+    {
+      const Connectivity& connectivity = elements.geometry_space().connectivity();
+      for(Uint elem = 0; elem != connectivity.size(); ++elem)
+      {
+        std::vector<Uint>& nodes = result[elements.glb_idx()[elem]];
+        boost_foreach(const Uint node, connectivity[elem])
+          nodes.push_back(node_glb_idx[node]);
+      }
+    }
+    return result;
+  }
+
+  /// Check that the mesh is still the same, apart from the local numbering
+  static void check_mesh(const Mesh& mesh, const std::map< Uint, std::vector<Uint> >& reference_cell_nodes)
+  {
+    BOOST_CHECK(cell_nodes(mesh) == reference_cell_nodes);
+
+    const Dictionary& geometry = mesh.geometry_fields();
+    const Field& coords = geometry.coordinates();
+    const Field& node_field = *Handle<Field const>(geometry.get_child("node_field"));
+    for(Uint node = 0; node != geometry.size(); ++node)
+    {
+      BOOST_CHECK_EQUAL(geometry.glb_to_loc().find(geometry.glb_idx()[node])->second, node);
+      BOOST_CHECK_EQUAL(node_field[node][0], coords[node][0] + 2.*coords[node][1]);
+    }
+
+    // The element-based field stores the global index of the element and the local index of the node in the element
+    const Dictionary& elems_dict = *Handle<Dictionary const>(mesh.get_child("elems_P1"));
+    const Field& elem_field = *Handle<Field const>(elems_dict.get_child("elem_field"));
+    boost_foreach(const Handle<Space>& space, elems_dict.spaces())
+    {
+      if(!is_volume(*space))
+        continue;
+      const Connectivity& connectivity = space->connectivity();
+      const List<Uint>& elem_glb_idx = space->support().glb_idx();
+      for(Uint elem = 0; elem != connectivity.size(); ++elem)
+      {
+        for(Uint i = 0; i != connectivity.row_size(); ++i)
+          BOOST_CHECK_EQUAL(elem_field[connectivity[elem][i]][0], static_cast<Real>(10*elem_glb_idx[elem] + i));
+      }
+    }
+  }
+
+  /// Random permutation of the given size
+  static std::vector<Uint> random_permutation(const Uint size)
+  {
+    std::vector<Uint> result(size);
+    for(Uint i = 0; i != size; ++i)
+      result[i] = i;
+    std::random_shuffle(result.begin(), result.end());
+    return result;
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE( LocalRenumberingSuite, LocalRenumberingFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+BOOST_AUTO_TEST_CASE( RenumberScrambledMesh )
+{
+  const Uint nb_cells = 20;
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("mesh");
+  Handle<SimpleMeshGenerator> generator = Core::instance().root().create_component<SimpleMeshGenerator>("generator");
+  generator->options().set("nb_cells", std::vector<Uint>(2, nb_cells));
+  generator->options().set("lengths", std::vector<Real>(2, 1.));
+  generator->options().set("mesh", mesh.uri());
+  generator->execute();
+
+  Dictionary& geometry = mesh.geometry_fields();
+  Field& node_field = geometry.create_field("node_field");
+  for(Uint node = 0; node != geometry.size(); ++node)
+    node_field[node][0] = geometry.coordinates()[node][0] + 2.*geometry.coordinates()[node][1];
+  // Create the comm pattern, which must be rebuilt after renumbering
+  node_field.synchronize();
+
+  Dictionary& elems_dict = mesh.create_discontinuous_space("elems_P1", "cf3.mesh.LagrangeP1");
+  Field& elem_field = elems_dict.create_field("elem_field");
+  boost_foreach(const Handle<Space>& space, elems_dict.spaces())
+  {
+    if(!is_volume(*space))
+      continue;
+    const Connectivity& connectivity = space->connectivity();
+    const List<Uint>& elem_glb_idx = space->support().glb_idx();
+    for(Uint elem = 0; elem != connectivity.size(); ++elem)
+    {
+      for(Uint i = 0; i != connectivity.row_size(); ++i)
+        elem_field[connectivity[elem][i]][0] = static_cast<Real>(10*elem_glb_idx[elem] + i);
+    }
+  }
+
+  const std::map< Uint, std::vector<Uint> > reference_cell_nodes = cell_nodes(mesh);
+  const Uint generated_bandwidth = bandwidth(mesh);
+
+  // Scramble the mesh
+  boost_foreach(Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+    LocalRenumbering::renumber_elements(elements, random_permutation(elements.size()));
+  LocalRenumbering::renumber_nodes(geometry, random_permutation(geometry.size()));
+  LocalRenumbering::renumber_nodes(elems_dict, random_permutation(elems_dict.size()));
+  mesh.raise_mesh_changed();
+  check_mesh(mesh, reference_cell_nodes);
+  const Uint scrambled_bandwidth = bandwidth(mesh);
+  // In parallel the generator appends the ghost nodes, so its numbering has no small bandwidth to compare with
+  if(PE::Comm::instance().size() == 1)
+    BOOST_CHECK_GT(scrambled_bandwidth, generated_bandwidth);
+
+  Handle<LocalRenumbering> renumbering = Core::instance().root().create_component<LocalRenumbering>("renumbering");
+  renumbering->transform(mesh);
+  check_mesh(mesh, reference_cell_nodes);
+
+  // Starting from a corner, the levels of reverse Cuthill-McKee are L-shaped, so the bandwidth is at most two rows of nodes
+  const Uint renumbered_bandwidth = bandwidth(mesh);
+  BOOST_CHECK_LE(renumbered_bandwidth, 2*(nb_cells+1));
+  BOOST_CHECK_LT(renumbered_bandwidth, scrambled_bandwidth);
+
+  // The discontinuous nodes follow the cells
+  boost_foreach(const Handle<Space>& space, elems_dict.spaces())
+  {
+    if(!is_volume(*space))
+      continue;
+    const Connectivity& connectivity = space->connectivity();
+    for(Uint elem = 1; elem < connectivity.size(); ++elem)
+      BOOST_CHECK_LT(connectivity[elem-1][0], connectivity[elem][0]);
+  }
+
+  // Synchronization sets up a new comm pattern
+  node_field.synchronize();
+  BOOST_CHECK(is_not_null(geometry.get_child("CommPattern")));
+}
+
+BOOST_AUTO_TEST_CASE( RejectInvalidPermutation )
+{
+  Dictionary& geometry = Handle<Mesh>(Core::instance().root().get_child("mesh"))->geometry_fields();
+  std::vector<Uint> new_index(geometry.size(), 0u);
+  BOOST_CHECK_THROW(LocalRenumbering::renumber_nodes(geometry, new_index), BadValue);
+  new_index.resize(geometry.size() - 1);
+  BOOST_CHECK_THROW(LocalRenumbering::renumber_nodes(geometry, new_index), BadValue);
+}
+
+BOOST_AUTO_TEST_CASE( SynchronizeAfterRenumbering )
+{
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("parallel_mesh");
+  Handle<SimpleMeshGenerator> generator = Core::instance().root().create_component<SimpleMeshGenerator>("parallel_generator");
+  generator->options().set("nb_cells", std::vector<Uint>(2, 10u));
+  generator->options().set("lengths", std::vector<Real>(2, 1.));
+  generator->options().set("mesh", mesh.uri());
+  generator->execute();
+
+  // Owned nodes hold their global index, ghost nodes a value that must be overwritten by the synchronization
+  Dictionary& geometry = mesh.geometry_fields();
+  Field& gid_field = geometry.create_field("gid_field");
+  for(Uint node = 0; node != geometry.size(); ++node)
+    gid_field[node][0] = geometry.is_ghost(node) ? -1. : static_cast<Real>(geometry.glb_idx()[node]);
+  // Build the comm pattern for the old numbering
+  gid_field.synchronize();
+
+  Uint nb_ghosts = 0;
+  for(Uint node = 0; node != geometry.size(); ++node)
+  {
+    if(geometry.is_ghost(node))
+    {
+      ++nb_ghosts;
+      gid_field[node][0] = -1.;
+    }
+  }
+  if(PE::Comm::instance().size() > 1)
+    BOOST_CHECK_GT(nb_ghosts, 0u);
+
+  LocalRenumbering::renumber_nodes(geometry, random_permutation(geometry.size()));
+  mesh.raise_mesh_changed();
+  BOOST_CHECK(is_null(geometry.get_child("CommPattern")));
+
+  // The comm pattern is rebuilt for the new numbering, so each ghost gets the value of the same global node
+  gid_field.synchronize();
+  for(Uint node = 0; node != geometry.size(); ++node)
+    BOOST_CHECK_EQUAL(gid_field[node][0], static_cast<Real>(geometry.glb_idx()[node]));
+}
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,229 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::actions::WallDistance"
+
+#include <limits>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "math/Consts.hpp"
+
+#include "mesh/BlockMesh/BlockData.hpp"
+#include "mesh/Domain.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/Region.hpp"
+
+#include "Tools/MeshGeneration/MeshGeneration.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct WallDistanceFixture
+{
+  WallDistanceFixture() : root(Core::instance().root())
+  {
+  }
+
+  /// Compute the wall distance on mesh, using the given wall regions
+  const Field& compute(Mesh& mesh, const std::vector<std::string>& walls, const Uint nb_threads)
+  {
+    std::vector< Handle<Region> > regions;
+    BOOST_FOREACH(const std::string& wall, walls)
+    {
+      regions.push_back(Handle<Region>(mesh.topology().get_child(wall)));
+    }
+    boost::shared_ptr<MeshTransformer> wall_distance = build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.WallDistance", "wall_distance");
+    wall_distance->options().set("regions", regions);
+    wall_distance->options().set("nb_threads", nb_threads);
+    wall_distance->transform(mesh);
+    return *Handle<Field const>(mesh.geometry_fields().get_child("WallDistance"));
+  }
+
+  /// Check the distance field against the exact distance to the walls at y = -half_height and, if both_walls is true, at y = half_height
+  void check(const Field& distance, const Real half_height, const bool both_walls)
+  {
+    const Field& coords = distance.dict().coordinates();
+    const Uint nb_nodes = coords.size();
+    BOOST_CHECK(nb_nodes > 0);
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      const Real y = coords[i][YY];
+      const Real exact = both_walls ? half_height - std::abs(y) : y + half_height;
+      BOOST_CHECK_SMALL(distance[i][0] - exact, 1e-10);
+    }
+  }
+
+  /// Check the distance field against the distance to the closest of the line segments through the rows of wall_points, computed by brute force
+  void check_brute_force(const Field& distance, const RealMatrix& wall_points, const Real tolerance)
+  {
+    const Field& coords = distance.dict().coordinates();
+    const Uint nb_nodes = coords.size();
+    const Uint nb_segments = wall_points.rows() - 1;
+    BOOST_CHECK(nb_nodes > 0);
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      const RealVector2 point(coords[i][XX], coords[i][YY]);
+      Real exact = std::numeric_limits<Real>::max();
+      for(Uint j = 0; j != nb_segments; ++j)
+      {
+        const RealVector2 start = wall_points.row(j).transpose();
+        const RealVector2 segment = wall_points.row(j+1).transpose() - start;
+        const Real t = std::max(0., std::min(1., segment.dot(point - start) / segment.squaredNorm()));
+        exact = std::min(exact, (point - start - t*segment).norm());
+      }
+      BOOST_CHECK_SMALL(distance[i][0] - exact, tolerance);
+    }
+  }
+
+  Component& root;
+};
+
+BOOST_FIXTURE_TEST_SUITE( WallDistanceSuite, WallDistanceFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  Core::instance().environment().options().set("log_level", 1u);
+}
+
+BOOST_AUTO_TEST_CASE( Channel2D )
+{
+  const Real length = 5.;
+  const Real half_height = 1.;
+
+  Domain& domain = *root.create_component<Domain>("domain2d");
+  BlockMesh::BlockArrays& blocks = *domain.create_component<BlockMesh::BlockArrays>("blocks");
+
+  (*blocks.create_points(2, 6)) << 0.     << -half_height
+                                << length << -half_height
+                                << 0.     <<  0.
+                                << length <<  0.
+                                << 0.     <<  half_height
+                                << length <<  half_height;
+
+  (*blocks.create_blocks(2)) << 0 << 1 << 3 << 2
+                             << 2 << 3 << 5 << 4;
+
+  (*blocks.create_block_subdivisions()) << 20 << 8
+                                        << 20 << 8;
+
+  (*blocks.create_block_gradings()) << 1. << 1. << 5. << 5.
+                                    << 1. << 1. << 0.2 << 0.2;
+
+  *blocks.create_patch("left", 2) << 2 << 0 << 4 << 2;
+  *blocks.create_patch("right", 2) << 1 << 3 << 3 << 5;
+  *blocks.create_patch("top", 1) << 5 << 4;
+  *blocks.create_patch("bottom", 1) << 0 << 1;
+
+  // Partition across the channel, so with more than one rank the top rank has no local bottom wall
+  blocks.partition_blocks(PE::Comm::instance().size(), YY);
+
+  Mesh& mesh = *domain.create_component<Mesh>("mesh");
+  blocks.create_mesh(mesh);
+
+  check(compute(mesh, std::vector<std::string>(1, "bottom"), 1), half_height, false);
+
+  std::vector<std::string> walls(1, "bottom");
+  walls.push_back("top");
+  check(compute(mesh, walls, 3), half_height, true);
+}
+
+BOOST_AUTO_TEST_CASE( Channel3D )
+{
+  const Real half_height = 0.5;
+
+  Domain& domain = *root.create_component<Domain>("domain3d");
+  BlockMesh::BlockArrays& blocks = *domain.create_component<BlockMesh::BlockArrays>("blocks");
+  Tools::MeshGeneration::create_channel_3d(blocks, 4., half_height, 2., 12, 6, 6, 0.1);
+  blocks.partition_blocks(PE::Comm::instance().size(), YY);
+
+  Mesh& mesh = *domain.create_component<Mesh>("mesh");
+  blocks.create_mesh(mesh);
+
+  check(compute(mesh, std::vector<std::string>(1, "bottom"), 4), half_height, false);
+
+  std::vector<std::string> walls(1, "bottom");
+  walls.push_back("top");
+  check(compute(mesh, walls, 2), half_height, true);
+}
+
+BOOST_AUTO_TEST_CASE( CurvedWall2D )
+{
+  const Real length = 4.;
+  const Real half_height = 1.;
+  const Real amplitude = 0.3;
+  const Uint x_segments = 40;
+
+  Domain& domain = *root.create_component<Domain>("domaincurved");
+  BlockMesh::BlockArrays& blocks = *domain.create_component<BlockMesh::BlockArrays>("blocks");
+
+  (*blocks.create_points(2, 4)) << 0.     << -half_height
+                                << length << -half_height
+                                << 0.     <<  half_height
+                                << length <<  half_height;
+
+  (*blocks.create_blocks(1)) << 0 << 1 << 3 << 2;
+  (*blocks.create_block_subdivisions()) << x_segments << 16;
+  (*blocks.create_block_gradings()) << 1. << 1. << 4. << 4.;
+
+  *blocks.create_patch("left", 1) << 2 << 0;
+  *blocks.create_patch("right", 1) << 1 << 3;
+  *blocks.create_patch("top", 1) << 3 << 2;
+  *blocks.create_patch("bottom", 1) << 0 << 1;
+
+  blocks.partition_blocks(PE::Comm::instance().size(), YY);
+
+  Mesh& mesh = *domain.create_component<Mesh>("mesh");
+  blocks.create_mesh(mesh);
+
+  // Bend the bottom wall into a full sine period, so it has both a convex and a concave part, and keep the top wall flat
+  Field& coords = mesh.geometry_fields().coordinates();
+  const Uint nb_nodes = coords.size();
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    const Real wall_offset = amplitude * sin(2. * math::Consts::pi() * coords[i][XX] / length);
+    coords[i][YY] += wall_offset * (half_height - coords[i][YY]) / (2. * half_height);
+  }
+
+  // The wall is the line through the deformed bottom nodes, which are equally spaced in X
+  RealMatrix wall_points(x_segments + 1, 2);
+  for(Uint i = 0; i <= x_segments; ++i)
+  {
+    const Real x = length * static_cast<Real>(i) / static_cast<Real>(x_segments);
+    wall_points(i, XX) = x;
+    wall_points(i, YY) = -half_height + amplitude * sin(2. * math::Consts::pi() * x / length);
+  }
+
+  // For this mesh the closest point on the wall is on a face touching the closest wall node, so only rounding may differ
+  check_brute_force(compute(mesh, std::vector<std::string>(1, "bottom"), 3), wall_points, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
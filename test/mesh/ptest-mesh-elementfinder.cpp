@@ -0,0 +1,174 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of the element finders on a graded mesh"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/OptionList.hpp"
+#include "common/Timer.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Domain.hpp"
+#include "mesh/ElementFinderBVH.hpp"
+#include "mesh/ElementFinderOcttree.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/BlockMesh/BlockData.hpp"
+
+#include "Tools/MeshGeneration/MeshGeneration.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+/// Memory in use by the process, in MB
+Real memory_mb()
+{
+  return OSystem::instance().layer()->memory_usage() / (1024.*1024.);
+}
+
+struct ElementFinderBenchmarkFixture
+{
+  ElementFinderBenchmarkFixture() :
+    root( Core::instance().root() )
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    // Number of segments in each direction, can be passed as first argument
+    nb_segments = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 32;
+    // Number of query points, can be passed as second argument
+    nb_points = argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 100000;
+  }
+
+  Component& root;
+  Uint nb_segments;
+  Uint nb_points;
+
+  static Handle<Mesh> mesh;
+  static RealMatrix points;
+  static std::vector<SpaceElem> reference_elements;
+
+  /// Query all points using the given finder, one by one or batched, and print the timing
+  void run(ElementFinder& finder, const std::string& name, const bool batched, std::vector<SpaceElem>& elements)
+  {
+    std::vector<bool> found;
+    Timer timer;
+    if(batched)
+    {
+      finder.find_elements(points, elements, found);
+    }
+    else
+    {
+      const Uint nb_points = points.rows();
+      elements.resize(nb_points);
+      RealVector coord(3);
+      for(Uint i = 0; i != nb_points; ++i)
+      {
+        coord = points.row(i).transpose();
+        finder.find_element(coord, elements[i]);
+      }
+    }
+    const Real elapsed = timer.elapsed();
+    std::cout << name << ": " << points.rows() << " queries in " << elapsed << " s, " << points.rows() / elapsed << " queries/s" << std::endl;
+    std::cout << "<DartMeasurement name=\"" << name << " query time\" type=\"numeric/double\">" << elapsed << "</DartMeasurement>" << std::endl;
+  }
+};
+
+Handle<Mesh> ElementFinderBenchmarkFixture::mesh;
+RealMatrix ElementFinderBenchmarkFixture::points;
+std::vector<SpaceElem> ElementFinderBenchmarkFixture::reference_elements;
+
+BOOST_FIXTURE_TEST_SUITE( ElementFinderBenchmarkSuite, ElementFinderBenchmarkFixture )
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  common::PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK_EQUAL(common::PE::Comm::instance().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( CreateMesh )
+{
+  Domain& domain = *root.create_component<Domain>("Domain");
+  mesh = domain.create_component<Mesh>("Mesh");
+  BlockMesh::BlockArrays& blocks = *domain.create_component<BlockMesh::BlockArrays>("blocks");
+  // Strong grading towards the walls, as in a boundary layer mesh
+  Tools::MeshGeneration::create_channel_3d(blocks, 10., 0.5, 5., nb_segments, nb_segments, nb_segments, 0.002);
+  blocks.create_mesh(*mesh);
+
+  // Query points, half of them uniform and half of them close to the walls
+  boost::mt19937 generator(1);
+  boost::variate_generator< boost::mt19937&, boost::uniform_real<Real> > random(generator, boost::uniform_real<Real>(0., 1.));
+  points.resize(nb_points, 3);
+  for(Uint i = 0; i != nb_points; ++i)
+  {
+    const Real y = i % 2 == 0 ? random() - 0.5 : (0.5 - 0.01*random()) * (random() < 0.5 ? -1. : 1.);
+    points(i, XX) = 10.*random();
+    points(i, YY) = y;
+    points(i, ZZ) = 5.*random();
+  }
+
+  std::cout << "Mesh with " << mesh->geometry_fields().size() << " nodes and " << nb_points << " query points" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE( Octtree )
+{
+  Handle<ElementFinderOcttree> finder = root.create_component<ElementFinderOcttree>("octtree_finder");
+  finder->options().set("dict", mesh->geometry_fields().handle<Dictionary>());
+
+  // The first query builds the octtree
+  const Real memory_before = memory_mb();
+  Timer timer;
+  SpaceElem element;
+  finder->find_element(points.row(0).transpose(), element);
+  std::cout << "Octtree build: " << timer.elapsed() << " s, " << memory_mb() - memory_before << " MB" << std::endl;
+
+  run(*finder, "Octtree", false, reference_elements);
+}
+
+BOOST_AUTO_TEST_CASE( BVH )
+{
+  Handle<ElementFinderBVH> finder = root.create_component<ElementFinderBVH>("bvh_finder");
+  finder->options().set("dict", mesh->geometry_fields().handle<Dictionary>());
+
+  const Real memory_before = memory_mb();
+  Timer timer;
+  finder->build();
+  std::cout << "BVH build: " << timer.elapsed() << " s, " << memory_mb() - memory_before << " MB (" << finder->memory_size() / (1024.*1024.) << " MB in the tree)" << std::endl;
+
+  std::vector<SpaceElem> elements;
+  run(*finder, "BVH", false, elements);
+
+  std::vector<SpaceElem> batched_elements;
+  run(*finder, "BVH batched", true, batched_elements);
+
+  // Points inside the domain must give the same elements, unless they lie on a shared face
+  Uint nb_different = 0;
+  for(Uint i = 0; i != nb_points; ++i)
+  {
+    if(elements[i] != reference_elements[i])
+      ++nb_different;
+    BOOST_CHECK(elements[i] == batched_elements[i]);
+  }
+  std::cout << nb_different << " of " << nb_points << " points found in a different element than the Octtree" << std::endl;
+  BOOST_CHECK(nb_different < nb_points / 1000 + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,182 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of the node to element connectivity storage"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/CompressedTable.hpp"
+#include "common/DynTable.hpp"
+#include "common/FindComponents.hpp"
+#include "common/OptionList.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/Timer.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/NodeElementConnectivity.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+/// Memory in use by the process, in MB
+Real memory_mb()
+{
+  return OSystem::instance().layer()->memory_usage() / (1024.*1024.);
+}
+
+struct NodeElementBenchmarkFixture
+{
+  NodeElementBenchmarkFixture() :
+    root( Core::instance().root() )
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    // Number of cells in each direction, can be passed as first argument. The default gives a million nodes.
+    nb_cells = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 99;
+    // Number of traversals of the connectivity
+    nb_traversals = argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 10;
+  }
+
+  /// Sum of all connected element indices, visiting all nodes
+  template<typename TableT>
+  Uint traverse(const TableT& table, const std::string& name)
+  {
+    Timer timer;
+    Uint result = 0;
+    for(Uint t = 0; t != nb_traversals; ++t)
+    {
+      const Uint nb_rows = table.size();
+      for(Uint i = 0; i != nb_rows; ++i)
+      {
+        boost_foreach(const Uint elem, table[i])
+          result += elem;
+      }
+    }
+    const Real elapsed = timer.elapsed();
+    std::cout << name << " traversal: " << elapsed / nb_traversals << " s" << std::endl;
+    std::cout << "<DartMeasurement name=\"" << name << " traversal time\" type=\"numeric/double\">" << elapsed / nb_traversals << "</DartMeasurement>" << std::endl;
+    return result;
+  }
+
+  Component& root;
+  Uint nb_cells;
+  Uint nb_traversals;
+
+  static Handle<Mesh> mesh;
+  static Handle<NodeElementConnectivity> compressed;
+  static Handle< DynTable<Uint> > dyn_table;
+};
+
+Handle<Mesh> NodeElementBenchmarkFixture::mesh;
+Handle<NodeElementConnectivity> NodeElementBenchmarkFixture::compressed;
+Handle< DynTable<Uint> > NodeElementBenchmarkFixture::dyn_table;
+
+BOOST_FIXTURE_TEST_SUITE( NodeElementBenchmarkSuite, NodeElementBenchmarkFixture )
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK_EQUAL(PE::Comm::instance().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( CreateMesh )
+{
+  mesh = root.create_component<Mesh>("mesh");
+  Handle<SimpleMeshGenerator> generator = root.create_component<SimpleMeshGenerator>("generator");
+  generator->options().set("nb_cells", std::vector<Uint>(3, nb_cells));
+  generator->options().set("lengths", std::vector<Real>(3, 1.));
+  generator->options().set("mesh", mesh->uri());
+  generator->execute();
+  std::cout << "Mesh with " << mesh->geometry_fields().size() << " nodes" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE( BuildDynTable )
+{
+  // Storage used before the compressed table: one vector per node, filled after reserving
+  const Real memory_before = memory_mb();
+  Timer timer;
+  dyn_table = root.create_component< DynTable<Uint> >("dyn_table");
+  dyn_table->resize(mesh->geometry_fields().size());
+  std::vector<Uint> sizes(dyn_table->size(), 0u);
+  boost_foreach(const Entities& elements, find_components_recursively<Entities>(mesh->topology()))
+  {
+    boost_foreach(Connectivity::ConstRow elem_nodes, elements.geometry_space().connectivity().array())
+    {
+      boost_foreach(const Uint node_idx, elem_nodes)
+        ++sizes[node_idx];
+    }
+  }
+  for(Uint i = 0; i != dyn_table->size(); ++i)
+    (*dyn_table)[i].reserve(sizes[i]);
+  Uint glb_elem_idx = 0;
+  boost_foreach(const Entities& elements, find_components_recursively<Entities>(mesh->topology()))
+  {
+    boost_foreach(Connectivity::ConstRow elem_nodes, elements.geometry_space().connectivity().array())
+    {
+      boost_foreach(const Uint node_idx, elem_nodes)
+        (*dyn_table)[node_idx].push_back(glb_elem_idx);
+      ++glb_elem_idx;
+    }
+  }
+  const Real elapsed = timer.elapsed();
+
+  std::size_t table_size = dyn_table->size() * sizeof(std::vector<Uint>);
+  for(Uint i = 0; i != dyn_table->size(); ++i)
+    table_size += (*dyn_table)[i].capacity() * sizeof(Uint);
+  std::cout << "DynTable build: " << elapsed << " s, " << memory_mb() - memory_before << " MB ("
+            << table_size / (1024.*1024.) << " MB in the table, excluding allocator overhead)" << std::endl;
+  std::cout << "<DartMeasurement name=\"DynTable build time\" type=\"numeric/double\">" << elapsed << "</DartMeasurement>" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE( BuildCompressed )
+{
+  const Real memory_before = memory_mb();
+  Timer timer;
+  compressed = root.create_component<NodeElementConnectivity>("compressed");
+  compressed->setup(mesh->topology());
+  const Real elapsed = timer.elapsed();
+  std::cout << "CompressedTable build: " << elapsed << " s, " << memory_mb() - memory_before << " MB ("
+            << compressed->connectivity().memory_size() / (1024.*1024.) << " MB in the table)" << std::endl;
+  std::cout << "<DartMeasurement name=\"CompressedTable build time\" type=\"numeric/double\">" << elapsed << "</DartMeasurement>" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE( Traverse )
+{
+  const Uint dyn_sum = traverse(*dyn_table, "DynTable");
+  const Uint compressed_sum = traverse(compressed->connectivity(), "CompressedTable");
+  BOOST_CHECK_EQUAL(dyn_sum, compressed_sum);
+
+  BOOST_REQUIRE_EQUAL(dyn_table->size(), compressed->connectivity().size());
+  for(Uint i = 0; i != dyn_table->size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL((*dyn_table)[i].size(), compressed->connectivity().row_size(i));
+    BOOST_CHECK(std::equal((*dyn_table)[i].begin(), (*dyn_table)[i].end(), compressed->connectivity()[i].begin()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -23,6 +23,7 @@
 #include "common/List.hpp"
 #include "common/Table.hpp"
 #include "common/DynTable.hpp"
+#include "common/CompressedTable.hpp"
 #include "mesh/ElementType.hpp"
 #include "mesh/Dictionary.hpp"
 #include "mesh/Field.hpp"
@@ -701,6 +702,57 @@ BOOST_AUTO_TEST_CASE ( DynTable_test_hard )
 }
 
 
+BOOST_AUTO_TEST_CASE ( CompressedTable_test )
+{
+  CompressedTable<Uint>& table = *root.create_component< CompressedTable<Uint> >("compressed_table");
+  BOOST_CHECK_EQUAL(table.size(), 0u);
+
+//  0:  0
+//  1:  ~
+//  2:  1 4 5
+//  3:  0 3
+  {
+    CompressedTable<Uint>::Builder builder(table, 4);
+    builder.count(0);
+    builder.count(2, 3);
+    builder.count(3, 2);
+    builder.allocate();
+    builder.add(2, 1);
+    builder.add(3, 0);
+    builder.add(0, 0);
+    builder.add(2, 4);
+    builder.add(3, 3);
+    builder.add(2, 5);
+  }
+
+  BOOST_CHECK_EQUAL(table.size(), 4u);
+  BOOST_CHECK_EQUAL(table.row_size(0), 1u);
+  BOOST_CHECK_EQUAL(table.row_size(1), 0u);
+  BOOST_CHECK_EQUAL(table.row_size(2), 3u);
+  BOOST_CHECK_EQUAL(table[2][0], 1u);
+  BOOST_CHECK_EQUAL(table[2][1], 4u);
+  BOOST_CHECK_EQUAL(table[2][2], 5u);
+  BOOST_CHECK_EQUAL(table[3][1], 3u);
+
+  Uint sum = 0;
+  boost_foreach(const Uint entry, table[2])
+    sum += entry;
+  BOOST_CHECK_EQUAL(sum, 10u);
+
+  table[3][1] = 7;
+  BOOST_CHECK_EQUAL(table[3][1], 7u);
+
+  // Rows added by resize are empty
+  table.resize(6);
+  BOOST_CHECK_EQUAL(table.row_size(5), 0u);
+  BOOST_CHECK_EQUAL(table.values().size(), 6u);
+  table.resize(2);
+  BOOST_CHECK_EQUAL(table.values().size(), 1u);
+
+  CFinfo << table << CFendl;
+}
+
+
 BOOST_AUTO_TEST_CASE ( Mesh_test )
 {
   boost::shared_ptr<Component> root = boost::static_pointer_cast<Component>(allocate_component<Group>("root"));
@@ -0,0 +1,170 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Tests mesh element finders"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/ElementFinderBVH.hpp"
+#include "mesh/ElementFinderOcttree.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ElementFinderFixture
+{
+  ElementFinderFixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Generate a square mesh of 5x5 quads with side 10
+  Mesh& generate_mesh(const std::string& name)
+  {
+    boost::shared_ptr< MeshGenerator > mesh_generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","generator_"+name);
+    Core::instance().root().add_component(mesh_generator);
+    mesh_generator->options().set("mesh",Core::instance().root().uri()/name);
+    mesh_generator->options().set("lengths",std::vector<Real>(2,10.));
+    mesh_generator->options().set("nb_cells",std::vector<Uint>(2,5));
+    mesh_generator->options().set("part",0u);
+    mesh_generator->options().set("nb_parts",1u);
+    return mesh_generator->generate();
+  }
+
+  int m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( ElementFinderSuite, ElementFinderFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init )
+{
+  PE::Comm::instance().init(m_argc,m_argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( find_single_elements )
+{
+  Mesh& mesh = generate_mesh("single_mesh");
+  Handle<ElementFinderBVH> finder = mesh.create_component<ElementFinderBVH>("bvh");
+  finder->options().set("dict", mesh.geometry_fields().handle<Dictionary>());
+  finder->options().set("leaf_size", 2u);
+
+  SpaceElem element;
+  RealVector2 coord;
+
+  coord << 1. , 1. ;
+  BOOST_CHECK(finder->find_element(coord, element));
+  BOOST_CHECK_EQUAL(element.idx,0u);
+  BOOST_CHECK(finder->is_built());
+
+  coord << 3. , 1. ;
+  BOOST_CHECK(finder->find_element(coord, element));
+  BOOST_CHECK_EQUAL(element.idx,1u);
+
+  coord << 1. , 3. ;
+  BOOST_CHECK(finder->find_element(coord, element));
+  BOOST_CHECK_EQUAL(element.idx,5u);
+
+  coord << 9. , 9. ;
+  BOOST_CHECK(finder->find_element(coord, element));
+  BOOST_CHECK_EQUAL(element.idx,24u);
+
+  // Outside the mesh, the closest element is returned only if requested
+  coord << 11. , 1. ;
+  BOOST_CHECK(finder->find_element(coord, element));
+  BOOST_CHECK_EQUAL(element.idx,4u);
+  finder->options().set("find_closest", false);
+  BOOST_CHECK(!finder->find_element(coord, element));
+
+  BOOST_CHECK(finder->memory_size() > 0u);
+  BOOST_CHECK(finder->nb_nodes() > 1u);
+
+  // A change of the mesh drops the tree, it is rebuilt at the next query
+  mesh.raise_mesh_changed();
+  BOOST_CHECK(!finder->is_built());
+  coord << 3. , 1. ;
+  BOOST_CHECK(finder->find_element(coord, element));
+  BOOST_CHECK_EQUAL(element.idx,1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( compare_batched_with_octtree )
+{
+  Mesh& mesh = generate_mesh("batch_mesh");
+  Handle<Dictionary> dict = mesh.geometry_fields().handle<Dictionary>();
+
+  Handle<ElementFinderBVH> bvh = mesh.create_component<ElementFinderBVH>("bvh");
+  bvh->options().set("dict", dict);
+  Handle<ElementFinderOcttree> octtree = mesh.create_component<ElementFinderOcttree>("octtree_finder");
+  octtree->options().set("dict", dict);
+
+  // Points at the cell centers of a finer grid, so none lie on element boundaries
+  const Uint nb_points_1d = 17;
+  RealMatrix coordinates(nb_points_1d*nb_points_1d, 2);
+  for(Uint i = 0; i != nb_points_1d; ++i)
+  {
+    for(Uint j = 0; j != nb_points_1d; ++j)
+    {
+      coordinates(i*nb_points_1d+j, XX) = (j+0.5) * 10. / nb_points_1d;
+      coordinates(i*nb_points_1d+j, YY) = (i+0.5) * 10. / nb_points_1d;
+    }
+  }
+
+  std::vector<SpaceElem> elements;
+  std::vector<bool> found;
+  BOOST_CHECK_EQUAL(bvh->find_elements(coordinates, elements, found), coordinates.rows());
+
+  std::vector<SpaceElem> octtree_elements;
+  std::vector<bool> octtree_found;
+  BOOST_CHECK_EQUAL(octtree->find_elements(coordinates, octtree_elements, octtree_found), coordinates.rows());
+
+  for(Uint i = 0; i != coordinates.rows(); ++i)
+  {
+    BOOST_CHECK(found[i]);
+    BOOST_CHECK(elements[i] == octtree_elements[i]);
+
+    SpaceElem single_element;
+    const RealVector coord = coordinates.row(i).transpose();
+    BOOST_CHECK(bvh->find_element(coord, single_element));
+    BOOST_CHECK(elements[i] == single_element);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
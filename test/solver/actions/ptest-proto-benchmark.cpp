@@ -13,6 +13,7 @@
 
 #include "common/Core.hpp"
 #include "common/Log.hpp"
+#include "common/Timer.hpp"
 
 #include "math/MatrixTypes.hpp"
 
@@ -228,6 +229,37 @@ BOOST_AUTO_TEST_CASE( SimulateVolumeComputer )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Time a threaded element loop that adds to the nodes, reporting the number of colours with the speedup
+BOOST_AUTO_TEST_CASE( ThreadedElementLoop )
+{
+  Mesh& mesh = *root.get_child("Direct")->handle<Model>()->domain().get_child("mesh")->handle<Mesh>();
+  mesh.geometry_fields().create_field("threads_source", "U[v]").add_tag("threads_source");
+  mesh.geometry_fields().create_field("threads_result", "A[v]").add_tag("threads_result");
+
+  FieldVariable<0, VectorField> U("U", "threads_source");
+  FieldVariable<1, VectorField> A("A", "threads_result");
+  for_each_node(mesh.topology(), U = coordinates);
+
+  const Elements& elements = find_component_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume());
+  const Uint nb_colours = detail::element_colouring(elements)->colour_starts.size() - 1;
+
+  Real serial_time = 0.;
+  for(Uint nb_threads = 1; nb_threads <= 4; nb_threads *= 2)
+  {
+    Timer timer;
+    for_each_element< boost::mpl::vector1<LagrangeP1::Hexa3D> >(mesh.topology(), A[_i] += nabla(U, gauss_points_1)[_i], nb_threads);
+    const Real elapsed = timer.elapsed();
+    if(nb_threads == 1)
+      serial_time = elapsed;
+    std::cout << "Element loop with " << nb_threads << " threads and " << nb_colours << " colours: " << elapsed << " s, speedup " << serial_time / elapsed << std::endl;
+    std::cout << "<DartMeasurement name=\"Element loop " << nb_threads << " threads\" type=\"numeric/double\">" << elapsed << "</DartMeasurement>" << std::endl;
+    std::cout << "<DartMeasurement name=\"Element loop " << nb_threads << " threads speedup\" type=\"numeric/double\">" << serial_time / elapsed << "</DartMeasurement>" << std::endl;
+  }
+  std::cout << "<DartMeasurement name=\"Element loop colours\" type=\"numeric/integer\">" << nb_colours << "</DartMeasurement>" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // Check the volume results (uses proto)
 BOOST_AUTO_TEST_CASE( CheckResult )
 {
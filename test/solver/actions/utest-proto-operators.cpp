@@ -27,6 +27,7 @@
 #include "solver/actions/Proto/Terminals.hpp"
 
 #include "common/Core.hpp"
+#include "common/FindComponents.hpp"
 #include "common/Log.hpp"
 
 #include "math/MatrixTypes.hpp"
@@ -39,8 +40,10 @@
 #include "mesh/ElementData.hpp"
 #include "mesh/FieldManager.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/Functions.hpp"
 
 #include "mesh/Integrators/Gauss.hpp"
+#include "mesh/Tags.hpp"
 #include "mesh/ElementTypes.hpp"
 
 #include "physics/PhysModel.hpp"
@@ -741,6 +744,116 @@ BOOST_AUTO_TEST_CASE( AddElementValues )
 }
 
 
+BOOST_AUTO_TEST_CASE( ThreadedElementLoop )
+{
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("threaded_elems_mesh");
+  Tools::MeshGeneration::create_rectangle(*mesh, 3., 2., 40, 30);
+
+  mesh->geometry_fields().create_field( "source", "U[v]" ).add_tag("source");
+  Field& serial_field = mesh->geometry_fields().create_field( "serial", "A[v]" );
+  serial_field.add_tag("serial");
+  Field& threaded_field = mesh->geometry_fields().create_field( "threaded", "B[v]" );
+  threaded_field.add_tag("threaded");
+  Field& threaded2_field = mesh->geometry_fields().create_field( "threaded2", "C[v]" );
+  threaded2_field.add_tag("threaded2");
+
+  FieldVariable<0, VectorField > U("U", "source");
+  FieldVariable<1, VectorField > A("A", "serial");
+  FieldVariable<2, VectorField > B("B", "threaded");
+  FieldVariable<3, VectorField > C("C", "threaded2");
+
+  for_each_node(mesh->topology(), U = coordinates);
+
+  for_each_element< boost::mpl::vector1<LagrangeP1::Quad2D> >(mesh->topology(), A[_i] += nabla(U, gauss_points_1)[_i]);
+  for_each_element< boost::mpl::vector1<LagrangeP1::Quad2D> >(mesh->topology(), B[_i] += nabla(U, gauss_points_1)[_i], 4);
+  for_each_element< boost::mpl::vector1<LagrangeP1::Quad2D> >(mesh->topology(), C[_i] += nabla(U, gauss_points_1)[_i], 2);
+
+  // The colouring keeps the order of the contributions to each node, so the results must be bit-identical
+  const Uint nb_nodes = serial_field.size();
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    BOOST_CHECK_EQUAL(serial_field[i][0], threaded_field[i][0]);
+    BOOST_CHECK_EQUAL(serial_field[i][1], threaded_field[i][1]);
+    BOOST_CHECK_EQUAL(serial_field[i][0], threaded2_field[i][0]);
+    BOOST_CHECK_EQUAL(serial_field[i][1], threaded2_field[i][1]);
+  }
+
+  // The colouring is cached with the mesh. The rectangle is numbered row by row, so there are nx + 2*(ny-1) colours.
+  const Elements& elements = find_component_recursively_with_filter<Elements>(mesh->topology(), IsElementsVolume());
+  const boost::shared_ptr<detail::ElementColouring const> colouring = detail::element_colouring(elements);
+  BOOST_CHECK(colouring == detail::element_colouring(elements));
+  BOOST_CHECK_EQUAL(colouring->colour_starts.size() - 1, 40u + 2u*29u);
+  BOOST_CHECK_EQUAL(colouring->elements_by_colour.size(), elements.size());
+  mesh->raise_mesh_changed();
+  BOOST_CHECK(colouring != detail::element_colouring(elements));
+}
+
+BOOST_AUTO_TEST_CASE( ThreadedNodeLoop )
+{
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("threaded_nodes_mesh");
+  Tools::MeshGeneration::create_rectangle(*mesh, 3., 2., 40, 30);
+
+  Field& serial_field = mesh->geometry_fields().create_field( "serial", "A[v]" );
+  serial_field.add_tag("serial");
+  Field& threaded_field = mesh->geometry_fields().create_field( "threaded", "B[v]" );
+  threaded_field.add_tag("threaded");
+
+  FieldVariable<0, VectorField > A("A", "serial");
+  FieldVariable<1, VectorField > B("B", "threaded");
+
+  for_each_node(mesh->topology(), A = 2.*coordinates);
+  for_each_node(mesh->topology(), B = 2.*coordinates, 3);
+
+  const Uint nb_nodes = serial_field.size();
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    BOOST_CHECK_EQUAL(serial_field[i][0], threaded_field[i][0]);
+    BOOST_CHECK_EQUAL(serial_field[i][1], threaded_field[i][1]);
+  }
+
+  // The used nodes are cached with the mesh, and dropped when the mesh changes
+  const boost::shared_ptr< common::List<Uint> const > used_nodes = mesh::cached_used_nodes_list(mesh->topology(), mesh->geometry_fields());
+  BOOST_CHECK(used_nodes == mesh::cached_used_nodes_list(mesh->topology(), mesh->geometry_fields()));
+  mesh->raise_mesh_changed();
+  BOOST_CHECK(used_nodes != mesh::cached_used_nodes_list(mesh->topology(), mesh->geometry_fields()));
+}
+
+BOOST_AUTO_TEST_CASE( GeometryCache )
+{
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("geometry_cache_mesh");
+  Tools::MeshGeneration::create_rectangle(*mesh, 3., 2., 12, 8);
+  mesh->geometry_fields().create_field( "Temperature", "Temperature" ).add_tag("solution");
+
+  FieldVariable<0, ScalarField > T("Temperature", "solution");
+
+  RealMatrix4 computed_result; computed_result.setZero();
+  RealMatrix4 cached_result; cached_result.setZero();
+
+  boost::shared_ptr<Expression> computed_expr = elements_expression(boost::mpl::vector1<LagrangeP1::Quad2D>(), element_quadrature(lit(computed_result) += transpose(nabla(T))*nabla(T)));
+  boost::shared_ptr<Expression> cached_expr = elements_expression(boost::mpl::vector1<LagrangeP1::Quad2D>(), element_quadrature(lit(cached_result) += transpose(nabla(T))*nabla(T)));
+  cached_expr->set_geometry_cache(true);
+
+  computed_expr->loop(mesh->topology());
+
+  // The first run builds the cache, the second one only reads it. Both must match the computed jacobians exactly.
+  for(Uint run = 0; run != 2; ++run)
+  {
+    cached_result.setZero();
+    cached_expr->loop(mesh->topology());
+    for(Uint i = 0; i != 4; ++i)
+      for(Uint j = 0; j != 4; ++j)
+        BOOST_CHECK_EQUAL(computed_result(i,j), cached_result(i,j));
+  }
+
+  // The cache is kept with the mesh and dropped when the mesh changes
+  typedef GeometryCache<LagrangeP1::Quad2D, 2> CacheT;
+  const Elements& elements = find_component_recursively_with_filter<Elements>(mesh->topology(), IsElementsVolume());
+  const boost::shared_ptr<CacheT const> cache = geometry_cache<LagrangeP1::Quad2D, 2>(elements);
+  BOOST_CHECK(cache == geometry_cache<LagrangeP1::Quad2D, 2>(elements));
+  mesh->raise_mesh_changed();
+  BOOST_CHECK(cache != geometry_cache<LagrangeP1::Quad2D, 2>(elements));
+}
+
 BOOST_AUTO_TEST_CASE( NodeIndexLoop )
 {
   Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("ArrayOpsGrid");
@@ -0,0 +1,187 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for threaded proto loops"
+
+#include <set>
+
+#include <boost/foreach.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "solver/Model.hpp"
+
+#include "solver/actions/Proto/ElementLooper.hpp"
+#include "solver/actions/Proto/Expression.hpp"
+#include "solver/actions/Proto/Functions.hpp"
+#include "solver/actions/Proto/NodeLooper.hpp"
+#include "solver/actions/Proto/Terminals.hpp"
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/FindComponents.hpp"
+
+#include "math/LSS/System.hpp"
+#include "math/LSS/Vector.hpp"
+
+#include "mesh/Domain.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementTypes.hpp"
+
+#include "physics/PhysModel.hpp"
+
+#include "Tools/MeshGeneration/MeshGeneration.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver;
+using namespace cf3::solver::actions;
+using namespace cf3::solver::actions::Proto;
+
+struct ProtoThreadsFixture
+{
+  ProtoThreadsFixture() :
+    root(Core::instance().root())
+  {
+    if(is_null(model))
+    {
+      common::PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+
+      model = Core::instance().root().create_component<Model>("Model");
+      model->create_physics("cf3.physics.DynamicModel");
+      Domain& dom = model->create_domain("Domain");
+      mesh = dom.create_component<Mesh>("mesh");
+      Tools::MeshGeneration::create_rectangle(*mesh, 1., 1., 20, 20);
+
+      // Build node connectivity
+      const Uint nb_nodes = mesh->geometry_fields().size();
+      std::vector< std::set<Uint> > connectivity_sets(nb_nodes);
+      BOOST_FOREACH(const Entities& elements, common::find_components_recursively_with_filter<Entities>(*mesh, IsElementsVolume()))
+      {
+        const Connectivity& connectivity = elements.geometry_space().connectivity();
+        const Uint nb_elems = connectivity.size();
+        for(Uint elem = 0; elem != nb_elems; ++elem)
+        {
+          BOOST_FOREACH(const Uint node_a, connectivity[elem])
+          {
+            BOOST_FOREACH(const Uint node_b, connectivity[elem])
+            {
+              connectivity_sets[node_a].insert(node_b);
+            }
+          }
+        }
+      }
+
+      starting_indices.push_back(0);
+      BOOST_FOREACH(const std::set<Uint>& nodes, connectivity_sets)
+      {
+        starting_indices.push_back(starting_indices.back() + nodes.size());
+        node_connectivity.insert(node_connectivity.end(), nodes.begin(), nodes.end());
+      }
+    }
+  }
+
+  /// Create a linear system for the mesh, using the default matrix of the build
+  Handle<math::LSS::System> create_lss(const std::string& name)
+  {
+    Handle<math::LSS::System> lss = root.create_component<math::LSS::System>(name);
+    lss->create(mesh->geometry_fields().comm_pattern(), 1, node_connectivity, starting_indices);
+    lss->reset();
+    return lss;
+  }
+
+  /// Check that both systems hold exactly the same matrix and RHS
+  void check_equal(math::LSS::System& serial_lss, math::LSS::System& threaded_lss)
+  {
+    const Uint nb_nodes = starting_indices.size() - 1;
+    for(Uint row = 0; row != nb_nodes; ++row)
+    {
+      for(Uint i = starting_indices[row]; i != starting_indices[row+1]; ++i)
+      {
+        Real serial_value, threaded_value;
+        serial_lss.matrix()->get_value(node_connectivity[i], row, serial_value);
+        threaded_lss.matrix()->get_value(node_connectivity[i], row, threaded_value);
+        BOOST_CHECK_EQUAL(serial_value, threaded_value);
+      }
+      Real serial_value, threaded_value;
+      serial_lss.rhs()->get_value(row, serial_value);
+      threaded_lss.rhs()->get_value(row, threaded_value);
+      BOOST_CHECK_EQUAL(serial_value, threaded_value);
+    }
+  }
+
+  Component& root;
+  static Handle<Model> model;
+  static Handle<Mesh> mesh;
+
+  static std::vector<Uint> node_connectivity;
+  static std::vector<Uint> starting_indices;
+};
+
+Handle<Model> ProtoThreadsFixture::model;
+Handle<Mesh> ProtoThreadsFixture::mesh;
+
+std::vector<Uint> ProtoThreadsFixture::node_connectivity;
+std::vector<Uint> ProtoThreadsFixture::starting_indices;
+
+BOOST_FIXTURE_TEST_SUITE( ProtoThreadsSuite, ProtoThreadsFixture )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( ThreadedAssembly )
+{
+  // Assemble the same system serially and with colouring over threads, the results must be identical
+  Handle<math::LSS::System> serial_lss = create_lss("serial_lss");
+  Handle<math::LSS::System> threaded_lss = create_lss("threaded_lss");
+
+  FieldVariable<0, ScalarField> T("ThreadedVar", "threaded");
+  mesh->geometry_fields().create_field("threaded", "ThreadedVar").add_tag("threaded");
+
+  SystemMatrix serial_matrix(*serial_lss);
+  SystemRHS serial_rhs(*serial_lss);
+  SystemMatrix threaded_matrix(*threaded_lss);
+  SystemRHS threaded_rhs(*threaded_lss);
+
+  for_each_element<boost::mpl::vector1<mesh::LagrangeP1::Quad2D> >(mesh->topology(), group
+  (
+    _A = _0, _a = _0,
+    element_quadrature
+    (
+      _A(T,T) += transpose(nabla(T)) * nabla(T),
+      _a[T] += transpose(N(T))
+    ),
+    serial_matrix += _A,
+    serial_rhs += _a
+  ), 1);
+
+  for_each_element<boost::mpl::vector1<mesh::LagrangeP1::Quad2D> >(mesh->topology(), group
+  (
+    _A = _0, _a = _0,
+    element_quadrature
+    (
+      _A(T,T) += transpose(nabla(T)) * nabla(T),
+      _a[T] += transpose(N(T))
+    ),
+    threaded_matrix += _A,
+    threaded_rhs += _a
+  ), 4);
+
+  check_equal(*serial_lss, *threaded_lss);
+}
+
+BOOST_AUTO_TEST_CASE( CleanUp )
+{
+  root.remove_component("serial_lss");
+  root.remove_component("threaded_lss");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//////////////////////////////////////////////////////////////////////////////
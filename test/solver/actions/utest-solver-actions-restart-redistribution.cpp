@@ -0,0 +1,259 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for reading restart files on a different partitioning"
+
+#include <boost/foreach.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Connectivity.hpp"
+
+#include "solver/Time.hpp"
+#include "solver/actions/ReadRestartFile.hpp"
+#include "solver/actions/WriteRestartFile.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct RestartFixture
+{
+  RestartFixture() : root(Core::instance().root())
+  {
+  }
+
+  /// Generate part of a square mesh with fields u on the nodes and p on the elements. The part may differ from the rank.
+  Mesh& generate_mesh(const std::string& name, const Uint part)
+  {
+    boost::shared_ptr<MeshGenerator> generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator", "generator_" + name);
+    root.add_component(generator);
+    generator->options().set("mesh", root.uri()/name);
+    generator->options().set("lengths", std::vector<Real>(2, 1.));
+    std::vector<Uint> nb_cells(2, 10);
+    nb_cells[XX] = 12;
+    generator->options().set("nb_cells", nb_cells);
+    generator->options().set("part", part);
+    generator->options().set("nb_parts", PE::Comm::instance().size());
+    Mesh& mesh = generator->generate();
+
+    // Part p is held by rank (p + nb_procs - 1) % nb_procs when the parts are shifted, so relabel the owners accordingly
+    const Uint nb_procs = PE::Comm::instance().size();
+    if(part != PE::Comm::instance().rank())
+    {
+      relabel(mesh.geometry_fields().rank(), nb_procs);
+      BOOST_FOREACH(Entities& entities, find_components_recursively<Entities>(mesh.topology()))
+      {
+        relabel(entities.rank(), nb_procs);
+      }
+    }
+
+    mesh.geometry_fields().create_field("u", "u[vector]");
+    mesh.create_discontinuous_space("elems_P0", "cf3.mesh.LagrangeP0").create_field("p", "p[scalar]");
+    return mesh;
+  }
+
+  void relabel(List<Uint>& ranks, const Uint nb_procs)
+  {
+    for(Uint i = 0; i != ranks.size(); ++i)
+      ranks[i] = (ranks[i] + nb_procs - 1) % nb_procs;
+  }
+
+  Field& u(Mesh& mesh)
+  {
+    return *Handle<Field>(mesh.geometry_fields().get_child("u"));
+  }
+
+  Field& p(Mesh& mesh)
+  {
+    return *Handle<Field>(mesh.get_child("elems_P0")->get_child("p"));
+  }
+
+  /// Set the fields to a function of the coordinates and the element global index, or to zero
+  void set_fields(Mesh& mesh, const bool zero)
+  {
+    Field& u_field = u(mesh);
+    const Field& coords = mesh.geometry_fields().coordinates();
+    for(Uint i = 0; i != coords.size(); ++i)
+    {
+      u_field[i][XX] = zero ? 0. : coords[i][XX] + 2.*coords[i][YY];
+      u_field[i][YY] = zero ? 0. : coords[i][XX] * coords[i][YY];
+    }
+
+    Field& p_field = p(mesh);
+    BOOST_FOREACH(const Handle<Space>& space, p_field.dict().spaces())
+    {
+      const Entities& entities = space->support();
+      for(Uint e = 0; e != entities.size(); ++e)
+        p_field[space->connectivity()[e][0]][0] = zero ? 0. : entities.glb_idx()[e] + 0.5;
+    }
+  }
+
+  void check_fields(Mesh& mesh)
+  {
+    const Field& u_field = u(mesh);
+    const Field& coords = mesh.geometry_fields().coordinates();
+    BOOST_CHECK(coords.size() > 0);
+    for(Uint i = 0; i != coords.size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(u_field[i][XX], coords[i][XX] + 2.*coords[i][YY]);
+      BOOST_CHECK_EQUAL(u_field[i][YY], coords[i][XX] * coords[i][YY]);
+    }
+
+    const Field& p_field = p(mesh);
+    BOOST_FOREACH(const Handle<Space>& space, p_field.dict().spaces())
+    {
+      const Entities& entities = space->support();
+      for(Uint e = 0; e != entities.size(); ++e)
+        BOOST_CHECK_EQUAL(p_field[space->connectivity()[e][0]][0], entities.glb_idx()[e] + 0.5);
+    }
+  }
+
+  void read(Mesh& mesh, const std::string& file = "restart-redistribution.cf3restart")
+  {
+    boost::shared_ptr<actions::ReadRestartFile> reader = allocate_component<actions::ReadRestartFile>("Reader");
+    reader->options().set("mesh", mesh.handle<Mesh>());
+    reader->options().set("file", URI(file));
+    reader->options().set("time", root.get_child("Time")->handle<Time>());
+    reader->execute();
+  }
+
+  Component& root;
+};
+
+BOOST_FIXTURE_TEST_SUITE( RestartSuite, RestartFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+BOOST_AUTO_TEST_CASE( Write )
+{
+  Mesh& mesh = generate_mesh("original", PE::Comm::instance().rank());
+  set_fields(mesh, false);
+
+  Time& time = *root.create_component<Time>("Time");
+  time.options().set("current_time", 2.);
+  time.options().set("time_step", 0.5);
+
+  std::vector< Handle<Field> > fields;
+  fields.push_back(u(mesh).handle<Field>());
+  fields.push_back(p(mesh).handle<Field>());
+
+  boost::shared_ptr<actions::WriteRestartFile> writer = allocate_component<actions::WriteRestartFile>("Writer");
+  writer->options().set("fields", fields);
+  writer->options().set("file", URI("restart-redistribution.cf3restart"));
+  writer->options().set("time", time.handle<Time>());
+  writer->execute();
+}
+
+BOOST_AUTO_TEST_CASE( ReadSamePartitioning )
+{
+  Mesh& mesh = *Handle<Mesh>(root.get_child("original"));
+  set_fields(mesh, true);
+  read(mesh);
+  check_fields(mesh);
+  BOOST_CHECK_EQUAL(Handle<Time>(root.get_child("Time"))->current_time(), 2.);
+}
+
+BOOST_AUTO_TEST_CASE( ReadShiftedPartitioning )
+{
+  // Each rank holds the part that was written by the next rank
+  PE::Comm& comm = PE::Comm::instance();
+  Mesh& mesh = generate_mesh("shifted", (comm.rank() + 1) % comm.size());
+  set_fields(mesh, true);
+  read(mesh);
+  check_fields(mesh);
+}
+
+BOOST_AUTO_TEST_CASE( WriteAsynchronousSharedFile )
+{
+  Mesh& mesh = *Handle<Mesh>(root.get_child("original"));
+  set_fields(mesh, false);
+
+  std::vector< Handle<Field> > fields;
+  fields.push_back(u(mesh).handle<Field>());
+  fields.push_back(p(mesh).handle<Field>());
+
+  boost::shared_ptr<actions::WriteRestartFile> writer = allocate_component<actions::WriteRestartFile>("AsyncWriter");
+  writer->options().set("fields", fields);
+  writer->options().set("time", root.get_child("Time")->handle<Time>());
+  writer->options().set("asynchronous", true);
+  writer->options().set("max_pending_outputs", 1u);
+  writer->options().set("shared_file", true);
+  writer->options().set("file", URI("restart-async-1.cf3restart"));
+  writer->execute();
+  writer->options().set("file", URI("restart-async-2.cf3restart"));
+  writer->execute();
+
+  // The field data was copied, so it may be changed while the output is pending
+  set_fields(mesh, true);
+  writer->wait_for_output();
+
+  read(mesh, "restart-async-1.cf3restart");
+  check_fields(mesh);
+  set_fields(mesh, true);
+  read(mesh, "restart-async-2.cf3restart");
+  check_fields(mesh);
+}
+
+BOOST_AUTO_TEST_CASE( WriteAsynchronousSameFile )
+{
+  Mesh& mesh = *Handle<Mesh>(root.get_child("original"));
+
+  std::vector< Handle<Field> > fields;
+  fields.push_back(u(mesh).handle<Field>());
+  fields.push_back(p(mesh).handle<Field>());
+
+  boost::shared_ptr<actions::WriteRestartFile> writer = allocate_component<actions::WriteRestartFile>("SameFileWriter");
+  writer->options().set("fields", fields);
+  writer->options().set("time", root.get_child("Time")->handle<Time>());
+  writer->options().set("asynchronous", true);
+  writer->options().set("max_pending_outputs", 2u);
+  writer->options().set("file", URI("restart-async-same.cf3restart"));
+
+  // The second output overwrites the first one, which must be complete before the file is opened again
+  set_fields(mesh, true);
+  writer->execute();
+  set_fields(mesh, false);
+  writer->execute();
+  writer->wait_for_output();
+
+  set_fields(mesh, true);
+  read(mesh, "restart-async-same.cf3restart");
+  check_fields(mesh);
+}
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
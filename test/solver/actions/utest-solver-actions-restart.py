@@ -64,6 +64,10 @@ writer = domain.create_component('Writer', 'cf3.solver.actions.WriteRestartFile'
 writer.fields = [mesh.geometry.node_gids, mesh.elems_P0.element_gids]
 writer.file = restart_file
 writer.time = time
+# Small chunks, so the data blocks are split and compressed on several threads
+writer.codec = 'zlib_fast'
+writer.chunk_size = 64
+writer.nb_threads = 2
 writer.execute()
 
 # Store reference data and destroy the original
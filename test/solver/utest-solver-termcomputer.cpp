@@ -0,0 +1,311 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::solver::TermComputer"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Core.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/LagrangeP1/Quad2D.hpp"
+
+#include "solver/ComputeRHS.hpp"
+#include "solver/TermComputer.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Value of the test terms in a node of an element
+inline Real term_value(const Uint elem_glb_idx, const Uint node, const Uint eq)
+{
+  return 100.*elem_glb_idx + 10.*node + eq;
+}
+
+inline Real wave_speed_value(const Uint elem_glb_idx, const Uint node)
+{
+  return static_cast<Real>(elem_glb_idx + node);
+}
+
+/// Term implemented through the element-wise virtual interface
+class ElementwiseTerm : public TermComputer
+{
+public:
+  ElementwiseTerm(const std::string& name) : TermComputer(name) {}
+  static std::string type_name () { return "ElementwiseTerm"; }
+
+  using TermComputer::compute_term;
+
+  virtual bool loop_cells(const Handle<Entities const>& cells)
+  {
+    m_cells = cells;
+    return cells->element_type().dimensionality() == 2;
+  }
+
+  virtual void compute_term(const Uint elem_idx, std::vector<RealVector>& term, std::vector<Real>& wave_speed)
+  {
+    term.resize(4, RealVector(2));
+    wave_speed.resize(4);
+    const Uint glb_idx = m_cells->glb_idx()[elem_idx];
+    for (Uint node=0; node<4; ++node)
+    {
+      for (Uint eq=0; eq<2; ++eq)
+        term[node][eq] = term_value(glb_idx, node, eq);
+      wave_speed[node] = wave_speed_value(glb_idx, node);
+    }
+  }
+
+private:
+  Handle<Entities const> m_cells;
+};
+
+/// The same term, implemented for a fixed element type and number of equations
+class BlockTerm : public TermComputerT<BlockTerm, LagrangeP1::Quad2D, 2>
+{
+public:
+  BlockTerm(const std::string& name) : TermComputerT<BlockTerm, LagrangeP1::Quad2D, 2>(name) {}
+  static std::string type_name () { return "BlockTerm"; }
+
+  virtual bool loop_cells(const Handle<Entities const>& cells)
+  {
+    m_cells = cells;
+    return cells->element_type().dimensionality() == 2;
+  }
+
+  // Only reads the mesh, so the blocks can be computed concurrently
+  virtual bool thread_safe() const { return true; }
+
+  void compute_element(const Uint elem_idx, TermMap& term, WaveSpeedMap& wave_speed)
+  {
+    const Uint glb_idx = m_cells->glb_idx()[elem_idx];
+    for (Uint node=0; node<nb_nodes; ++node)
+    {
+      for (Uint eq=0; eq<nb_eqs; ++eq)
+        term(node, eq) = term_value(glb_idx, node, eq);
+      wave_speed[node] = wave_speed_value(glb_idx, node);
+    }
+  }
+
+private:
+  Handle<Entities const> m_cells;
+};
+
+/// Term that fails on the first element, which is computed by the calling thread
+class ThrowingTerm : public TermComputerT<ThrowingTerm, LagrangeP1::Quad2D, 2>
+{
+public:
+  ThrowingTerm(const std::string& name) : TermComputerT<ThrowingTerm, LagrangeP1::Quad2D, 2>(name) {}
+  static std::string type_name () { return "ThrowingTerm"; }
+
+  virtual bool loop_cells(const Handle<Entities const>& cells)
+  {
+    return cells->element_type().dimensionality() == 2;
+  }
+
+  virtual bool thread_safe() const { return true; }
+
+  void compute_element(const Uint elem_idx, TermMap& term, WaveSpeedMap& wave_speed)
+  {
+    if (elem_idx == 0)
+      throw BadValue(FromHere(), "Failing on the first element");
+    term.setZero();
+    wave_speed.setZero();
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct TermComputerFixture
+{
+  TermComputerFixture() : root(Core::instance().root()) {}
+
+  /// Check that two fields are equal
+  static void check_equal(const Field& a, const Field& b)
+  {
+    BOOST_REQUIRE_EQUAL(a.size(), b.size());
+    BOOST_REQUIRE_EQUAL(a.row_size(), b.row_size());
+    for (Uint i=0; i<a.size(); ++i)
+      for (Uint j=0; j<a.row_size(); ++j)
+        BOOST_CHECK_EQUAL(a[i][j], b[i][j]);
+  }
+
+  Component& root;
+};
+
+BOOST_FIXTURE_TEST_SUITE( TermComputerSuite, TermComputerFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+
+  Mesh& mesh = *root.create_component<Mesh>("mesh");
+  Handle<SimpleMeshGenerator> generator = root.create_component<SimpleMeshGenerator>("generator");
+  generator->options().set("nb_cells", std::vector<Uint>(2, 7u));
+  generator->options().set("lengths", std::vector<Real>(2, 1.));
+  generator->options().set("mesh", mesh.uri());
+  generator->execute();
+
+  Dictionary& discontinuous = mesh.create_discontinuous_space("discontinuous", "cf3.mesh.LagrangeP1");
+  Dictionary& continuous = mesh.create_continuous_space("continuous", "cf3.mesh.LagrangeP1");
+  const std::string names[] = { "elementwise", "block", "rhs" };
+  for (Uint i=0; i<3; ++i)
+  {
+    discontinuous.create_field(names[i], 2u);
+    discontinuous.create_field(names[i] + "_ws", 1u);
+    continuous.create_field(names[i], 2u);
+    continuous.create_field(names[i] + "_ws", 1u);
+  }
+
+  root.create_component<ElementwiseTerm>("elementwise");
+  root.create_component<BlockTerm>("block");
+}
+
+BOOST_AUTO_TEST_CASE( Discontinuous )
+{
+  Dictionary& dict = *Handle<Dictionary>(root.access_component("mesh/discontinuous"));
+  Field& elementwise = *Handle<Field>(dict.get_child("elementwise"));
+  Field& elementwise_ws = *Handle<Field>(dict.get_child("elementwise_ws"));
+  Field& block = *Handle<Field>(dict.get_child("block"));
+  Field& block_ws = *Handle<Field>(dict.get_child("block_ws"));
+
+  TermComputer& elementwise_term = *Handle<TermComputer>(root.get_child("elementwise"));
+  TermComputer& block_term = *Handle<TermComputer>(root.get_child("block"));
+
+  elementwise_term.options().set("block_size", 1u);
+  elementwise_term.compute_term(elementwise, elementwise_ws);
+
+  // Check the values of the element-wise version
+  boost_foreach(const Handle<Space>& space, dict.spaces())
+  {
+    if (space->support().element_type().dimensionality() != 2)
+      continue;
+    for (Uint e=0; e<space->size(); ++e)
+    {
+      for (Uint node=0; node<4; ++node)
+      {
+        const Uint p = space->connectivity()[e][node];
+        BOOST_CHECK_EQUAL(elementwise[p][1], term_value(space->support().glb_idx()[e], node, 1));
+        BOOST_CHECK_EQUAL(elementwise_ws[p][0], wave_speed_value(space->support().glb_idx()[e], node));
+      }
+    }
+  }
+
+  const Uint block_sizes[] = { 1u, 5u, 32u };
+  for (Uint b=0; b<3; ++b)
+  {
+    for (Uint nb_threads=1; nb_threads<=3; nb_threads+=2)
+    {
+      block_term.options().set("block_size", block_sizes[b]);
+      block_term.options().set("nb_threads", nb_threads);
+      block_term.compute_term(block, block_ws);
+      check_equal(block, elementwise);
+      check_equal(block_ws, elementwise_ws);
+
+      elementwise_term.options().set("block_size", block_sizes[b]);
+      elementwise_term.options().set("nb_threads", nb_threads);
+      elementwise_term.compute_term(block, block_ws);
+      check_equal(block, elementwise);
+      check_equal(block_ws, elementwise_ws);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Continuous )
+{
+  Dictionary& dict = *Handle<Dictionary>(root.access_component("mesh/continuous"));
+  Field& elementwise = *Handle<Field>(dict.get_child("elementwise"));
+  Field& elementwise_ws = *Handle<Field>(dict.get_child("elementwise_ws"));
+  Field& block = *Handle<Field>(dict.get_child("block"));
+  Field& block_ws = *Handle<Field>(dict.get_child("block_ws"));
+
+  TermComputer& elementwise_term = *Handle<TermComputer>(root.get_child("elementwise"));
+  TermComputer& block_term = *Handle<TermComputer>(root.get_child("block"));
+
+  elementwise_term.options().set("block_size", 1u);
+  elementwise_term.options().set("nb_threads", 1u);
+  elementwise_term.compute_term(elementwise, elementwise_ws);
+
+  // Shared nodes accumulate the term of all elements, also when more threads are requested
+  block_term.options().set("block_size", 5u);
+  block_term.options().set("nb_threads", 3u);
+  block_term.compute_term(block, block_ws);
+  check_equal(block, elementwise);
+  check_equal(block_ws, elementwise_ws);
+}
+
+BOOST_AUTO_TEST_CASE( Errors )
+{
+  Dictionary& dict = *Handle<Dictionary>(root.access_component("mesh/discontinuous"));
+  Field& block = *Handle<Field>(dict.get_child("block"));
+  Field& block_ws = *Handle<Field>(dict.get_child("block_ws"));
+
+  ThrowingTerm& throwing_term = *root.create_component<ThrowingTerm>("throwing");
+
+  // Serially, the error keeps its type
+  throwing_term.options().set("nb_threads", 1u);
+  BOOST_CHECK_THROW(throwing_term.compute_term(block, block_ws), BadValue);
+
+  // An error in the calling thread is reported after all threads are joined
+  throwing_term.options().set("nb_threads", 3u);
+  BOOST_CHECK_THROW(throwing_term.compute_term(block, block_ws), ParallelError);
+
+  root.remove_component("throwing");
+}
+
+BOOST_AUTO_TEST_CASE( RHS )
+{
+  Dictionary& dict = *Handle<Dictionary>(root.access_component("mesh/discontinuous"));
+  Field& block = *Handle<Field>(dict.get_child("block"));
+  Field& block_ws = *Handle<Field>(dict.get_child("block_ws"));
+  Field& rhs = *Handle<Field>(dict.get_child("rhs"));
+  Field& rhs_ws = *Handle<Field>(dict.get_child("rhs_ws"));
+
+  Handle<TermComputer>(root.get_child("block"))->compute_term(block, block_ws);
+
+  // The right hand side is the sum of both terms, the wave speed their maximum
+  ComputeRHS& compute_rhs = *root.create_component<ComputeRHS>("compute_rhs");
+  compute_rhs.create_component<ElementwiseTerm>("elementwise");
+  compute_rhs.create_component<BlockTerm>("block");
+  compute_rhs.options().set("block_size", 3u);
+  compute_rhs.compute_rhs(rhs, rhs_ws);
+
+  for (Uint i=0; i<rhs.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(rhs[i][0], 2.*block[i][0]);
+    BOOST_CHECK_EQUAL(rhs[i][1], 2.*block[i][1]);
+    BOOST_CHECK_EQUAL(rhs_ws[i][0], block_ws[i][0]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////